@@ -56,19 +56,42 @@
           ]
         }
       },
+      "variables": {
+        "disable_debug_log%": "0"
+      },
       "defines": [
         "NAPI_CPP_EXCEPTIONS",
         "NAPI_VERSION=8"
       ],
       "conditions": [
+        ["disable_debug_log==1", {
+          "defines": [
+            "TUNTAP_DISABLE_DEBUG_LOG"
+          ]
+        }],
         ["OS=='linux'", {
+          "variables": {
+            "have_liburing%": "<!(pkg-config --exists liburing 2>/dev/null && echo 1 || echo 0)"
+          },
           "sources": [
             "src/native/file_descriptor.cc",
             "src/native/posix_uv_poll_loop.cc",
+            "src/native/async_reader.cc",
+            "src/native/async_writer.cc",
             "src/native/debug_log.cc",
+            "src/native/forwarding_hub.cc",
+            "src/native/link_stats.cc",
+            "src/native/packet_pool.cc",
+            "src/native/packet_ring.cc",
+            "src/native/rtnetlink.cc",
+            "src/native/tcp_offload.cc",
             "src/native/tun_backend_linux.cc",
+            "src/native/tun_backend_linux_uring.cc",
+            "src/native/thread_tuning.cc",
             "src/native/tunnel_ssl.cc",
-            "src/native/tunnel_forwarder.cc"
+            "src/native/tunnel_pump.cc",
+            "src/native/tunnel_forwarder.cc",
+            "src/native/wakeup_event.cc"
           ],
           "cflags": [
             "-pthread"
@@ -85,6 +108,19 @@
             "<!(pkg-config --variable=libdir openssl)/libcrypto.a",
             "-ldl",
             "-lz"
+          ],
+          "conditions": [
+            ["have_liburing==1", {
+              "defines": [
+                "TUNTAP_HAVE_LIBURING"
+              ],
+              "include_dirs": [
+                "<!(pkg-config --cflags-only-I liburing 2>/dev/null | sed 's/-I//g')"
+              ],
+              "ldflags": [
+                "<!(pkg-config --variable=libdir liburing)/liburing.a"
+              ]
+            }]
           ]
         }],
         ["OS=='mac'", {
@@ -94,10 +130,19 @@
           "sources": [
             "src/native/file_descriptor.cc",
             "src/native/posix_uv_poll_loop.cc",
+            "src/native/async_reader.cc",
+            "src/native/async_writer.cc",
             "src/native/debug_log.cc",
+            "src/native/forwarding_hub.cc",
+            "src/native/packet_pool.cc",
+            "src/native/packet_ring.cc",
+            "src/native/tcp_offload.cc",
             "src/native/tun_backend_darwin.cc",
+            "src/native/thread_tuning.cc",
             "src/native/tunnel_ssl.cc",
-            "src/native/tunnel_forwarder.cc"
+            "src/native/tunnel_pump.cc",
+            "src/native/tunnel_forwarder.cc",
+            "src/native/wakeup_event.cc"
           ],
           "include_dirs": [
             "<!(pkg-config --cflags-only-I openssl 2>/dev/null | sed 's/-I//g' || echo '<(openssl_prefix)/include')"
@@ -117,12 +162,20 @@
             "openssl_root%": "<!(node -p \"process.env.OPENSSL_ROOT_DIR || process.env.OPENSSL_ROOT || ''\")"
           },
           "sources": [
+            "src/native/async_reader.cc",
+            "src/native/async_writer.cc",
             "src/native/debug_log.cc",
             "src/native/handle.cc",
+            "src/native/packet_pool.cc",
+            "src/native/packet_ring.cc",
             "src/native/wintun_loader.cc",
+            "src/native/tcp_offload.cc",
             "src/native/tun_backend_windows.cc",
+            "src/native/thread_tuning.cc",
             "src/native/tunnel_ssl.cc",
-            "src/native/tunnel_forwarder.cc"
+            "src/native/tunnel_pump.cc",
+            "src/native/tunnel_forwarder.cc",
+            "src/native/wakeup_event.cc"
           ],
           "include_dirs": [
             "<(openssl_root)/include"
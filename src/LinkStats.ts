@@ -0,0 +1,114 @@
+/**
+ * Interface counters read by the addon, without spawning `ip` (Linux only).
+ *
+ * Counters come from `IFLA_STATS64` over a cached rtnetlink socket, one
+ * request per interface in a single send, or from
+ * `/sys/class/net/<name>/statistics` when netlink is unavailable.
+ */
+import {createRequire} from 'node:module';
+import path from 'node:path';
+import {fileURLToPath} from 'node:url';
+
+import {TunTapError} from './errors.js';
+import type {TunTapInterfaceStats} from './platform/types.js';
+
+const require = createRequire(import.meta.url);
+const pkgRoot = path.join(fileURLToPath(new URL('.', import.meta.url)), '..');
+
+/** Per-second rates between two {@link LinkRateMeter.sample} calls. */
+export interface LinkRates {
+  rxPps: number;
+  txPps: number;
+  /** Bits per second. */
+  rxBps: number;
+  txBps: number;
+  rxErrorsPerSec: number;
+  txErrorsPerSec: number;
+  rxDropsPerSec: number;
+  txDropsPerSec: number;
+}
+
+/** One interface's entry in a {@link LinkRateMeter.sample} result. */
+export interface LinkStatsSample {
+  stats: TunTapInterfaceStats;
+  /** `null` on the first sample of an interface. */
+  rates: LinkRates | null;
+  /** Time since the previous sample of this interface (0 on the first). */
+  intervalMs: number;
+}
+
+interface NativeLinkStats {
+  read(names: string[]): (TunTapInterfaceStats | null)[];
+  RateMeter: new () => {sample(names: string[]): (LinkStatsSample | null)[]};
+}
+
+/** Error thrown by the native reader. */
+interface NativeLinkStatsError extends Error {
+  /** errno name, e.g. `EACCES`. */
+  code?: string;
+}
+
+function loadNative(): NativeLinkStats {
+  const native = require('node-gyp-build')(pkgRoot) as {linkStats?: NativeLinkStats};
+  if (!native.linkStats) {
+    throw new TunTapError('Native link statistics are only available on Linux', 'ENOTSUP');
+  }
+  return native.linkStats;
+}
+
+function callNative<T>(fn: () => T): T {
+  try {
+    return fn();
+  } catch (err: unknown) {
+    if (err instanceof TypeError) {
+      throw err;
+    }
+    const {message, code} = err as NativeLinkStatsError;
+    throw new TunTapError(`Failed to read interface statistics: ${message}`, code);
+  }
+}
+
+/**
+ * Reads the counters of several interfaces at once.
+ *
+ * @param names — kernel interface names
+ * @returns counters in the order of `names`, `null` for interfaces that do not exist
+ * @throws {TunTapError} off Linux, or if neither netlink nor sysfs can be read
+ */
+export function readLinkStats(names: string[]): (TunTapInterfaceStats | null)[] {
+  const native = loadNative();
+  return callNative(() => native.read(names));
+}
+
+/**
+ * Samples interface counters and derives rates from consecutive samples.
+ * Each meter keeps its own previous sample per interface, so pollers with
+ * different intervals do not disturb each other.
+ *
+ * @example
+ * ```ts
+ * const meter = new LinkRateMeter();
+ * setInterval(() => {
+ *   const [tun] = meter.sample([tunTap.name]);
+ *   if (tun?.rates) console.log(tun.rates.rxPps, tun.rates.rxBps);
+ * }, 1000);
+ * ```
+ */
+export class LinkRateMeter {
+  private readonly meter: InstanceType<NativeLinkStats['RateMeter']>;
+
+  /** @throws {TunTapError} off Linux */
+  constructor() {
+    const native = loadNative();
+    this.meter = new native.RateMeter();
+  }
+
+  /**
+   * @param names — kernel interface names
+   * @returns one entry per name, `null` for interfaces that do not exist
+   * @throws {TunTapError} if neither netlink nor sysfs can be read
+   */
+  sample(names: string[]): (LinkStatsSample | null)[] {
+    return callNative(() => this.meter.sample(names));
+  }
+}
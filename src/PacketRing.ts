@@ -0,0 +1,173 @@
+/**
+ * Consumer side of the shared packet ring filled by {@link TunTap.startRing}.
+ *
+ * This module has no native dependency, so a worker thread can import it and
+ * consume packets from the `SharedArrayBuffer` it received via `postMessage`.
+ * The memory layout is defined in `src/native/packet_ring.h`.
+ */
+
+/** Header size in bytes; slots follow it. */
+const RING_HEADER_BYTES = 64;
+/** Per-slot header: `uint32` packet length plus 4 reserved bytes. */
+export const RING_SLOT_HEADER_BYTES = 8;
+const RING_MAGIC = 0x54524e47;
+
+// Header word indices (32-bit).
+const WRITE_INDEX = 0;
+const READ_INDEX = 1;
+const SLOT_COUNT = 2;
+const SLOT_SIZE = 3;
+const CONSUMER_WAITING = 4;
+const STATE = 5;
+const MAGIC = 6;
+
+const STATE_RUNNING = 0;
+const STATE_FAILED = 2;
+
+type WaitAsyncResult =
+  | {async: false; value: 'not-equal' | 'timed-out'}
+  | {async: true; value: Promise<'ok' | 'timed-out'>};
+// `Atomics.waitAsync` is missing from the es2023 lib typings.
+const atomicsWaitAsync = (
+  Atomics as unknown as {
+    waitAsync(array: Int32Array, index: number, value: number, timeout?: number): WaitAsyncResult;
+  }
+).waitAsync;
+
+/**
+ * Single-consumer view of a packet ring. Packets are handed out as
+ * `Uint8Array` views into the shared memory; a view stays valid only until
+ * the slot is released, after which the native side may overwrite it.
+ */
+export class PacketRing {
+  /** The shared memory; pass it to a worker and wrap it there with `new PacketRing(buffer)`. */
+  readonly buffer: SharedArrayBuffer;
+  readonly slotCount: number;
+  readonly slotSize: number;
+  private readonly header: Int32Array;
+  private readonly words: Uint32Array;
+  private readIndex: number;
+
+  /** Bytes of shared memory a ring of `slots` slots of `slotSize` bytes needs. */
+  static byteLength(slots: number, slotSize: number): number {
+    return RING_HEADER_BYTES + slots * slotSize;
+  }
+
+  /**
+   * @param buffer — ring memory, after {@link TunTap.startRing} initialized it
+   * @throws {TypeError} if `buffer` does not hold an initialized ring
+   */
+  constructor(buffer: SharedArrayBuffer) {
+    if (!(buffer instanceof SharedArrayBuffer) || buffer.byteLength < RING_HEADER_BYTES) {
+      throw new TypeError('Packet ring memory must be a SharedArrayBuffer');
+    }
+    this.buffer = buffer;
+    this.header = new Int32Array(buffer, 0, RING_HEADER_BYTES / 4);
+    this.words = new Uint32Array(buffer);
+    if (Atomics.load(this.header, MAGIC) !== RING_MAGIC) {
+      throw new TypeError('SharedArrayBuffer does not hold a started packet ring');
+    }
+    this.slotCount = Atomics.load(this.header, SLOT_COUNT);
+    this.slotSize = Atomics.load(this.header, SLOT_SIZE);
+    this.readIndex = Atomics.load(this.header, READ_INDEX) >>> 0;
+  }
+
+  /** Packets ready to read. */
+  get available(): number {
+    return ((Atomics.load(this.header, WRITE_INDEX) >>> 0) - this.readIndex) >>> 0;
+  }
+
+  /** Whether the producer has stopped (ring stopped, device closed or read error). */
+  get stopped(): boolean {
+    return Atomics.load(this.header, STATE) !== STATE_RUNNING;
+  }
+
+  /** Whether the producer stopped on an error rather than `stopRing()`/`close()`. */
+  get failed(): boolean {
+    return Atomics.load(this.header, STATE) === STATE_FAILED;
+  }
+
+  /**
+   * The oldest unread packet, or `null` when the ring is empty. The view is
+   * valid until {@link PacketRing.release}.
+   */
+  peek(): Uint8Array | null {
+    if (this.available === 0) {
+      return null;
+    }
+    return this.view(this.readIndex);
+  }
+
+  /** Hands `count` read packets back to the producer. */
+  release(count: number = 1): void {
+    const n = Math.min(count, this.available);
+    this.readIndex = (this.readIndex + n) >>> 0;
+    Atomics.store(this.header, READ_INDEX, this.readIndex | 0);
+  }
+
+  /**
+   * Calls `callback` for up to `max` ready packets, then releases them all at
+   * once. Views must not be kept after `callback` returns.
+   *
+   * @returns number of packets handled
+   */
+  drain(callback: (packet: Uint8Array) => void, max: number = Infinity): number {
+    const count = Math.min(this.available, max);
+    let handled = 0;
+    try {
+      for (; handled < count; handled++) {
+        callback(this.view((this.readIndex + handled) >>> 0));
+      }
+    } finally {
+      this.release(handled);
+    }
+    return handled;
+  }
+
+  /**
+   * Resolves once packets are ready (`true`) or the ring stopped or
+   * `timeoutMs` passed with it still empty (`false`). Never blocks the thread.
+   */
+  async waitAsync(timeoutMs?: number): Promise<boolean> {
+    const deadline = timeoutMs === undefined ? Infinity : Date.now() + timeoutMs;
+    for (;;) {
+      if (this.available > 0) {
+        return true;
+      }
+      if (this.stopped) {
+        return false;
+      }
+      // Announce the wait before re-reading the write index: the producer
+      // publishes, then checks this flag, so one of the two sides sees the other.
+      Atomics.store(this.header, CONSUMER_WAITING, 1);
+      const seen = Atomics.load(this.header, WRITE_INDEX);
+      if ((seen >>> 0) !== this.readIndex || this.stopped) {
+        continue;
+      }
+      const remaining = deadline - Date.now();
+      if (remaining <= 0) {
+        return false;
+      }
+      const result = atomicsWaitAsync(
+        this.header,
+        WRITE_INDEX,
+        seen,
+        remaining === Infinity ? undefined : remaining,
+      );
+      if (result.async) {
+        await result.value;
+      }
+    }
+  }
+
+  private view(index: number): Uint8Array {
+    const offset = RING_HEADER_BYTES + (index & (this.slotCount - 1)) * this.slotSize;
+    const length = this.words[offset / 4];
+    return new Uint8Array(this.buffer, offset + RING_SLOT_HEADER_BYTES, length);
+  }
+}
+
+/** Wakes every consumer parked in {@link PacketRing.waitAsync} on `buffer`. */
+export function notifyPacketRing(buffer: SharedArrayBuffer): void {
+  Atomics.notify(new Int32Array(buffer, 0, RING_HEADER_BYTES / 4), WRITE_INDEX);
+}
@@ -5,6 +5,7 @@ import {fileURLToPath} from 'node:url';
 
 import {TunTapDeviceError, TunTapError, TunTapPermissionError} from './errors.js';
 import {log} from './logger.js';
+import {notifyPacketRing, PacketRing, RING_SLOT_HEADER_BYTES} from './PacketRing.js';
 import {createTunTapPlatform} from './platform/create-platform.js';
 import type {TunTapInterfaceStats, TunTapPlatform} from './platform/types.js';
 
@@ -15,6 +16,19 @@ const DEFAULT_READ_BUFFER_SIZE = 4096;
 const MAX_BUFFER_SIZE = 0xffff; // 65535
 const DEFAULT_MTU = 1500;
 const MIN_MTU = 1280;
+const DEFAULT_MAX_BATCH = 32;
+const MAX_BATCH = 256;
+const DEFAULT_MAX_BATCH_DELAY_US = 200;
+const MAX_BATCH_DELAY_US = 1_000_000;
+const DEFAULT_READ_MANY_PACKETS = 64;
+const MAX_READ_MANY_PACKETS = 1024;
+const DEFAULT_READ_MANY_BYTES = 256 * 1024;
+const MAX_READ_MANY_BYTES = 4 * 1024 * 1024;
+const MAX_WRITE_MANY_PACKETS = 1024;
+const DEFAULT_WRITE_HIGH_WATER_MARK = 1024;
+const DEFAULT_RING_SLOTS = 1024;
+const MAX_RING_SLOTS = 65536;
+const DEFAULT_RING_SLOT_SIZE = 2048;
 
 /**
  * Called by {@link TunTap.startPolling} for each packet read from the TUN device.
@@ -23,21 +37,155 @@ const MIN_MTU = 1280;
  */
 export type PacketCallback = (data: Buffer) => void;
 
+/**
+ * Called by {@link TunTap.startPolling} in batch mode with several packets at
+ * once. Packet `i` is `data.subarray(offsets[i], offsets[i + 1])`; there are
+ * `offsets.length - 1` packets.
+ *
+ * @param data — the packets back to back
+ * @param offsets — packet boundaries within `data`
+ */
+export type PacketBatchCallback = (data: Buffer, offsets: Uint32Array) => void;
+
+/** Receive settings for {@link TunTap.startPolling}. */
+export interface PollingOptions {
+  /** Max read size per packet (default 65535). */
+  bufferSize?: number;
+  /** Deliveries the receive loop may queue ahead of JS (1–64, default 8). */
+  queueDepth?: number;
+  /** Device queues to poll (default {@link TunTap.queueCount}). */
+  queues?: number;
+  /**
+   * Deliver several packets per callback ({@link PacketBatchCallback}). A
+   * wakeup that finds a single packet delivers it at once; under load a
+   * partial batch waits up to `maxDelayUs` for more.
+   */
+  batch?: boolean;
+  /** Batch mode: packets per callback (1–256, default 32). */
+  maxBatch?: number;
+  /** Batch mode: longest a partial batch is held under load (0–1000000, default 200). */
+  maxDelayUs?: number;
+}
+
+/** Options for {@link TunTap.readAsync}. */
+export interface ReadAsyncOptions {
+  /** Give up after this many ms without a packet (default: wait until one arrives). */
+  timeoutMs?: number;
+}
+
+/** Options for {@link TunTap.readMany}. */
+export interface ReadManyOptions extends ReadAsyncOptions {
+  /** Max bytes per packet; longer packets are truncated (default 4096). */
+  maxSize?: number;
+}
+
+/**
+ * Back-pressure settings for {@link TunTap.writeAsync} and
+ * {@link TunTap.writeMany} (see {@link TunTap.setWriteQueueOptions}).
+ */
+export interface WriteQueueOptions {
+  /** Queued packets at which {@link TunTap.writeQueueFull} turns true (default 1024). */
+  highWaterMark?: number;
+  /** Called when the queue reaches `highWaterMark`. */
+  onHighWater?: (depth: number) => void;
+  /** Called when a full queue has drained to half of `highWaterMark`. */
+  onDrain?: (depth: number) => void;
+}
+
+/** Geometry of the shared packet ring created by {@link TunTap.startRing}. */
+export interface PacketRingOptions {
+  /** Packet slots (power of two, 2–65536, default 1024). */
+  slots?: number;
+  /**
+   * Bytes per slot including its 8-byte header (multiple of 8, default 2048).
+   * Longer packets are truncated to `slotSize - 8` bytes.
+   */
+  slotSize?: number;
+  /** Called on the main thread if the ring stops on a read error or device close. */
+  onError?: (error: TunTapError) => void;
+}
+
+/** Device settings fixed at construction (see {@link TunTap}). */
+export interface TunTapOptions {
+  /**
+   * Linux only: open the device with `IFF_VNET_HDR`, checksum offload and
+   * TSO so the tunnel forwarder can inject coalesced TCP super-packets (GRO)
+   * and read 64 KiB super-packets that it segments itself. Reads still return
+   * MTU-sized packets. Ignored on other platforms.
+   */
+  offload?: boolean;
+  /**
+   * Linux only: open this many queues (`IFF_MULTI_QUEUE`, 1–16, default 1).
+   * The kernel spreads flows across queues by hash; the threaded tunnel
+   * forwarder runs one reader per queue. Ignored on other platforms.
+   */
+  queues?: number;
+  /**
+   * Linux only: move TUN reads and writes onto io_uring with registered
+   * buffers (single-queue devices). Needs a build against liburing; falls back
+   * to plain `read()`/`write()` when unavailable (see {@link TunTap.ioUringEnabled}).
+   */
+  ioUring?: boolean;
+}
+
+/** Counters of the native packet buffer pool shared by every device. */
+export interface PacketPoolStats {
+  /** Buffers ever allocated from the heap; stays flat once traffic is steady. */
+  heapAllocations: number;
+  /** Requests larger than the biggest size class (heap-allocated each time). */
+  oversizeAllocations: number;
+  /** Buffers handed out. */
+  acquired: number;
+  /** Buffers returned, including those freed by GC of packet `Buffer`s. */
+  released: number;
+  /** Buffers idle in the shared free lists (per-thread caches not included). */
+  pooled: number;
+}
+
 interface NativeTunDevice {
   open(): boolean;
   close(): void;
   read(maxSize: number): Buffer;
   write(data: Buffer): number;
+  writeMany(packets: Uint8Array[]): Promise<number>;
+  readInto(buffer: Uint8Array, offset: number): number;
+  writeFrom(buffer: Uint8Array, offset: number, length: number): number;
+  readMany(
+    maxPackets: number,
+    maxSize: number,
+    maxBytes: number,
+    timeoutMs?: number,
+  ): Promise<[Buffer, Uint32Array] | null>;
   getName(): string;
   getFd(): number;
+  getOffloadEnabled(): boolean;
+  getQueueCount(): number;
+  getIoUringEnabled(): boolean;
   getForwardingHandle(): unknown;
-  startPolling(callback: PacketCallback, bufferSize?: number, queueDepth?: number): void;
+  startPolling(
+    callback: PacketCallback | PacketBatchCallback,
+    bufferSize?: number,
+    queueDepth?: number,
+    queues?: number,
+    maxBatch?: number,
+    maxDelayUs?: number,
+  ): void;
   pausePolling(): void;
   resumePolling(): void;
+  startRing(
+    memory: Uint8Array,
+    slots: number,
+    slotSize: number,
+    wakeup: (error?: string) => void,
+  ): void;
+  stopRing(): void;
 }
 
 interface NativeTuntapModule {
-  TunDevice: new (name?: string) => NativeTunDevice;
+  TunDevice: {
+    new (name?: string, options?: TunTapOptions): NativeTunDevice;
+    getPacketPoolStats(): PacketPoolStats;
+  };
 }
 
 const nativeTuntap = require('node-gyp-build')(pkgRoot) as NativeTuntapModule;
@@ -53,13 +201,28 @@ export class TunTap {
   private _isOpen: boolean;
   private _isClosed: boolean;
   private removeExitListener: (() => void) | null = null;
+  private writeQueue: Required<Pick<WriteQueueOptions, 'highWaterMark'>> & WriteQueueOptions = {
+    highWaterMark: DEFAULT_WRITE_HIGH_WATER_MARK,
+  };
+  private writesQueued = 0;
+  private writeQueueHigh = false;
+
+  /** Allocation counters of the native packet buffer pool (process-wide). */
+  static getPacketPoolStats(): PacketPoolStats {
+    return nativeTuntap.TunDevice.getPacketPoolStats();
+  }
 
   /**
    * @param name — optional interface name hint for the native layer
    * @param platform — Node.js platform id (e.g. `darwin`, `linux`); defaults to `process.platform`
+   * @param options — native device settings such as segmentation offload
    */
-  constructor(name: string = '', platform: NodeJS.Platform = process.platform) {
-    this.device = new nativeTuntap.TunDevice(name);
+  constructor(
+    name: string = '',
+    platform: NodeJS.Platform = process.platform,
+    options: TunTapOptions = {},
+  ) {
+    this.device = new nativeTuntap.TunDevice(name, options);
     this.platformBackend = createTunTapPlatform(platform);
     this._isOpen = false;
     this._isClosed = false;
@@ -83,6 +246,19 @@ export class TunTap {
     };
   }
 
+  /**
+   * Packets handed to {@link TunTap.writeAsync}/{@link TunTap.writeMany} and
+   * not yet completed.
+   */
+  get writeQueueDepth(): number {
+    return this.writesQueued;
+  }
+
+  /** Whether the write queue has reached its high-water mark; hold further writes until `onDrain`. */
+  get writeQueueFull(): boolean {
+    return this.writeQueueHigh;
+  }
+
   /** Whether {@link TunTap.open} has succeeded and {@link TunTap.close} has not run. */
   get isOpen(): boolean {
     return this._isOpen;
@@ -98,11 +274,31 @@ export class TunTap {
     return this.device.getName();
   }
 
-  /** File descriptor for the open TUN device (for advanced use). */
+  /**
+   * File descriptor for the open TUN device (for advanced use). While
+   * {@link TunTap.ioUringEnabled} is true the descriptor is in blocking mode,
+   * since io_uring parks its queued reads on it; it is non-blocking again
+   * once the device closes.
+   */
   get fd(): number {
     return this.device.getFd();
   }
 
+  /** Whether the device was opened with segmentation offload (see {@link TunTapOptions.offload}). */
+  get offloadEnabled(): boolean {
+    return this.device.getOffloadEnabled();
+  }
+
+  /** Number of queues the device was opened with (see {@link TunTapOptions.queues}). */
+  get queueCount(): number {
+    return this.device.getQueueCount();
+  }
+
+  /** Whether reads and writes go through io_uring (see {@link TunTapOptions.ioUring}). */
+  get ioUringEnabled(): boolean {
+    return this.device.getIoUringEnabled();
+  }
+
   /** @internal Opaque native handle consumed by the tunnel forwarder. */
   get forwardingHandle(): unknown {
     this.assertReady();
@@ -189,6 +385,222 @@ export class TunTap {
     }
   }
 
+  /**
+   * Queue one packet for the native writer thread, which writes queued
+   * packets in batches and waits for writability on back-pressure, so the
+   * event loop never makes the write syscall. The packet is copied, so
+   * `data` may be reused immediately.
+   *
+   * @returns bytes written once the packet reached the device
+   * @throws {TunTapError} if not open, closed, or the write fails
+   * @throws {TypeError} if `data` is not a `Uint8Array`/`Buffer`
+   * @throws {RangeError} if `data` is empty or exceeds the maximum buffer size
+   */
+  async writeAsync(data: Uint8Array): Promise<number> {
+    await this.writeMany([data]);
+    return data.length;
+  }
+
+  /**
+   * Queue several packets for the native writer thread in one call (see
+   * {@link TunTap.writeAsync}). Watch {@link TunTap.writeQueueFull} or the
+   * callbacks set with {@link TunTap.setWriteQueueOptions} to apply
+   * back-pressure.
+   *
+   * @returns number of packets written
+   * @throws {TunTapError} if not open, closed, or a write fails
+   * @throws {TypeError} if a packet is not a `Uint8Array`/`Buffer`
+   * @throws {RangeError} if there are no packets, more than 1024, or one is
+   *   empty or too large
+   */
+  async writeMany(packets: Uint8Array[]): Promise<number> {
+    this.assertReady();
+    if (!Array.isArray(packets)) {
+      throw new TypeError('Packets must be an array');
+    }
+    if (packets.length === 0 || packets.length > MAX_WRITE_MANY_PACKETS) {
+      throw new RangeError(`Packet count must be between 1 and ${MAX_WRITE_MANY_PACKETS}`);
+    }
+    for (const packet of packets) {
+      if (!(packet instanceof Uint8Array)) {
+        throw new TypeError('Every packet must be a Uint8Array');
+      }
+      if (packet.length === 0 || packet.length > MAX_BUFFER_SIZE) {
+        throw new RangeError(`Packet length must be between 1 and ${MAX_BUFFER_SIZE} bytes`);
+      }
+    }
+
+    let written: Promise<number>;
+    try {
+      written = this.device.writeMany(packets);
+    } catch (err: unknown) {
+      throw new TunTapError(`Write failed: ${(err as Error).message}`);
+    }
+    this.adjustWriteQueue(packets.length);
+    try {
+      return await written;
+    } catch (err: unknown) {
+      throw new TunTapError(`Write failed: ${(err as Error).message}`);
+    } finally {
+      this.adjustWriteQueue(-packets.length);
+    }
+  }
+
+  /**
+   * Set the write queue's high-water mark and back-pressure callbacks.
+   *
+   * @throws {RangeError} if `highWaterMark` is not a positive integer
+   */
+  setWriteQueueOptions(options: WriteQueueOptions): void {
+    const {highWaterMark = DEFAULT_WRITE_HIGH_WATER_MARK} = options;
+    if (!Number.isInteger(highWaterMark) || highWaterMark < 1) {
+      throw new RangeError('High-water mark must be a positive integer');
+    }
+    this.writeQueue = {...options, highWaterMark};
+  }
+
+  /**
+   * Read one packet straight into caller-owned memory, e.g. a slice of a
+   * preallocated arena, so the read allocates nothing.
+   *
+   * @param buffer — destination; the packet is truncated to the room left
+   * @param offset — where in `buffer` the packet starts (default 0)
+   * @returns bytes read, or 0 when no packet is waiting
+   * @throws {TunTapError} if not open, closed, or the read fails
+   * @throws {TypeError} if `buffer` is not a `Uint8Array`/`Buffer`
+   * @throws {RangeError} if `offset` leaves no room
+   */
+  readInto(buffer: Uint8Array, offset: number = 0): number {
+    this.assertReady();
+    if (!(buffer instanceof Uint8Array)) {
+      throw new TypeError('Buffer must be a Uint8Array');
+    }
+    if (!Number.isInteger(offset) || offset < 0 || offset >= buffer.length) {
+      throw new RangeError(`Offset must be between 0 and ${buffer.length - 1}`);
+    }
+
+    try {
+      return this.device.readInto(buffer, offset);
+    } catch (err: unknown) {
+      throw new TunTapError(`Read failed: ${(err as Error).message}`);
+    }
+  }
+
+  /**
+   * Write one packet from a range of caller-owned memory without copying it
+   * into a new `Buffer` first.
+   *
+   * @param buffer — memory holding the packet
+   * @param offset — start of the packet in `buffer` (default 0)
+   * @param length — packet length (default: the rest of `buffer`)
+   * @returns bytes written, or 0 when the device pushed back
+   * @throws {TunTapError} if not open, closed, or the write fails
+   * @throws {TypeError} if `buffer` is not a `Uint8Array`/`Buffer`
+   * @throws {RangeError} if the range is outside `buffer` or too large
+   */
+  writeFrom(buffer: Uint8Array, offset: number = 0, length: number = buffer.length - offset): number {
+    this.assertReady();
+    if (!(buffer instanceof Uint8Array)) {
+      throw new TypeError('Buffer must be a Uint8Array');
+    }
+    if (
+      !Number.isInteger(offset) ||
+      !Number.isInteger(length) ||
+      offset < 0 ||
+      length < 0 ||
+      offset + length > buffer.length
+    ) {
+      throw new RangeError('Range is outside the buffer');
+    }
+    if (length === 0) {
+      return 0;
+    }
+    if (length > MAX_BUFFER_SIZE) {
+      throw new RangeError(`Write data too large (max ${MAX_BUFFER_SIZE} bytes)`);
+    }
+
+    try {
+      return this.device.writeFrom(buffer, offset, length);
+    } catch (err: unknown) {
+      throw new TunTapError(`Write failed: ${(err as Error).message}`);
+    }
+  }
+
+  /**
+   * Wait for one packet without blocking the event loop. The wait runs on a
+   * native reader thread, which resolves the promise as soon as the device
+   * has a packet.
+   *
+   * @param maxSize — upper bound on bytes to read (default 4096)
+   * @param options — `timeoutMs` bounds the wait
+   * @returns the packet, or `null` if `timeoutMs` passed without one
+   * @throws {TunTapError} if not open, closed, or the read fails (also when
+   *   the device is closed while waiting)
+   * @throws {RangeError} if `maxSize` or `timeoutMs` is out of range
+   */
+  async readAsync(
+    maxSize: number = DEFAULT_READ_BUFFER_SIZE,
+    options: ReadAsyncOptions = {},
+  ): Promise<Buffer | null> {
+    const packets = await this.readMany(1, maxSize, {...options, maxSize});
+    return packets.length > 0 ? packets[0] : null;
+  }
+
+  /**
+   * Wait for packets without blocking the event loop, then take every packet
+   * already queued on the device in one go. All returned buffers are slices
+   * of one pooled allocation.
+   *
+   * @param maxPackets — most packets to return (1–1024, default 64)
+   * @param maxBytes — bound on the bytes returned; reading stops before a
+   *   `maxSize` packet could overflow it (default 256 KiB, max 4 MiB)
+   * @param options — `maxSize` truncates each packet (default 4096);
+   *   `timeoutMs` bounds the wait for the first packet
+   * Not available while polling or a packet ring is active; while calls are
+   * pending, `read()`, `readInto()`, `startPolling()` and `startRing()` throw,
+   * since the device has a single reader at a time.
+   *
+   * @returns the packets, or an empty array if `timeoutMs` passed without one
+   * @throws {TunTapError} if not open, closed, polling, or the read fails
+   * @throws {RangeError} if a limit is out of range
+   */
+  async readMany(
+    maxPackets: number = DEFAULT_READ_MANY_PACKETS,
+    maxBytes: number = DEFAULT_READ_MANY_BYTES,
+    options: ReadManyOptions = {},
+  ): Promise<Buffer[]> {
+    this.assertReady();
+    const {maxSize = DEFAULT_READ_BUFFER_SIZE, timeoutMs} = options;
+    if (!Number.isInteger(maxPackets) || maxPackets < 1 || maxPackets > MAX_READ_MANY_PACKETS) {
+      throw new RangeError(`Max packets must be between 1 and ${MAX_READ_MANY_PACKETS}`);
+    }
+    if (maxSize <= 0 || maxSize > MAX_BUFFER_SIZE) {
+      throw new RangeError(`Read size must be between 1 and ${MAX_BUFFER_SIZE} bytes`);
+    }
+    if (maxBytes < maxSize || maxBytes > MAX_READ_MANY_BYTES) {
+      throw new RangeError(`Max bytes must be between ${maxSize} and ${MAX_READ_MANY_BYTES}`);
+    }
+    if (timeoutMs !== undefined && (timeoutMs < 0 || timeoutMs > 0x7fffffff)) {
+      throw new RangeError(`Timeout must be between 0 and ${0x7fffffff} ms`);
+    }
+
+    let result: [Buffer, Uint32Array] | null;
+    try {
+      result = await this.device.readMany(maxPackets, maxSize, maxBytes, timeoutMs);
+    } catch (err: unknown) {
+      throw new TunTapError(`Read failed: ${(err as Error).message}`);
+    }
+    if (!result) {
+      return [];
+    }
+    const [data, offsets] = result;
+    const packets: Buffer[] = new Array(offsets.length - 1);
+    for (let i = 0; i < packets.length; i++) {
+      packets[i] = data.subarray(offsets[i], offsets[i + 1]);
+    }
+    return packets;
+  }
+
   /**
    * Write a full IPv6 packet to the TUN device.
    *
@@ -224,28 +636,71 @@ export class TunTap {
   /**
    * Start libuv-driven polling on the TUN fd; `callback` runs on the Node thread pool per packet.
    *
-   * @param callback — invoked with each packet read from the device
+   * Pass a {@link PollingOptions} object instead of the positional arguments
+   * to configure batch mode, where `callback` receives several packets per
+   * call (see {@link PacketBatchCallback}).
+   *
+   * @param callback — invoked with each packet (or batch) read from the device
    * @param bufferSize — max read size per poll (default 65535)
-   * @throws {TunTapError} if not open or closed
+   * @param queueDepth — packets the poll thread may queue ahead of JS (default 8)
+   * @param queues — device queues to poll (default {@link TunTap.queueCount}); the
+   *   rest are detached while polling and re-attached when polling stops (on a
+   *   receive error or when `startPolling()` or `startRing()` replaces it)
+   * @throws {TunTapError} if not open or closed, or if queues left detached by
+   *   the previous `startPolling()` cannot be re-attached
    * @throws {TypeError} if `callback` is not a function
-   * @throws {RangeError} if `bufferSize` is out of range
+   * @throws {RangeError} if `bufferSize`, `queues` or a batch setting is out of range
    */
   startPolling(
     callback: PacketCallback,
-    bufferSize: number = MAX_BUFFER_SIZE,
-    queueDepth: number = 8,
+    bufferSize?: number,
+    queueDepth?: number,
+    queues?: number,
+  ): void;
+  startPolling(callback: PacketCallback, options: PollingOptions & {batch?: false}): void;
+  startPolling(callback: PacketBatchCallback, options: PollingOptions & {batch: true}): void;
+  startPolling(
+    callback: PacketCallback | PacketBatchCallback,
+    bufferSizeOrOptions: number | PollingOptions = MAX_BUFFER_SIZE,
+    queueDepthArg: number = 8,
+    queuesArg: number = this.queueCount,
   ): void {
     this.assertReady();
     if (typeof callback !== 'function') {
       throw new TypeError('Callback must be a function');
     }
+    const options: PollingOptions =
+      typeof bufferSizeOrOptions === 'object'
+        ? bufferSizeOrOptions
+        : {bufferSize: bufferSizeOrOptions, queueDepth: queueDepthArg, queues: queuesArg};
+    const {
+      bufferSize = MAX_BUFFER_SIZE,
+      queueDepth = 8,
+      queues = this.queueCount,
+      batch = false,
+      maxBatch = DEFAULT_MAX_BATCH,
+      maxDelayUs = DEFAULT_MAX_BATCH_DELAY_US,
+    } = options;
     if (bufferSize <= 0 || bufferSize > MAX_BUFFER_SIZE) {
       throw new RangeError(`Buffer size must be between 1 and ${MAX_BUFFER_SIZE} bytes`);
     }
     if (queueDepth <= 0 || queueDepth > 64) {
       throw new RangeError('Queue depth must be between 1 and 64');
     }
-    this.device.startPolling(callback, bufferSize, queueDepth);
+    if (!Number.isInteger(queues) || queues < 1 || queues > this.queueCount) {
+      throw new RangeError(`Queue count must be between 1 and ${this.queueCount}`);
+    }
+    if (!batch) {
+      this.device.startPolling(callback, bufferSize, queueDepth, queues);
+      return;
+    }
+    if (!Number.isInteger(maxBatch) || maxBatch < 1 || maxBatch > MAX_BATCH) {
+      throw new RangeError(`Max batch must be between 1 and ${MAX_BATCH}`);
+    }
+    if (!Number.isInteger(maxDelayUs) || maxDelayUs < 0 || maxDelayUs > MAX_BATCH_DELAY_US) {
+      throw new RangeError(`Max delay must be between 0 and ${MAX_BATCH_DELAY_US} us`);
+    }
+    this.device.startPolling(callback, bufferSize, queueDepth, queues, maxBatch, maxDelayUs);
   }
 
   /**
@@ -264,16 +719,80 @@ export class TunTap {
     this.device.resumePolling();
   }
 
+  /**
+   * Deliver packets through a shared-memory ring instead of callbacks: a
+   * native thread reads packets straight into the slots of a
+   * `SharedArrayBuffer` and JS consumes them in place through the returned
+   * {@link PacketRing}. The JS thread is only called when a consumer parked
+   * in {@link PacketRing.waitAsync} needs waking, so the ring suits
+   * consumers that keep up with line rate. Pass `ring.buffer` to a worker
+   * and wrap it with `new PacketRing(buffer)` to consume there; the main
+   * event loop must stay alive to deliver wakeups. Replaces
+   * {@link TunTap.startPolling} (and vice versa).
+   *
+   * @throws {TunTapError} if not open or closed
+   * @throws {RangeError} if the ring geometry is out of range
+   */
+  startRing(options: PacketRingOptions = {}): PacketRing {
+    this.assertReady();
+    const {slots = DEFAULT_RING_SLOTS, slotSize = DEFAULT_RING_SLOT_SIZE, onError} = options;
+    if (!Number.isInteger(slots) || slots < 2 || slots > MAX_RING_SLOTS || (slots & (slots - 1)) !== 0) {
+      throw new RangeError(`Ring slots must be a power of two between 2 and ${MAX_RING_SLOTS}`);
+    }
+    const maxSlotSize = MAX_BUFFER_SIZE + 1 + RING_SLOT_HEADER_BYTES;
+    if (
+      !Number.isInteger(slotSize) ||
+      slotSize <= RING_SLOT_HEADER_BYTES ||
+      slotSize > maxSlotSize ||
+      slotSize % 8 !== 0
+    ) {
+      throw new RangeError(`Ring slot size must be a multiple of 8 up to ${maxSlotSize} bytes`);
+    }
+
+    const buffer = new SharedArrayBuffer(PacketRing.byteLength(slots, slotSize));
+    try {
+      this.device.startRing(new Uint8Array(buffer), slots, slotSize, (error?: string) => {
+        notifyPacketRing(buffer);
+        if (error !== undefined) {
+          const err = new TunTapError(`Packet ring stopped: ${error}`);
+          if (onError) {
+            onError(err);
+          } else {
+            log.error(err.message);
+          }
+        }
+      });
+    } catch (err: unknown) {
+      throw new TunTapError(`Failed to start packet ring: ${(err as Error).message}`);
+    }
+    return new PacketRing(buffer);
+  }
+
+  /**
+   * Stop the packet ring; consumers see {@link PacketRing.stopped} once
+   * they have drained what is left.
+   */
+  stopRing(): void {
+    this.assertReady();
+    this.device.stopRing();
+  }
+
   /**
    * Configure IPv6 address and MTU on this interface using the platform backend (must run as root on Darwin/Linux).
    *
    * @param address — IPv6 address
    * @param mtu — link MTU (min 1280, max 65535)
-   * @throws {TypeError} if `address` is not a valid IPv6 literal
+   * @param routes — routes to add once the interface is up, as for {@link TunTap.addRoute};
+   *   on Linux they go to the kernel in the same rtnetlink batch as the address
+   * @throws {TypeError} if `address` is not a valid IPv6 literal or a route is invalid
    * @throws {RangeError} if `mtu` is out of range
    * @throws {TunTapError} on backend failure
    */
-  async configure(address: string, mtu: number = DEFAULT_MTU): Promise<void> {
+  async configure(
+    address: string,
+    mtu: number = DEFAULT_MTU,
+    routes: string[] = [],
+  ): Promise<void> {
     this.assertReady();
     if (!isIPv6(address)) {
       throw new TypeError('Invalid IPv6 address format');
@@ -281,9 +800,14 @@ export class TunTap {
     if (mtu < MIN_MTU || mtu > MAX_BUFFER_SIZE) {
       throw new RangeError(`MTU must be between ${MIN_MTU} and ${MAX_BUFFER_SIZE}`);
     }
+    for (const route of routes) {
+      if (typeof route !== 'string' || !isValidIPv6Route(route)) {
+        throw new TypeError('Routes must be valid IPv6 addresses or CIDRs (e.g., fd00::1/128)');
+      }
+    }
 
     try {
-      await this.platformBackend.configure(this.name, address, mtu);
+      await this.platformBackend.configure(this.name, address, mtu, routes);
     } catch (err: unknown) {
       if (err instanceof TunTapError) {
         throw err;
@@ -338,7 +862,11 @@ export class TunTap {
       await this.platformBackend.removeRoute(this.name, destination);
     } catch (err: unknown) {
       const message = (err as Error).message;
-      if (message.includes('not in table') || message.includes('No such process')) {
+      if (
+        (err as TunTapError).code === 'ESRCH' ||
+        message.includes('not in table') ||
+        message.includes('No such process')
+      ) {
         return;
       }
       throw new TunTapError(`Failed to remove route: ${message}`);
@@ -364,6 +892,22 @@ export class TunTap {
     }
   }
 
+  /**
+   * Tracks queued writes and fires the high-water/drain callbacks on the
+   * transitions.
+   */
+  private adjustWriteQueue(delta: number): void {
+    this.writesQueued += delta;
+    const {highWaterMark, onHighWater, onDrain} = this.writeQueue;
+    if (!this.writeQueueHigh && this.writesQueued >= highWaterMark) {
+      this.writeQueueHigh = true;
+      onHighWater?.(this.writesQueued);
+    } else if (this.writeQueueHigh && this.writesQueued <= Math.floor(highWaterMark / 2)) {
+      this.writeQueueHigh = false;
+      onDrain?.(this.writesQueued);
+    }
+  }
+
   /**
    * Throws if the device is not in a usable state (not open or already closed).
    */
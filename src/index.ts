@@ -1,3 +1,22 @@
 export {TunTapDeviceError, TunTapError, TunTapPermissionError} from './errors.js';
-export {TunTap, type PacketCallback} from './TunTap.js';
+export {
+  LinkRateMeter,
+  readLinkStats,
+  type LinkRates,
+  type LinkStatsSample,
+} from './LinkStats.js';
+export {PacketRing} from './PacketRing.js';
+export type {TunTapInterfaceStats} from './platform/types.js';
+export {
+  TunTap,
+  type PacketBatchCallback,
+  type PacketCallback,
+  type PacketPoolStats,
+  type PacketRingOptions,
+  type PollingOptions,
+  type ReadAsyncOptions,
+  type ReadManyOptions,
+  type TunTapOptions,
+  type WriteQueueOptions,
+} from './TunTap.js';
 export * from './tunnel/index.js';
@@ -0,0 +1,167 @@
+#include "async_reader.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "receive_coalescer.h"
+#include "thread_tuning.h"
+
+bool TunAsyncReader::Start(TunPlatformBackend* backend, std::string& error) {
+  if (thread_.joinable()) {
+    return true;
+  }
+  if (backend == nullptr || !backend->IsOpen()) {
+    error = "Device not open";
+    return false;
+  }
+  if (!wakeup_.Open(error)) {
+    return false;
+  }
+  wakeup_.Reset();
+  backend_ = backend;
+  running_ = true;
+  thread_ = std::thread([this]() {
+    SetCurrentThreadName("tuntap-read");
+    Run();
+  });
+  return true;
+}
+
+void TunAsyncReader::Submit(const AsyncReadRequest& request, Callback done) {
+  Pending pending;
+  pending.request = request;
+  if (request.timeout_ms >= 0) {
+    pending.deadline_ns =
+        PacketBatch::NowNs() + static_cast<uint64_t>(request.timeout_ms) * 1000000;
+  }
+  // Counted until answered; the count drops before the answer is posted,
+  // so JS may read synchronously as soon as the promise settles.
+  outstanding_.fetch_add(1, std::memory_order_acq_rel);
+  pending.done = [this, done = std::move(done)](PooledPacket batch, const std::string& error) {
+    outstanding_.fetch_sub(1, std::memory_order_acq_rel);
+    done(std::move(batch), error);
+  };
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+      queue_.push_back(std::move(pending));
+      cv_.notify_one();
+      return;
+    }
+  }
+  pending.done(PooledPacket(), "Device not open");
+}
+
+void TunAsyncReader::Stop(const std::string& reason) {
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_reason_ = reason;
+    running_ = false;
+  }
+  cv_.notify_one();
+  wakeup_.Signal();
+  thread_.join();
+
+  std::deque<Pending> abandoned;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    abandoned.swap(queue_);
+  }
+  for (Pending& pending : abandoned) {
+    pending.done(PooledPacket(), reason);
+  }
+  backend_ = nullptr;
+}
+
+void TunAsyncReader::Run() {
+  for (;;) {
+    Pending pending;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+      if (!running_) {
+        return;
+      }
+      pending = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    Serve(pending);
+  }
+}
+
+void TunAsyncReader::Serve(Pending& pending) {
+  const AsyncReadRequest& request = pending.request;
+  PacketBuffer* buffer = PacketPool::Instance().Acquire(
+      PackedBatchBytes(request.max_bytes, request.max_packets));
+  PooledPacket owned(buffer);
+  offsets_.resize(request.max_packets + 1);
+
+  std::string error;
+  for (;;) {
+    size_t count = 0;
+    size_t used = 0;
+    TunIoStatus status = TunIoStatus::kOk;
+    int error_code = 0;
+    while (count < request.max_packets && request.max_bytes - used >= request.max_size) {
+      size_t length = 0;
+      status = backend_->ReadPacketInto(buffer->data() + used, request.max_size, length,
+                                        error_code);
+      if (status != TunIoStatus::kOk) {
+        break;
+      }
+      offsets_[count++] = static_cast<uint32_t>(used);
+      used += length;
+    }
+
+    // Packets read before a failure still go out; the failure surfaces on
+    // the next request.
+    if (count > 0) {
+      offsets_[count] = static_cast<uint32_t>(used);
+      uint32_t* offsets = WritePackedBatchTail(buffer, used, count);
+      std::copy(offsets_.begin(), offsets_.begin() + count + 1, offsets);
+      pending.done(std::move(owned), std::string());
+      return;
+    }
+
+    switch (status) {
+      case TunIoStatus::kWouldBlock:
+        break;
+      case TunIoStatus::kClosed:
+        pending.done(PooledPacket(), "Device closed");
+        return;
+      default:
+        pending.done(PooledPacket(), "Read error: " + TunIoErrorString(error_code));
+        return;
+    }
+
+    int timeout_ms = -1;
+    if (pending.deadline_ns != 0) {
+      const uint64_t now_ns = PacketBatch::NowNs();
+      if (now_ns >= pending.deadline_ns) {
+        pending.done(PooledPacket(), std::string());
+        return;
+      }
+      // Round up so the final wait does not end just short of the deadline.
+      timeout_ms = static_cast<int>((pending.deadline_ns - now_ns + 999999) / 1000000);
+    }
+    if (!backend_->WaitReadableFor(timeout_ms, running_, &wakeup_, error)) {
+      if (!running_.load()) {
+        std::string reason;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          reason = stop_reason_;
+        }
+        pending.done(PooledPacket(), reason);
+        return;
+      }
+      if (!error.empty()) {
+        pending.done(PooledPacket(), error);
+        return;
+      }
+      // Timed out: loop once more so the deadline check answers the request.
+    }
+  }
+}
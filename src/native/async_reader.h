@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "packet_pool.h"
+#include "tun_backend.h"
+#include "wakeup_event.h"
+
+/** One `readAsync`/`readMany` call (see TunAsyncReader::Submit). */
+struct AsyncReadRequest {
+  // Packets to return at most; each is truncated to `max_size` bytes.
+  size_t max_packets = 1;
+  size_t max_size = 0;
+  // Bound on the returned bytes; reading stops before a packet could overflow it.
+  size_t max_bytes = 0;
+  // How long to wait for the first packet; negative waits until one arrives.
+  int timeout_ms = -1;
+};
+
+/**
+ * Serves asynchronous reads on a thread of its own so JS never blocks or
+ * polls: each request waits for readiness with `WaitReadableFor`, then takes
+ * every packet already queued (within its limits) in one pass. Requests are
+ * answered in submission order.
+ */
+class TunAsyncReader {
+public:
+  // Called on the reader thread with a packed batch (see receive_coalescer.h),
+  // an empty packet when the wait timed out, or an error message.
+  using Callback = std::function<void(PooledPacket batch, const std::string& error)>;
+
+  TunAsyncReader() = default;
+  ~TunAsyncReader() { Stop(); }
+
+  TunAsyncReader(const TunAsyncReader&) = delete;
+  TunAsyncReader& operator=(const TunAsyncReader&) = delete;
+
+  /** Starts the thread on first use; `backend` must outlive `Stop()`. */
+  bool Start(TunPlatformBackend* backend, std::string& error);
+
+  void Submit(const AsyncReadRequest& request, Callback done);
+
+  /** Joins the thread, failing the current and queued requests with `reason`. */
+  void Stop(const std::string& reason = "Device closed");
+
+  bool running() const { return thread_.joinable(); }
+
+  /**
+   * True while a submitted request has not been answered. The reader thread
+   * then owns the backend's read side, which is single-consumer (queue
+   * rotation, TSO segmentation, io_uring completions), so no other reader
+   * may touch it.
+   */
+  bool busy() const { return outstanding_.load(std::memory_order_acquire) != 0; }
+
+private:
+  struct Pending {
+    AsyncReadRequest request;
+    uint64_t deadline_ns = 0;  // 0 without a timeout
+    Callback done;
+  };
+
+  void Run();
+  void Serve(Pending& pending);
+
+  TunPlatformBackend* backend_ = nullptr;
+  WakeupEvent wakeup_;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+  // Requests submitted and not yet answered.
+  std::atomic<size_t> outstanding_{0};
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Pending> queue_;
+  std::string stop_reason_;
+
+  // Packet starts of the request being served (reader thread only).
+  std::vector<uint32_t> offsets_;
+};
@@ -0,0 +1,143 @@
+#include "async_writer.h"
+
+#include <utility>
+
+#include "receive_coalescer.h"
+#include "thread_tuning.h"
+
+bool TunAsyncWriter::Start(TunPlatformBackend* backend, std::string& error) {
+  if (thread_.joinable()) {
+    return true;
+  }
+  if (backend == nullptr || !backend->IsOpen()) {
+    error = "Device not open";
+    return false;
+  }
+  if (!wakeup_.Open(error)) {
+    return false;
+  }
+  wakeup_.Reset();
+  backend_ = backend;
+  running_ = true;
+  thread_ = std::thread([this]() {
+    SetCurrentThreadName("tuntap-write");
+    Run();
+  });
+  return true;
+}
+
+void TunAsyncWriter::Submit(PooledPacket packets, Callback done) {
+  Job job;
+  job.packets = std::move(packets);
+  job.done = std::move(done);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+      queue_.push_back(std::move(job));
+      cv_.notify_one();
+      return;
+    }
+  }
+  job.done(0, "Device not open");
+}
+
+void TunAsyncWriter::Stop(const std::string& reason) {
+  if (!thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_reason_ = reason;
+    running_ = false;
+  }
+  cv_.notify_one();
+  wakeup_.Signal();
+  thread_.join();
+
+  std::deque<Job> abandoned;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    abandoned.swap(queue_);
+  }
+  for (Job& job : abandoned) {
+    job.done(0, reason);
+  }
+  backend_ = nullptr;
+}
+
+void TunAsyncWriter::Run() {
+  for (;;) {
+    std::deque<Job> jobs;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+      if (!running_) {
+        return;
+      }
+      jobs.swap(queue_);
+    }
+
+    bool stopped = false;
+    for (Job& job : jobs) {
+      if (stopped || !Write(job)) {
+        stopped = true;
+        std::lock_guard<std::mutex> lock(mutex_);
+        job.error = stop_reason_;
+      }
+    }
+    // One flush for everything written this round (a no-op unless the
+    // backend defers writes, as io_uring does).
+    std::string flush_error;
+    if (!backend_->FlushWrites(flush_error)) {
+      for (Job& job : jobs) {
+        if (job.error.empty()) {
+          job.error = flush_error;
+        }
+      }
+    }
+    for (Job& job : jobs) {
+        job.done(job.written, job.error);
+    }
+    if (stopped) {
+      return;
+    }
+  }
+}
+
+bool TunAsyncWriter::Write(Job& job) {
+  const PackedBatchView view = ViewPackedBatch(job.packets.get());
+  batch_.Wrap(view.data, view.bytes);
+  for (size_t i = 0; i < view.count; ++i) {
+    batch_.AddRange(view.offsets[i], view.offsets[i + 1] - view.offsets[i]);
+  }
+
+  std::string error;
+  for (;;) {
+    const TunIoStatus status = backend_->WritePackets(batch_);
+    job.written = batch_.cursor();
+    switch (status) {
+      case TunIoStatus::kOk:
+        return true;
+      case TunIoStatus::kWouldBlock:
+        // Push what is already queued before sleeping on writability.
+        if (!backend_->FlushWrites(error)) {
+          job.error = error;
+          return true;
+        }
+        if (!backend_->WaitWritable(running_, &wakeup_, error)) {
+          if (!running_.load()) {
+            return false;
+          }
+          job.error = error.empty() ? std::string("Device not writable") : error;
+          return true;
+        }
+        break;
+      case TunIoStatus::kClosed:
+        job.error = "Device closed";
+        return true;
+      default:
+        job.error = "Write error: " + TunIoErrorString(batch_.error_code());
+        return true;
+    }
+  }
+}
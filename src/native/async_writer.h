@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "packet_batch.h"
+#include "packet_pool.h"
+#include "tun_backend.h"
+#include "wakeup_event.h"
+
+/**
+ * Writes queued packets on a thread of its own so JS never makes the write
+ * syscall or retries after back-pressure: each job is a packed batch (see
+ * receive_coalescer.h) copied off the JS heap, written with `WritePackets`
+ * and resumed after `WaitWritable` when the device pushes back. Every job
+ * queued by the time the thread wakes is written before one `FlushWrites`,
+ * then completed in submission order.
+ */
+class TunAsyncWriter {
+public:
+  // Most packets one job may carry.
+  static constexpr size_t kMaxJobPackets = 1024;
+
+  // Called on the writer thread with the packets written and, when not all
+  // of them were, the reason.
+  using Callback = std::function<void(size_t written, const std::string& error)>;
+
+  TunAsyncWriter() : batch_(kMaxJobPackets, 0) {}
+  ~TunAsyncWriter() { Stop(); }
+
+  TunAsyncWriter(const TunAsyncWriter&) = delete;
+  TunAsyncWriter& operator=(const TunAsyncWriter&) = delete;
+
+  /** Starts the thread on first use; `backend` must outlive `Stop()`. */
+  bool Start(TunPlatformBackend* backend, std::string& error);
+
+  /** Queues a packed batch of at most kMaxJobPackets packets. */
+  void Submit(PooledPacket packets, Callback done);
+
+  /** Joins the thread, failing unwritten jobs with `reason`. */
+  void Stop(const std::string& reason = "Device closed");
+
+private:
+  struct Job {
+    PooledPacket packets;
+    Callback done;
+    size_t written = 0;
+    std::string error;
+  };
+
+  void Run();
+  // Writes one job until done, failed or stopped; false only when stopped.
+  bool Write(Job& job);
+
+  TunPlatformBackend* backend_ = nullptr;
+  WakeupEvent wakeup_;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Job> queue_;
+  std::string stop_reason_;
+
+  // Describes the job being written (writer thread only).
+  PacketBatch batch_;
+};
@@ -1,56 +1,629 @@
 #include "debug_log.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "latency_histogram.h"
 
 namespace tuntap {
-namespace {
 
-std::once_flag g_init;
-bool g_debug = false;
-uint64_t g_seq = 0;
-std::mutex g_log_mutex;
+#ifndef TUNTAP_DISABLE_DEBUG_LOG
+
+namespace debug_log {
+namespace {
 
-void InitDebug() {
+int LevelFromEnvironment() {
   const char* value = std::getenv("APPIUM_TUNTAP_DEBUG");
-  g_debug = value != nullptr && (std::strcmp(value, "1") == 0 || std::strcmp(value, "true") == 0);
+  if (value == nullptr) {
+    return kDebugLevelOff;
+  }
+  if (std::strcmp(value, "1") == 0 || std::strcmp(value, "true") == 0 ||
+      std::strcmp(value, "trace") == 0) {
+    return kDebugLevelTrace;
+  }
+  if (std::strcmp(value, "debug") == 0) {
+    return kDebugLevelDebug;
+  }
+  return kDebugLevelOff;
 }
 
-}  // namespace
+enum RecordKind : uint16_t {
+  kRecordPadding,
+  kRecordFormat,
+  kRecordPacket,
+};
+
+// Records are 8-byte aligned: a header, then per argument an `ArgHeader` and
+// an 8-byte value, or the string/byte payload padded to 8 bytes.
+struct RecordHeader {
+  uint32_t size;  // whole record, including this header
+  uint16_t kind;
+  uint16_t argc;
+  uint64_t ticks;
+  const char* event;
+  const char* fmt;
+};
+
+struct ArgHeader {
+  uint32_t type;
+  uint32_t length;
+};
 
-bool DebugEnabled() {
-  std::call_once(g_init, InitDebug);
-  return g_debug;
+constexpr size_t kRingBytes = 64 * 1024;
+constexpr size_t kMaxRecordBytes = 4 * 1024;
+constexpr size_t kMaxStringBytes = 256;
+// Enough for the IPv6 header plus the TCP ports and flags.
+constexpr size_t kPacketHeaderBytes = 60;
+constexpr auto kDrainInterval = std::chrono::milliseconds(10);
+
+constexpr size_t Align8(size_t n) {
+  return (n + 7) & ~size_t{7};
 }
 
-void FwdDebug(const char* event) {
-  if (!DebugEnabled()) {
-    return;
+/**
+ * Single-producer single-consumer byte ring of log records. The owning
+ * thread writes; whoever holds the drain lock reads. A record that does not
+ * fit before the end of the buffer is preceded by a padding record and
+ * starts again at offset 0.
+ */
+class LogRing {
+public:
+  LogRing() : data_(new uint8_t[kRingBytes]) {}
+
+  // Producer: space for `size` bytes, or nullptr (and a drop) when full.
+  uint8_t* Reserve(size_t size) {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    const uint64_t tail = tail_.load(std::memory_order_acquire);
+    const size_t offset = head % kRingBytes;
+    const size_t contiguous = kRingBytes - offset;
+    const size_t needed = contiguous < size ? contiguous + size : size;
+    if (kRingBytes - (head - tail) < needed) {
+      dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    reserved_ = head;
+    if (contiguous < size) {
+      // `contiguous` is a non-zero multiple of 8, enough for size and kind.
+      const uint32_t padding_size = static_cast<uint32_t>(contiguous);
+      const uint16_t padding_kind = kRecordPadding;
+      std::memcpy(data_.get() + offset, &padding_size, sizeof(padding_size));
+      std::memcpy(data_.get() + offset + sizeof(padding_size), &padding_kind, sizeof(padding_kind));
+      reserved_ += contiguous;
+    }
+    return data_.get() + reserved_ % kRingBytes;
   }
 
-  std::lock_guard<std::mutex> lock(g_log_mutex);
-  fprintf(stderr, "[fwd] #%llu %s\n", static_cast<unsigned long long>(++g_seq), event);
-  fflush(stderr);
-}
+  // Producer: publishes the record written into the last reservation.
+  void Commit(size_t size) { head_.store(reserved_ + size, std::memory_order_release); }
 
-void FwdDebug(const char* event, const char* fmt, ...) {
-  if (!DebugEnabled()) {
-    return;
+  // Consumer: passes every published record to `visit` and returns the count.
+  template <typename Visit>
+  size_t Drain(Visit&& visit) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    size_t records = 0;
+    while (tail < head) {
+      const uint8_t* record = data_.get() + tail % kRingBytes;
+      uint32_t size = 0;
+      uint16_t kind = 0;
+      std::memcpy(&size, record, sizeof(size));
+      std::memcpy(&kind, record + sizeof(size), sizeof(kind));
+      if (kind != kRecordPadding) {
+        visit(record, size);
+        ++records;
+      }
+      tail += size;
+    }
+    tail_.store(tail, std::memory_order_release);
+    return records;
   }
 
-  std::lock_guard<std::mutex> lock(g_log_mutex);
-  fprintf(stderr, "[fwd] #%llu %s ", static_cast<unsigned long long>(++g_seq), event);
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  void Retire() { retired_.store(true, std::memory_order_release); }
+  bool retired() const { return retired_.load(std::memory_order_acquire); }
+  bool empty() const {
+    return tail_.load(std::memory_order_relaxed) == head_.load(std::memory_order_acquire);
+  }
 
+private:
+  std::unique_ptr<uint8_t[]> data_;
+  alignas(64) std::atomic<uint64_t> head_{0};
+  uint64_t reserved_ = 0;
+  std::atomic<uint64_t> dropped_{0};
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  std::atomic<bool> retired_{false};
+  // Drops already reported by the drain thread.
+  uint64_t reported_drops_ = 0;
+
+  friend class DebugLogDrain;
+};
+
+std::string FormatIpv6Address(const uint8_t* addr) {
+  char buf[40];
+  std::snprintf(buf,
+                sizeof(buf),
+                "%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x",
+                addr[0],
+                addr[1],
+                addr[2],
+                addr[3],
+                addr[4],
+                addr[5],
+                addr[6],
+                addr[7],
+                addr[8],
+                addr[9],
+                addr[10],
+                addr[11],
+                addr[12],
+                addr[13],
+                addr[14],
+                addr[15]);
+  return buf;
+}
+
+void AppendFormatted(std::string& out, const char* fmt, ...)
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+void AppendFormatted(std::string& out, const char* fmt, ...) {
+  char buf[512];
   va_list args;
   va_start(args, fmt);
-  vfprintf(stderr, fmt, args);
+  const int n = std::vsnprintf(buf, sizeof(buf), fmt, args);
   va_end(args);
+  if (n > 0) {
+    out.append(buf, std::min(static_cast<size_t>(n), sizeof(buf) - 1));
+  }
+}
+
+// A decoded argument; strings and bytes point into the copied record.
+struct DecodedArg {
+  ArgType type;
+  uint32_t length;
+  uint64_t value;
+  const uint8_t* payload;
+};
+
+std::vector<DecodedArg> DecodeArgs(const uint8_t* record, uint32_t size, uint16_t argc) {
+  std::vector<DecodedArg> args;
+  args.reserve(argc);
+  size_t offset = sizeof(RecordHeader);
+  for (uint16_t i = 0; i < argc && offset + sizeof(ArgHeader) <= size; ++i) {
+    ArgHeader header;
+    std::memcpy(&header, record + offset, sizeof(header));
+    offset += sizeof(header);
+    DecodedArg arg{static_cast<ArgType>(header.type), header.length, 0, record + offset};
+    if (header.type == kArgString || header.type == kArgBytes) {
+      offset += Align8(header.length);
+    } else {
+      std::memcpy(&arg.value, record + offset, sizeof(arg.value));
+      offset += sizeof(uint64_t);
+    }
+    if (offset > size) {
+      break;
+    }
+    args.push_back(arg);
+  }
+  return args;
+}
+
+// Re-applies one printf conversion (`spec` holds flags, width and precision)
+// to a captured argument. The conversion is adapted to the captured type, so
+// a mismatched format cannot read the wrong type.
+void AppendConversion(std::string& out, const std::string& spec, char conversion, const DecodedArg& arg) {
+  std::string format = "%" + spec;
+  switch (arg.type) {
+    case kArgInt:
+    case kArgUint: {
+      const bool is_signed = arg.type == kArgInt;
+      if (conversion == 'c') {
+        AppendFormatted(out, (format + "c").c_str(), static_cast<int>(arg.value));
+      } else if (conversion == 'x' || conversion == 'X' || conversion == 'o' || conversion == 'u' ||
+                 !is_signed) {
+        const char suffix = conversion == 'x' || conversion == 'X' || conversion == 'o'
+                                ? conversion
+                                : 'u';
+        AppendFormatted(out, (format + "ll" + suffix).c_str(),
+                        static_cast<unsigned long long>(arg.value));
+      } else {
+        int64_t value;
+        std::memcpy(&value, &arg.value, sizeof(value));
+        AppendFormatted(out, (format + "lld").c_str(), static_cast<long long>(value));
+      }
+      break;
+    }
+    case kArgDouble: {
+      double value;
+      std::memcpy(&value, &arg.value, sizeof(value));
+      const bool floating = std::strchr("fFeEgGaA", conversion) != nullptr;
+      AppendFormatted(out, (format + (floating ? conversion : 'g')).c_str(), value);
+      break;
+    }
+    case kArgString:
+      out.append(reinterpret_cast<const char*>(arg.payload), arg.length);
+      break;
+    case kArgPointer:
+      AppendFormatted(out, "%p", reinterpret_cast<const void*>(static_cast<uintptr_t>(arg.value)));
+      break;
+    case kArgBytes:
+      out.append("<bytes>");
+      break;
+  }
+}
+
+void AppendMessage(std::string& out, const char* fmt, const std::vector<DecodedArg>& args) {
+  size_t next = 0;
+  for (const char* p = fmt; *p != '\0'; ++p) {
+    if (*p != '%') {
+      out.push_back(*p);
+      continue;
+    }
+    if (p[1] == '%') {
+      out.push_back('%');
+      ++p;
+      continue;
+    }
+    std::string spec;
+    ++p;
+    while (*p != '\0' && std::strchr("-+ #0", *p) != nullptr) {
+      spec.push_back(*p++);
+    }
+    while (*p >= '0' && *p <= '9') {
+      spec.push_back(*p++);
+    }
+    if (*p == '.') {
+      spec.push_back(*p++);
+      while (*p >= '0' && *p <= '9') {
+        spec.push_back(*p++);
+      }
+    }
+    while (*p != '\0' && std::strchr("hlLqjzt", *p) != nullptr) {
+      ++p;  // length modifiers: the captured type decides
+    }
+    if (*p == '\0') {
+      break;
+    }
+    if (next < args.size()) {
+      AppendConversion(out, spec, *p, args[next++]);
+    } else {
+      out.append("<missing>");
+    }
+  }
+}
+
+// The former synchronous DebugIpv6Packet, now run on the drain thread.
+void AppendPacket(std::string& out, const std::vector<DecodedArg>& args) {
+  if (args.size() < 3) {
+    return;
+  }
+  const uint64_t len = args[0].value;
+  const unsigned long long count = args[1].value;
+  const uint8_t* data = args[2].payload;
+  const size_t captured = args[2].length;
+  if (len < 40 || captured < 40 || (data[0] >> 4) != 6) {
+    AppendFormatted(out, "len=%llu packets=%llu non-ipv6", static_cast<unsigned long long>(len), count);
+    return;
+  }
+  const unsigned payload_len = static_cast<unsigned>((data[4] << 8) | data[5]);
+  const std::string src = FormatIpv6Address(data + 8);
+  const std::string dst = FormatIpv6Address(data + 24);
+  if (data[6] == 6 && len >= 60 && captured >= 60) {
+    const unsigned src_port = static_cast<unsigned>((data[40] << 8) | data[41]);
+    const unsigned dst_port = static_cast<unsigned>((data[42] << 8) | data[43]);
+    AppendFormatted(out,
+                    "len=%llu packets=%llu next=%u payload=%u %s:%u -> %s:%u flags=0x%02x",
+                    static_cast<unsigned long long>(len),
+                    count,
+                    data[6],
+                    payload_len,
+                    src.c_str(),
+                    src_port,
+                    dst.c_str(),
+                    dst_port,
+                    data[53]);
+    return;
+  }
+  AppendFormatted(out,
+                  "len=%llu packets=%llu next=%u payload=%u %s -> %s",
+                  static_cast<unsigned long long>(len),
+                  count,
+                  data[6],
+                  payload_len,
+                  src.c_str(),
+                  dst.c_str());
+}
+
+/**
+ * Registry of per-thread rings and the thread that formats them. Records
+ * from all rings are merged by timestamp within each drain pass and numbered
+ * in that order, so `#N` is global as before.
+ */
+class DebugLogDrain {
+public:
+  // Intentionally leaked like the forwarding hub: logging threads may still
+  // be running when static destructors would run. An atexit hook writes
+  // whatever is still queued.
+  static DebugLogDrain& Instance() {
+    static DebugLogDrain* drain = new DebugLogDrain();
+    return *drain;
+  }
+
+  std::shared_ptr<LogRing> Register() {
+    auto ring = std::make_shared<LogRing>();
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    rings_.push_back(ring);
+    if (!thread_started_) {
+      thread_started_ = true;
+      std::atexit([] { DebugLogDrain::Instance().Drain(); });
+      std::thread([this] {
+        for (;;) {
+          std::this_thread::sleep_for(kDrainInterval);
+          Drain();
+        }
+      }).detach();
+    }
+    return ring;
+  }
+
+  void Drain() {
+    std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+    std::vector<std::shared_ptr<LogRing>> rings;
+    {
+      std::lock_guard<std::mutex> lock(rings_mutex_);
+      rings = rings_;
+    }
+
+    batch_.clear();
+    entries_.clear();
+    std::string out;
+    for (const std::shared_ptr<LogRing>& ring : rings) {
+      ring->Drain([this](const uint8_t* record, uint32_t size) {
+        RecordHeader header;
+        std::memcpy(&header, record, sizeof(header));
+        entries_.push_back({header.ticks, batch_.size()});
+        batch_.insert(batch_.end(), record, record + size);
+      });
+      const uint64_t dropped = ring->dropped();
+      if (dropped != ring->reported_drops_) {
+        AppendFormatted(out, "[fwd] #%llu debug-log-dropped records=%llu\n",
+                        static_cast<unsigned long long>(++seq_),
+                        static_cast<unsigned long long>(dropped - ring->reported_drops_));
+        ring->reported_drops_ = dropped;
+      }
+    }
+    std::stable_sort(entries_.begin(), entries_.end(),
+                     [](const Entry& a, const Entry& b) { return a.ticks < b.ticks; });
+    for (const Entry& entry : entries_) {
+      AppendRecord(out, batch_.data() + entry.offset);
+    }
+    if (!out.empty()) {
+      std::fwrite(out.data(), 1, out.size(), stderr);
+      std::fflush(stderr);
+    }
+
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                [](const std::shared_ptr<LogRing>& ring) {
+                                  return ring->retired() && ring->empty();
+                                }),
+                 rings_.end());
+  }
+
+private:
+  struct Entry {
+    uint64_t ticks;
+    size_t offset;
+  };
 
-  fputc('\n', stderr);
-  fflush(stderr);
+  DebugLogDrain() = default;
+
+  void AppendRecord(std::string& out, const uint8_t* record) {
+    RecordHeader header;
+    std::memcpy(&header, record, sizeof(header));
+    const std::vector<DecodedArg> args = DecodeArgs(record, header.size, header.argc);
+    AppendFormatted(out, "[fwd] #%llu %s", static_cast<unsigned long long>(++seq_), header.event);
+    if (header.kind == kRecordPacket) {
+      out.push_back(' ');
+      AppendPacket(out, args);
+    } else if (header.fmt != nullptr) {
+      out.push_back(' ');
+      AppendMessage(out, header.fmt, args);
+    }
+    out.push_back('\n');
+  }
+
+  std::mutex rings_mutex_;
+  std::vector<std::shared_ptr<LogRing>> rings_;
+  bool thread_started_ = false;
+
+  // Guarded by drain_mutex_.
+  std::mutex drain_mutex_;
+  uint64_t seq_ = 0;
+  std::vector<uint8_t> batch_;
+  std::vector<Entry> entries_;
+};
+
+// Marks the ring retired when its thread exits; the drain thread frees it
+// once it has been emptied.
+struct ThreadRing {
+  std::shared_ptr<LogRing> ring;
+
+  ~ThreadRing() {
+    if (ring) {
+      ring->Retire();
+    }
+  }
+};
+
+LogRing& CurrentRing() {
+  thread_local ThreadRing thread_ring;
+  if (!thread_ring.ring) {
+    thread_ring.ring = DebugLogDrain::Instance().Register();
+  }
+  return *thread_ring.ring;
+}
+
+size_t EncodedSize(const Arg& arg) {
+  return sizeof(ArgHeader) +
+         (arg.type == kArgString || arg.type == kArgBytes ? Align8(arg.length) : sizeof(uint64_t));
+}
+
+uint8_t* Encode(uint8_t* out, const Arg& arg) {
+  const ArgHeader header{arg.type, arg.length};
+  std::memcpy(out, &header, sizeof(header));
+  out += sizeof(header);
+  if (arg.type == kArgString || arg.type == kArgBytes) {
+    std::memcpy(out, arg.p, arg.length);
+    return out + Align8(arg.length);
+  }
+  std::memcpy(out, &arg.u, sizeof(arg.u));
+  return out + sizeof(uint64_t);
 }
 
+void WriteRecord(RecordKind kind, const char* event, const char* fmt, Arg* args, size_t count) {
+  const uint64_t ticks = forwarder_latency::Now();
+  size_t size = sizeof(RecordHeader);
+  for (size_t i = 0; i < count; ++i) {
+    if (args[i].type == kArgString) {
+      const char* value = args[i].p == nullptr ? "(null)" : static_cast<const char*>(args[i].p);
+      args[i].p = value;
+      args[i].length = static_cast<uint32_t>(strnlen(value, kMaxStringBytes));
+    }
+    size += EncodedSize(args[i]);
+  }
+  if (size > kMaxRecordBytes) {
+    return;
+  }
+  LogRing& ring = CurrentRing();
+  uint8_t* out = ring.Reserve(size);
+  if (out == nullptr) {
+    return;
+  }
+  const RecordHeader header{static_cast<uint32_t>(size), kind, static_cast<uint16_t>(count), ticks,
+                            event, fmt};
+  std::memcpy(out, &header, sizeof(header));
+  uint8_t* cursor = out + sizeof(header);
+  for (size_t i = 0; i < count; ++i) {
+    cursor = Encode(cursor, args[i]);
+  }
+  ring.Commit(size);
+}
+
+}  // namespace
+
+std::atomic<int> g_level{LevelFromEnvironment()};
+
+void Write(const char* event, const char* fmt, const Arg* args, size_t count) {
+  Arg copy[32];
+  count = std::min(count, sizeof(copy) / sizeof(copy[0]));
+  std::copy(args, args + count, copy);
+  WriteRecord(kRecordFormat, event, fmt, copy, count);
+}
+
+void WritePacket(const char* event, const uint8_t* data, size_t len, uint64_t count) {
+  Arg args[3] = {};
+  args[0].type = kArgUint;
+  args[0].u = len;
+  args[1].type = kArgUint;
+  args[1].u = count;
+  args[2].type = kArgBytes;
+  args[2].p = data;
+  args[2].length = data == nullptr ? 0 : static_cast<uint32_t>(std::min(len, kPacketHeaderBytes));
+  WriteRecord(kRecordPacket, event, nullptr, args, 3);
+}
+
+}  // namespace debug_log
+
+void FlushDebugLog() {
+  debug_log::DebugLogDrain::Instance().Drain();
+}
+
+#endif  // TUNTAP_DISABLE_DEBUG_LOG
+
 }  // namespace tuntap
+
+namespace {
+
+const char* LevelName(int level) {
+  switch (level) {
+    case tuntap::kDebugLevelDebug:
+      return "debug";
+    case tuntap::kDebugLevelTrace:
+      return "trace";
+    default:
+      return "off";
+  }
+}
+
+Napi::Value GetLevel(const Napi::CallbackInfo& info) {
+#ifdef TUNTAP_DISABLE_DEBUG_LOG
+  const int level = tuntap::kDebugLevelOff;
+#else
+  const int level = tuntap::debug_log::g_level.load(std::memory_order_relaxed);
+#endif
+  return Napi::String::New(info.Env(), LevelName(level));
+}
+
+Napi::Value SetLevel(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected a debug level string").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  const std::string name = info[0].As<Napi::String>().Utf8Value();
+  int level;
+  if (name == "off") {
+    level = tuntap::kDebugLevelOff;
+  } else if (name == "debug") {
+    level = tuntap::kDebugLevelDebug;
+  } else if (name == "trace") {
+    level = tuntap::kDebugLevelTrace;
+  } else {
+    Napi::TypeError::New(env, "Debug level must be 'off', 'debug' or 'trace'")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+#ifdef TUNTAP_DISABLE_DEBUG_LOG
+  if (level != tuntap::kDebugLevelOff) {
+    Napi::Error::New(env, "Native debug logging was compiled out (TUNTAP_DISABLE_DEBUG_LOG)")
+        .ThrowAsJavaScriptException();
+  }
+#else
+  tuntap::debug_log::g_level.store(level, std::memory_order_relaxed);
+#endif
+  return env.Undefined();
+}
+
+Napi::Value Flush(const Napi::CallbackInfo& info) {
+  tuntap::FlushDebugLog();
+  return info.Env().Undefined();
+}
+
+}  // namespace
+
+Napi::Object InitDebugLog(Napi::Env env, Napi::Object exports) {
+  Napi::Object debug_log = Napi::Object::New(env);
+  debug_log.Set("getLevel", Napi::Function::New(env, GetLevel, "getLevel"));
+  debug_log.Set("setLevel", Napi::Function::New(env, SetLevel, "setLevel"));
+  debug_log.Set("flush", Napi::Function::New(env, Flush, "flush"));
+#ifdef TUNTAP_DISABLE_DEBUG_LOG
+  debug_log.Set("compiledOut", Napi::Boolean::New(env, true));
+#else
+  debug_log.Set("compiledOut", Napi::Boolean::New(env, false));
+#endif
+  exports.Set("debugLog", debug_log);
+  return exports;
+}
@@ -1,18 +1,176 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <napi.h>
+
 namespace tuntap {
 
-/** True when APPIUM_TUNTAP_DEBUG is `1` or `true`. */
-bool DebugEnabled();
+/**
+ * Native debug verbosity. `kDebugLevelDebug` covers connection lifecycle and
+ * errors; `kDebugLevelTrace` adds per-packet and per-batch events.
+ */
+enum DebugLevel : int {
+  kDebugLevelOff = 0,
+  kDebugLevelDebug = 1,
+  kDebugLevelTrace = 2,
+};
+
+namespace debug_log {
+
+// One argument of a log record, captured by value on the logging thread and
+// formatted later by the drain thread.
+enum ArgType : uint32_t {
+  kArgInt,
+  kArgUint,
+  kArgDouble,
+  kArgString,
+  kArgPointer,
+  kArgBytes,
+};
+
+struct Arg {
+  ArgType type;
+  uint32_t length;  // kArgString/kArgBytes only
+  union {
+    int64_t i;
+    uint64_t u;
+    double d;
+    const void* p;
+  };
+};
+
+#ifndef TUNTAP_DISABLE_DEBUG_LOG
+
+extern std::atomic<int> g_level;
+
+template <typename T>
+Arg MakeArg(T value) {
+  Arg arg{};
+  if constexpr (std::is_same_v<T, bool>) {
+    arg.type = kArgUint;
+    arg.u = value ? 1 : 0;
+  } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+    arg.type = kArgInt;
+    arg.i = value;
+  } else if constexpr (std::is_integral_v<T>) {
+    arg.type = kArgUint;
+    arg.u = value;
+  } else if constexpr (std::is_enum_v<T>) {
+    arg.type = kArgInt;
+    arg.i = static_cast<int64_t>(value);
+  } else if constexpr (std::is_floating_point_v<T>) {
+    arg.type = kArgDouble;
+    arg.d = value;
+  } else if constexpr (std::is_same_v<std::decay_t<T>, const char*> ||
+                       std::is_same_v<std::decay_t<T>, char*>) {
+    arg.type = kArgString;
+    arg.p = value;
+  } else {
+    static_assert(std::is_pointer_v<T>, "FwdDebug takes printf-style scalars and C strings");
+    arg.type = kArgPointer;
+    arg.p = value;
+  }
+  return arg;
+}
+
+// Encodes one record into the calling thread's ring; drops it when full.
+void Write(const char* event, const char* fmt, const Arg* args, size_t count);
+void WritePacket(const char* event, const uint8_t* data, size_t len, uint64_t count);
+
+template <typename... Args>
+void Log(const char* event, const char* fmt, Args... args) {
+  if constexpr (sizeof...(Args) == 0) {
+    Write(event, fmt, nullptr, 0);
+  } else {
+    const Arg encoded[] = {MakeArg(args)...};
+    Write(event, fmt, encoded, sizeof...(Args));
+  }
+}
+
+#endif  // TUNTAP_DISABLE_DEBUG_LOG
+
+}  // namespace debug_log
+
+#ifndef TUNTAP_DISABLE_DEBUG_LOG
 
-/** Log `[fwd] #N event ...` to stderr (matches JS {@link fwdDebug}). */
-void FwdDebug(const char* event);
+/**
+ * True when native logging is on at `level`. Starts at
+ * APPIUM_TUNTAP_DEBUG (`1`/`true`/`trace`: trace, `debug`: debug) and can be
+ * changed at runtime from JS.
+ */
+inline bool DebugEnabled(DebugLevel level = kDebugLevelDebug) {
+  return debug_log::g_level.load(std::memory_order_relaxed) >= level;
+}
 
-/** Log `[fwd] #N event fmt...` to stderr. */
-void FwdDebug(const char* event, const char* fmt, ...)
-#if defined(__GNUC__) || defined(__clang__)
-    __attribute__((format(printf, 2, 3)))
-#endif
-    ;
+/**
+ * Log `[fwd] #N event` to stderr (matches JS {@link fwdDebug}).
+ *
+ * The calling thread only copies the event, the format pointer, a timestamp
+ * and the raw arguments into its own lock-free ring; a background thread
+ * formats and writes the line. `event` and `fmt` must be string literals,
+ * since they are read after the call returns. String arguments are copied
+ * (up to 256 bytes). When the ring is full the record is dropped and counted.
+ */
+inline void FwdDebug(const char* event) {
+  if (DebugEnabled(kDebugLevelDebug)) {
+    debug_log::Log(event, nullptr);
+  }
+}
+
+/** Log `[fwd] #N event fmt...` (printf conversions) at debug level. */
+template <typename... Args>
+void FwdDebug(const char* event, const char* fmt, Args... args) {
+  if (DebugEnabled(kDebugLevelDebug)) {
+    debug_log::Log(event, fmt, args...);
+  }
+}
+
+/** {@link FwdDebug} at trace level, for per-packet and per-batch events. */
+template <typename... Args>
+void FwdTrace(const char* event, const char* fmt, Args... args) {
+  if (DebugEnabled(kDebugLevelTrace)) {
+    debug_log::Log(event, fmt, args...);
+  }
+}
+
+/**
+ * Trace-level summary of an IPv6 packet (addresses, next header, TCP ports
+ * and flags). Only the header bytes are copied on the calling thread.
+ */
+inline void FwdTracePacket(const char* event, const uint8_t* data, size_t len, uint64_t count) {
+  if (DebugEnabled(kDebugLevelTrace)) {
+    debug_log::WritePacket(event, data, len, count);
+  }
+}
+
+/** Formats and writes every record logged so far. */
+void FlushDebugLog();
+
+#else  // TUNTAP_DISABLE_DEBUG_LOG
+
+constexpr bool DebugEnabled(DebugLevel = kDebugLevelDebug) {
+  return false;
+}
+
+inline void FwdDebug(const char*) {}
+
+template <typename... Args>
+void FwdDebug(const char*, const char*, Args...) {}
+
+template <typename... Args>
+void FwdTrace(const char*, const char*, Args...) {}
+
+inline void FwdTracePacket(const char*, const uint8_t*, size_t, uint64_t) {}
+
+inline void FlushDebugLog() {}
+
+#endif  // TUNTAP_DISABLE_DEBUG_LOG
 
 }  // namespace tuntap
+
+/** Exports `debugLog: {setLevel, getLevel, flush, compiledOut}`. */
+Napi::Object InitDebugLog(Napi::Env env, Napi::Object exports);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+
+#include "thread_tuning.h"
+
+/** How a {@link TunnelForwarder} schedules the two tunnel directions. */
+enum class ForwarderEngine {
+  // One blocking thread per direction sharing the SSL session under a mutex.
+  kThreaded,
+  // One thread owning the SSL session, driving both directions from a single
+  // readiness loop (POSIX only).
+  kPump,
+  // Four threads (TUN reader, encryptor, decryptor, TUN writer) handing
+  // packets through bounded SPSC queues, so TUN syscalls overlap with crypto.
+  kPipeline,
+  // Attach to the process-wide ForwardingHub: a small pool of event-loop
+  // workers that multiplex many tunnels (POSIX only).
+  kHub,
+};
+
+/** Tuning knobs supplied through `TunnelForwarder.startForwarding(..., options)`. */
+struct ForwarderOptions {
+  ForwarderEngine engine = ForwarderEngine::kThreaded;
+
+  // Egress batching: after the first TUN packet of a run, keep draining the
+  // non-blocking fd until it would block or either budget is reached, then send
+  // the run with one SSL_write (OpenSSL splits it into maximum-size records).
+  // A packet budget of 1 disables batching.
+  size_t egress_batch_packets = 1;
+  size_t egress_batch_bytes = 64 * 1024;
+
+  // Slots per direction in the pipeline engine's SPSC queues (rounded up to a
+  // power of two).
+  size_t pipeline_queue_depth = 256;
+
+  // Minimum ForwardingHub pool size for the hub engine; 0 keeps the current
+  // pool (or the default for a new one). The pool grows but never shrinks.
+  size_t hub_workers = 0;
+
+  // Placement/scheduling for the TUN-side threads (threaded reader, pipeline
+  // reader and writer, pump thread) and the socket-side threads (threaded
+  // reader, pipeline encryptor and decryptor). Hub workers are shared across
+  // tunnels and are not tuned per tunnel.
+  ThreadTuning tun_thread;
+  ThreadTuning socket_thread;
+
+  // Before blocking in poll() for TUN or socket readiness, keep retrying the
+  // non-blocking read for this long. Trades a busy core for lower wakeup
+  // latency; 0 disables spinning.
+  size_t spin_us = 0;
+};
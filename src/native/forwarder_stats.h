@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "tun_backend.h"
+
+/**
+ * Layout of the forwarder statistics block (mirrored by
+ * src/tunnel/forwarder-stats.ts).
+ *
+ * The block is a JS `SharedArrayBuffer`: a header of 32-bit words written
+ * once by JS, followed by one slot of `uint64_t` counters per forwarder
+ * thread role. Every slot has a single writer that updates it with plain
+ * relaxed stores (no locked read-modify-write), and JS sums the slots with
+ * `Atomics.load`, so reading costs no call into native code.
+ *
+ * Slots are `kSlotBytes` apart and the counters fill less than half of one,
+ * so two threads never write the same 64- or 128-byte cache line however the
+ * buffer is aligned.
+ */
+namespace forwarder_stats {
+
+constexpr size_t kHeaderBytes = 64;
+constexpr size_t kSlotBytes = 256;
+constexpr uint32_t kMagic = 0x54465354;  // "TFST"
+
+// Header word indices.
+constexpr size_t kMagicWord = 0;
+constexpr size_t kSlotCountWord = 1;
+constexpr size_t kSlotBytesWord = 2;
+constexpr size_t kCounterCountWord = 3;
+
+// Slot owners. `kTun` is the TUN reader of the threaded and pipeline
+// engines (queue 0 on multi-queue devices) and the single thread of the pump
+// and hub engines; queues 1..N-1 use `kTunQueue + queue - 1`.
+enum Slot : size_t {
+  kTun = 0,
+  kSocket,     // threaded device-to-TUN thread, pipeline decryptor
+  kEncrypt,    // pipeline encryptor
+  kTunWriter,  // pipeline TUN writer
+  kTunQueue,
+};
+
+constexpr size_t kSlotCount = kTunQueue + kMaxTunQueues - 1;
+constexpr size_t kBytes = kHeaderBytes + kSlotCount * kSlotBytes;
+
+enum Counter : size_t {
+  kEgressPackets = 0,     // TUN packets admitted for the tunnel
+  kEgressBytes,
+  kIngressPackets,        // frames handed to the TUN device
+  kIngressBytes,
+  kDropNonIpv6,           // egress drops by reason (Windows filters)
+  kDropMulticast,
+  kDropNeighborDiscovery,
+  kDropOversize,          // pipeline queue slot too small
+  kTunReadWouldBlock,     // TUN reads that found no packet
+  kTunWriteBlocked,       // TUN writes refused by back-pressure
+  kSslWantRead,           // socket waits for readability (OpenSSL or kTLS)
+  kSslWantWrite,          // socket waits for writability
+  kPollWakeups,           // returns from a blocking readiness wait
+  kIngressHighWater,      // most decrypted bytes buffered ahead of the TUN
+  kCounterCount,
+};
+
+}  // namespace forwarder_stats
+
+/** One thread's counters; only that thread writes them. */
+struct ForwarderStatsSlot {
+  uint64_t Add(forwarder_stats::Counter counter, uint64_t n = 1) {
+    std::atomic<uint64_t>& value = counters[counter];
+    const uint64_t next = value.load(std::memory_order_relaxed) + n;
+    value.store(next, std::memory_order_relaxed);
+    return next;
+  }
+
+  void Max(forwarder_stats::Counter counter, uint64_t candidate) {
+    std::atomic<uint64_t>& value = counters[counter];
+    if (candidate > value.load(std::memory_order_relaxed)) {
+      value.store(candidate, std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t Get(forwarder_stats::Counter counter) const {
+    return counters[counter].load(std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> counters[forwarder_stats::kCounterCount] = {};
+  uint8_t padding[forwarder_stats::kSlotBytes -
+                  forwarder_stats::kCounterCount * sizeof(std::atomic<uint64_t>)] = {};
+};
+
+static_assert(sizeof(ForwarderStatsSlot) == forwarder_stats::kSlotBytes,
+              "stats slot must match the shared layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared stats counters need lock-free 64-bit atomics");
+
+/**
+ * The statistics block of one {@link TunnelForwarder}. Counters live in
+ * private memory until `Attach()` moves them into a JS-owned buffer.
+ */
+class ForwarderStats {
+public:
+  ForwarderStats() : own_(new uint64_t[forwarder_stats::kBytes / sizeof(uint64_t)]()) {
+    base_ = reinterpret_cast<uint8_t*>(own_.get());
+  }
+
+  ForwarderStats(const ForwarderStats&) = delete;
+  ForwarderStats& operator=(const ForwarderStats&) = delete;
+
+  /**
+   * Writes counters into `memory` from now on. The caller keeps it alive and
+   * must not call this while a forwarding thread runs.
+   */
+  bool Attach(uint8_t* memory, size_t length, std::string& error) {
+    if (memory == nullptr || length < forwarder_stats::kBytes) {
+      error = "Stats memory must be at least " + std::to_string(forwarder_stats::kBytes) +
+              " bytes";
+      return false;
+    }
+    if (reinterpret_cast<uintptr_t>(memory) % alignof(std::atomic<uint64_t>) != 0) {
+      error = "Stats memory must be 8-byte aligned";
+      return false;
+    }
+    uint32_t header[4];
+    std::memcpy(header, memory, sizeof(header));
+    if (header[forwarder_stats::kMagicWord] != forwarder_stats::kMagic ||
+        header[forwarder_stats::kSlotCountWord] != forwarder_stats::kSlotCount ||
+        header[forwarder_stats::kSlotBytesWord] != forwarder_stats::kSlotBytes ||
+        header[forwarder_stats::kCounterCountWord] != forwarder_stats::kCounterCount) {
+      error = "Stats memory layout does not match this build of the addon";
+      return false;
+    }
+    base_ = memory;
+    return true;
+  }
+
+  ForwarderStatsSlot& slot(size_t index) {
+    return reinterpret_cast<ForwarderStatsSlot*>(base_ + forwarder_stats::kHeaderBytes)[index];
+  }
+
+  /** Slot of the reader of TUN queue `queue` (`kAnyQueue`-style values map to `kTun`). */
+  ForwarderStatsSlot& tun_queue_slot(size_t queue) {
+    if (queue == 0 || queue >= kMaxTunQueues) {
+      return slot(forwarder_stats::kTun);
+    }
+    return slot(forwarder_stats::kTunQueue + queue - 1);
+  }
+
+  /** Zeroes every counter; only while no forwarding thread runs. */
+  void Reset() {
+    for (size_t i = 0; i < forwarder_stats::kSlotCount; ++i) {
+      for (std::atomic<uint64_t>& counter : slot(i).counters) {
+        counter.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  std::unique_ptr<uint64_t[]> own_;
+  uint8_t* base_ = nullptr;
+};
@@ -0,0 +1,491 @@
+#include "forwarding_hub.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <utility>
+
+#include <poll.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+#include "debug_log.h"
+#include "file_descriptor.h"
+#include "forwarder_options.h"
+#include "thread_tuning.h"
+#include "tunnel_pump.h"
+#include "wakeup_event.h"
+
+namespace {
+
+// Pool size when the first hub tunnel does not ask for one.
+constexpr size_t kDefaultHubWorkers = 2;
+constexpr size_t kMaxHubWorkers = 64;
+
+// Reserved event tag for the worker's command wakeup; tunnel ids start at 1.
+constexpr uint64_t kWakeupTag = 0;
+
+struct HubTunnel {
+  uint64_t id = 0;
+  int tun_fd = -1;
+  int sock_fd = -1;
+  std::unique_ptr<TunnelPump> pump;
+  ForwardingHub::ErrorCallback on_error;
+  // Readiness currently registered with the poller.
+  bool want_tun_in = false;
+  bool want_tun_out = false;
+  bool want_sock_in = false;
+  bool want_sock_out = false;
+  bool registered = false;
+  bool failed = false;
+};
+
+}  // namespace
+
+class ForwardingHub::Worker {
+public:
+  explicit Worker(size_t index) : index_(index) {}
+
+  ~Worker() { Shutdown(); }
+
+  bool Start(std::string& error) {
+    if (!wakeup_.Open(error)) {
+      return false;
+    }
+#ifdef __linux__
+    epoll_.reset(epoll_create1(EPOLL_CLOEXEC));
+    if (!epoll_.is_valid()) {
+      error = std::string("epoll_create1 failed: ") + strerror(errno);
+      return false;
+    }
+    struct epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = kWakeupTag;
+    if (epoll_ctl(epoll_.get(), EPOLL_CTL_ADD, wakeup_.fd(), &ev) != 0) {
+      error = std::string("epoll_ctl(wakeup) failed: ") + strerror(errno);
+      return false;
+    }
+#endif
+    running_.store(true);
+    thread_ = std::thread(&Worker::Run, this);
+    return true;
+  }
+
+  void Shutdown() {
+    running_.store(false);
+    wakeup_.Signal();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+  size_t load() const { return load_.load(); }
+
+  ForwardingHubWorkerStats stats() const { return {load_.load(), wakeups_.load()}; }
+
+  void Attach(std::unique_ptr<HubTunnel> tunnel) {
+    load_.fetch_add(1);
+    {
+      std::lock_guard<std::mutex> lock(commands_mutex_);
+      if (!exited_) {
+        commands_.push_back(Command{std::move(tunnel), 0, nullptr});
+      }
+    }
+    if (tunnel && tunnel->on_error) {
+      tunnel->on_error("Hub worker stopped");
+      return;
+    }
+    wakeup_.Signal();
+  }
+
+  void Detach(uint64_t id) {
+    std::promise<void> done;
+    std::future<void> finished = done.get_future();
+    {
+      std::lock_guard<std::mutex> lock(commands_mutex_);
+      if (exited_) {
+        load_.fetch_sub(1);
+        return;
+      }
+      commands_.push_back(Command{nullptr, id, &done});
+    }
+    wakeup_.Signal();
+    finished.wait();
+    load_.fetch_sub(1);
+  }
+
+private:
+  struct Command {
+    std::unique_ptr<HubTunnel> attach;
+    uint64_t detach_id;
+    std::promise<void>* detached;
+  };
+
+  void Run() {
+    const std::string name = "tuntap-hub-" + std::to_string(index_);
+    SetCurrentThreadName(name.c_str());
+    std::vector<uint64_t> ready;
+    std::vector<uint64_t> again;
+    while (running_.load()) {
+      ready.clear();
+      bool woken = false;
+      // Tunnels that stopped on their per-call budget get another turn right
+      // away; otherwise sleep until a fd or the command wakeup fires.
+      if (!Wait(again.empty() ? -1 : 0, ready, woken)) {
+        break;
+      }
+      ++wakeups_;
+      if (woken) {
+        wakeup_.Reset();
+        ProcessCommands();
+      }
+      ready.insert(ready.end(), again.begin(), again.end());
+      again.clear();
+      std::sort(ready.begin(), ready.end());
+      ready.erase(std::unique(ready.begin(), ready.end()), ready.end());
+      for (uint64_t id : ready) {
+        auto it = tunnels_.find(id);
+        if (it != tunnels_.end() && !it->second->failed && Service(*it->second)) {
+          again.push_back(id);
+        }
+      }
+    }
+    Exit();
+  }
+
+  // Fails every tunnel still attached and releases pending detaches so no
+  // caller waits on a worker that is gone.
+  void Exit() {
+    std::vector<Command> commands;
+    {
+      std::lock_guard<std::mutex> lock(commands_mutex_);
+      exited_ = true;
+      commands.swap(commands_);
+    }
+    for (auto& entry : tunnels_) {
+      if (!entry.second->failed) {
+        FailTunnel(*entry.second, "Hub worker stopped");
+      }
+    }
+    for (Command& command : commands) {
+      if (command.attach) {
+        if (command.attach->on_error) {
+          command.attach->on_error("Hub worker stopped");
+        }
+      } else {
+        command.detached->set_value();
+      }
+    }
+  }
+
+  // Returns true when the tunnel should be pumped again without waiting.
+  bool Service(HubTunnel& tunnel) {
+    // A hub tunnel has no wait of its own; each turn on the worker counts.
+    tunnel.pump->stats().Add(forwarder_stats::kPollWakeups);
+    PumpInterest interest;
+    std::string error;
+    if (!tunnel.pump->Pump(interest, error)) {
+      FailTunnel(tunnel, error.empty() ? "Hub engine failed" : error);
+      return false;
+    }
+    SetInterest(tunnel, interest);
+    return interest.again;
+  }
+
+  void FailTunnel(HubTunnel& tunnel, const std::string& reason) {
+    tunnel.failed = true;
+    Unregister(tunnel);
+    tuntap::FwdDebug("hub-tunnel-failed", "worker=%zu id=%llu reason=%s", index_,
+                     static_cast<unsigned long long>(tunnel.id), reason.c_str());
+    ErrorCallback cb = std::move(tunnel.on_error);
+    tunnel.on_error = nullptr;
+    if (cb) {
+      cb(reason);
+    }
+  }
+
+  void ProcessCommands() {
+    std::vector<Command> commands;
+    {
+      std::lock_guard<std::mutex> lock(commands_mutex_);
+      commands.swap(commands_);
+    }
+    for (Command& command : commands) {
+      if (command.attach) {
+        HubTunnel& tunnel = *command.attach;
+        const uint64_t id = tunnel.id;
+        tunnels_[id] = std::move(command.attach);
+        tuntap::FwdDebug("hub-attach", "worker=%zu id=%llu tunnels=%zu", index_,
+                         static_cast<unsigned long long>(id), tunnels_.size());
+        // Pump once immediately: it registers the initial interest and moves
+        // anything already queued.
+        if (!Register(tunnel)) {
+          FailTunnel(tunnel, "Failed to register tunnel with hub worker");
+        } else if (Service(tunnel)) {
+          pending_again_.push_back(id);
+        }
+        continue;
+      }
+      auto it = tunnels_.find(command.detach_id);
+      if (it != tunnels_.end()) {
+        Unregister(*it->second);
+        tunnels_.erase(it);
+      }
+      tuntap::FwdDebug("hub-detach", "worker=%zu id=%llu tunnels=%zu", index_,
+                       static_cast<unsigned long long>(command.detach_id), tunnels_.size());
+      command.detached->set_value();
+    }
+  }
+
+  void SetInterest(HubTunnel& tunnel, const PumpInterest& interest) {
+    const bool changed = tunnel.want_tun_in != interest.tun_readable ||
+                         tunnel.want_tun_out != interest.tun_writable ||
+                         tunnel.want_sock_in != interest.sock_readable ||
+                         tunnel.want_sock_out != interest.sock_writable;
+    tunnel.want_tun_in = interest.tun_readable;
+    tunnel.want_tun_out = interest.tun_writable;
+    tunnel.want_sock_in = interest.sock_readable;
+    tunnel.want_sock_out = interest.sock_writable;
+#ifdef __linux__
+    if (changed && tunnel.registered) {
+      Modify(tunnel, tunnel.tun_fd, tunnel.want_tun_in, tunnel.want_tun_out);
+      Modify(tunnel, tunnel.sock_fd, tunnel.want_sock_in, tunnel.want_sock_out);
+    }
+#else
+    (void)changed;
+#endif
+  }
+
+#ifdef __linux__
+  // Both fds of a tunnel carry its id; the pump retries both directions on
+  // any readiness, so the worker does not need to know which fd fired.
+  bool Register(HubTunnel& tunnel) {
+    struct epoll_event ev {};
+    ev.data.u64 = tunnel.id;
+    if (epoll_ctl(epoll_.get(), EPOLL_CTL_ADD, tunnel.tun_fd, &ev) != 0) {
+      return false;
+    }
+    if (epoll_ctl(epoll_.get(), EPOLL_CTL_ADD, tunnel.sock_fd, &ev) != 0) {
+      epoll_ctl(epoll_.get(), EPOLL_CTL_DEL, tunnel.tun_fd, nullptr);
+      return false;
+    }
+    tunnel.registered = true;
+    return true;
+  }
+
+  void Unregister(HubTunnel& tunnel) {
+    if (!tunnel.registered) {
+      return;
+    }
+    epoll_ctl(epoll_.get(), EPOLL_CTL_DEL, tunnel.tun_fd, nullptr);
+    epoll_ctl(epoll_.get(), EPOLL_CTL_DEL, tunnel.sock_fd, nullptr);
+    tunnel.registered = false;
+  }
+
+  void Modify(HubTunnel& tunnel, int fd, bool in, bool out) {
+    struct epoll_event ev {};
+    ev.events = (in ? static_cast<uint32_t>(EPOLLIN) : 0u) | (out ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    ev.data.u64 = tunnel.id;
+    epoll_ctl(epoll_.get(), EPOLL_CTL_MOD, fd, &ev);
+  }
+
+  bool Wait(int timeout_ms, std::vector<uint64_t>& ready, bool& woken) {
+    struct epoll_event events[64];
+    if (!pending_again_.empty()) {
+      ready.swap(pending_again_);
+      timeout_ms = 0;
+    }
+    const int n = epoll_wait(epoll_.get(), events, 64, timeout_ms);
+    if (n < 0) {
+      if (errno == EINTR) {
+        return true;
+      }
+      tuntap::FwdDebug("hub-epoll-error", "worker=%zu errno=%d %s", index_, errno,
+                       strerror(errno));
+      return false;
+    }
+    for (int i = 0; i < n; ++i) {
+      if (events[i].data.u64 == kWakeupTag) {
+        woken = true;
+      } else {
+        ready.push_back(events[i].data.u64);
+      }
+    }
+    return true;
+  }
+#else
+  // poll() fallback: the wait set is rebuilt from each tunnel's interest.
+  bool Register(HubTunnel& tunnel) {
+    tunnel.registered = true;
+    return true;
+  }
+
+  void Unregister(HubTunnel& tunnel) { tunnel.registered = false; }
+
+  bool Wait(int timeout_ms, std::vector<uint64_t>& ready, bool& woken) {
+    if (!pending_again_.empty()) {
+      ready.swap(pending_again_);
+      timeout_ms = 0;
+    }
+    pollfds_.clear();
+    pollfd_ids_.clear();
+    pollfds_.push_back(pollfd{wakeup_.fd(), POLLIN, 0});
+    pollfd_ids_.push_back(kWakeupTag);
+    for (const auto& entry : tunnels_) {
+      const HubTunnel& tunnel = *entry.second;
+      if (!tunnel.registered) {
+        continue;
+      }
+      pollfds_.push_back(pollfd{tunnel.tun_fd,
+                                static_cast<short>((tunnel.want_tun_in ? POLLIN : 0) |
+                                                   (tunnel.want_tun_out ? POLLOUT : 0)),
+                                0});
+      pollfd_ids_.push_back(tunnel.id);
+      pollfds_.push_back(pollfd{tunnel.sock_fd,
+                                static_cast<short>((tunnel.want_sock_in ? POLLIN : 0) |
+                                                   (tunnel.want_sock_out ? POLLOUT : 0)),
+                                0});
+      pollfd_ids_.push_back(tunnel.id);
+    }
+    const int n = poll(pollfds_.data(), static_cast<nfds_t>(pollfds_.size()), timeout_ms);
+    if (n < 0) {
+      if (errno == EINTR) {
+        return true;
+      }
+      tuntap::FwdDebug("hub-poll-error", "worker=%zu errno=%d %s", index_, errno,
+                       strerror(errno));
+      return false;
+    }
+    for (size_t i = 0; i < pollfds_.size() && n > 0; ++i) {
+      if (pollfds_[i].revents == 0) {
+        continue;
+      }
+      if (pollfd_ids_[i] == kWakeupTag) {
+        woken = true;
+      } else {
+        ready.push_back(pollfd_ids_[i]);
+      }
+    }
+    return true;
+  }
+
+  std::vector<pollfd> pollfds_;
+  std::vector<uint64_t> pollfd_ids_;
+#endif
+
+  const size_t index_;
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+  std::atomic<size_t> load_{0};
+  std::atomic<uint64_t> wakeups_{0};
+  WakeupEvent wakeup_;
+#ifdef __linux__
+  FileDescriptor epoll_;
+#endif
+
+  std::mutex commands_mutex_;
+  std::vector<Command> commands_;
+  bool exited_ = false;
+
+  // Worker-thread state.
+  std::unordered_map<uint64_t, std::unique_ptr<HubTunnel>> tunnels_;
+  std::vector<uint64_t> pending_again_;
+};
+
+ForwardingHub& ForwardingHub::Instance() {
+  // Intentionally leaked: workers may still be parked in epoll_wait when the
+  // process exits, and joining them from a static destructor is not safe.
+  static ForwardingHub* hub = new ForwardingHub();
+  return *hub;
+}
+
+ForwardingHub::ForwardingHub() = default;
+
+ForwardingHub::~ForwardingHub() = default;
+
+bool ForwardingHub::EnsureWorkers(size_t count, std::string& error) {
+  if (count == 0) {
+    count = workers_.empty() ? kDefaultHubWorkers : workers_.size();
+  }
+  count = std::min(count, kMaxHubWorkers);
+  while (workers_.size() < count) {
+    auto worker = std::make_unique<Worker>(workers_.size());
+    if (!worker->Start(error)) {
+      return false;
+    }
+    workers_.push_back(std::move(worker));
+  }
+  return true;
+}
+
+bool ForwardingHub::Attach(SSL* ssl,
+                           TunPlatformBackend* tun_backend,
+                           size_t mtu,
+                           const ForwarderOptions& options,
+                           size_t worker_count,
+                           ForwarderStatsSlot& stats,
+                           ForwarderLatency& latency,
+                           ErrorCallback on_error,
+                           uint64_t& id,
+                           std::string& error) {
+  const int tun_fd = tun_backend == nullptr ? -1 : tun_backend->GetNativeFd();
+  const int sock_fd = ssl == nullptr ? -1 : SSL_get_fd(ssl);
+  if (tun_fd < 0 || sock_fd < 0) {
+    error = "The hub forwarder engine requires pollable TUN and socket descriptors";
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!EnsureWorkers(worker_count, error)) {
+    return false;
+  }
+
+  Worker* target = workers_.front().get();
+  for (const auto& worker : workers_) {
+    if (worker->load() < target->load()) {
+      target = worker.get();
+    }
+  }
+
+  auto tunnel = std::make_unique<HubTunnel>();
+  tunnel->id = next_id_++;
+  tunnel->tun_fd = tun_fd;
+  tunnel->sock_fd = sock_fd;
+  tunnel->pump = std::make_unique<TunnelPump>(ssl, tun_backend, mtu, options, stats, latency);
+  tunnel->on_error = std::move(on_error);
+
+  id = tunnel->id;
+  owners_[id] = target;
+  target->Attach(std::move(tunnel));
+  return true;
+}
+
+void ForwardingHub::Detach(uint64_t id) {
+  Worker* worker = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = owners_.find(id);
+    if (it == owners_.end()) {
+      return;
+    }
+    worker = it->second;
+    owners_.erase(it);
+  }
+  // Workers are never destroyed, so the pointer stays valid without the lock.
+  worker->Detach(id);
+}
+
+std::vector<ForwardingHubWorkerStats> ForwardingHub::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<ForwardingHubWorkerStats> out;
+  out.reserve(workers_.size());
+  for (const auto& worker : workers_) {
+    out.push_back(worker->stats());
+  }
+  return out;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <openssl/ssl.h>
+
+#include "forwarder_stats.h"
+#include "latency_histogram.h"
+#include "tun_backend.h"
+
+struct ForwarderOptions;
+
+/** Per-worker occupancy reported by {@link ForwardingHub::GetStats}. */
+struct ForwardingHubWorkerStats {
+  size_t tunnels = 0;
+  uint64_t wakeups = 0;
+};
+
+/**
+ * Process-wide pool of event-loop workers shared by every tunnel started with
+ * `ForwarderEngine::kHub` (POSIX only).
+ *
+ * Each worker multiplexes the TUN fds and TLS sockets of many tunnels (epoll
+ * on Linux, poll on macOS) and drives every tunnel through its own
+ * {@link TunnelPump}, so N tunnels cost a handful of threads instead of 2N.
+ * New tunnels go to the worker with the fewest attached tunnels.
+ */
+class ForwardingHub {
+public:
+  using ErrorCallback = std::function<void(std::string)>;
+
+  static ForwardingHub& Instance();
+
+  ForwardingHub(const ForwardingHub&) = delete;
+  ForwardingHub& operator=(const ForwardingHub&) = delete;
+
+  /**
+   * Hands `ssl` and `tun_backend` to a worker until `Detach(id)`. The caller
+   * must not touch either meanwhile. `worker_count` grows the pool if it is
+   * smaller (0 keeps the current size, or picks a default for a new pool).
+   * The worker counts into `stats`, times into `latency` and runs
+   * `on_error` at most once.
+   */
+  bool Attach(SSL* ssl,
+              TunPlatformBackend* tun_backend,
+              size_t mtu,
+              const ForwarderOptions& options,
+              size_t worker_count,
+              ForwarderStatsSlot& stats,
+              ForwarderLatency& latency,
+              ErrorCallback on_error,
+              uint64_t& id,
+              std::string& error);
+
+  /** Removes a tunnel; returns once its worker no longer touches it. */
+  void Detach(uint64_t id);
+
+  std::vector<ForwardingHubWorkerStats> GetStats() const;
+
+private:
+  class Worker;
+
+  ForwardingHub();
+  ~ForwardingHub();
+
+  bool EnsureWorkers(size_t count, std::string& error);
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::unordered_map<uint64_t, Worker*> owners_;
+  uint64_t next_id_ = 1;
+};
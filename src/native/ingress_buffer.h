@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+/** Default device-to-TUN buffer size (bounds one stalled partial frame plus read-ahead). */
+inline constexpr size_t kIngressBufferCapacity = 256 * 1024;
+
+/**
+ * Largest TLS record plaintext. Readers keep at least this much room so a
+ * single SSL_read_ex can always take a whole record.
+ */
+inline constexpr size_t kIngressReadReserve = 16 * 1024;
+
+/**
+ * Fixed-capacity contiguous receive buffer for the device-to-TUN path.
+ *
+ * SSL_read decrypts straight into `write_ptr()` and frames are consumed in
+ * place from `read_ptr()`, so the hot path never allocates. Cursors rewind for
+ * free whenever the buffer drains; otherwise `Reserve()` relocates only the
+ * unconsumed tail (at most one partial frame) once the write head nears the
+ * end of the storage.
+ */
+class IngressBuffer {
+public:
+  explicit IngressBuffer(size_t capacity)
+      : data_(new uint8_t[capacity]), capacity_(capacity) {}
+
+  IngressBuffer(const IngressBuffer&) = delete;
+  IngressBuffer& operator=(const IngressBuffer&) = delete;
+
+  uint8_t* write_ptr() { return data_.get() + tail_; }
+  size_t writable() const { return capacity_ - tail_; }
+
+  const uint8_t* read_ptr() const { return data_.get() + head_; }
+  size_t readable() const { return tail_ - head_; }
+
+  size_t capacity() const { return capacity_; }
+  size_t high_water() const { return high_water_; }
+
+  void Commit(size_t len) {
+    tail_ += len;
+    if (readable() > high_water_) {
+      high_water_ = readable();
+    }
+  }
+
+  void Consume(size_t len) {
+    head_ += len;
+    if (head_ == tail_) {
+      head_ = 0;
+      tail_ = 0;
+    }
+  }
+
+  /** Ensure `min_space` writable bytes; false when unconsumed data leaves too little room. */
+  bool Reserve(size_t min_space) {
+    if (writable() >= min_space) {
+      return true;
+    }
+    if (capacity_ - readable() < min_space) {
+      return false;
+    }
+    const size_t pending = readable();
+    std::memmove(data_.get(), data_.get() + head_, pending);
+    head_ = 0;
+    tail_ = pending;
+    return true;
+  }
+
+private:
+  std::unique_ptr<uint8_t[]> data_;
+  size_t capacity_ = 0;
+  size_t head_ = 0;
+  size_t tail_ = 0;
+  size_t high_water_ = 0;
+};
@@ -2,7 +2,6 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <vector>
 
 namespace ipv6_frame {
 
@@ -25,11 +24,38 @@ inline size_t FrameLength(const uint8_t* data, size_t len) {
   return total;
 }
 
-/** Append bytes and extract every complete IPv6 frame into `out`. */
-inline void DrainFrames(std::vector<uint8_t>& buffer, std::vector<std::vector<uint8_t>>& out) {
+/**
+ * FNV-1a hash of the flow identity: source and destination address, next
+ * header, and the port pair for TCP/UDP. 0 when `data` is not IPv6.
+ */
+inline uint32_t FlowHash(const uint8_t* data, size_t len) {
+  if (len < kHeaderSize || ((data[0] >> 4) & 0x0f) != kVersion) {
+    return 0;
+  }
+  uint32_t hash = 2166136261u;
+  auto mix = [&hash](const uint8_t* bytes, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      hash = (hash ^ bytes[i]) * 16777619u;
+    }
+  };
+  mix(data + 8, 32);
+  mix(data + 6, 1);
+  if ((data[6] == 6 || data[6] == 17) && len >= kHeaderSize + 4) {
+    mix(data + kHeaderSize, 4);
+  }
+  return hash;
+}
+
+/**
+ * Visit every complete IPv6 frame in `data` in place via `fn(frame, len)`.
+ * Returns the number of bytes consumed; stops early when `fn` returns false
+ * (the rejected frame is not counted as consumed).
+ */
+template <typename FrameFn>
+inline size_t ForEachFrame(const uint8_t* data, size_t len, FrameFn&& fn) {
   size_t offset = 0;
-  while (offset < buffer.size()) {
-    const size_t frame_len = FrameLength(buffer.data() + offset, buffer.size() - offset);
+  while (offset < len) {
+    const size_t frame_len = FrameLength(data + offset, len - offset);
     if (frame_len == 0) {
       break;
     }
@@ -37,13 +63,12 @@ inline void DrainFrames(std::vector<uint8_t>& buffer, std::vector<std::vector<ui
       offset += 1;
       continue;
     }
-    out.emplace_back(buffer.begin() + static_cast<ptrdiff_t>(offset),
-                     buffer.begin() + static_cast<ptrdiff_t>(offset + frame_len));
+    if (!fn(data + offset, frame_len)) {
+      break;
+    }
     offset += frame_len;
   }
-  if (offset > 0) {
-    buffer.erase(buffer.begin(), buffer.begin() + static_cast<ptrdiff_t>(offset));
-  }
+  return offset;
 }
 
 }  // namespace ipv6_frame
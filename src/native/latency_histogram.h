@@ -0,0 +1,264 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace forwarder_latency {
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__)
+constexpr bool kCycleClock = true;
+#else
+constexpr bool kCycleClock = false;
+#endif
+
+/**
+ * Timestamp for latency measurement: the invariant TSC on x86-64, the
+ * virtual counter on arm64 (both a few ns, no syscall or vDSO call) and
+ * `steady_clock` nanoseconds elsewhere. Convert differences with
+ * `NanosPerTick()`.
+ */
+inline uint64_t Now() {
+#if defined(__x86_64__) || defined(_M_X64)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t ticks;
+  __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+#endif
+}
+
+namespace detail {
+
+struct CalibrationOrigin {
+  uint64_t ticks;
+  std::chrono::steady_clock::time_point at;
+};
+
+inline const CalibrationOrigin& Origin() {
+  static const CalibrationOrigin origin{Now(), std::chrono::steady_clock::now()};
+  return origin;
+}
+
+}  // namespace detail
+
+/**
+ * Pins the reference point `NanosPerTick()` measures from. Cheap; call it
+ * well before the first conversion (e.g. at module load).
+ */
+inline void StartCalibration() {
+  (void)detail::Origin();
+}
+
+/**
+ * Length of a `Now()` tick, measured against `steady_clock` since
+ * `StartCalibration()` (or the first call). Sleeps only when less than 10ms
+ * have passed since then.
+ */
+inline double NanosPerTick() {
+  if (!kCycleClock) {
+    return 1.0;
+  }
+  using Clock = std::chrono::steady_clock;
+  const detail::CalibrationOrigin& origin = detail::Origin();
+  constexpr auto kMinWindow = std::chrono::milliseconds(10);
+  auto elapsed = Clock::now() - origin.at;
+  if (elapsed < kMinWindow) {
+    std::this_thread::sleep_for(kMinWindow - elapsed);
+  }
+  const uint64_t ticks = Now() - origin.ticks;
+  elapsed = Clock::now() - origin.at;
+  const double nanos = std::chrono::duration<double, std::nano>(elapsed).count();
+  return ticks == 0 ? 1.0 : nanos / static_cast<double>(ticks);
+}
+
+}  // namespace forwarder_latency
+
+/**
+ * Log-linear histogram of durations in clock ticks (HDR-style).
+ *
+ * Values below 16 get a bucket each; above that every power of two is split
+ * into 16 equal buckets, so a reported percentile is at most 1/16 (6.25 %)
+ * above the true value. Recording computes the bucket with one
+ * count-leading-zeros and updates it with a relaxed load and store: no
+ * lock and no atomic read-modify-write, so each histogram must have one
+ * writer at a time. Any thread may take snapshots.
+ */
+class LatencyHistogram {
+public:
+  static constexpr int kSubBucketBits = 4;
+  static constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBucketBits;
+  // Values at or above 2^40 ticks (minutes at GHz rates) share the last bucket.
+  static constexpr int kMaxBits = 40;
+  static constexpr size_t kBucketCount = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+  struct Summary {
+    uint64_t count = 0;
+    double mean_ns = 0;
+    uint64_t max_ns = 0;
+    uint64_t p50_ns = 0;
+    uint64_t p90_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+  };
+
+  /** Records `count` samples of `value` ticks. */
+  void Record(uint64_t value, uint64_t count = 1) {
+    std::atomic<uint64_t>& bucket = buckets_[BucketIndex(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    sum_.store(sum_.load(std::memory_order_relaxed) + value * count, std::memory_order_relaxed);
+    if (value > max_.load(std::memory_order_relaxed)) {
+      max_.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Percentiles, in nanoseconds, over everything recorded since the last
+   * `Reset()`. Samples recorded concurrently may or may not be included.
+   */
+  Summary Snapshot(double nanos_per_tick) const {
+    std::array<uint64_t, kBucketCount> counts;
+    Summary summary;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      counts[i] = buckets_[i].load(std::memory_order_relaxed);
+      summary.count += counts[i];
+    }
+    if (summary.count == 0) {
+      return summary;
+    }
+    const uint64_t max = max_.load(std::memory_order_relaxed);
+    const auto nanos = [nanos_per_tick](uint64_t ticks) {
+      return static_cast<uint64_t>(static_cast<double>(ticks) * nanos_per_tick);
+    };
+    summary.max_ns = nanos(max);
+    summary.mean_ns = static_cast<double>(sum_.load(std::memory_order_relaxed)) * nanos_per_tick /
+                      static_cast<double>(summary.count);
+    summary.p50_ns = nanos(Percentile(counts, summary.count, 0.5, max));
+    summary.p90_ns = nanos(Percentile(counts, summary.count, 0.9, max));
+    summary.p99_ns = nanos(Percentile(counts, summary.count, 0.99, max));
+    summary.p999_ns = nanos(Percentile(counts, summary.count, 0.999, max));
+    return summary;
+  }
+
+  /** Clears the histogram; samples recorded meanwhile may survive. */
+  void Reset() {
+    for (std::atomic<uint64_t>& bucket : buckets_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+  static size_t BucketIndex(uint64_t value) {
+    if (value < kSubBuckets) {
+      return static_cast<size_t>(value);
+    }
+    if (value >= (uint64_t{1} << kMaxBits)) {
+      return kBucketCount - 1;
+    }
+    const int exponent = HighestBit(value);  // >= kSubBucketBits
+    const int shift = exponent - kSubBucketBits;
+    const uint64_t sub = (value >> shift) - kSubBuckets;
+    return static_cast<size_t>((shift + 1) * kSubBuckets + sub);
+  }
+
+  /** Largest value that maps to bucket `index`. */
+  static uint64_t BucketUpperBound(size_t index) {
+    if (index < kSubBuckets) {
+      return index;
+    }
+    const int shift = static_cast<int>(index / kSubBuckets) - 1;
+    const uint64_t sub = index % kSubBuckets;
+    return ((kSubBuckets + sub + 1) << shift) - 1;
+  }
+
+private:
+  static int HighestBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+  }
+
+  static uint64_t Percentile(const std::array<uint64_t, kBucketCount>& counts,
+                             uint64_t total,
+                             double quantile,
+                             uint64_t max) {
+    // Rank of the sample at `quantile`, 1-based and rounded up.
+    uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(total));
+    if (static_cast<double>(rank) < quantile * static_cast<double>(total)) {
+      ++rank;
+    }
+    rank = rank == 0 ? 1 : rank;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        const uint64_t upper = BucketUpperBound(i);
+        return upper < max ? upper : max;
+      }
+    }
+    return max;
+  }
+
+  std::atomic<uint64_t> buckets_[kBucketCount] = {};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+namespace forwarder_latency {
+
+// Stages timed by the tunnel forwarder. A packet's time in a stage runs
+// from the previous timestamp on its path to the next one; the waits are
+// the time a forwarder thread spent blocked on the device or the socket.
+// Each stage is recorded by one thread at a time (egress under the egress
+// lock when several TUN queues share the session).
+enum Stage : size_t {
+  kEgressTunToTunnel = 0,  // TUN read completion -> SSL write completion
+  kEgressSocketWait,       // PollFd for socket writability during a write
+  kIngressReadToFrame,     // SSL read completion -> frame extracted
+  kIngressFrameToTun,      // frame extracted -> TUN write completion
+  kIngressTunWait,         // WaitWritable for TUN back-pressure
+  kIngressSocketWait,      // PollFd for socket readability during a read
+  kStageCount,
+};
+
+}  // namespace forwarder_latency
+
+/** One histogram per {@link forwarder_latency::Stage}. */
+class ForwarderLatency {
+public:
+  /** Records `count` samples of `end - start` ticks (0 if the clock went backwards). */
+  void Record(forwarder_latency::Stage stage, uint64_t start, uint64_t end, uint64_t count = 1) {
+    histograms_[stage].Record(end > start ? end - start : 0, count);
+  }
+
+  const LatencyHistogram& stage(forwarder_latency::Stage stage) const {
+    return histograms_[stage];
+  }
+
+  void Reset() {
+    for (LatencyHistogram& histogram : histograms_) {
+      histogram.Reset();
+    }
+  }
+
+private:
+  std::array<LatencyHistogram, forwarder_latency::kStageCount> histograms_;
+};
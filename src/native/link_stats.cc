@@ -0,0 +1,433 @@
+#include "link_stats.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/if_link.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "debug_log.h"
+#include "rtnetlink.h"
+
+namespace {
+
+// Stats requests are answered from memory, so waiting long means trouble.
+constexpr int kReplyTimeoutMs = 1000;
+
+// A RTM_NEWLINK reply with every attribute fits well within this.
+constexpr size_t kReplyBufferBytes = 64 * 1024;
+
+// Appends `data` to a netlink message under construction, padded to 4 bytes.
+void Append(std::vector<uint8_t>& buffer, const void* data, size_t length) {
+  const size_t offset = buffer.size();
+  buffer.resize(offset + NLMSG_ALIGN(length));
+  std::memcpy(buffer.data() + offset, data, length);
+}
+
+void AppendGetLink(std::vector<uint8_t>& buffer, const std::string& name, uint32_t sequence) {
+  const size_t offset = buffer.size();
+  nlmsghdr header {};
+  header.nlmsg_type = RTM_GETLINK;
+  header.nlmsg_flags = NLM_F_REQUEST;
+  header.nlmsg_seq = sequence;
+  Append(buffer, &header, sizeof(header));
+  ifinfomsg link {};
+  link.ifi_family = AF_UNSPEC;
+  Append(buffer, &link, sizeof(link));
+  rtattr attribute {};
+  attribute.rta_type = IFLA_IFNAME;
+  attribute.rta_len = static_cast<uint16_t>(RTA_LENGTH(name.size() + 1));
+  Append(buffer, &attribute, sizeof(attribute));
+  Append(buffer, name.c_str(), name.size() + 1);
+  const uint32_t length = static_cast<uint32_t>(buffer.size() - offset);
+  std::memcpy(buffer.data() + offset + offsetof(nlmsghdr, nlmsg_len), &length, sizeof(length));
+}
+
+// Copies IFLA_STATS64 out of a RTM_NEWLINK reply; false when it has none.
+bool ParseStats64(const nlmsghdr* header, LinkStats& out) {
+  const auto* link = static_cast<const ifinfomsg*>(NLMSG_DATA(header));
+  int remaining = static_cast<int>(IFLA_PAYLOAD(header));
+  for (const rtattr* attribute = IFLA_RTA(link); RTA_OK(attribute, remaining);
+       attribute = RTA_NEXT(attribute, remaining)) {
+    if (attribute->rta_type != IFLA_STATS64 ||
+        RTA_PAYLOAD(attribute) < sizeof(rtnl_link_stats64)) {
+      continue;
+    }
+    // Attributes are only 4-byte aligned.
+    rtnl_link_stats64 stats;
+    std::memcpy(&stats, RTA_DATA(attribute), sizeof(stats));
+    out.rx_packets = stats.rx_packets;
+    out.tx_packets = stats.tx_packets;
+    out.rx_bytes = stats.rx_bytes;
+    out.tx_bytes = stats.tx_bytes;
+    out.rx_errors = stats.rx_errors;
+    out.tx_errors = stats.tx_errors;
+    out.rx_dropped = stats.rx_dropped;
+    out.tx_dropped = stats.tx_dropped;
+    return true;
+  }
+  return false;
+}
+
+bool ReadCounterFile(const std::string& path, uint64_t& value, int& error_code, std::string& error) {
+  FileDescriptor file(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+  if (!file.is_valid()) {
+    error_code = errno;
+    error = "Failed to open " + path + ": " + strerror(errno);
+    return false;
+  }
+  char text[32];
+  ssize_t length;
+  do {
+    length = ::read(file.get(), text, sizeof(text) - 1);
+  } while (length < 0 && errno == EINTR);
+  if (length <= 0) {
+    error_code = length < 0 ? errno : EIO;
+    error = "Failed to read " + path;
+    return false;
+  }
+  text[length] = '\0';
+  value = std::strtoull(text, nullptr, 10);
+  return true;
+}
+
+// Reads /sys/class/net/<name>/statistics; `found` is false when the
+// interface does not exist.
+bool ReadSysfs(const std::string& name,
+               LinkStats& out,
+               bool& found,
+               int& error_code,
+               std::string& error) {
+  found = false;
+  if (name.empty() || name.size() >= IFNAMSIZ || name.find('/') != std::string::npos ||
+      name == "." || name == "..") {
+    return true;
+  }
+  const std::string directory = "/sys/class/net/" + name + "/statistics/";
+  struct stat info {};
+  if (::stat(directory.c_str(), &info) != 0) {
+    if (errno == ENOENT || errno == ENOTDIR) {
+      return true;
+    }
+    error_code = errno;
+    error = "Failed to stat " + directory + ": " + strerror(errno);
+    return false;
+  }
+  found = true;
+  const struct {
+    const char* file;
+    uint64_t LinkStats::*field;
+  } counters[] = {
+      {"rx_packets", &LinkStats::rx_packets}, {"tx_packets", &LinkStats::tx_packets},
+      {"rx_bytes", &LinkStats::rx_bytes},     {"tx_bytes", &LinkStats::tx_bytes},
+      {"rx_errors", &LinkStats::rx_errors},   {"tx_errors", &LinkStats::tx_errors},
+      {"rx_dropped", &LinkStats::rx_dropped}, {"tx_dropped", &LinkStats::tx_dropped},
+  };
+  for (const auto& counter : counters) {
+    if (!ReadCounterFile(directory + counter.file, out.*counter.field, error_code, error)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Per-second rate of a counter that may have restarted from zero (the
+// interface was recreated) since the previous sample.
+double Rate(uint64_t current, uint64_t previous, double seconds) {
+  const uint64_t delta = current >= previous ? current - previous : current;
+  return static_cast<double>(delta) / seconds;
+}
+
+}  // namespace
+
+LinkStatsReader& LinkStatsReader::Shared() {
+  // Never destroyed: the socket closes with the process.
+  static LinkStatsReader* reader = new LinkStatsReader();
+  return *reader;
+}
+
+bool LinkStatsReader::ReadNetlink(const std::vector<std::string>& names,
+                                  std::vector<LinkStats>& stats,
+                                  std::vector<bool>& found,
+                                  std::vector<bool>& complete,
+                                  int& error_code,
+                                  std::string& error) {
+  if (!socket_.is_valid() && !OpenRouteSocket(socket_, kReplyTimeoutMs, error_code, error)) {
+    return false;
+  }
+
+  // Sequence numbers keep running across calls so a late reply to an
+  // earlier request is never taken for one of these.
+  const uint32_t first = next_sequence_;
+  next_sequence_ += static_cast<uint32_t>(names.size());
+  std::vector<uint8_t> request;
+  for (size_t i = 0; i < names.size(); ++i) {
+    AppendGetLink(request, names[i], first + static_cast<uint32_t>(i));
+  }
+
+  sockaddr_nl kernel {};
+  kernel.nl_family = AF_NETLINK;
+  ssize_t sent;
+  do {
+    sent = ::sendto(socket_.get(), request.data(), request.size(), 0,
+                    reinterpret_cast<const sockaddr*>(&kernel), sizeof(kernel));
+  } while (sent < 0 && errno == EINTR);
+  if (sent < 0) {
+    error_code = errno;
+    error = std::string("Failed to send RTM_GETLINK: ") + strerror(errno);
+    socket_.reset();
+    return false;
+  }
+
+  // Each request gets exactly one reply: RTM_NEWLINK, or NLMSG_ERROR.
+  std::vector<bool> settled(names.size(), false);
+  size_t pending = names.size();
+  std::vector<uint8_t> reply(kReplyBufferBytes);
+  while (pending > 0) {
+    const ssize_t received = ::recv(socket_.get(), reply.data(), reply.size(), 0);
+    if (received < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      error_code = errno == EAGAIN || errno == EWOULDBLOCK ? ETIMEDOUT : errno;
+      error = std::string("Failed to read RTM_GETLINK reply: ") + strerror(error_code);
+      socket_.reset();
+      return false;
+    }
+
+    int remaining = static_cast<int>(received);
+    for (auto* header = reinterpret_cast<const nlmsghdr*>(reply.data());
+         NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+      const size_t index = header->nlmsg_seq - first;
+      if (index >= names.size() || settled[index]) {
+        continue;
+      }
+      if (header->nlmsg_type == NLMSG_ERROR &&
+          header->nlmsg_len >= NLMSG_LENGTH(sizeof(nlmsgerr))) {
+        const int code = -static_cast<const nlmsgerr*>(NLMSG_DATA(header))->error;
+        // No such interface is an answer; anything else (say, a kernel that
+        // cannot look links up by name) is left to sysfs.
+        complete[index] = code == ENODEV;
+      } else if (header->nlmsg_type == RTM_NEWLINK &&
+                 header->nlmsg_len >= NLMSG_LENGTH(sizeof(ifinfomsg))) {
+        found[index] = true;
+        complete[index] = ParseStats64(header, stats[index]);
+      } else {
+        continue;
+      }
+      settled[index] = true;
+      --pending;
+    }
+  }
+  return true;
+}
+
+bool LinkStatsReader::Read(const std::vector<std::string>& names,
+                           std::vector<LinkStats>& stats,
+                           std::vector<bool>& found,
+                           int& error_code,
+                           std::string& error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats.assign(names.size(), LinkStats());
+  found.assign(names.size(), false);
+  std::vector<bool> complete(names.size(), false);
+  if (names.empty()) {
+    return true;
+  }
+
+  int netlink_code = 0;
+  std::string netlink_error;
+  if (!ReadNetlink(names, stats, found, complete, netlink_code, netlink_error)) {
+    tuntap::FwdDebug("link-stats-sysfs", "%s", netlink_error.c_str());
+    stats.assign(names.size(), LinkStats());
+    found.assign(names.size(), false);
+    complete.assign(names.size(), false);
+  }
+
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (complete[i]) {
+      continue;
+    }
+    bool exists = false;
+    if (!ReadSysfs(names[i], stats[i], exists, error_code, error)) {
+      if (!netlink_error.empty()) {
+        error += " (netlink: " + netlink_error + ")";
+      }
+      return false;
+    }
+    found[i] = exists;
+  }
+  return true;
+}
+
+bool LinkRateMeter::Sample(const std::vector<std::string>& names,
+                           std::vector<Reading>& samples,
+                           int& error_code,
+                           std::string& error) {
+  std::vector<LinkStats> stats;
+  std::vector<bool> found;
+  if (!LinkStatsReader::Shared().Read(names, stats, found, error_code, error)) {
+    return false;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  samples.assign(names.size(), Reading());
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (!found[i]) {
+      previous_.erase(names[i]);
+      continue;
+    }
+    Reading& sample = samples[i];
+    sample.found = true;
+    sample.stats = stats[i];
+
+    auto entry = previous_.find(names[i]);
+    if (entry != previous_.end() && now > entry->second.at) {
+      const LinkStats& before = entry->second.stats;
+      const double seconds = std::chrono::duration<double>(now - entry->second.at).count();
+      sample.has_rates = true;
+      sample.interval_ms = seconds * 1000;
+      sample.rates.rx_packets = Rate(stats[i].rx_packets, before.rx_packets, seconds);
+      sample.rates.tx_packets = Rate(stats[i].tx_packets, before.tx_packets, seconds);
+      sample.rates.rx_bits = Rate(stats[i].rx_bytes, before.rx_bytes, seconds) * 8;
+      sample.rates.tx_bits = Rate(stats[i].tx_bytes, before.tx_bytes, seconds) * 8;
+      sample.rates.rx_errors = Rate(stats[i].rx_errors, before.rx_errors, seconds);
+      sample.rates.tx_errors = Rate(stats[i].tx_errors, before.tx_errors, seconds);
+      sample.rates.rx_dropped = Rate(stats[i].rx_dropped, before.rx_dropped, seconds);
+      sample.rates.tx_dropped = Rate(stats[i].tx_dropped, before.tx_dropped, seconds);
+    }
+    previous_[names[i]] = Previous{stats[i], now};
+  }
+  return true;
+}
+
+// --- N-API bindings ---
+
+namespace {
+
+bool ParseNames(Napi::Env env, const Napi::Value& value, std::vector<std::string>& names) {
+  if (!value.IsArray()) {
+    Napi::TypeError::New(env, "Expected an array of interface names")
+        .ThrowAsJavaScriptException();
+    return false;
+  }
+  const Napi::Array list = value.As<Napi::Array>();
+  names.resize(list.Length());
+  for (uint32_t i = 0; i < list.Length(); ++i) {
+    const Napi::Value name = list.Get(i);
+    if (!name.IsString()) {
+      Napi::TypeError::New(env, "Interface names must be strings").ThrowAsJavaScriptException();
+      return false;
+    }
+    names[i] = name.As<Napi::String>().Utf8Value();
+  }
+  return true;
+}
+
+Napi::Object StatsObject(Napi::Env env, const LinkStats& stats) {
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("rxBytes", Napi::Number::New(env, static_cast<double>(stats.rx_bytes)));
+  result.Set("txBytes", Napi::Number::New(env, static_cast<double>(stats.tx_bytes)));
+  result.Set("rxPackets", Napi::Number::New(env, static_cast<double>(stats.rx_packets)));
+  result.Set("txPackets", Napi::Number::New(env, static_cast<double>(stats.tx_packets)));
+  result.Set("rxErrors", Napi::Number::New(env, static_cast<double>(stats.rx_errors)));
+  result.Set("txErrors", Napi::Number::New(env, static_cast<double>(stats.tx_errors)));
+  result.Set("rxDropped", Napi::Number::New(env, static_cast<double>(stats.rx_dropped)));
+  result.Set("txDropped", Napi::Number::New(env, static_cast<double>(stats.tx_dropped)));
+  return result;
+}
+
+// read(names): counters per interface, null where there is no such interface.
+Napi::Value Read(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::vector<std::string> names;
+  if (!ParseNames(env, info[0], names)) {
+    return env.Undefined();
+  }
+  std::vector<LinkStats> stats;
+  std::vector<bool> found;
+  int error_code = 0;
+  std::string error;
+  if (!LinkStatsReader::Shared().Read(names, stats, found, error_code, error)) {
+    ThrowNetlinkError(env, "RTM_GETLINK", error_code, error);
+    return env.Undefined();
+  }
+  Napi::Array result = Napi::Array::New(env, names.size());
+  for (uint32_t i = 0; i < names.size(); ++i) {
+    result.Set(i, found[i] ? Napi::Value(StatsObject(env, stats[i])) : env.Null());
+  }
+  return result;
+}
+
+class LinkRateMeterWrap : public Napi::ObjectWrap<LinkRateMeterWrap> {
+public:
+  static Napi::Function Define(Napi::Env env) {
+    return DefineClass(env, "LinkRateMeter",
+                       {InstanceMethod("sample", &LinkRateMeterWrap::SampleRates)});
+  }
+
+  LinkRateMeterWrap(const Napi::CallbackInfo& info) : Napi::ObjectWrap<LinkRateMeterWrap>(info) {}
+
+private:
+  // sample(names): {stats, rates, intervalMs} per interface, null where there
+  // is no such interface; `rates` is null on an interface's first sample.
+  Napi::Value SampleRates(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<std::string> names;
+    if (!ParseNames(env, info[0], names)) {
+      return env.Undefined();
+    }
+    std::vector<LinkRateMeter::Reading> samples;
+    int error_code = 0;
+    std::string error;
+    if (!meter_.Sample(names, samples, error_code, error)) {
+      ThrowNetlinkError(env, "RTM_GETLINK", error_code, error);
+      return env.Undefined();
+    }
+    Napi::Array result = Napi::Array::New(env, names.size());
+    for (uint32_t i = 0; i < names.size(); ++i) {
+      const LinkRateMeter::Reading& sample = samples[i];
+      if (!sample.found) {
+        result.Set(i, env.Null());
+        continue;
+      }
+      Napi::Object entry = Napi::Object::New(env);
+      entry.Set("stats", StatsObject(env, sample.stats));
+      entry.Set("intervalMs", Napi::Number::New(env, sample.interval_ms));
+      if (sample.has_rates) {
+        Napi::Object rates = Napi::Object::New(env);
+        rates.Set("rxPps", Napi::Number::New(env, sample.rates.rx_packets));
+        rates.Set("txPps", Napi::Number::New(env, sample.rates.tx_packets));
+        rates.Set("rxBps", Napi::Number::New(env, sample.rates.rx_bits));
+        rates.Set("txBps", Napi::Number::New(env, sample.rates.tx_bits));
+        rates.Set("rxErrorsPerSec", Napi::Number::New(env, sample.rates.rx_errors));
+        rates.Set("txErrorsPerSec", Napi::Number::New(env, sample.rates.tx_errors));
+        rates.Set("rxDropsPerSec", Napi::Number::New(env, sample.rates.rx_dropped));
+        rates.Set("txDropsPerSec", Napi::Number::New(env, sample.rates.tx_dropped));
+        entry.Set("rates", rates);
+      } else {
+        entry.Set("rates", env.Null());
+      }
+      result.Set(i, entry);
+    }
+    return result;
+  }
+
+  LinkRateMeter meter_;
+};
+
+}  // namespace
+
+Napi::Object InitLinkStats(Napi::Env env, Napi::Object exports) {
+  Napi::Object link_stats = Napi::Object::New(env);
+  link_stats.Set("read", Napi::Function::New(env, Read, "read"));
+  link_stats.Set("RateMeter", LinkRateMeterWrap::Define(env));
+  exports.Set("linkStats", link_stats);
+  return exports;
+}
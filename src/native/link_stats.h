@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <napi.h>
+
+#include "file_descriptor.h"
+
+/** Interface traffic counters, as in `struct rtnl_link_stats64`. */
+struct LinkStats {
+  uint64_t rx_packets = 0;
+  uint64_t tx_packets = 0;
+  uint64_t rx_bytes = 0;
+  uint64_t tx_bytes = 0;
+  uint64_t rx_errors = 0;
+  uint64_t tx_errors = 0;
+  uint64_t rx_dropped = 0;
+  uint64_t tx_dropped = 0;
+};
+
+/**
+ * Reads interface counters without spawning `ip` (Linux only).
+ *
+ * One `RTM_GETLINK` request per interface, keyed by name, goes to the kernel
+ * in a single send and the `IFLA_STATS64` attribute of each reply is kept.
+ * The netlink socket stays open between calls. When netlink is unavailable
+ * or a reply carries no 64-bit stats, counters come from
+ * `/sys/class/net/<name>/statistics` instead.
+ */
+class LinkStatsReader {
+public:
+  /** The process-wide reader. */
+  static LinkStatsReader& Shared();
+
+  /**
+   * Fills `stats[i]` for `names[i]`; `found[i]` is false when there is no
+   * such interface. False (with `error_code`/`error`) only when neither
+   * source could be read.
+   */
+  bool Read(const std::vector<std::string>& names,
+            std::vector<LinkStats>& stats,
+            std::vector<bool>& found,
+            int& error_code,
+            std::string& error);
+
+private:
+  // Netlink path. `complete[i]` is false for interfaces the replies did not
+  // settle (no IFLA_STATS64), which the caller reads from sysfs.
+  bool ReadNetlink(const std::vector<std::string>& names,
+                   std::vector<LinkStats>& stats,
+                   std::vector<bool>& found,
+                   std::vector<bool>& complete,
+                   int& error_code,
+                   std::string& error);
+
+  std::mutex mutex_;
+  FileDescriptor socket_;
+  uint32_t next_sequence_ = 1;
+};
+
+/** Per-second rates between two samples of one interface. */
+struct LinkRates {
+  double rx_packets = 0;
+  double tx_packets = 0;
+  double rx_bits = 0;
+  double tx_bits = 0;
+  double rx_errors = 0;
+  double tx_errors = 0;
+  double rx_dropped = 0;
+  double tx_dropped = 0;
+};
+
+/**
+ * Turns successive counter reads into rates. Each meter remembers the last
+ * sample of every interface it was asked about, so independent callers keep
+ * their own intervals.
+ */
+class LinkRateMeter {
+public:
+  struct Reading {
+    bool found = false;
+    LinkStats stats;
+    // False on an interface's first sample.
+    bool has_rates = false;
+    LinkRates rates;
+    double interval_ms = 0;
+  };
+
+  bool Sample(const std::vector<std::string>& names,
+              std::vector<Reading>& samples,
+              int& error_code,
+              std::string& error);
+
+private:
+  struct Previous {
+    LinkStats stats;
+    std::chrono::steady_clock::time_point at;
+  };
+
+  std::unordered_map<std::string, Previous> previous_;
+};
+
+Napi::Object InitLinkStats(Napi::Env env, Napi::Object exports);
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** Outcome of a batch TUN operation (see TunPlatformBackend::ReadPackets). */
+enum class TunIoStatus : int {
+  kOk = 0,
+  // Nothing could be read or written right now; wait for readiness.
+  kWouldBlock = 1,
+  kClosed = 2,
+  // `PacketBatch::error_code()` holds an errno value (a Win32 error on Windows).
+  kError = 3,
+};
+
+/** Human-readable text for `PacketBatch::error_code()`; only built on failure. */
+inline std::string TunIoErrorString(int error_code) {
+#ifdef _WIN32
+  return "Win32 error " + std::to_string(error_code);
+#else
+  return std::strerror(error_code);
+#endif
+}
+
+/** One entry of a {@link PacketBatch}. */
+struct PacketMeta {
+  // Position of the packet relative to the batch's base.
+  uint32_t offset = 0;
+  uint32_t length = 0;
+  // Steady-clock receive time (ns) for packets read from a device; 0 otherwise.
+  uint64_t timestamp_ns = 0;
+  // ipv6_frame::FlowHash of the packet for packets read from a device.
+  uint32_t flow_hash = 0;
+};
+
+/**
+ * A run of packets in one contiguous region, described by an offset/length
+ * table. Backends fill it on read (`ReadPackets`) and drain it on write
+ * (`WritePackets`), so per-packet bookkeeping is an array slot instead of a
+ * vector and a string.
+ *
+ * The region is either the batch's own storage (sized at construction, used
+ * for reads) or caller memory attached with `Wrap()` (used to write packets
+ * that already sit back to back, e.g. frames decoded from the TLS stream).
+ * Writers consume entries from `cursor()` so a partially written batch can be
+ * resumed after the device pushes back.
+ */
+class PacketBatch {
+public:
+  PacketBatch(size_t max_packets, size_t storage_bytes)
+      : entries_(max_packets),
+        storage_(storage_bytes > 0 ? new uint8_t[storage_bytes] : nullptr),
+        storage_bytes_(storage_bytes) {}
+
+  PacketBatch(const PacketBatch&) = delete;
+  PacketBatch& operator=(const PacketBatch&) = delete;
+
+  /** Drops all entries and detaches wrapped memory. */
+  void Clear() {
+    count_ = 0;
+    cursor_ = 0;
+    used_ = 0;
+    error_code_ = 0;
+    wrapped_ = nullptr;
+    wrapped_bytes_ = 0;
+  }
+
+  /** Clears the batch and describes packets inside `base` (read-only) from now on. */
+  void Wrap(const uint8_t* base, size_t size) {
+    Clear();
+    wrapped_ = base;
+    wrapped_bytes_ = size;
+  }
+
+  /** Adds the wrapped range `[offset, offset + length)`; false when full or out of range. */
+  bool AddRange(size_t offset, size_t length) {
+    if (wrapped_ == nullptr || full() || offset + length > wrapped_bytes_) {
+      return false;
+    }
+    PacketMeta& meta = entries_[count_++];
+    meta.offset = static_cast<uint32_t>(offset);
+    meta.length = static_cast<uint32_t>(length);
+    meta.timestamp_ns = 0;
+    meta.flow_hash = 0;
+    return true;
+  }
+
+  /**
+   * Room for one more packet of up to `max_length` bytes in owned storage, or
+   * nullptr when the batch is full (or wrapping caller memory).
+   */
+  uint8_t* Reserve(size_t max_length) {
+    if (!HasRoom(max_length)) {
+      return nullptr;
+    }
+    return storage_.get() + used_;
+  }
+
+  /** Whether `Reserve(max_length)` would succeed. */
+  bool HasRoom(size_t max_length) const {
+    return wrapped_ == nullptr && !full() && used_ + max_length <= storage_bytes_;
+  }
+
+  /** Records the packet written at the last `Reserve()` pointer. */
+  void Commit(size_t length, uint64_t timestamp_ns, uint32_t flow_hash) {
+    PacketMeta& meta = entries_[count_++];
+    meta.offset = static_cast<uint32_t>(used_);
+    meta.length = static_cast<uint32_t>(length);
+    meta.timestamp_ns = timestamp_ns;
+    meta.flow_hash = flow_hash;
+    // Keep every packet 8-byte aligned for header parsing.
+    used_ += (length + 7) & ~static_cast<size_t>(7);
+  }
+
+  /** Copies a packet into owned storage; false when it does not fit. */
+  bool Append(const uint8_t* data, size_t length) {
+    uint8_t* slot = Reserve(length);
+    if (slot == nullptr) {
+      return false;
+    }
+    std::memcpy(slot, data, length);
+    Commit(length, 0, 0);
+    return true;
+  }
+
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+  bool full() const { return count_ == entries_.size(); }
+  size_t max_packets() const { return entries_.size(); }
+  /** Payload bytes stored (owned storage only, including alignment padding). */
+  size_t bytes_used() const { return used_; }
+
+  const uint8_t* data(size_t index) const { return base() + entries_[index].offset; }
+  uint8_t* mutable_data(size_t index) { return storage_.get() + entries_[index].offset; }
+  size_t length(size_t index) const { return entries_[index].length; }
+  const PacketMeta& meta(size_t index) const { return entries_[index]; }
+
+  /** Next entry a writer has not consumed yet. */
+  size_t cursor() const { return cursor_; }
+  void Advance() { ++cursor_; }
+  bool drained() const { return cursor_ >= count_; }
+
+  int error_code() const { return error_code_; }
+  void set_error_code(int error_code) { error_code_ = error_code; }
+
+  /** Steady-clock now in ns; backends stamp a whole read burst with one value. */
+  static uint64_t NowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+  }
+
+private:
+  const uint8_t* base() const { return wrapped_ != nullptr ? wrapped_ : storage_.get(); }
+
+  std::vector<PacketMeta> entries_;
+  std::unique_ptr<uint8_t[]> storage_;
+  size_t storage_bytes_ = 0;
+  const uint8_t* wrapped_ = nullptr;
+  size_t wrapped_bytes_ = 0;
+  size_t count_ = 0;
+  size_t cursor_ = 0;
+  size_t used_ = 0;
+  int error_code_ = 0;
+};
@@ -0,0 +1,168 @@
+#include "packet_pool.h"
+
+#include <cstring>
+#include <new>
+
+namespace {
+
+// Buffers a thread keeps per size class before spilling to the shared list.
+constexpr size_t kThreadCacheLimit = 64;
+// Buffers moved between a thread cache and the shared list at a time.
+constexpr size_t kTransferBatch = 32;
+
+}  // namespace
+
+struct PacketPoolThreadCache {
+  PacketBuffer* head[PacketPool::kSizeClasses] = {};
+  size_t count[PacketPool::kSizeClasses] = {};
+
+  ~PacketPoolThreadCache() {
+    // Hand everything back so buffers cached by exiting threads (forwarder
+    // workers, Wintun receive threads) stay reusable.
+    for (uint8_t size_class = 0; size_class < PacketPool::kSizeClasses; ++size_class) {
+      PacketBuffer* first = head[size_class];
+      if (first == nullptr) {
+        continue;
+      }
+      PacketBuffer* last = first;
+      while (last->next != nullptr) {
+        last = last->next;
+      }
+      PacketPool::Instance().GiveBatch(size_class, first, last, count[size_class]);
+      head[size_class] = nullptr;
+      count[size_class] = 0;
+    }
+  }
+};
+
+namespace {
+
+thread_local PacketPoolThreadCache thread_cache;
+
+}  // namespace
+
+PacketPool& PacketPool::Instance() {
+  // Intentionally leaked: thread caches may hand buffers back from static
+  // destructors of other threads during shutdown.
+  static PacketPool* pool = new PacketPool();
+  return *pool;
+}
+
+PacketBuffer* PacketPool::Acquire(size_t size) {
+  acquired_.fetch_add(1, std::memory_order_relaxed);
+
+  uint8_t size_class = kUnpooled;
+  for (uint8_t i = 0; i < kSizeClasses; ++i) {
+    if (size <= kClassCapacity[i]) {
+      size_class = i;
+      break;
+    }
+  }
+  if (size_class == kUnpooled) {
+    oversize_allocations_.fetch_add(1, std::memory_order_relaxed);
+    PacketBuffer* buffer = Allocate(size, kUnpooled);
+    buffer->size = size;
+    return buffer;
+  }
+
+  PacketPoolThreadCache& cache = thread_cache;
+  if (cache.count[size_class] == 0) {
+    cache.count[size_class] = TakeBatch(size_class, &cache.head[size_class], kTransferBatch);
+  }
+  PacketBuffer* buffer = cache.head[size_class];
+  if (buffer != nullptr) {
+    cache.head[size_class] = buffer->next;
+    --cache.count[size_class];
+  } else {
+    heap_allocations_.fetch_add(1, std::memory_order_relaxed);
+    buffer = Allocate(kClassCapacity[size_class], size_class);
+  }
+  buffer->next = nullptr;
+  buffer->size = size;
+  return buffer;
+}
+
+void PacketPool::Release(PacketBuffer* buffer) {
+  if (buffer == nullptr) {
+    return;
+  }
+  released_.fetch_add(1, std::memory_order_relaxed);
+
+  const uint8_t size_class = buffer->size_class;
+  if (size_class == kUnpooled) {
+    buffer->~PacketBuffer();
+    ::operator delete(buffer);
+    return;
+  }
+
+  PacketPoolThreadCache& cache = thread_cache;
+  buffer->next = cache.head[size_class];
+  cache.head[size_class] = buffer;
+  if (++cache.count[size_class] <= kThreadCacheLimit) {
+    return;
+  }
+
+  // Over the limit: spill the most recently released batch.
+  PacketBuffer* first = cache.head[size_class];
+  PacketBuffer* last = first;
+  for (size_t i = 1; i < kTransferBatch; ++i) {
+    last = last->next;
+  }
+  cache.head[size_class] = last->next;
+  cache.count[size_class] -= kTransferBatch;
+  last->next = nullptr;
+  GiveBatch(size_class, first, last, kTransferBatch);
+}
+
+PacketPoolStats PacketPool::GetStats() const {
+  PacketPoolStats stats;
+  stats.heap_allocations = heap_allocations_.load(std::memory_order_relaxed);
+  stats.oversize_allocations = oversize_allocations_.load(std::memory_order_relaxed);
+  stats.acquired = acquired_.load(std::memory_order_relaxed);
+  stats.released = released_.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < kSizeClasses; ++i) {
+    stats.pooled += free_count_[i];
+  }
+  return stats;
+}
+
+size_t PacketPool::TakeBatch(uint8_t size_class, PacketBuffer** head, size_t max) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t moved = 0;
+  while (moved < max && free_[size_class] != nullptr) {
+    PacketBuffer* buffer = free_[size_class];
+    free_[size_class] = buffer->next;
+    buffer->next = *head;
+    *head = buffer;
+    ++moved;
+  }
+  free_count_[size_class] -= moved;
+  return moved;
+}
+
+void PacketPool::GiveBatch(uint8_t size_class,
+                           PacketBuffer* head,
+                           PacketBuffer* tail,
+                           size_t count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  tail->next = free_[size_class];
+  free_[size_class] = head;
+  free_count_[size_class] += count;
+}
+
+PacketBuffer* PacketPool::Allocate(size_t capacity, uint8_t size_class) {
+  void* memory = ::operator new(sizeof(PacketBuffer) + capacity);
+  auto* buffer = new (memory) PacketBuffer();
+  buffer->capacity = capacity;
+  buffer->size_class = size_class;
+  return buffer;
+}
+
+PooledPacket PooledPacket::CopyOf(const uint8_t* data, size_t len) {
+  PooledPacket packet(PacketPool::Instance().Acquire(len));
+  if (len > 0) {
+    std::memcpy(packet.data(), data, len);
+  }
+  return packet;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+/**
+ * One pooled packet: this header followed by `capacity` data bytes in the
+ * same allocation. Obtained from {@link PacketPool::Acquire} and returned with
+ * {@link PacketPool::Release} (usually through {@link PooledPacket}).
+ */
+struct PacketBuffer {
+  uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+  const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(this + 1); }
+
+  size_t capacity = 0;
+  size_t size = 0;
+  // Index into the pool's size classes, or `kUnpooled` for oversize buffers.
+  uint8_t size_class = 0;
+  // Free-list link while the buffer sits in the pool.
+  PacketBuffer* next = nullptr;
+};
+
+/** Counters reported by {@link PacketPool::GetStats}. */
+struct PacketPoolStats {
+  // Buffers ever allocated from the heap; flat in steady state.
+  uint64_t heap_allocations = 0;
+  // Requests larger than the biggest size class (heap-allocated and freed).
+  uint64_t oversize_allocations = 0;
+  uint64_t acquired = 0;
+  uint64_t released = 0;
+  // Buffers parked in the shared free lists (thread caches not included).
+  size_t pooled = 0;
+};
+
+/**
+ * Process-wide, size-classed free lists for packet buffers.
+ *
+ * Each thread keeps a small cache per size class, so a thread that acquires
+ * and releases (the libuv loop reading the TUN device and finalizing the JS
+ * buffers it handed out) never touches the shared lists. Caches spill to and
+ * refill from the shared lists in batches when one side runs over or dry.
+ * Buffers are never returned to the heap while the process runs.
+ */
+class PacketPool {
+public:
+  static constexpr uint8_t kUnpooled = 0xff;
+
+  static PacketPool& Instance();
+
+  PacketPool(const PacketPool&) = delete;
+  PacketPool& operator=(const PacketPool&) = delete;
+
+  /** A buffer of at least `size` bytes with `size` already set. Never null. */
+  PacketBuffer* Acquire(size_t size);
+  void Release(PacketBuffer* buffer);
+
+  PacketPoolStats GetStats() const;
+
+private:
+  friend struct PacketPoolThreadCache;
+
+  static constexpr size_t kSizeClasses = 3;
+  static constexpr size_t kClassCapacity[kSizeClasses] = {2048, 16 * 1024, 64 * 1024};
+
+  PacketPool() = default;
+
+  // Moves up to `max` buffers of `size_class` from the shared list onto
+  // `*head`; returns how many moved.
+  size_t TakeBatch(uint8_t size_class, PacketBuffer** head, size_t max);
+  // Pushes a linked chain (`head` .. `tail`, `count` buffers) onto the shared list.
+  void GiveBatch(uint8_t size_class, PacketBuffer* head, PacketBuffer* tail, size_t count);
+
+  static PacketBuffer* Allocate(size_t capacity, uint8_t size_class);
+
+  mutable std::mutex mutex_;
+  PacketBuffer* free_[kSizeClasses] = {};
+  size_t free_count_[kSizeClasses] = {};
+
+  std::atomic<uint64_t> heap_allocations_{0};
+  std::atomic<uint64_t> oversize_allocations_{0};
+  std::atomic<uint64_t> acquired_{0};
+  std::atomic<uint64_t> released_{0};
+};
+
+/** Move-only owner of a {@link PacketBuffer}; releases it to the pool on destruction. */
+class PooledPacket {
+public:
+  PooledPacket() = default;
+  explicit PooledPacket(PacketBuffer* buffer) : buffer_(buffer) {}
+  ~PooledPacket() { reset(); }
+
+  PooledPacket(PooledPacket&& other) noexcept : buffer_(other.release()) {}
+  PooledPacket& operator=(PooledPacket&& other) noexcept {
+    if (this != &other) {
+      reset(other.release());
+    }
+    return *this;
+  }
+
+  PooledPacket(const PooledPacket&) = delete;
+  PooledPacket& operator=(const PooledPacket&) = delete;
+
+  /** Acquires a pooled copy of `len` bytes at `data`. */
+  static PooledPacket CopyOf(const uint8_t* data, size_t len);
+
+  explicit operator bool() const { return buffer_ != nullptr; }
+  PacketBuffer* get() const { return buffer_; }
+  uint8_t* data() { return buffer_->data(); }
+  const uint8_t* data() const { return buffer_->data(); }
+  size_t size() const { return buffer_->size; }
+
+  /** Gives up ownership; the caller must hand the buffer to `PacketPool::Release`. */
+  PacketBuffer* release() { return std::exchange(buffer_, nullptr); }
+
+  void reset(PacketBuffer* buffer = nullptr) {
+    PacketBuffer* old = std::exchange(buffer_, buffer);
+    if (old != nullptr) {
+      PacketPool::Instance().Release(old);
+    }
+  }
+
+private:
+  PacketBuffer* buffer_ = nullptr;
+};
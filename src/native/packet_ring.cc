@@ -0,0 +1,179 @@
+#include "packet_ring.h"
+
+#include <chrono>
+#include <cstring>
+
+#include "thread_tuning.h"
+
+namespace {
+
+// Packets read before the write index is published (and the consumer woken);
+// a burst also ends as soon as the device runs dry.
+constexpr uint32_t kMaxReadsPerPublish = 32;
+// How long the producer sleeps while the consumer has not freed a slot.
+constexpr auto kFullBackoff = std::chrono::microseconds(200);
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "ring header words are plain 32-bit integers shared with JS");
+
+}  // namespace
+
+bool PacketRingProducer::Start(TunPlatformBackend* backend,
+                               uint8_t* memory,
+                               size_t slot_count,
+                               size_t slot_size,
+                               WakeCallback wake,
+                               TunPlatformBackend::ErrorCallback on_error,
+                               std::string& error) {
+  if (thread_.joinable()) {
+    error = "Packet ring already started";
+    return false;
+  }
+  if (backend == nullptr || !backend->IsOpen()) {
+    error = "Device not open";
+    return false;
+  }
+  if (slot_count == 0 || (slot_count & (slot_count - 1)) != 0 ||
+      slot_count > UINT32_MAX / 2) {
+    error = "Packet ring slot count must be a power of two";
+    return false;
+  }
+  if (slot_size <= packet_ring::kSlotHeaderBytes || slot_size % 8 != 0) {
+    error = "Packet ring slot size must be a multiple of 8 larger than the slot header";
+    return false;
+  }
+  if (!wakeup_.Open(error)) {
+    return false;
+  }
+  wakeup_.Reset();
+
+  backend_ = backend;
+  memory_ = memory;
+  slot_count_ = static_cast<uint32_t>(slot_count);
+  mask_ = slot_count_ - 1;
+  slot_size_ = slot_size;
+  wake_ = std::move(wake);
+  on_error_ = std::move(on_error);
+
+  Word(packet_ring::kWriteIndex).store(0, std::memory_order_relaxed);
+  Word(packet_ring::kReadIndex).store(0, std::memory_order_relaxed);
+  Word(packet_ring::kSlotCount).store(slot_count_, std::memory_order_relaxed);
+  Word(packet_ring::kSlotSize).store(static_cast<uint32_t>(slot_size_), std::memory_order_relaxed);
+  Word(packet_ring::kConsumerWaiting).store(0, std::memory_order_relaxed);
+  Word(packet_ring::kState).store(packet_ring::kRunning, std::memory_order_relaxed);
+  Word(packet_ring::kMagicWord).store(packet_ring::kMagic, std::memory_order_seq_cst);
+
+  running_ = true;
+  thread_ = std::thread([this]() {
+    SetCurrentThreadName("tuntap-ring");
+    Run();
+  });
+  return true;
+}
+
+void PacketRingProducer::Stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  running_ = false;
+  wakeup_.Signal();
+  thread_.join();
+  Finish(packet_ring::kStopped);
+  wake_ = nullptr;
+  on_error_ = nullptr;
+  backend_ = nullptr;
+  memory_ = nullptr;
+}
+
+void PacketRingProducer::Run() {
+  const size_t capacity = slot_size_ - packet_ring::kSlotHeaderBytes;
+  uint32_t write = 0;
+  std::string error;
+
+  while (running_.load(std::memory_order_relaxed)) {
+    uint32_t burst = 0;
+    TunIoStatus status = TunIoStatus::kOk;
+    int error_code = 0;
+    while (burst < kMaxReadsPerPublish) {
+      const uint32_t read = Word(packet_ring::kReadIndex).load(std::memory_order_acquire);
+      if (write - read >= slot_count_) {
+        break;
+      }
+      uint8_t* slot = Slot(write);
+      size_t length = 0;
+      status = backend_->ReadPacketInto(slot + packet_ring::kSlotHeaderBytes, capacity, length,
+                                        error_code);
+      if (status != TunIoStatus::kOk) {
+        break;
+      }
+      const uint32_t slot_length = static_cast<uint32_t>(length);
+      std::memcpy(slot, &slot_length, sizeof(slot_length));
+      ++write;
+      ++burst;
+    }
+    if (burst > 0) {
+      Publish(write);
+    }
+
+    switch (status) {
+      case TunIoStatus::kOk:
+        if (burst < kMaxReadsPerPublish) {
+          // The ring is full: the consumer has not caught up yet.
+          std::this_thread::sleep_for(kFullBackoff);
+        }
+        break;
+      case TunIoStatus::kWouldBlock:
+        if (!backend_->WaitReadable(running_, &wakeup_, error)) {
+          if (running_.load()) {
+            Fail(error);
+          }
+          return;
+        }
+        break;
+      case TunIoStatus::kClosed:
+        Fail("Device closed");
+        return;
+      default:
+        Fail("Read error: " + TunIoErrorString(error_code));
+        return;
+    }
+  }
+}
+
+void PacketRingProducer::Publish(uint32_t write) {
+  // Sequentially consistent on both sides: either the consumer sees the new
+  // index before parking, or we see its waiting flag here.
+  Word(packet_ring::kWriteIndex).store(write, std::memory_order_seq_cst);
+  if (Word(packet_ring::kConsumerWaiting).exchange(0, std::memory_order_seq_cst) != 0 && wake_) {
+    wake_();
+  }
+}
+
+bool PacketRingProducer::SetFinalState(packet_ring::RingState state) {
+  uint32_t expected = packet_ring::kRunning;
+  const bool changed = Word(packet_ring::kState)
+                           .compare_exchange_strong(expected, state, std::memory_order_seq_cst);
+  Word(packet_ring::kConsumerWaiting).store(0, std::memory_order_seq_cst);
+  return changed;
+}
+
+void PacketRingProducer::Finish(packet_ring::RingState state) {
+  SetFinalState(state);
+  // Wake a parked consumer so it notices the ring is done.
+  if (wake_) {
+    wake_();
+  }
+}
+
+void PacketRingProducer::Fail(const std::string& message) {
+  // The error is the final wakeup: its delivery also wakes the consumer,
+  // so it is not queued behind (or dropped after) a separate one.
+  if (!SetFinalState(packet_ring::kFailed)) {
+    return;
+  }
+  if (on_error_) {
+    on_error_(message);
+  } else if (wake_) {
+    wake_();
+  }
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "tun_backend.h"
+#include "wakeup_event.h"
+
+/**
+ * Layout of the shared packet ring (mirrored by src/PacketRing.ts).
+ *
+ * The memory is a JS `SharedArrayBuffer`: a header of 32-bit words that both
+ * sides access atomically (`Atomics` in JS), followed by `slot_count` slots
+ * of `slot_size` bytes. A slot holds a `uint32_t` packet length, four
+ * reserved bytes and the packet, so packets start 8-byte aligned.
+ *
+ * `kWriteIndex` and `kReadIndex` count packets published and consumed; they
+ * wrap at 2^32 and a packet lives in slot `index % slot_count`.
+ */
+namespace packet_ring {
+
+constexpr size_t kHeaderBytes = 64;
+constexpr size_t kSlotHeaderBytes = 8;
+constexpr uint32_t kMagic = 0x54524e47;  // "TRNG"
+
+// Header word indices.
+constexpr size_t kWriteIndex = 0;        // native: packets published
+constexpr size_t kReadIndex = 1;         // JS: packets consumed
+constexpr size_t kSlotCount = 2;
+constexpr size_t kSlotSize = 3;
+constexpr size_t kConsumerWaiting = 4;   // JS sets it before parking; native clears it when waking
+constexpr size_t kState = 5;             // a RingState
+constexpr size_t kMagicWord = 6;
+
+enum RingState : uint32_t {
+  kRunning = 0,
+  kStopped = 1,
+  kFailed = 2,
+};
+
+}  // namespace packet_ring
+
+/**
+ * Producer side of the shared packet ring: a thread that reads packets from
+ * the device straight into free slots and publishes them with one index
+ * store per burst, so delivery to JS costs no allocation, no copy beyond the
+ * read itself and no call into JS.
+ *
+ * The consumer polls `kWriteIndex` and parks with `Atomics.waitAsync` after
+ * setting `kConsumerWaiting`; only then does a publish call `wake`, whose
+ * owner wakes it from the JS thread (native code cannot `Atomics.notify`).
+ * A busy consumer therefore never sees a callback. While the ring is full
+ * the producer stops reading and leaves packets queued in the kernel.
+ */
+class PacketRingProducer {
+public:
+  using WakeCallback = std::function<void()>;
+
+  PacketRingProducer() = default;
+  ~PacketRingProducer() { Stop(); }
+
+  PacketRingProducer(const PacketRingProducer&) = delete;
+  PacketRingProducer& operator=(const PacketRingProducer&) = delete;
+
+  /** Bytes of shared memory needed for `slot_count` slots of `slot_size`. */
+  static size_t RequiredBytes(size_t slot_count, size_t slot_size) {
+    return packet_ring::kHeaderBytes + slot_count * slot_size;
+  }
+
+  /**
+   * Initializes the header in `memory` (at least `RequiredBytes`) and starts
+   * the producer thread. `slot_count` must be a power of two and `slot_size`
+   * a multiple of 8. `memory` and `backend` must outlive `Stop()`.
+   */
+  bool Start(TunPlatformBackend* backend,
+             uint8_t* memory,
+             size_t slot_count,
+             size_t slot_size,
+             WakeCallback wake,
+             TunPlatformBackend::ErrorCallback on_error,
+             std::string& error);
+
+  /** Joins the thread and marks the ring stopped; safe to call repeatedly. */
+  void Stop();
+
+  bool running() const { return thread_.joinable(); }
+
+private:
+  void Run();
+  // Stores `write` to kWriteIndex and wakes a parked consumer.
+  void Publish(uint32_t write);
+  // Moves kState from kRunning to `state`; false if it had already left it.
+  bool SetFinalState(packet_ring::RingState state);
+  // Ends the ring and wakes the consumer.
+  void Finish(packet_ring::RingState state);
+  // Ends the ring as failed and reports `message` through the error
+  // callback, which also wakes the consumer.
+  void Fail(const std::string& message);
+
+  std::atomic<uint32_t>& Word(size_t index) {
+    return reinterpret_cast<std::atomic<uint32_t>*>(memory_)[index];
+  }
+  uint8_t* Slot(uint32_t index) {
+    return memory_ + packet_ring::kHeaderBytes + static_cast<size_t>(index & mask_) * slot_size_;
+  }
+
+  TunPlatformBackend* backend_ = nullptr;
+  uint8_t* memory_ = nullptr;
+  uint32_t slot_count_ = 0;
+  uint32_t mask_ = 0;
+  size_t slot_size_ = 0;
+  WakeCallback wake_;
+  TunPlatformBackend::ErrorCallback on_error_;
+  WakeupEvent wakeup_;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+};
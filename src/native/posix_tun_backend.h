@@ -5,31 +5,102 @@
 #include <cerrno>
 #include <poll.h>
 
+#include <algorithm>
 #include <chrono>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "file_descriptor.h"
+#include "ipv6_frame.h"
 #include "posix_uv_poll_loop.h"
 #include "tun_backend.h"
+#include "wakeup_event.h"
 
 // Shared base class for POSIX TUN backends (Darwin, Linux). Owns the file
-// descriptor, the assigned interface name, and the libuv poll loop. Concrete
-// subclasses implement only the platform-specific OpenDevice, ReadPacket, and
-// WritePacket.
+// descriptor (queue 0), the assigned interface name, and the libuv poll loops.
+// Concrete subclasses implement only the platform-specific OpenDevice and the
+// ReadInto/WriteFrom primitives, plus the queue hooks for multi-queue devices;
+// the single-packet and batch entry points are built on those here.
 class PosixTunBackend : public TunPlatformBackend {
 public:
   void CloseDevice() override {
-    poll_loop_.Stop();
+    StopReceiveLoop();
     fd_.reset();
     interface_name_.clear();
   }
 
   bool IsOpen() const override { return fd_.is_valid(); }
 
+  ReadPacketStatus ReadPacket(size_t max_payload_size,
+                              std::vector<uint8_t>& out,
+                              std::string& error) override {
+    out.resize(max_payload_size);
+    size_t length = 0;
+    int error_code = 0;
+    const TunIoStatus status = ReadInto(out.data(), out.size(), length, error_code);
+    return FinishRead(status, length, error_code, out, error);
+  }
+
+  ReadPacketStatus ReadQueuePacket(size_t queue,
+                                   size_t max_payload_size,
+                                   std::vector<uint8_t>& out,
+                                   std::string& error) override {
+    out.resize(max_payload_size);
+    size_t length = 0;
+    int error_code = 0;
+    const TunIoStatus status = ReadQueueInto(queue, out.data(), out.size(), length, error_code);
+    return FinishRead(status, length, error_code, out, error);
+  }
+
+  ssize_t WritePacket(const uint8_t* data,
+                      size_t length,
+                      std::string& error) override {
+    int error_code = 0;
+    switch (WriteFrom(data, length, error_code)) {
+      case TunIoStatus::kOk:
+        return static_cast<ssize_t>(length);
+      case TunIoStatus::kWouldBlock:
+        return 0;
+      default:
+        error = "Write error: " + TunIoErrorString(error_code);
+        return -1;
+    }
+  }
+
+  TunIoStatus ReadPackets(PacketBatch& batch, size_t max_payload_size) override {
+    return ReadBatch(kAllQueues, batch, max_payload_size);
+  }
+
+  // ReadPackets restricted to one queue (per-queue receive loops).
+  TunIoStatus ReadQueuePackets(size_t queue, PacketBatch& batch, size_t max_payload_size) {
+    return ReadBatch(queue, batch, max_payload_size);
+  }
+
+  TunIoStatus WritePackets(PacketBatch& batch) override {
+    while (!batch.drained()) {
+      const size_t index = batch.cursor();
+      int error_code = 0;
+      const TunIoStatus status = WriteFrom(batch.data(index), batch.length(index), error_code);
+      if (status != TunIoStatus::kOk) {
+        batch.set_error_code(error_code);
+        return status;
+      }
+      batch.Advance();
+    }
+    return TunIoStatus::kOk;
+  }
+
+  TunIoStatus ReadPacketInto(uint8_t* buffer,
+                             size_t capacity,
+                             size_t& length,
+                             int& error_code) override {
+    return ReadInto(buffer, capacity, length, error_code);
+  }
+
   bool StartReceiveLoop(uv_loop_t* loop,
-                        size_t buffer_size,
+                        const ReceiveLoopOptions& options,
                         PacketCallback on_packet,
                         ErrorCallback on_error,
                         std::string& error) override {
@@ -37,58 +108,182 @@ public:
       error = "Device not open";
       return false;
     }
-    return poll_loop_.Start(
-        loop,
-        fd_.get(),
-        buffer_size,
-        [this](size_t size, std::vector<uint8_t>& out, std::string& err) {
-          return ReadPacket(size, out, err);
-        },
-        std::move(on_packet),
-        std::move(on_error),
-        error);
+    if (!poll_loops_.empty()) {
+      error = "Receive loop already started";
+      return false;
+    }
+    // One poll handle per attached queue, all feeding the same callbacks.
+    const size_t queues = ActiveQueueCount();
+    for (size_t queue = 0; queue < queues; ++queue) {
+      auto poll_loop = std::make_unique<PosixUvPollLoop>();
+      const bool started = poll_loop->Start(
+          loop,
+          GetQueueFd(queue),
+          options,
+          [this, queue](size_t size, std::vector<uint8_t>& out, std::string& err) {
+            return ReadQueuePacket(queue, size, out, err);
+          },
+          [this, queue](PacketBatch& batch, size_t size) {
+            return ReadQueuePackets(queue, batch, size);
+          },
+          [this, queue]() { return HasBufferedQueuePackets(queue); },
+          on_packet,
+          on_error,
+          error);
+      if (!started) {
+        StopReceiveLoop();
+        return false;
+      }
+      poll_loops_.push_back(std::move(poll_loop));
+    }
+    return true;
   }
 
-  void StopReceiveLoop() override { poll_loop_.Stop(); }
+  void StopReceiveLoop() override { poll_loops_.clear(); }
 
-  void PauseReceiveLoop() override { poll_loop_.Pause(); }
+  void PauseReceiveLoop() override {
+    for (auto& poll_loop : poll_loops_) {
+      poll_loop->Pause();
+    }
+  }
 
-  void ResumeReceiveLoop() override { poll_loop_.Resume(); }
+  void ResumeReceiveLoop() override {
+    for (auto& poll_loop : poll_loops_) {
+      poll_loop->Resume();
+    }
+  }
 
   int GetNativeFd() const override { return fd_.get(); }
 
-  bool WaitReadable(const std::atomic<bool>& running, std::string& error) override {
-    return WaitForEvents(POLLIN, running, error);
+  bool WaitReadable(const std::atomic<bool>& running,
+                    const WakeupEvent* wakeup,
+                    std::string& error) override {
+    return WaitReadableFor(-1, running, wakeup, error);
   }
 
-  bool WaitWritable(const std::atomic<bool>& running, std::string& error) override {
-    return WaitForEvents(POLLOUT, running, error);
+  bool WaitReadableFor(int timeout_ms,
+                       const std::atomic<bool>& running,
+                       const WakeupEvent* wakeup,
+                       std::string& error) override {
+    int fds[kMaxTunQueues];
+    const size_t queues = ActiveQueueCount();
+    for (size_t queue = 0; queue < queues; ++queue) {
+      fds[queue] = GetQueueFd(queue);
+    }
+    return WaitForEvents(fds, queues, POLLIN, running, wakeup, error, timeout_ms);
+  }
+
+  bool WaitQueueReadable(size_t queue,
+                         const std::atomic<bool>& running,
+                         const WakeupEvent* wakeup,
+                         std::string& error) override {
+    const int fd = GetQueueFd(queue);
+    return WaitForEvents(&fd, 1, POLLIN, running, wakeup, error);
+  }
+
+  bool WaitWritable(const std::atomic<bool>& running,
+                    const WakeupEvent* wakeup,
+                    std::string& error) override {
+    const int fd = fd_.get();
+    return WaitForEvents(&fd, 1, POLLOUT, running, wakeup, error);
   }
 
 protected:
-  FileDescriptor fd_;
-  std::string interface_name_;
-  PosixUvPollLoop poll_loop_;
+  // Reads one packet (from any attached queue) into `buffer`, truncating it
+  // to `capacity`. kOk sets `length`; kError/kClosed set `error_code` to an
+  // errno value.
+  virtual TunIoStatus ReadInto(uint8_t* buffer,
+                               size_t capacity,
+                               size_t& length,
+                               int& error_code) = 0;
+  virtual TunIoStatus ReadQueueInto(size_t queue,
+                                    uint8_t* buffer,
+                                    size_t capacity,
+                                    size_t& length,
+                                    int& error_code) {
+    (void)queue;
+    return ReadInto(buffer, capacity, length, error_code);
+  }
+  // Writes one whole packet; kWouldBlock when the device pushes back.
+  virtual TunIoStatus WriteFrom(const uint8_t* data, size_t length, int& error_code) = 0;
 
-private:
-  bool WaitForEvents(short events, const std::atomic<bool>& running, std::string& error) {
-    if (!fd_.is_valid()) {
+  static ReadPacketStatus FinishRead(TunIoStatus status,
+                                     size_t length,
+                                     int error_code,
+                                     std::vector<uint8_t>& out,
+                                     std::string& error) {
+    switch (status) {
+      case TunIoStatus::kOk:
+        out.resize(length);
+        return ReadPacketStatus::Data;
+      case TunIoStatus::kWouldBlock:
+        out.clear();
+        return ReadPacketStatus::NoData;
+      case TunIoStatus::kClosed:
+        out.clear();
+        return ReadPacketStatus::Closed;
+      default:
+        out.clear();
+        error = "Read error: " + TunIoErrorString(error_code);
+        return ReadPacketStatus::Error;
+    }
+  }
+
+  // Waits until any of `fds` reports `events`; the wakeup fd (if any) is the
+  // last entry of the poll set. A non-negative `timeout_ms` bounds the wait
+  // (false with an empty `error` once it expires).
+  bool WaitForEvents(const int* fds,
+                     size_t count,
+                     short events,
+                     const std::atomic<bool>& running,
+                     const WakeupEvent* wakeup,
+                     std::string& error,
+                     int timeout_ms = -1) {
+    if (!fd_.is_valid() || count == 0 || count > kMaxTunQueues) {
       error = "Device not open";
       return false;
     }
 
-    struct pollfd pfd {};
-    pfd.fd = fd_.get();
-    pfd.events = events;
+    struct pollfd pfds[kMaxTunQueues + 1] {};
+    for (size_t i = 0; i < count; ++i) {
+      pfds[i].fd = fds[i];
+      pfds[i].events = events;
+    }
+    const bool has_wakeup = wakeup != nullptr && wakeup->IsOpen();
+    pfds[count].fd = has_wakeup ? wakeup->fd() : -1;
+    pfds[count].events = POLLIN;
+    const nfds_t nfds = static_cast<nfds_t>(has_wakeup ? count + 1 : count);
+    const int poll_ms = has_wakeup ? -1 : 200;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout_ms, 0));
 
     while (running.load()) {
-      const int rc = poll(&pfd, 1, 200);
+      int wait_ms = poll_ms;
+      if (timeout_ms >= 0) {
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              deadline - std::chrono::steady_clock::now())
+                              .count();
+        const int left_ms = static_cast<int>(std::max<decltype(left)>(left, 0));
+        wait_ms = wait_ms < 0 ? left_ms : std::min(wait_ms, left_ms);
+      }
+      const int rc = poll(pfds, nfds, wait_ms);
       if (rc > 0) {
-        if ((pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0) {
-          error = "TUN device poll failed";
+        for (size_t i = 0; i < count; ++i) {
+          if ((pfds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0) {
+            error = "TUN device poll failed";
+            return false;
+          }
+          if ((pfds[i].revents & events) != 0) {
+            return true;
+          }
+        }
+        if (has_wakeup && pfds[count].revents != 0) {
           return false;
         }
-        return (pfd.revents & events) != 0;
+        continue;
+      }
+      if (rc == 0 && timeout_ms >= 0 && std::chrono::steady_clock::now() >= deadline) {
+        return false;
       }
       if (rc == 0 || errno == EINTR) {
         continue;
@@ -99,6 +294,37 @@ private:
 
     return false;
   }
+
+  FileDescriptor fd_;
+  std::string interface_name_;
+  std::vector<std::unique_ptr<PosixUvPollLoop>> poll_loops_;
+
+private:
+  static constexpr size_t kAllQueues = ~static_cast<size_t>(0);
+
+  TunIoStatus ReadBatch(size_t queue, PacketBatch& batch, size_t max_payload_size) {
+    // One clock read per burst; every packet in it arrived "now" as far as
+    // any consumer can tell.
+    const uint64_t now_ns = PacketBatch::NowNs();
+    TunIoStatus result = TunIoStatus::kWouldBlock;
+    while (uint8_t* slot = batch.Reserve(max_payload_size)) {
+      size_t length = 0;
+      int error_code = 0;
+      const TunIoStatus status =
+          queue == kAllQueues ? ReadInto(slot, max_payload_size, length, error_code)
+                              : ReadQueueInto(queue, slot, max_payload_size, length, error_code);
+      if (status != TunIoStatus::kOk) {
+        if (result == TunIoStatus::kOk) {
+          break;
+        }
+        batch.set_error_code(error_code);
+        return status;
+      }
+      batch.Commit(length, now_ns, ipv6_frame::FlowHash(slot, length));
+      result = TunIoStatus::kOk;
+    }
+    return result;
+  }
 };
 
 #endif
@@ -8,14 +8,25 @@
 #include <string.h>
 #include <utility>
 
+namespace {
+
+// Per-wakeup read budgets, so one busy device cannot starve the rest of the
+// event loop.
+constexpr size_t kMaxReadsPerPoll = 64;
+constexpr size_t kMaxBatchesPerPoll = 4;
+
+}  // namespace
+
 PosixUvPollLoop::~PosixUvPollLoop() {
   Stop();
 }
 
 bool PosixUvPollLoop::Start(uv_loop_t* loop,
                             int fd,
-                            size_t buffer_size,
+                            const ReceiveLoopOptions& options,
                             ReadFn read_fn,
+                            ReadBatchFn read_batch_fn,
+                            PendingFn has_pending,
                             TunPlatformBackend::PacketCallback on_packet,
                             TunPlatformBackend::ErrorCallback on_error,
                             std::string& error) {
@@ -23,14 +34,22 @@ bool PosixUvPollLoop::Start(uv_loop_t* loop,
     error = "Receive loop already started";
     return false;
   }
-  if (!loop || fd < 0 || buffer_size == 0) {
+  if (!loop || fd < 0 || options.buffer_size == 0) {
     error = "Invalid receive-loop parameters";
     return false;
   }
 
   auto state = std::make_unique<State>();
-  state->buffer_size = buffer_size;
+  state->buffer_size = options.buffer_size;
+  if (options.max_batch > 0) {
+    state->coalescer = std::make_unique<ReceiveCoalescer>(
+        options.max_batch, options.max_delay_us, options.buffer_size);
+  } else {
+    state->scratch.reserve(options.buffer_size);
+  }
   state->read_fn = std::move(read_fn);
+  state->read_batch_fn = std::move(read_batch_fn);
+  state->has_pending = std::move(has_pending);
   state->on_packet = std::move(on_packet);
   state->on_error = std::move(on_error);
   state->owner = this;
@@ -49,8 +68,15 @@ bool PosixUvPollLoop::Start(uv_loop_t* loop,
     return false;
   }
 
+  if (state->coalescer) {
+    hold_timer_ = new uv_timer_t();
+    uv_timer_init(loop, hold_timer_);
+    hold_timer_->data = state.get();
+  }
+
   state_ = std::move(state);
   handle_ = handle.release();
+  events_ = UV_READABLE;
   return true;
 }
 
@@ -60,11 +86,19 @@ void PosixUvPollLoop::Stop() {
   }
 
   paused_ = false;
+  events_ = 0;
   uv_poll_stop(handle_);
   handle_->data = nullptr;
   uv_close(reinterpret_cast<uv_handle_t*>(handle_),
            &PosixUvPollLoop::OnHandleClosed);
   handle_ = nullptr;
+  if (hold_timer_) {
+    uv_timer_stop(hold_timer_);
+    hold_timer_->data = nullptr;
+    uv_close(reinterpret_cast<uv_handle_t*>(hold_timer_),
+             [](uv_handle_t* h) { delete reinterpret_cast<uv_timer_t*>(h); });
+    hold_timer_ = nullptr;
+  }
   state_.reset();
 }
 
@@ -73,7 +107,11 @@ void PosixUvPollLoop::Pause() {
     return;
   }
   paused_ = true;
+  events_ = 0;
   uv_poll_stop(handle_);
+  if (hold_timer_) {
+    uv_timer_stop(hold_timer_);
+  }
 }
 
 void PosixUvPollLoop::Resume() {
@@ -81,7 +119,60 @@ void PosixUvPollLoop::Resume() {
     return;
   }
   paused_ = false;
-  uv_poll_start(handle_, UV_READABLE, &PosixUvPollLoop::OnPoll);
+  Arm();
+  ArmHoldTimer();
+}
+
+void PosixUvPollLoop::Arm() {
+  if (!handle_ || paused_ || !state_) {
+    return;
+  }
+  // Buffered packets never make the fd readable. A TUN fd is always
+  // writable, so adding UV_WRITABLE gets OnPoll called on the next loop
+  // iteration to deliver them, without an extra timer or idle handle.
+  const bool pending = state_->has_pending && state_->has_pending();
+  const int events = pending ? (UV_READABLE | UV_WRITABLE) : UV_READABLE;
+  if (events == events_) {
+    return;
+  }
+  events_ = events;
+  uv_poll_start(handle_, events, &PosixUvPollLoop::OnPoll);
+}
+
+void PosixUvPollLoop::ArmHoldTimer() {
+  if (!hold_timer_ || paused_ || !state_ || state_->coalescer->batch().empty()) {
+    return;
+  }
+  // libuv timers tick in milliseconds. Round down and re-check on expiry;
+  // under a millisecond the timer fires on the next loop iteration, which
+  // still polls the device first.
+  const uint64_t now_ns = PacketBatch::NowNs();
+  const uint64_t deadline_ns = state_->coalescer->DeadlineNs();
+  const uint64_t timeout_ms = deadline_ns > now_ns ? (deadline_ns - now_ns) / 1000000 : 0;
+  uv_timer_start(hold_timer_, &PosixUvPollLoop::OnHoldTimer, timeout_ms, 0);
+}
+
+void PosixUvPollLoop::OnHoldTimer(uv_timer_t* timer) {
+  auto* state = static_cast<State*>(timer->data);
+  if (!state || state->coalescer->batch().empty()) {
+    return;
+  }
+  if (PacketBatch::NowNs() < state->coalescer->DeadlineNs()) {
+    state->owner->ArmHoldTimer();
+    return;
+  }
+  if (!DeliverBatch(state) || timer->data != state) {
+    return;
+  }
+  state->owner->Arm();
+}
+
+bool PosixUvPollLoop::DeliverBatch(State* state) {
+  if (state->owner->hold_timer_) {
+    uv_timer_stop(state->owner->hold_timer_);
+  }
+  PooledPacket packed = state->coalescer->Take();
+  return !state->on_packet || state->on_packet(std::move(packed));
 }
 
 void PosixUvPollLoop::OnPoll(uv_poll_t* handle, int status, int events) {
@@ -109,30 +200,77 @@ void PosixUvPollLoop::OnPoll(uv_poll_t* handle, int status, int events) {
     return;
   }
 
-  if (!(events & UV_READABLE) || !state->read_fn) {
+  if (!(events & (UV_READABLE | UV_WRITABLE)) || !state->read_fn) {
     return;
   }
 
-  // One utun packet per poll callback (pmd3 tun_read_task reads once per iteration).
-  std::vector<uint8_t> packet;
-  std::string error;
-  ReadPacketStatus rs = state->read_fn(state->buffer_size, packet, error);
-
-  switch (rs) {
-    case ReadPacketStatus::Data:
-      if (state->on_packet && !state->on_packet(std::move(packet))) {
+  if (state->coalescer) {
+    PacketBatch& batch = state->coalescer->batch();
+    // ReadPackets stops at a full batch; keep going while the device still
+    // fills batches, within the same budget as single-packet reads.
+    for (size_t batches = 0; batches < kMaxBatchesPerPoll; ++batches) {
+      const size_t held = batch.size();
+      const TunIoStatus rs = state->read_batch_fn(batch, state->buffer_size);
+      if (rs == TunIoStatus::kClosed || rs == TunIoStatus::kError) {
+        const std::string msg = rs == TunIoStatus::kClosed
+                                    ? std::string("Device closed")
+                                    : "Read error: " + TunIoErrorString(batch.error_code());
+        // Packets read before the failure still go out.
+        if (!batch.empty()) {
+          DeliverBatch(state);
+          if (handle->data != state) {
+            return;
+          }
+        }
+        handle_terminal(msg);
         return;
       }
-      break;
-    case ReadPacketStatus::NoData:
-      return;
-    case ReadPacketStatus::Closed:
-      handle_terminal("Device closed");
-      return;
-    case ReadPacketStatus::Error:
-      handle_terminal(error);
-      return;
+      const bool full = state->coalescer->full();
+      if (!state->coalescer->ShouldDeliver(batch.size() - held, PacketBatch::NowNs())) {
+        state->owner->ArmHoldTimer();
+        break;
+      }
+      // `on_packet` may have paused (out of credits) or stopped the loop.
+      if (!DeliverBatch(state) || handle->data != state) {
+        return;
+      }
+      if (!full) {
+        break;
+      }
+    }
+    state->owner->Arm();
+    return;
+  }
+
+  // Drain until the device runs dry, `on_packet` runs out of credits (it
+  // pauses the loop then), or the budget is spent; a still-readable fd
+  // fires again on the next loop iteration.
+  for (size_t reads = 0; reads < kMaxReadsPerPoll; ++reads) {
+    std::string error;
+    const ReadPacketStatus rs = state->read_fn(state->buffer_size, state->scratch, error);
+    switch (rs) {
+      case ReadPacketStatus::Data:
+        if (state->on_packet &&
+            !state->on_packet(PooledPacket::CopyOf(state->scratch.data(), state->scratch.size()))) {
+          return;
+        }
+        // `on_packet` may have stopped the loop.
+        if (handle->data != state) {
+          return;
+        }
+        break;
+      case ReadPacketStatus::NoData:
+        state->owner->Arm();
+        return;
+      case ReadPacketStatus::Closed:
+        handle_terminal("Device closed");
+        return;
+      case ReadPacketStatus::Error:
+        handle_terminal(error);
+        return;
+    }
   }
+  state->owner->Arm();
 }
 
 void PosixUvPollLoop::OnHandleClosed(uv_handle_t* handle) {
@@ -10,6 +10,7 @@
 
 #include <uv.h>
 
+#include "receive_coalescer.h"
 #include "tun_backend.h"
 
 class PosixUvPollLoop {
@@ -17,6 +18,11 @@ public:
   using ReadFn = std::function<ReadPacketStatus(size_t,
                                                 std::vector<uint8_t>&,
                                                 std::string&)>;
+  // Batched delivery: appends what is ready to the batch (ReadPackets).
+  using ReadBatchFn = std::function<TunIoStatus(PacketBatch&, size_t)>;
+  // Reports packets the backend buffered beyond the fd (see
+  // TunPlatformBackend::HasBufferedPackets).
+  using PendingFn = std::function<bool()>;
 
   PosixUvPollLoop() = default;
   ~PosixUvPollLoop();
@@ -26,8 +32,10 @@ public:
 
   bool Start(uv_loop_t* loop,
              int fd,
-             size_t buffer_size,
+             const ReceiveLoopOptions& options,
              ReadFn read_fn,
+             ReadBatchFn read_batch_fn,
+             PendingFn has_pending,
              TunPlatformBackend::PacketCallback on_packet,
              TunPlatformBackend::ErrorCallback on_error,
              std::string& error);
@@ -38,18 +46,35 @@ public:
 
 private:
   bool paused_ = false;
+  int events_ = 0;
   struct State {
     size_t buffer_size = 0;
     ReadFn read_fn;
+    ReadBatchFn read_batch_fn;
+    PendingFn has_pending;
     TunPlatformBackend::PacketCallback on_packet;
     TunPlatformBackend::ErrorCallback on_error;
     PosixUvPollLoop* owner = nullptr;
+    // Read target reused across polls; packets leave as pooled copies.
+    std::vector<uint8_t> scratch;
+    // Set in batched mode (ReceiveLoopOptions::max_batch).
+    std::unique_ptr<ReceiveCoalescer> coalescer;
   };
 
+  // (Re)starts the poll with the interest the buffered state calls for.
+  void Arm();
+  // Batched mode: hold the partial batch until its deadline.
+  void ArmHoldTimer();
   static void OnPoll(uv_poll_t* handle, int status, int events);
+  static void OnHoldTimer(uv_timer_t* timer);
+  // Hands the batch to `on_packet`; false when the loop must not continue
+  // (the callback refused it or stopped the loop).
+  static bool DeliverBatch(State* state);
   static void OnHandleClosed(uv_handle_t* handle);
 
   uv_poll_t* handle_ = nullptr;
+  // Batched mode only.
+  uv_timer_t* hold_timer_ = nullptr;
   std::unique_ptr<State> state_;
 };
 
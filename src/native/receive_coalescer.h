@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "packet_batch.h"
+#include "packet_pool.h"
+
+/**
+ * A batched delivery as handed to `TunPlatformBackend::PacketCallback` when
+ * `ReceiveLoopOptions::max_batch` is set: one pooled buffer whose `size`
+ * bytes are the packets back to back, followed (4-byte aligned) by a
+ * `uint32_t` packet count and `count + 1` packet boundaries. Packet `i` spans
+ * `[offsets[i], offsets[i + 1])`.
+ */
+struct PackedBatchView {
+  const uint8_t* data = nullptr;
+  size_t bytes = 0;
+  const uint32_t* offsets = nullptr;
+  size_t count = 0;
+};
+
+inline size_t PackedBatchTailOffset(size_t bytes) {
+  return (bytes + 3) & ~static_cast<size_t>(3);
+}
+
+inline PackedBatchView ViewPackedBatch(const PacketBuffer* buffer) {
+  PackedBatchView view;
+  view.data = buffer->data();
+  view.bytes = buffer->size;
+  const uint8_t* tail = view.data + PackedBatchTailOffset(buffer->size);
+  uint32_t count = 0;
+  std::memcpy(&count, tail, sizeof(count));
+  view.count = count;
+  view.offsets = reinterpret_cast<const uint32_t*>(tail + sizeof(count));
+  return view;
+}
+
+/** Buffer size needed to pack `count` packets totalling `bytes` bytes. */
+inline size_t PackedBatchBytes(size_t bytes, size_t count) {
+  return PackedBatchTailOffset(bytes) + sizeof(uint32_t) * (count + 2);
+}
+
+/**
+ * Writes the packet count after the first `bytes` bytes of `buffer` and
+ * returns the `count + 1` boundary slots for the caller to fill.
+ */
+inline uint32_t* WritePackedBatchTail(PacketBuffer* buffer, size_t bytes, size_t count) {
+  uint8_t* tail = buffer->data() + PackedBatchTailOffset(bytes);
+  const uint32_t packed_count = static_cast<uint32_t>(count);
+  std::memcpy(tail, &packed_count, sizeof(packed_count));
+  buffer->size = bytes;
+  return reinterpret_cast<uint32_t*>(tail + sizeof(packed_count));
+}
+
+/**
+ * Accumulates packets read by a receive loop and decides when to hand them
+ * over, NIC interrupt-coalescing style: a wakeup that finds a single packet
+ * (light traffic) delivers it at once, while a wakeup that finds a backlog
+ * keeps the partial batch for up to `max_delay_us` from its first packet so
+ * later arrivals share the crossing into JS. A full batch always goes out.
+ */
+class ReceiveCoalescer {
+public:
+  ReceiveCoalescer(size_t max_batch, uint32_t max_delay_us, size_t buffer_size)
+      : batch_(max_batch, StorageBytes(max_batch, buffer_size)),
+        buffer_size_(buffer_size),
+        max_delay_ns_(static_cast<uint64_t>(max_delay_us) * 1000) {}
+
+  /** Read target; receive loops append to it with `ReadPackets`. */
+  PacketBatch& batch() { return batch_; }
+
+  bool full() const { return !batch_.HasRoom(buffer_size_); }
+
+  /**
+   * Called after a wakeup appended `burst` packets: whether the batch should
+   * be delivered now rather than held until `DeadlineNs()`.
+   */
+  bool ShouldDeliver(size_t burst, uint64_t now_ns) const {
+    if (batch_.empty()) {
+      return false;
+    }
+    if (full() || max_delay_ns_ == 0) {
+      return true;
+    }
+    if (burst == batch_.size() && burst <= 1) {
+      return true;
+    }
+    return now_ns >= DeadlineNs();
+  }
+
+  /** When a held batch must go out (its first packet's receive time + delay). */
+  uint64_t DeadlineNs() const { return batch_.meta(0).timestamp_ns + max_delay_ns_; }
+
+  /** Packs the batch into one pooled buffer (see PackedBatchView) and clears it. */
+  PooledPacket Take() {
+    const size_t count = batch_.size();
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; ++i) {
+      bytes += batch_.length(i);
+    }
+    PacketBuffer* buffer = PacketPool::Instance().Acquire(PackedBatchBytes(bytes, count));
+    uint8_t* out = buffer->data();
+    uint32_t* offsets = WritePackedBatchTail(buffer, bytes, count);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+      offsets[i] = static_cast<uint32_t>(offset);
+      std::memcpy(out + offset, batch_.data(i), batch_.length(i));
+      offset += batch_.length(i);
+    }
+    offsets[count] = static_cast<uint32_t>(offset);
+    batch_.Clear();
+    return PooledPacket(buffer);
+  }
+
+private:
+  // Room for `max_batch` full-size reads, capped so a large `buffer_size`
+  // does not pin megabytes per queue; a batch whose storage fills up is
+  // delivered early.
+  static size_t StorageBytes(size_t max_batch, size_t buffer_size) {
+    constexpr size_t kMaxStorage = 256 * 1024;
+    return std::max(buffer_size, std::min(max_batch * buffer_size, kMaxStorage));
+  }
+
+  PacketBatch batch_;
+  size_t buffer_size_ = 0;
+  uint64_t max_delay_ns_ = 0;
+};
@@ -0,0 +1,462 @@
+#include "rtnetlink.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <uv.h>
+
+#include "debug_log.h"
+#include "file_descriptor.h"
+
+namespace {
+
+// How long Commit() waits for the kernel to acknowledge a batch.
+constexpr int kAckTimeoutMs = 5000;
+
+// Largest acknowledgement we read; with NETLINK_CAP_ACK acks carry only the
+// failed request's header plus the extended-ack attributes.
+constexpr size_t kReplyBufferBytes = 16 * 1024;
+
+// Reads the NLMSGERR_ATTR_MSG text from an extended ack, if present.
+std::string ExtendedAckMessage(const nlmsghdr* header, const nlmsgerr* ack) {
+#ifdef NETLINK_EXT_ACK
+  if ((header->nlmsg_flags & NLM_F_ACK_TLVS) == 0) {
+    return std::string();
+  }
+  const uint8_t* end = reinterpret_cast<const uint8_t*>(header) + header->nlmsg_len;
+  const uint8_t* cursor = reinterpret_cast<const uint8_t*>(ack) + sizeof(nlmsgerr);
+  if ((header->nlmsg_flags & NLM_F_CAPPED) == 0) {
+    // Uncapped acks echo the whole request before the attributes.
+    cursor += ack->msg.nlmsg_len - sizeof(nlmsghdr);
+  }
+  while (cursor + sizeof(nlattr) <= end) {
+    nlattr attribute;
+    std::memcpy(&attribute, cursor, sizeof(attribute));
+    if (attribute.nla_len < sizeof(nlattr) || cursor + attribute.nla_len > end) {
+      break;
+    }
+    if ((attribute.nla_type & NLA_TYPE_MASK) == NLMSGERR_ATTR_MSG) {
+      const char* text = reinterpret_cast<const char*>(cursor + NLA_HDRLEN);
+      return std::string(text, strnlen(text, attribute.nla_len - NLA_HDRLEN));
+    }
+    cursor += NLA_ALIGN(attribute.nla_len);
+  }
+#else
+  (void)header;
+  (void)ack;
+#endif
+  return std::string();
+}
+
+}  // namespace
+
+bool OpenRouteSocket(FileDescriptor& socket_fd,
+                     int timeout_ms,
+                     int& error_code,
+                     std::string& error) {
+  socket_fd.reset(::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE));
+  if (!socket_fd.is_valid()) {
+    error_code = errno;
+    error = std::string("Failed to open rtnetlink socket: ") + strerror(errno);
+    return false;
+  }
+  struct timeval timeout {};
+  timeout.tv_sec = timeout_ms / 1000;
+  timeout.tv_usec = (timeout_ms % 1000) * 1000;
+  ::setsockopt(socket_fd.get(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#ifdef NETLINK_EXT_ACK
+  // Best effort: older kernels reject these and send plain acks.
+  const int on = 1;
+  ::setsockopt(socket_fd.get(), SOL_NETLINK, NETLINK_EXT_ACK, &on, sizeof(on));
+  ::setsockopt(socket_fd.get(), SOL_NETLINK, NETLINK_CAP_ACK, &on, sizeof(on));
+#endif
+  return true;
+}
+
+bool ParseIpv6Prefix(const std::string& text, uint8_t default_length, Ipv6Prefix& out) {
+  const size_t slash = text.find('/');
+  const std::string address = text.substr(0, slash);
+  if (inet_pton(AF_INET6, address.c_str(), &out.address) != 1) {
+    return false;
+  }
+  out.length = default_length;
+  if (slash == std::string::npos) {
+    return true;
+  }
+  const std::string length = text.substr(slash + 1);
+  if (length.empty() || length.size() > 3 ||
+      length.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+  const int value = std::stoi(length);
+  if (value > 128) {
+    return false;
+  }
+  out.length = static_cast<uint8_t>(value);
+  return true;
+}
+
+size_t RtNetlinkTransaction::Begin(uint16_t type, uint16_t flags, const char* operation) {
+  buffer_.resize(NLMSG_ALIGN(buffer_.size()));
+  const size_t offset = buffer_.size();
+  operations_.push_back(operation);
+  nlmsghdr header {};
+  header.nlmsg_type = type;
+  header.nlmsg_flags = static_cast<uint16_t>(flags | NLM_F_REQUEST | NLM_F_ACK);
+  // Sequence numbers map acknowledgements back to requests.
+  header.nlmsg_seq = static_cast<uint32_t>(operations_.size());
+  Append(&header, sizeof(header));
+  return offset;
+}
+
+void RtNetlinkTransaction::Append(const void* data, size_t length) {
+  const size_t offset = buffer_.size();
+  buffer_.resize(offset + NLMSG_ALIGN(length));
+  std::memcpy(buffer_.data() + offset, data, length);
+}
+
+void RtNetlinkTransaction::AddAttribute(uint16_t type, const void* data, size_t length) {
+  rtattr attribute {};
+  attribute.rta_type = type;
+  attribute.rta_len = static_cast<uint16_t>(RTA_LENGTH(length));
+  Append(&attribute, sizeof(attribute));
+  Append(data, length);
+}
+
+void RtNetlinkTransaction::End(size_t header_offset) {
+  const uint32_t length = static_cast<uint32_t>(buffer_.size() - header_offset);
+  std::memcpy(buffer_.data() + header_offset + offsetof(nlmsghdr, nlmsg_len), &length,
+              sizeof(length));
+}
+
+void RtNetlinkTransaction::SetLinkUp(int ifindex, uint32_t mtu) {
+  const size_t offset = Begin(RTM_NEWLINK, 0, "RTM_NEWLINK");
+  ifinfomsg link {};
+  link.ifi_family = AF_UNSPEC;
+  link.ifi_index = ifindex;
+  link.ifi_flags = IFF_UP;
+  link.ifi_change = IFF_UP;
+  Append(&link, sizeof(link));
+  if (mtu != 0) {
+    AddAttribute(IFLA_MTU, &mtu, sizeof(mtu));
+  }
+  End(offset);
+}
+
+void RtNetlinkTransaction::AddAddress(int ifindex, const Ipv6Prefix& prefix) {
+  const size_t offset = Begin(RTM_NEWADDR, NLM_F_CREATE | NLM_F_EXCL, "RTM_NEWADDR");
+  ifaddrmsg address {};
+  address.ifa_family = AF_INET6;
+  address.ifa_prefixlen = prefix.length;
+  address.ifa_scope = RT_SCOPE_UNIVERSE;
+  address.ifa_index = static_cast<uint32_t>(ifindex);
+  Append(&address, sizeof(address));
+  AddAttribute(IFA_LOCAL, &prefix.address, sizeof(prefix.address));
+  AddAttribute(IFA_ADDRESS, &prefix.address, sizeof(prefix.address));
+  End(offset);
+}
+
+void RtNetlinkTransaction::AddRoute(int ifindex, const Ipv6Prefix& destination) {
+  const size_t offset = Begin(RTM_NEWROUTE, NLM_F_CREATE | NLM_F_EXCL, "RTM_NEWROUTE");
+  rtmsg route {};
+  route.rtm_family = AF_INET6;
+  route.rtm_dst_len = destination.length;
+  route.rtm_table = RT_TABLE_MAIN;
+  route.rtm_protocol = RTPROT_BOOT;
+  route.rtm_scope = RT_SCOPE_UNIVERSE;
+  route.rtm_type = RTN_UNICAST;
+  Append(&route, sizeof(route));
+  AddAttribute(RTA_DST, &destination.address, sizeof(destination.address));
+  const uint32_t oif = static_cast<uint32_t>(ifindex);
+  AddAttribute(RTA_OIF, &oif, sizeof(oif));
+  End(offset);
+}
+
+void RtNetlinkTransaction::DeleteRoute(int ifindex, const Ipv6Prefix& destination) {
+  const size_t offset = Begin(RTM_DELROUTE, 0, "RTM_DELROUTE");
+  rtmsg route {};
+  route.rtm_family = AF_INET6;
+  route.rtm_dst_len = destination.length;
+  route.rtm_table = RT_TABLE_MAIN;
+  route.rtm_scope = RT_SCOPE_NOWHERE;
+  Append(&route, sizeof(route));
+  AddAttribute(RTA_DST, &destination.address, sizeof(destination.address));
+  const uint32_t oif = static_cast<uint32_t>(ifindex);
+  AddAttribute(RTA_OIF, &oif, sizeof(oif));
+  End(offset);
+}
+
+bool RtNetlinkTransaction::Commit(std::vector<int>& results,
+                                  std::vector<std::string>& messages,
+                                  int& error_code,
+                                  std::string& error) {
+  const size_t count = operations_.size();
+  results.assign(count, 0);
+  messages.assign(count, std::string());
+  if (count == 0) {
+    return true;
+  }
+
+  FileDescriptor socket_fd;
+  if (!OpenRouteSocket(socket_fd, kAckTimeoutMs, error_code, error)) {
+    return false;
+  }
+
+  sockaddr_nl kernel {};
+  kernel.nl_family = AF_NETLINK;
+  ssize_t sent;
+  do {
+    sent = ::sendto(socket_fd.get(), buffer_.data(), buffer_.size(), 0,
+                    reinterpret_cast<const sockaddr*>(&kernel), sizeof(kernel));
+  } while (sent < 0 && errno == EINTR);
+  if (sent < 0) {
+    error_code = errno;
+    error = std::string("Failed to send rtnetlink request: ") + strerror(errno);
+    return false;
+  }
+
+  std::vector<bool> acked(count, false);
+  size_t pending = count;
+  std::vector<uint8_t> reply(kReplyBufferBytes);
+  while (pending > 0) {
+    const ssize_t received = ::recv(socket_fd.get(), reply.data(), reply.size(), 0);
+    if (received < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      error_code = errno == EAGAIN || errno == EWOULDBLOCK ? ETIMEDOUT : errno;
+      error = error_code == ETIMEDOUT
+                  ? std::string("Timed out waiting for rtnetlink acknowledgement")
+                  : std::string("Failed to read rtnetlink reply: ") + strerror(errno);
+      return false;
+    }
+
+    int remaining = static_cast<int>(received);
+    for (auto* header = reinterpret_cast<const nlmsghdr*>(reply.data());
+         NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+      if (header->nlmsg_type != NLMSG_ERROR ||
+          header->nlmsg_len < NLMSG_LENGTH(sizeof(nlmsgerr))) {
+        continue;
+      }
+      const size_t index = header->nlmsg_seq - 1;
+      if (header->nlmsg_seq == 0 || index >= count || acked[index]) {
+        continue;
+      }
+      const auto* ack = static_cast<const nlmsgerr*>(NLMSG_DATA(header));
+      results[index] = -ack->error;
+      if (ack->error != 0) {
+        messages[index] = ExtendedAckMessage(header, ack);
+        tuntap::FwdDebug("rtnetlink-nack", "op=%s errno=%d %s", operations_[index],
+                         results[index], messages[index].c_str());
+      }
+      acked[index] = true;
+      --pending;
+    }
+  }
+  return true;
+}
+
+// --- N-API bindings ---
+
+namespace {
+
+}  // namespace
+
+void ThrowNetlinkError(Napi::Env env,
+                       const char* operation,
+                       int code,
+                       const std::string& detail) {
+  char name[32];
+  uv_err_name_r(-code, name, sizeof(name));
+  std::string message = std::string(operation) + " failed: " + strerror(code);
+  if (!detail.empty()) {
+    message += " (" + detail + ")";
+  }
+  Napi::Error error = Napi::Error::New(env, message);
+  error.Set("code", Napi::String::New(env, name));
+  error.Set("errno", Napi::Number::New(env, code));
+  error.Set("operation", Napi::String::New(env, operation));
+  error.ThrowAsJavaScriptException();
+}
+
+namespace {
+
+// Resolves `name` to an interface index, throwing ENODEV-style errors.
+bool ResolveInterface(Napi::Env env, const Napi::Value& value, int& ifindex) {
+  const std::string name = value.As<Napi::String>().Utf8Value();
+  errno = 0;
+  const unsigned int index = name.size() < IFNAMSIZ ? if_nametoindex(name.c_str()) : 0;
+  if (index == 0) {
+    ThrowNetlinkError(env, "if_nametoindex", errno == 0 ? ENODEV : errno, name);
+    return false;
+  }
+  ifindex = static_cast<int>(index);
+  return true;
+}
+
+bool ParsePrefixArgument(Napi::Env env,
+                         const Napi::Value& value,
+                         uint8_t default_length,
+                         Ipv6Prefix& out) {
+  if (!value.IsString() ||
+      !ParseIpv6Prefix(value.As<Napi::String>().Utf8Value(), default_length, out)) {
+    Napi::TypeError::New(env, "Expected an IPv6 address or CIDR").ThrowAsJavaScriptException();
+    return false;
+  }
+  return true;
+}
+
+// Commits `transaction`; throws for the first failed request whose errno is
+// not in `tolerated`, which reports through `existed` instead.
+bool CommitOrThrow(Napi::Env env,
+                   RtNetlinkTransaction& transaction,
+                   std::vector<bool>& existed,
+                   int tolerated) {
+  std::vector<int> results;
+  std::vector<std::string> messages;
+  int error_code = 0;
+  std::string error;
+  if (!transaction.Commit(results, messages, error_code, error)) {
+    ThrowNetlinkError(env, "rtnetlink", error_code, error);
+    return false;
+  }
+  existed.assign(results.size(), false);
+  for (size_t i = 0; i < results.size(); ++i) {
+    if (results[i] == 0) {
+      continue;
+    }
+    if (results[i] == tolerated) {
+      existed[i] = true;
+      continue;
+    }
+    ThrowNetlinkError(env, transaction.operation(i), results[i], messages[i]);
+    return false;
+  }
+  return true;
+}
+
+// configure(interfaceName, address, prefixLength, mtu, routes[]) (`prefixLength`
+// applies unless `address` carries its own):
+// one transaction that sets the MTU, brings the link up, adds the address
+// and adds each route. An address or route that already exists is not an
+// error; the result says which ones did.
+Napi::Value Configure(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 5 || !info[0].IsString() || !info[1].IsString() || !info[2].IsNumber() ||
+      !info[3].IsNumber() || !info[4].IsArray()) {
+    Napi::TypeError::New(env, "Expected (interfaceName, address, prefixLength, mtu, routes)")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  const uint32_t prefix_length = info[2].As<Napi::Number>().Uint32Value();
+  if (prefix_length > 128) {
+    Napi::RangeError::New(env, "prefixLength must be between 0 and 128")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Ipv6Prefix address;
+  if (!ParsePrefixArgument(env, info[1], static_cast<uint8_t>(prefix_length), address)) {
+    return env.Undefined();
+  }
+
+  const Napi::Array route_list = info[4].As<Napi::Array>();
+  std::vector<Ipv6Prefix> routes(route_list.Length());
+  for (uint32_t i = 0; i < route_list.Length(); ++i) {
+    if (!ParsePrefixArgument(env, route_list.Get(i), 128, routes[i])) {
+      return env.Undefined();
+    }
+  }
+
+  int ifindex = 0;
+  if (!ResolveInterface(env, info[0], ifindex)) {
+    return env.Undefined();
+  }
+
+  // The link goes first: IPv6 refuses addresses while the MTU is below 1280.
+  RtNetlinkTransaction transaction;
+  transaction.SetLinkUp(ifindex, info[3].As<Napi::Number>().Uint32Value());
+  transaction.AddAddress(ifindex, address);
+  for (const Ipv6Prefix& route : routes) {
+    transaction.AddRoute(ifindex, route);
+  }
+
+  std::vector<bool> existed;
+  if (!CommitOrThrow(env, transaction, existed, EEXIST)) {
+    return env.Undefined();
+  }
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("addressExists", Napi::Boolean::New(env, existed[1]));
+  Napi::Array existing_routes = Napi::Array::New(env);
+  for (uint32_t i = 0; i < route_list.Length(); ++i) {
+    if (existed[2 + i]) {
+      existing_routes.Set(existing_routes.Length(), route_list.Get(i));
+    }
+  }
+  result.Set("existingRoutes", existing_routes);
+  return result;
+}
+
+// addRoute(interfaceName, destination): false when the route already existed.
+Napi::Value AddRoute(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected (interfaceName, destination)")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Ipv6Prefix destination;
+  int ifindex = 0;
+  if (!ParsePrefixArgument(env, info[1], 128, destination) ||
+      !ResolveInterface(env, info[0], ifindex)) {
+    return env.Undefined();
+  }
+  RtNetlinkTransaction transaction;
+  transaction.AddRoute(ifindex, destination);
+  std::vector<bool> existed;
+  if (!CommitOrThrow(env, transaction, existed, EEXIST)) {
+    return env.Undefined();
+  }
+  return Napi::Boolean::New(env, !existed[0]);
+}
+
+// removeRoute(interfaceName, destination): false when there was no such route.
+Napi::Value RemoveRoute(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected (interfaceName, destination)")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Ipv6Prefix destination;
+  int ifindex = 0;
+  if (!ParsePrefixArgument(env, info[1], 128, destination) ||
+      !ResolveInterface(env, info[0], ifindex)) {
+    return env.Undefined();
+  }
+  RtNetlinkTransaction transaction;
+  transaction.DeleteRoute(ifindex, destination);
+  std::vector<bool> missing;
+  if (!CommitOrThrow(env, transaction, missing, ESRCH)) {
+    return env.Undefined();
+  }
+  return Napi::Boolean::New(env, !missing[0]);
+}
+
+}  // namespace
+
+Napi::Object InitRtNetlink(Napi::Env env, Napi::Object exports) {
+  Napi::Object netlink = Napi::Object::New(env);
+  netlink.Set("configure", Napi::Function::New(env, Configure, "configure"));
+  netlink.Set("addRoute", Napi::Function::New(env, AddRoute, "addRoute"));
+  netlink.Set("removeRoute", Napi::Function::New(env, RemoveRoute, "removeRoute"));
+  exports.Set("rtnetlink", netlink);
+  return exports;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <netinet/in.h>
+
+#include <napi.h>
+
+#include "file_descriptor.h"
+
+/** An IPv6 address with a prefix length (`fd00::1/128`, `fd00::/64`). */
+struct Ipv6Prefix {
+  in6_addr address{};
+  uint8_t length = 128;
+};
+
+/** Parses `addr` or `addr/len`; a bare address gets `default_length`. */
+bool ParseIpv6Prefix(const std::string& text, uint8_t default_length, Ipv6Prefix& out);
+
+/**
+ * Opens a NETLINK_ROUTE socket whose reads give up after `timeout_ms`, with
+ * extended acks enabled where the kernel supports them.
+ */
+bool OpenRouteSocket(FileDescriptor& socket_fd,
+                     int timeout_ms,
+                     int& error_code,
+                     std::string& error);
+
+/**
+ * A batch of rtnetlink requests sent to the kernel in one `sendmsg()`
+ * (Linux only). The kernel handles the requests in order and acknowledges
+ * each one, so a failing request does not stop the ones after it; `Commit()`
+ * reports each request's errno separately.
+ */
+class RtNetlinkTransaction {
+public:
+  /** Sets the link MTU (when non-zero) and brings the link up. */
+  void SetLinkUp(int ifindex, uint32_t mtu);
+  void AddAddress(int ifindex, const Ipv6Prefix& prefix);
+  void AddRoute(int ifindex, const Ipv6Prefix& destination);
+  void DeleteRoute(int ifindex, const Ipv6Prefix& destination);
+
+  size_t size() const { return operations_.size(); }
+
+  /**
+   * Sends every queued request and waits for their acknowledgements.
+   * `results[i]` receives request i's errno (0 on success) and, when the
+   * kernel supplies one, `messages[i]` its extended-ack text. False (with
+   * `error_code`/`error`) only when the exchange itself failed.
+   */
+  bool Commit(std::vector<int>& results,
+              std::vector<std::string>& messages,
+              int& error_code,
+              std::string& error);
+
+  /** Name of request i's message type, for error reports (`RTM_NEWADDR`, ...). */
+  const char* operation(size_t index) const { return operations_[index]; }
+
+private:
+  // Starts a request; returns the offset of its header in `buffer_`.
+  size_t Begin(uint16_t type, uint16_t flags, const char* operation);
+  void Append(const void* data, size_t length);
+  void AddAttribute(uint16_t type, const void* data, size_t length);
+  void End(size_t header_offset);
+
+  std::vector<uint8_t> buffer_;
+  std::vector<const char*> operations_;
+};
+
+/**
+ * Throws an Error for a failed netlink operation with `code` (errno name),
+ * `errno` and `operation` properties.
+ */
+void ThrowNetlinkError(Napi::Env env, const char* operation, int code, const std::string& detail);
+
+Napi::Object InitRtNetlink(Napi::Env env, Napi::Object exports);
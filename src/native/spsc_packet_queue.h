@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+/**
+ * Bounded single-producer/single-consumer queue of fixed-size packet slots.
+ *
+ * Producers write packets straight into `BeginPush()` and consumers read them
+ * in place through `Front()`, so handing a packet between pipeline stages is
+ * two atomic index updates with no copy or allocation. The blocking helpers
+ * only take a mutex when a side actually has to park.
+ */
+class SpscPacketQueue {
+public:
+  /** `slots` is rounded up to a power of two. */
+  SpscPacketQueue(size_t slots, size_t slot_size)
+      : slot_count_(RoundUpPow2(slots)),
+        mask_(slot_count_ - 1),
+        slot_size_(slot_size),
+        storage_(new uint8_t[slot_count_ * slot_size]),
+        lengths_(new size_t[slot_count_]),
+        stamps_(new uint64_t[slot_count_]) {}
+
+  SpscPacketQueue(const SpscPacketQueue&) = delete;
+  SpscPacketQueue& operator=(const SpscPacketQueue&) = delete;
+
+  size_t capacity() const { return slot_count_; }
+  size_t slot_size() const { return slot_size_; }
+
+  size_t depth() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+
+  size_t high_water() const { return high_water_.load(std::memory_order_relaxed); }
+
+  // --- producer side ---
+
+  /** Slot for the next packet, or nullptr when the queue is full. */
+  uint8_t* BeginPush() {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) >= slot_count_) {
+      return nullptr;
+    }
+    return storage_.get() + (tail & mask_) * slot_size_;
+  }
+
+  /** Publishes the slot; `stamp` travels with the packet (see `FrontStamp()`). */
+  void CommitPush(size_t len, uint64_t stamp = 0) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    lengths_[tail & mask_] = len;
+    stamps_[tail & mask_] = stamp;
+    tail_.store(tail + 1, std::memory_order_seq_cst);
+    const size_t depth = tail + 1 - head_.load(std::memory_order_acquire);
+    if (depth > high_water_.load(std::memory_order_relaxed)) {
+      high_water_.store(depth, std::memory_order_relaxed);
+    }
+    if (consumer_parked_.load(std::memory_order_seq_cst)) {
+      Wake();
+    }
+  }
+
+  // --- consumer side ---
+
+  /** Oldest packet, if any. It stays valid until `Pop()`. */
+  bool Front(const uint8_t*& data, size_t& len) const {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    data = storage_.get() + (head & mask_) * slot_size_;
+    len = lengths_[head & mask_];
+    return true;
+  }
+
+  /** Stamp pushed with the packet `Front()` returned. */
+  uint64_t FrontStamp() const { return stamps_[head_.load(std::memory_order_relaxed) & mask_]; }
+
+  void Pop() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+    if (producer_parked_.load(std::memory_order_seq_cst)) {
+      Wake();
+    }
+  }
+
+  // --- parking ---
+
+  /**
+   * Block until a slot is free or `running` turns false. Whoever clears
+   * `running` must call `Wake()` afterwards; the wait has no timeout.
+   */
+  bool WaitNotFull(const std::atomic<bool>& running) {
+    return Park(producer_parked_, running, [this] {
+      return tail_.load(std::memory_order_seq_cst) - head_.load(std::memory_order_seq_cst) <
+             slot_count_;
+    });
+  }
+
+  /** Block until a packet is queued or `running` turns false (see `WaitNotFull`). */
+  bool WaitNotEmpty(const std::atomic<bool>& running) {
+    return Park(consumer_parked_, running, [this] {
+      return tail_.load(std::memory_order_seq_cst) != head_.load(std::memory_order_seq_cst);
+    });
+  }
+
+  /** Release any parked side (used by producers/consumers and on shutdown). */
+  void Wake() {
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    park_cv_.notify_all();
+  }
+
+private:
+  static size_t RoundUpPow2(size_t value) {
+    size_t out = 1;
+    while (out < value) {
+      out <<= 1;
+    }
+    return out;
+  }
+
+  template <typename Ready>
+  bool Park(std::atomic<bool>& parked_flag, const std::atomic<bool>& running, Ready ready) {
+    if (ready()) {
+      return true;
+    }
+    // Publish intent to sleep, then re-check: the peer either sees the flag
+    // after its index update and wakes us, or we see its update here.
+    parked_flag.store(true, std::memory_order_seq_cst);
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    while (running.load() && !ready()) {
+      park_cv_.wait(lock);
+    }
+    parked_flag.store(false, std::memory_order_seq_cst);
+    return ready();
+  }
+
+  const size_t slot_count_;
+  const size_t mask_;
+  const size_t slot_size_;
+  std::unique_ptr<uint8_t[]> storage_;
+  std::unique_ptr<size_t[]> lengths_;
+  std::unique_ptr<uint64_t[]> stamps_;
+
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+  alignas(64) std::atomic<size_t> high_water_{0};
+  std::atomic<bool> consumer_parked_{false};
+  std::atomic<bool> producer_parked_{false};
+
+  std::mutex park_mutex_;
+  std::condition_variable park_cv_;
+};
@@ -0,0 +1,369 @@
+#include "tcp_offload.h"
+
+#include <cstring>
+#include <string>
+
+namespace tcp_offload {
+
+namespace {
+
+constexpr size_t kMinTcpHeaderSize = 20;
+constexpr uint8_t kTcpFlagFin = 0x01;
+constexpr uint8_t kTcpFlagPsh = 0x08;
+constexpr uint8_t kTcpFlagAck = 0x10;
+constexpr uint8_t kTcpFlagCwr = 0x80;
+
+// Upper bound on segments per super-packet; keeps one GSO write well inside
+// the kernel's per-skb segment limits.
+constexpr size_t kMaxSegments = 64;
+
+uint16_t ReadBe16(const uint8_t* p) {
+  return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t ReadBe32(const uint8_t* p) {
+  return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+void WriteBe16(uint8_t* p, uint16_t value) {
+  p[0] = static_cast<uint8_t>(value >> 8);
+  p[1] = static_cast<uint8_t>(value & 0xff);
+}
+
+void WriteBe32(uint8_t* p, uint32_t value) {
+  p[0] = static_cast<uint8_t>(value >> 24);
+  p[1] = static_cast<uint8_t>((value >> 16) & 0xff);
+  p[2] = static_cast<uint8_t>((value >> 8) & 0xff);
+  p[3] = static_cast<uint8_t>(value & 0xff);
+}
+
+// TCP header length of a segment the coalescer may take, or 0.
+size_t CoalescableTcpHeaderLength(const uint8_t* frame, size_t len) {
+  if (len < kIpv6HeaderSize + kMinTcpHeaderSize || (frame[0] >> 4) != 6 ||
+      frame[6] != kProtoTcp) {
+    return 0;
+  }
+  const size_t payload_len = ReadBe16(frame + 4);
+  if (kIpv6HeaderSize + payload_len != len) {
+    return 0;
+  }
+  const uint8_t* tcp = frame + kIpv6HeaderSize;
+  const size_t header_len = static_cast<size_t>(tcp[12] >> 4) * 4;
+  if (header_len < kMinTcpHeaderSize || header_len >= payload_len) {
+    return 0;
+  }
+  const uint8_t flags = tcp[13];
+  if ((flags & kTcpFlagAck) == 0 || (flags & ~(kTcpFlagAck | kTcpFlagPsh)) != 0) {
+    return 0;
+  }
+  const uint32_t sum =
+      ChecksumAdd(Ipv6PseudoHeaderSum(frame, static_cast<uint32_t>(payload_len), kProtoTcp),
+                  tcp, payload_len);
+  if (ChecksumFold(sum) != 0xffff) {
+    return 0;
+  }
+  return header_len;
+}
+
+}  // namespace
+
+uint32_t ChecksumAdd(uint32_t sum, const uint8_t* data, size_t len) {
+  size_t i = 0;
+  for (; i + 1 < len; i += 2) {
+    sum += static_cast<uint16_t>((data[i] << 8) | data[i + 1]);
+  }
+  if (i < len) {
+    sum += static_cast<uint16_t>(data[i] << 8);
+  }
+  return sum;
+}
+
+uint16_t ChecksumFold(uint32_t sum) {
+  while ((sum >> 16) != 0) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+  return static_cast<uint16_t>(sum);
+}
+
+uint32_t Ipv6PseudoHeaderSum(const uint8_t* ipv6_header, uint32_t upper_len, uint8_t protocol) {
+  uint32_t sum = ChecksumAdd(0, ipv6_header + 8, 32);
+  sum += upper_len >> 16;
+  sum += upper_len & 0xffff;
+  sum += protocol;
+  return sum;
+}
+
+bool CompletePartialChecksum(uint8_t* packet, size_t len, size_t csum_start, size_t csum_offset) {
+  if (csum_start + csum_offset + 2 > len) {
+    return false;
+  }
+  const uint32_t sum = ChecksumAdd(0, packet + csum_start, len - csum_start);
+  WriteBe16(packet + csum_start + csum_offset, static_cast<uint16_t>(~ChecksumFold(sum)));
+  return true;
+}
+
+TcpGroCoalescer::TcpGroCoalescer() {
+  buffer_.reserve(kMaxSuperPacket);
+}
+
+bool TcpGroCoalescer::Add(const uint8_t* frame, size_t len) {
+  const size_t header_len = CoalescableTcpHeaderLength(frame, len);
+  if (header_len == 0) {
+    return false;
+  }
+  if (segments_ == 0) {
+    return Start(frame, len, header_len);
+  }
+  if (closed_ || segments_ >= kMaxSegments || header_len != tcp_header_len_) {
+    return false;
+  }
+
+  const size_t payload_len = len - kIpv6HeaderSize - header_len;
+  if (payload_len > segment_size_ || buffer_.size() + payload_len > kMaxSuperPacket) {
+    return false;
+  }
+
+  uint8_t* head = buffer_.data();
+  const uint8_t* tcp = frame + kIpv6HeaderSize;
+  uint8_t* head_tcp = head + kIpv6HeaderSize;
+  // Version/class/flow label, hop limit and both addresses must match, as must
+  // the ports, ACK number and option bytes (timestamps included).
+  if (std::memcmp(head, frame, 4) != 0 || head[7] != frame[7] ||
+      std::memcmp(head + 8, frame + 8, 32) != 0 || std::memcmp(head_tcp, tcp, 4) != 0 ||
+      ReadBe32(tcp + 4) != next_seq_ || std::memcmp(head_tcp + 8, tcp + 8, 4) != 0 ||
+      std::memcmp(head_tcp + kMinTcpHeaderSize, tcp + kMinTcpHeaderSize,
+                  header_len - kMinTcpHeaderSize) != 0) {
+    return false;
+  }
+
+  buffer_.insert(buffer_.end(), tcp + header_len, tcp + header_len + payload_len);
+  head_tcp = buffer_.data() + kIpv6HeaderSize;
+  // Advertise the newest receive window.
+  head_tcp[14] = tcp[14];
+  head_tcp[15] = tcp[15];
+  ++segments_;
+  next_seq_ += static_cast<uint32_t>(payload_len);
+  if ((tcp[13] & kTcpFlagPsh) != 0) {
+    head_tcp[13] |= kTcpFlagPsh;
+    closed_ = true;
+  }
+  if (payload_len < segment_size_) {
+    closed_ = true;
+  }
+  return true;
+}
+
+bool TcpGroCoalescer::Start(const uint8_t* frame, size_t len, size_t tcp_header_len) {
+  const uint8_t* tcp = frame + kIpv6HeaderSize;
+  buffer_.assign(frame, frame + len);
+  segments_ = 1;
+  tcp_header_len_ = tcp_header_len;
+  segment_size_ = len - kIpv6HeaderSize - tcp_header_len;
+  next_seq_ = ReadBe32(tcp + 4) + static_cast<uint32_t>(segment_size_);
+  closed_ = (tcp[13] & kTcpFlagPsh) != 0;
+  return true;
+}
+
+void TcpGroCoalescer::Finish(TunGsoInfo& gso) {
+  uint8_t* packet = buffer_.data();
+  const uint32_t upper_len = static_cast<uint32_t>(buffer_.size() - kIpv6HeaderSize);
+  WriteBe16(packet + 4, static_cast<uint16_t>(upper_len));
+  // CHECKSUM_PARTIAL convention: seed the field with the pseudo-header sum.
+  WriteBe16(packet + kIpv6HeaderSize + kTcpChecksumOffset,
+            ChecksumFold(Ipv6PseudoHeaderSum(packet, upper_len, kProtoTcp)));
+
+  gso.header_length = static_cast<uint16_t>(kIpv6HeaderSize + tcp_header_len_);
+  gso.segment_size = static_cast<uint16_t>(segment_size_);
+  gso.csum_start = static_cast<uint16_t>(kIpv6HeaderSize);
+  gso.csum_offset = static_cast<uint16_t>(kTcpChecksumOffset);
+}
+
+void TcpGroCoalescer::Reset() {
+  buffer_.clear();
+  segments_ = 0;
+  tcp_header_len_ = 0;
+  segment_size_ = 0;
+  next_seq_ = 0;
+  closed_ = false;
+}
+
+bool TcpSegmenter::Load(const uint8_t* packet,
+                        size_t len,
+                        size_t tcp_offset,
+                        size_t segment_size,
+                        size_t max_packet) {
+  Reset();
+  if (len < kIpv6HeaderSize || (packet[0] >> 4) != 6 || tcp_offset < kIpv6HeaderSize ||
+      tcp_offset + kMinTcpHeaderSize > len || len > kMaxSuperPacket) {
+    return false;
+  }
+  const size_t header_len = tcp_offset + static_cast<size_t>(packet[tcp_offset + 12] >> 4) * 4;
+  if (header_len < tcp_offset + kMinTcpHeaderSize || header_len >= len ||
+      max_packet <= header_len || segment_size == 0) {
+    return false;
+  }
+
+  packet_ = packet;
+  len_ = len;
+  tcp_offset_ = tcp_offset;
+  header_len_ = header_len;
+  segment_size_ = segment_size < max_packet - header_len ? segment_size : max_packet - header_len;
+  offset_ = header_len;
+  seq_ = ReadBe32(packet + tcp_offset + 4);
+  return true;
+}
+
+size_t TcpSegmenter::Next(uint8_t* out) {
+  if (packet_ == nullptr) {
+    return 0;
+  }
+  const size_t remaining = len_ - offset_;
+  const size_t payload_len = remaining < segment_size_ ? remaining : segment_size_;
+  const bool first = offset_ == header_len_;
+  const bool last = payload_len == remaining;
+
+  std::memcpy(out, packet_, header_len_);
+  std::memcpy(out + header_len_, packet_ + offset_, payload_len);
+  const size_t total = header_len_ + payload_len;
+
+  WriteBe16(out + 4, static_cast<uint16_t>(total - kIpv6HeaderSize));
+  uint8_t* tcp = out + tcp_offset_;
+  WriteBe32(tcp + 4, seq_ + static_cast<uint32_t>(offset_ - header_len_));
+  if (!last) {
+    tcp[13] &= static_cast<uint8_t>(~(kTcpFlagFin | kTcpFlagPsh));
+  }
+  if (!first) {
+    tcp[13] &= static_cast<uint8_t>(~kTcpFlagCwr);
+  }
+  const size_t upper_len = total - tcp_offset_;
+  tcp[kTcpChecksumOffset] = 0;
+  tcp[kTcpChecksumOffset + 1] = 0;
+  const uint32_t sum = ChecksumAdd(
+      Ipv6PseudoHeaderSum(out, static_cast<uint32_t>(upper_len), kProtoTcp), tcp, upper_len);
+  WriteBe16(tcp + kTcpChecksumOffset, static_cast<uint16_t>(~ChecksumFold(sum)));
+
+  offset_ += payload_len;
+  ++emitted_;
+  if (last) {
+    packet_ = nullptr;
+  }
+  return total;
+}
+
+void TcpSegmenter::Reset() {
+  packet_ = nullptr;
+  len_ = 0;
+  tcp_offset_ = 0;
+  header_len_ = 0;
+  segment_size_ = 0;
+  offset_ = 0;
+  emitted_ = 0;
+  seq_ = 0;
+}
+
+}  // namespace tcp_offload
+
+namespace {
+
+Napi::Object GroupToObject(Napi::Env env,
+                           const uint8_t* data,
+                           size_t len,
+                           size_t segments,
+                           const TunGsoInfo* gso) {
+  Napi::Object out = Napi::Object::New(env);
+  out.Set("packet", Napi::Buffer<uint8_t>::Copy(env, data, len));
+  out.Set("segments", Napi::Number::New(env, static_cast<double>(segments)));
+  if (gso != nullptr) {
+    Napi::Object info = Napi::Object::New(env);
+    info.Set("headerLength", Napi::Number::New(env, gso->header_length));
+    info.Set("segmentSize", Napi::Number::New(env, gso->segment_size));
+    info.Set("csumStart", Napi::Number::New(env, gso->csum_start));
+    info.Set("csumOffset", Napi::Number::New(env, gso->csum_offset));
+    out.Set("gso", info);
+  }
+  return out;
+}
+
+// coalesce(frames: Buffer[]): {packet, segments, gso?}[]
+// Feeds `frames` through one coalescer the way the forwarder does: a refused
+// frame flushes the group and is retried once, then passed through as-is.
+Napi::Value Coalesce(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected an array of Buffers").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  const Napi::Array frames = info[0].As<Napi::Array>();
+  Napi::Array groups = Napi::Array::New(env);
+  uint32_t count = 0;
+  tcp_offload::TcpGroCoalescer gro;
+  const auto flush = [&]() {
+    if (gro.empty()) {
+      return;
+    }
+    TunGsoInfo gso;
+    const bool super_packet = gro.segments() > 1;
+    if (super_packet) {
+      gro.Finish(gso);
+    }
+    groups.Set(count++, GroupToObject(env, gro.data(), gro.size(), gro.segments(),
+                                      super_packet ? &gso : nullptr));
+    gro.Reset();
+  };
+  for (uint32_t i = 0; i < frames.Length(); ++i) {
+    const Napi::Value value = frames.Get(i);
+    if (!value.IsBuffer()) {
+      Napi::TypeError::New(env, "Expected an array of Buffers").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    const Napi::Buffer<uint8_t> frame = value.As<Napi::Buffer<uint8_t>>();
+    if (gro.Add(frame.Data(), frame.Length())) {
+      continue;
+    }
+    flush();
+    if (!gro.Add(frame.Data(), frame.Length())) {
+      groups.Set(count++, GroupToObject(env, frame.Data(), frame.Length(), 1, nullptr));
+    }
+  }
+  flush();
+  return groups;
+}
+
+// segment(packet: Buffer, tcpOffset, segmentSize, maxPacket): Buffer[]
+Napi::Value Segment(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 4 || !info[0].IsBuffer() || !info[1].IsNumber() || !info[2].IsNumber() ||
+      !info[3].IsNumber()) {
+    Napi::TypeError::New(env, "Expected (packet, tcpOffset, segmentSize, maxPacket)")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  const Napi::Buffer<uint8_t> packet = info[0].As<Napi::Buffer<uint8_t>>();
+  const size_t tcp_offset = info[1].As<Napi::Number>().Uint32Value();
+  const size_t segment_size = info[2].As<Napi::Number>().Uint32Value();
+  const size_t max_packet = info[3].As<Napi::Number>().Uint32Value();
+  tcp_offload::TcpSegmenter segmenter;
+  if (!segmenter.Load(packet.Data(), packet.Length(), tcp_offset, segment_size, max_packet)) {
+    Napi::Error::New(env, "Not a TCP/IPv6 super-packet").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  std::vector<uint8_t> scratch(max_packet);
+  Napi::Array segments = Napi::Array::New(env);
+  uint32_t count = 0;
+  while (segmenter.pending()) {
+    const size_t len = segmenter.Next(scratch.data());
+    segments.Set(count++, Napi::Buffer<uint8_t>::Copy(env, scratch.data(), len));
+  }
+  return segments;
+}
+
+}  // namespace
+
+Napi::Object InitTcpOffload(Napi::Env env, Napi::Object exports) {
+  Napi::Object tcp_offload = Napi::Object::New(env);
+  tcp_offload.Set("coalesce", Napi::Function::New(env, Coalesce, "coalesce"));
+  tcp_offload.Set("segment", Napi::Function::New(env, Segment, "segment"));
+  exports.Set("tcpOffload", tcp_offload);
+  return exports;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <napi.h>
+
+#include "tun_backend.h"
+
+namespace tcp_offload {
+
+constexpr size_t kIpv6HeaderSize = 40;
+constexpr size_t kTcpChecksumOffset = 16;
+constexpr uint8_t kProtoTcp = 6;
+
+/** Largest IPv6 packet a GSO write may carry (payload length is 16 bits). */
+constexpr size_t kMaxSuperPacket = kIpv6HeaderSize + 0xffff;
+
+/** One's-complement sum of `data` added to `sum` (not folded). */
+uint32_t ChecksumAdd(uint32_t sum, const uint8_t* data, size_t len);
+
+/** Folds a 32-bit one's-complement sum to 16 bits (not inverted). */
+uint16_t ChecksumFold(uint32_t sum);
+
+/** Sum of the IPv6 pseudo header for an upper-layer packet of `upper_len` bytes. */
+uint32_t Ipv6PseudoHeaderSum(const uint8_t* ipv6_header, uint32_t upper_len, uint8_t protocol);
+
+/**
+ * Finishes a checksum the kernel left partial (virtio `NEEDS_CSUM`): the field
+ * at `csum_start + csum_offset` already holds the pseudo-header sum. Returns
+ * false when the offsets do not fit in `len`.
+ */
+bool CompletePartialChecksum(uint8_t* packet, size_t len, size_t csum_start, size_t csum_offset);
+
+/**
+ * Merges consecutive in-order TCP/IPv6 segments of one flow into a single
+ * super-packet for `TunPlatformBackend::WriteGsoPacket` (receive-side GRO,
+ * following the rules of the kernel's tcp_gro_receive and wireguard-go).
+ *
+ * Only plain IPv6 + TCP packets with ACK (optionally PSH) and a non-empty
+ * payload qualify; segments must match the head's addresses, ports, ACK
+ * number and option bytes, continue its sequence number, and be no larger
+ * than the first segment. A short segment or PSH closes the group. Checksums
+ * are verified before a segment is absorbed, because the kernel does not
+ * re-check a GSO packet it is handed.
+ */
+class TcpGroCoalescer {
+public:
+  TcpGroCoalescer();
+
+  /**
+   * Absorbs `frame` into the current group (or starts one when empty).
+   * Returns false when it does not fit: the caller flushes the group and
+   * retries once, then writes the frame as-is if it is still refused.
+   */
+  bool Add(const uint8_t* frame, size_t len);
+
+  bool empty() const { return segments_ == 0; }
+  size_t segments() const { return segments_; }
+
+  /**
+   * Finalizes the super-packet headers and fills `gso`. Only meaningful with
+   * more than one segment; a single segment is still the original packet.
+   */
+  void Finish(TunGsoInfo& gso);
+
+  const uint8_t* data() const { return buffer_.data(); }
+  size_t size() const { return buffer_.size(); }
+
+  void Reset();
+
+private:
+  bool Start(const uint8_t* frame, size_t len, size_t tcp_header_len);
+
+  std::vector<uint8_t> buffer_;
+  size_t segments_ = 0;
+  size_t tcp_header_len_ = 0;
+  size_t segment_size_ = 0;
+  uint32_t next_seq_ = 0;
+  bool closed_ = false;
+};
+
+/**
+ * Splits a TSO super-packet read from the device into MSS-sized TCP segments
+ * (user-space GSO for the host-to-device direction).
+ *
+ * `Load()` borrows the super-packet; the caller keeps it alive and unchanged
+ * until `pending()` turns false. Each `Next()` copies the headers, advances the
+ * sequence number, keeps FIN/PSH only on the last segment and CWR only on the
+ * first, and computes a full TCP checksum.
+ */
+class TcpSegmenter {
+public:
+  /**
+   * `tcp_offset` is the TCP header position (the virtio `csum_start`);
+   * segments carry at most `segment_size` payload bytes and at most
+   * `max_packet` bytes overall. False when the packet is not a usable
+   * TCP/IPv6 super-packet.
+   */
+  bool Load(const uint8_t* packet,
+            size_t len,
+            size_t tcp_offset,
+            size_t segment_size,
+            size_t max_packet);
+
+  bool pending() const { return packet_ != nullptr; }
+  size_t segments_emitted() const { return emitted_; }
+
+  /** Writes the next segment to `out` (at least `max_packet` bytes); returns its length. */
+  size_t Next(uint8_t* out);
+
+  void Reset();
+
+private:
+  const uint8_t* packet_ = nullptr;
+  size_t len_ = 0;
+  size_t tcp_offset_ = 0;
+  size_t header_len_ = 0;
+  size_t segment_size_ = 0;
+  size_t offset_ = 0;
+  size_t emitted_ = 0;
+  uint32_t seq_ = 0;
+};
+
+}  // namespace tcp_offload
+
+/**
+ * Exports `tcpOffload: {coalesce, segment}`, which run TcpGroCoalescer and
+ * TcpSegmenter over JS buffers. Test hooks only; not part of the public API.
+ */
+Napi::Object InitTcpOffload(Napi::Env env, Napi::Object exports);
@@ -0,0 +1,176 @@
+#include "thread_tuning.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "debug_log.h"
+
+namespace {
+
+// Tuning is best effort: unprivileged processes are routinely refused
+// SCHED_FIFO or affinity, so failures only go to the debug log.
+void WarnTuning(const char* name, const std::string& what) {
+  tuntap::FwdDebug("thread-tuning-failed", "thread=%s %s", name, what.c_str());
+}
+
+#ifndef _WIN32
+std::string ErrnoText(int err) {
+  return std::string(strerror(err)) + " (errno " + std::to_string(err) + ")";
+}
+
+bool ToPosixPolicy(ThreadSchedPolicy policy, int& out) {
+  switch (policy) {
+    case ThreadSchedPolicy::kOther:
+      out = SCHED_OTHER;
+      return true;
+    case ThreadSchedPolicy::kFifo:
+      out = SCHED_FIFO;
+      return true;
+    case ThreadSchedPolicy::kRoundRobin:
+      out = SCHED_RR;
+      return true;
+#ifdef __linux__
+    case ThreadSchedPolicy::kBatch:
+      out = SCHED_BATCH;
+      return true;
+    case ThreadSchedPolicy::kIdle:
+      out = SCHED_IDLE;
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+#endif
+
+void ApplyAffinity(const char* name, const std::vector<int>& cpus) {
+  if (cpus.empty()) {
+    return;
+  }
+#ifdef __linux__
+  static_assert(kMaxThreadCpus == CPU_SETSIZE, "kMaxThreadCpus mirrors CPU_SETSIZE");
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      WarnTuning(name, "CPU index " + std::to_string(cpu) + " is out of range");
+      return;
+    }
+    CPU_SET(cpu, &set);
+  }
+  const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (rc != 0) {
+    WarnTuning(name, "pthread_setaffinity_np failed: " + ErrnoText(rc));
+  }
+#elif defined(_WIN32)
+  DWORD_PTR mask = 0;
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+      WarnTuning(name, "CPU index " + std::to_string(cpu) + " is out of range");
+      return;
+    }
+    mask |= static_cast<DWORD_PTR>(1) << cpu;
+  }
+  if (::SetThreadAffinityMask(::GetCurrentThread(), mask) == 0) {
+    WarnTuning(name, "SetThreadAffinityMask failed: " + std::to_string(::GetLastError()));
+  }
+#else
+  // macOS only offers affinity tags (a hint for cache sharing), not pinning.
+  WarnTuning(name, "CPU pinning is not supported on this platform");
+#endif
+}
+
+void ApplyPolicy(const char* name, const ThreadTuning& tuning) {
+  if (tuning.policy == ThreadSchedPolicy::kInherit) {
+    return;
+  }
+#ifdef _WIN32
+  // Closest Win32 equivalent: real-time classes map to the highest thread
+  // priority, background classes to the lowest.
+  int priority = THREAD_PRIORITY_NORMAL;
+  switch (tuning.policy) {
+    case ThreadSchedPolicy::kFifo:
+    case ThreadSchedPolicy::kRoundRobin:
+      priority = THREAD_PRIORITY_TIME_CRITICAL;
+      break;
+    case ThreadSchedPolicy::kBatch:
+      priority = THREAD_PRIORITY_BELOW_NORMAL;
+      break;
+    case ThreadSchedPolicy::kIdle:
+      priority = THREAD_PRIORITY_IDLE;
+      break;
+    default:
+      break;
+  }
+  if (!::SetThreadPriority(::GetCurrentThread(), priority)) {
+    WarnTuning(name, "SetThreadPriority failed: " + std::to_string(::GetLastError()));
+  }
+#else
+  int policy = SCHED_OTHER;
+  if (!ToPosixPolicy(tuning.policy, policy)) {
+    WarnTuning(name, "scheduling policy is not supported on this platform");
+    return;
+  }
+  struct sched_param param {};
+  param.sched_priority =
+      (policy == SCHED_FIFO || policy == SCHED_RR) ? tuning.priority : 0;
+  const int rc = pthread_setschedparam(pthread_self(), policy, &param);
+  if (rc != 0) {
+    WarnTuning(name, "pthread_setschedparam failed: " + ErrnoText(rc));
+  }
+#endif
+}
+
+void ApplyNice(const char* name, const ThreadTuning& tuning) {
+  if (!tuning.has_nice) {
+    return;
+  }
+#ifdef __linux__
+  // On Linux the nice value is per thread when addressed by TID.
+  const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+  if (setpriority(PRIO_PROCESS, static_cast<id_t>(tid), tuning.nice) != 0) {
+    WarnTuning(name, "setpriority failed: " + ErrnoText(errno));
+  }
+#else
+  // macOS and Windows only apply nice values process-wide.
+  WarnTuning(name, "per-thread nice is not supported on this platform");
+#endif
+}
+
+}  // namespace
+
+void SetCurrentThreadName(const char* name) {
+#ifdef __linux__
+  char truncated[16];
+  snprintf(truncated, sizeof(truncated), "%s", name);
+  pthread_setname_np(pthread_self(), truncated);
+#elif defined(__APPLE__)
+  pthread_setname_np(name);
+#elif defined(_WIN32)
+  wchar_t wide[64];
+  const int len = ::MultiByteToWideChar(CP_UTF8, 0, name, -1, wide, 64);
+  if (len > 0) {
+    ::SetThreadDescription(::GetCurrentThread(), wide);
+  }
+#endif
+}
+
+void ApplyThreadTuning(const char* name, const ThreadTuning& tuning) {
+  SetCurrentThreadName(name);
+  ApplyAffinity(name, tuning.cpus);
+  ApplyPolicy(name, tuning);
+  ApplyNice(name, tuning);
+}
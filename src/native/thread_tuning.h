@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+/** Scheduling class requested for a forwarder thread. */
+enum class ThreadSchedPolicy {
+  kInherit,  // leave whatever the thread inherited from Node
+  kOther,    // SCHED_OTHER
+  kBatch,    // SCHED_BATCH (Linux)
+  kIdle,     // SCHED_IDLE (Linux)
+  kFifo,     // SCHED_FIFO, needs `priority` and usually CAP_SYS_NICE
+  kRoundRobin,  // SCHED_RR, needs `priority` and usually CAP_SYS_NICE
+};
+
+/** CPU indices an affinity list may use: 0 to this minus one (glibc's CPU_SETSIZE). */
+inline constexpr int kMaxThreadCpus = 1024;
+
+/** Per-thread placement and scheduling; every field is optional. */
+struct ThreadTuning {
+  // CPUs the thread may run on; empty leaves the affinity alone.
+  std::vector<int> cpus;
+  ThreadSchedPolicy policy = ThreadSchedPolicy::kInherit;
+  // Static priority for kFifo / kRoundRobin (1-99 on Linux).
+  int priority = 0;
+  bool has_nice = false;
+  int nice = 0;
+};
+
+/**
+ * Names the calling thread (visible in `top -H`, `perf`, debuggers). Names
+ * longer than the platform limit (15 bytes on Linux) are truncated.
+ */
+void SetCurrentThreadName(const char* name);
+
+/**
+ * Names the calling thread and applies `tuning` to it. Best effort: settings
+ * the OS refuses (missing privileges, unsupported on this platform) are
+ * only reported in the native debug log, and the thread keeps running
+ * untuned.
+ */
+void ApplyThreadTuning(const char* name, const ThreadTuning& tuning);
+
+/** Hint to the CPU that the caller is busy-waiting. */
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#endif
+}
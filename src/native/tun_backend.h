@@ -21,6 +21,53 @@ using ssize_t = SSIZE_T;
 
 #include <uv.h>
 
+#include "packet_batch.h"
+#include "packet_pool.h"
+
+class WakeupEvent;
+
+/** Upper bound on `TunOpenOptions::queues`. */
+constexpr size_t kMaxTunQueues = 16;
+
+/** Device-level settings fixed when the backend is created. */
+struct TunOpenOptions {
+  // Linux: open the device with IFF_VNET_HDR and checksum offload so the
+  // forwarder can inject coalesced TCP super-packets (see WriteGsoPacket).
+  // Other platforms ignore it.
+  bool offload = false;
+  // Linux: attach this many queues to the interface (IFF_MULTI_QUEUE). The
+  // kernel spreads host-originated flows across them by flow hash. Other
+  // platforms always have one queue.
+  size_t queues = 1;
+  // Linux builds with liburing: drive reads and writes through io_uring with
+  // registered buffers (single-queue devices only). Falls back to plain
+  // read()/write() when the build or the kernel lacks io_uring.
+  bool io_uring = false;
+};
+
+/**
+ * Segmentation metadata for {@link TunPlatformBackend::WriteGsoPacket}. All
+ * offsets are relative to the start of the IPv6 header.
+ */
+struct TunGsoInfo {
+  uint16_t header_length = 0;  // IPv6 + TCP header bytes repeated in every segment
+  uint16_t segment_size = 0;   // TCP payload bytes per segment (last may be shorter)
+  uint16_t csum_start = 0;     // first byte covered by the TCP checksum
+  uint16_t csum_offset = 0;    // checksum field offset from `csum_start`
+};
+
+/** Receive-loop settings (see TunPlatformBackend::StartReceiveLoop). */
+struct ReceiveLoopOptions {
+  // Largest packet delivered; longer packets are truncated.
+  size_t buffer_size = 65535;
+  // Non-zero switches to batched delivery: every PacketCallback then carries
+  // up to this many packets packed as described in receive_coalescer.h.
+  size_t max_batch = 0;
+  // Batched delivery only: how long a partial batch may wait for more
+  // packets while the device is busy (0 delivers every wakeup at once).
+  uint32_t max_delay_us = 0;
+};
+
 enum class ReadPacketStatus {
   Data,
   NoData,
@@ -42,8 +89,10 @@ public:
   // Invoked once per packet read by the receive loop. Always called on a
   // background thread (libuv loop thread on POSIX, worker thread on Windows);
   // the caller in `tuntap.cc` is responsible for marshalling onto the JS
-  // thread via `Napi::ThreadSafeFunction`.
-  using PacketCallback = std::function<bool(std::vector<uint8_t>)>;
+  // thread via `Napi::ThreadSafeFunction`. Packets come from the process-wide
+  // PacketPool so steady-state delivery does not touch the heap. With
+  // `ReceiveLoopOptions::max_batch` each call carries a packed batch instead.
+  using PacketCallback = std::function<bool(PooledPacket)>;
 
   // Invoked at most once when the receive loop encounters a fatal error and
   // stops. The receive loop must not deliver any further packets afterwards.
@@ -64,16 +113,128 @@ public:
                               size_t length,
                               std::string& error) = 0;
 
-  // Block until a packet can be read/written or `running` becomes false.
-  // Implementations may use short timed waits when the platform does not expose
-  // an explicit writable event.
-  virtual bool WaitReadable(const std::atomic<bool>& running, std::string& error) = 0;
-  virtual bool WaitWritable(const std::atomic<bool>& running, std::string& error) = 0;
+  // Batch I/O, the primary data path; ReadPacket/WritePacket are thin
+  // single-packet wrappers over the same code.
+  //
+  // `ReadPackets` appends packets until `batch` is full or nothing more is
+  // ready, truncating each to `max_payload_size` and stamping the receive time
+  // and flow hash. kOk when at least one packet was appended (a failure after
+  // that surfaces on the next call), kWouldBlock when none was ready.
+  //
+  // `WritePackets` writes from `batch.cursor()` on, advancing past each packet
+  // written. kOk once drained, kWouldBlock when the device pushed back (wait
+  // with WaitWritable and call again). kError/kClosed set `batch.error_code()`.
+  virtual TunIoStatus ReadPackets(PacketBatch& batch, size_t max_payload_size) = 0;
+  virtual TunIoStatus WritePackets(PacketBatch& batch) = 0;
+
+  // Reads one packet straight into caller memory, truncated to `capacity`.
+  // kOk sets `length`; kError/kClosed set `error_code` as for batches.
+  virtual TunIoStatus ReadPacketInto(uint8_t* buffer,
+                                     size_t capacity,
+                                     size_t& length,
+                                     int& error_code) = 0;
+
+  // True when the device was opened with `TunOpenOptions::offload` and the
+  // kernel accepted it, i.e. `WriteGsoPacket` is usable.
+  virtual bool OffloadEnabled() const { return false; }
+
+  // True while packets already taken off the device (segments of a TSO
+  // super-packet) are waiting to be returned by `ReadPacket`. Readiness waits
+  // do not see these, so drain them before waiting again.
+  virtual bool HasBufferedPackets() const { return false; }
+
+  // True when reads and writes go through io_uring (`TunOpenOptions::io_uring`
+  // was honoured). The native fd is then not a readiness source: reads are
+  // already in flight on it, so `GetQueueFd(0)` is the completion eventfd.
+  virtual bool IoUringEnabled() const { return false; }
+
+  // Hands writes queued by `WritePacket`/`WriteGsoPacket` to the kernel and
+  // reports any asynchronous write failure. Writers call it at the end of a
+  // burst; a no-op for backends that write synchronously.
+  virtual bool FlushWrites(std::string& error) {
+    (void)error;
+    return true;
+  }
+
+  // --- multi-queue devices ---
+  //
+  // `ReadPacket`/`WaitReadable` cover every attached queue, so single-reader
+  // callers need not care. Callers that dedicate a reader to each queue use
+  // the per-queue variants instead; writes may go through any queue and use
+  // queue 0. Backends without multi-queue support expose exactly one queue.
+
+  // Queues opened with the device.
+  virtual size_t QueueCount() const { return 1; }
+  // Queues currently attached (receiving traffic); always a prefix 0..n-1.
+  virtual size_t ActiveQueueCount() const { return 1; }
+  // Attach queues [0, count) and detach the rest so the kernel stops steering
+  // flows to queues nobody reads.
+  virtual bool SetActiveQueues(size_t count, std::string& error) {
+    if (count == 1) {
+      return true;
+    }
+    error = "TUN device has a single queue";
+    return false;
+  }
+  virtual int GetQueueFd(size_t queue) const { return queue == 0 ? GetNativeFd() : -1; }
+  virtual ReadPacketStatus ReadQueuePacket(size_t queue,
+                                           size_t max_payload_size,
+                                           std::vector<uint8_t>& out,
+                                           std::string& error) {
+    (void)queue;
+    return ReadPacket(max_payload_size, out, error);
+  }
+  virtual bool WaitQueueReadable(size_t queue,
+                                 const std::atomic<bool>& running,
+                                 const WakeupEvent* wakeup,
+                                 std::string& error) {
+    (void)queue;
+    return WaitReadable(running, wakeup, error);
+  }
+  virtual bool HasBufferedQueuePackets(size_t queue) const {
+    (void)queue;
+    return HasBufferedPackets();
+  }
+
+  // Write one TCP/IPv6 super-packet whose checksum field holds the folded
+  // pseudo-header sum; the kernel segments it by `gso.segment_size` and
+  // finishes the checksums. Same return convention as `WritePacket`.
+  virtual ssize_t WriteGsoPacket(const uint8_t* data,
+                                 size_t length,
+                                 const TunGsoInfo& gso,
+                                 std::string& error) {
+    (void)data;
+    (void)length;
+    (void)gso;
+    error = "TUN segmentation offload is not supported on this platform";
+    return -1;
+  }
+
+  // Block until a packet can be read/written, `wakeup` is signalled, or
+  // `running` becomes false. With a `wakeup` the wait is indefinite and the
+  // caller signals it after clearing `running`; without one, implementations
+  // re-check `running` on a short timer. Implementations may also use short
+  // timed waits when the platform does not expose an explicit writable event.
+  virtual bool WaitReadable(const std::atomic<bool>& running,
+                            const WakeupEvent* wakeup,
+                            std::string& error) = 0;
+  virtual bool WaitWritable(const std::atomic<bool>& running,
+                            const WakeupEvent* wakeup,
+                            std::string& error) = 0;
+
+  // WaitReadable bounded by `timeout_ms` (negative waits indefinitely): also
+  // returns false, leaving `error` empty, once that long has passed without
+  // the device becoming readable.
+  virtual bool WaitReadableFor(int timeout_ms,
+                               const std::atomic<bool>& running,
+                               const WakeupEvent* wakeup,
+                               std::string& error) = 0;
 
   // Begin asynchronous packet delivery. `loop` is supplied by Node-API and is
-  // used by POSIX backends for `uv_poll_init`; Windows ignores it.
+  // used by POSIX backends for `uv_poll_init` (one poll handle per active
+  // queue) and the batch hold timer; Windows ignores it.
   virtual bool StartReceiveLoop(uv_loop_t* loop,
-                                size_t buffer_size,
+                                const ReceiveLoopOptions& options,
                                 PacketCallback on_packet,
                                 ErrorCallback on_error,
                                 std::string& error) = 0;
@@ -88,4 +249,5 @@ public:
   virtual int GetNativeFd() const { return -1; }
 };
 
-std::unique_ptr<TunPlatformBackend> CreatePlatformBackend();
+std::unique_ptr<TunPlatformBackend> CreatePlatformBackend(
+    const TunOpenOptions& options = TunOpenOptions());
@@ -8,6 +8,7 @@
 #include <sys/kern_control.h>
 #include <sys/socket.h>
 #include <sys/sys_domain.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <net/if_utun.h>
@@ -83,67 +84,68 @@ public:
     return true;
   }
 
-  ReadPacketStatus ReadPacket(size_t max_payload_size,
-                              std::vector<uint8_t>& out,
-                              std::string& error) override {
+protected:
+  // utun prefixes every packet with a 4-byte address family; scatter/gather
+  // it into a local word so the payload lands directly in the caller's buffer.
+  TunIoStatus ReadInto(uint8_t* buffer,
+                       size_t capacity,
+                       size_t& length,
+                       int& error_code) override {
     if (!fd_.is_valid()) {
-      error = "Device not open";
-      return ReadPacketStatus::Error;
+      error_code = EBADF;
+      return TunIoStatus::kError;
     }
 
-    const size_t read_cap = max_payload_size + kUtunHeaderSize;
-    if (read_frame_.size() < read_cap) {
-      read_frame_.resize(read_cap);
-    }
-    ssize_t bytes_read = read(fd_.get(), read_frame_.data(), read_cap);
+    uint32_t family = 0;
+    struct iovec iov[2];
+    iov[0].iov_base = &family;
+    iov[0].iov_len = kUtunHeaderSize;
+    iov[1].iov_base = buffer;
+    iov[1].iov_len = capacity;
+    const ssize_t bytes_read = readv(fd_.get(), iov, 2);
     if (bytes_read < 0) {
       if (errno == EAGAIN || errno == EWOULDBLOCK) {
-        out.clear();
-        return ReadPacketStatus::NoData;
+        return TunIoStatus::kWouldBlock;
       }
-      error = std::string("Read error: ") + strerror(errno);
-      return ReadPacketStatus::Error;
+      error_code = errno;
+      return TunIoStatus::kError;
     }
     if (bytes_read == 0) {
-      out.clear();
-      return ReadPacketStatus::Closed;
+      return TunIoStatus::kClosed;
     }
     if (bytes_read <= static_cast<ssize_t>(kUtunHeaderSize)) {
-      out.clear();
-      return ReadPacketStatus::NoData;
+      return TunIoStatus::kWouldBlock;
     }
 
-    const auto payload_len = static_cast<size_t>(bytes_read - kUtunHeaderSize);
-    out.resize(payload_len);
-    memcpy(out.data(), read_frame_.data() + kUtunHeaderSize, payload_len);
-    return ReadPacketStatus::Data;
+    length = static_cast<size_t>(bytes_read) - kUtunHeaderSize;
+    return TunIoStatus::kOk;
   }
 
-  ssize_t WritePacket(const uint8_t* data,
-                      size_t length,
-                      std::string& error) override {
+  TunIoStatus WriteFrom(const uint8_t* data, size_t length, int& error_code) override {
     if (!fd_.is_valid()) {
-      error = "Device not open";
-      return -1;
+      error_code = EBADF;
+      return TunIoStatus::kError;
     }
 
-    write_frame_.resize(length + kUtunHeaderSize);
     uint32_t family = htonl(AF_INET6);
-    memcpy(write_frame_.data(), &family, kUtunHeaderSize);
-    memcpy(write_frame_.data() + kUtunHeaderSize, data, length);
-
-    ssize_t bytes_written = write(fd_.get(), write_frame_.data(), write_frame_.size());
+    struct iovec iov[2];
+    iov[0].iov_base = &family;
+    iov[0].iov_len = kUtunHeaderSize;
+    iov[1].iov_base = const_cast<uint8_t*>(data);
+    iov[1].iov_len = length;
+    const ssize_t bytes_written = writev(fd_.get(), iov, 2);
     if (bytes_written < 0) {
       if (errno == EAGAIN || errno == EWOULDBLOCK) {
-        return 0;
+        return TunIoStatus::kWouldBlock;
       }
-      error = std::string("Write error: ") + strerror(errno);
-      return -1;
+      error_code = errno;
+      return TunIoStatus::kError;
     }
-
-    return bytes_written > static_cast<ssize_t>(kUtunHeaderSize)
-               ? bytes_written - static_cast<ssize_t>(kUtunHeaderSize)
-               : 0;
+    if (static_cast<size_t>(bytes_written) < kUtunHeaderSize + length) {
+      error_code = EIO;
+      return TunIoStatus::kError;
+    }
+    return TunIoStatus::kOk;
   }
 
 private:
@@ -173,13 +175,13 @@ private:
     return false;
   }
 
-  std::vector<uint8_t> read_frame_;
-  std::vector<uint8_t> write_frame_;
 };
 
 } // namespace
 
-std::unique_ptr<TunPlatformBackend> CreatePlatformBackend() {
+std::unique_ptr<TunPlatformBackend> CreatePlatformBackend(const TunOpenOptions& options) {
+  // Segmentation offload is Linux-only; utun/Wintun always move plain packets.
+  (void)options;
   return std::make_unique<DarwinTunBackend>();
 }
 
@@ -1,123 +1,16 @@
 #ifdef __linux__
 
-#include "tun_backend.h"
+#include "tun_backend_linux.h"
 
-#include <errno.h>
-#include <fcntl.h>
-#include <string.h>
-#include <sys/ioctl.h>
-#include <sys/stat.h>
-#include <unistd.h>
+#include <memory>
 
-#include <linux/if.h>
-#include <linux/if_tun.h>
-
-#include <utility>
-
-#include "file_descriptor.h"
-#include "posix_tun_backend.h"
-#include "posix_uv_poll_loop.h"
-
-namespace {
-
-constexpr const char* kTunDevicePath = "/dev/net/tun";
-
-class LinuxTunBackend : public PosixTunBackend {
-public:
-  bool OpenDevice(const std::string& requested_name,
-                  std::string& out_interface_name,
-                  std::string& error) override {
-    struct stat statbuf;
-    if (stat(kTunDevicePath, &statbuf) != 0) {
-      error =
-          "TUN/TAP device not available: /dev/net/tun does not exist. "
-          "Please ensure the TUN/TAP kernel module is loaded (modprobe tun).";
-      return false;
-    }
-
-    FileDescriptor temp_fd(open(kTunDevicePath, O_RDWR));
-    if (!temp_fd.is_valid()) {
-      error =
-          std::string("Failed to open ") + kTunDevicePath + ": " + strerror(errno) +
-          ". This usually means you don't have sufficient permissions. "
-          "Try running with sudo or add your user to the 'tun' group.";
-      return false;
-    }
-
-    struct ifreq ifr;
-    memset(&ifr, 0, sizeof(ifr));
-    ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
-
-    if (!requested_name.empty()) {
-      strncpy(ifr.ifr_name, requested_name.c_str(), IFNAMSIZ - 1);
-      ifr.ifr_name[IFNAMSIZ - 1] = '\0';
-    }
-
-    if (ioctl(temp_fd.get(), TUNSETIFF, &ifr) < 0) {
-      error = std::string("Failed to configure TUN device: ") + strerror(errno);
-      return false;
-    }
-
-    if (!SetNonBlocking(temp_fd.get(), error)) {
-      return false;
-    }
-
-    fd_ = std::move(temp_fd);
-    interface_name_ = std::string(ifr.ifr_name);
-    out_interface_name = interface_name_;
-    return true;
-  }
-
-  ReadPacketStatus ReadPacket(size_t max_payload_size,
-                              std::vector<uint8_t>& out,
-                              std::string& error) override {
-    if (!fd_.is_valid()) {
-      error = "Device not open";
-      return ReadPacketStatus::Error;
-    }
-
-    out.resize(max_payload_size);
-    ssize_t bytes_read = read(fd_.get(), out.data(), out.size());
-    if (bytes_read < 0) {
-      if (errno == EAGAIN || errno == EWOULDBLOCK) {
-        out.clear();
-        return ReadPacketStatus::NoData;
-      }
-      error = std::string("Read error: ") + strerror(errno);
-      return ReadPacketStatus::Error;
-    }
-    if (bytes_read == 0) {
-      out.clear();
-      return ReadPacketStatus::Closed;
-    }
-
-    out.resize(static_cast<size_t>(bytes_read));
-    return ReadPacketStatus::Data;
+std::unique_ptr<TunPlatformBackend> CreatePlatformBackend(const TunOpenOptions& options) {
+#ifdef TUNTAP_HAVE_LIBURING
+  if (options.io_uring) {
+    return CreateUringTunBackend(options);
   }
-
-  ssize_t WritePacket(const uint8_t* data,
-                      size_t length,
-                      std::string& error) override {
-    if (!fd_.is_valid()) {
-      error = "Device not open";
-      return -1;
-    }
-    ssize_t bytes_written = write(fd_.get(), data, length);
-    if (bytes_written < 0) {
-      if (errno == EAGAIN || errno == EWOULDBLOCK) {
-        return 0;
-      }
-      error = std::string("Write error: ") + strerror(errno);
-      return -1;
-    }
-    return bytes_written;
-  }
-};
-
-} // namespace
-
-std::unique_ptr<TunPlatformBackend> CreatePlatformBackend() {
-  return std::make_unique<LinuxTunBackend>();
+#endif
+  return std::make_unique<LinuxTunBackend>(options);
 }
 
 #endif
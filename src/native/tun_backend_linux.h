@@ -0,0 +1,467 @@
+#pragma once
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <linux/if.h>
+#include <linux/if_tun.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "file_descriptor.h"
+#include "posix_tun_backend.h"
+#include "tcp_offload.h"
+#include "tun_backend.h"
+
+
+inline constexpr const char* kTunDevicePath = "/dev/net/tun";
+
+// Mirrors `struct virtio_net_hdr` from <linux/virtio_net.h>, which does not
+// compile as C++ (one of its structs has a member named `class`). Fields are
+// in host byte order, the TUN default.
+struct VirtioNetHdr {
+  uint8_t flags;
+  uint8_t gso_type;
+  uint16_t hdr_len;
+  uint16_t gso_size;
+  uint16_t csum_start;
+  uint16_t csum_offset;
+};
+static_assert(sizeof(VirtioNetHdr) == 10, "virtio_net_hdr is 10 bytes");
+
+inline constexpr uint8_t kVirtioNetHdrFNeedsCsum = 1;
+inline constexpr uint8_t kVirtioNetHdrGsoNone = 0;
+inline constexpr uint8_t kVirtioNetHdrGsoTcpV6 = 4;
+
+// `/dev/net/tun` backend: plain read()/write() on non-blocking fds, with
+// optional virtio-net offload and multi-queue support (see TunOpenOptions).
+class LinuxTunBackend : public PosixTunBackend {
+public:
+  explicit LinuxTunBackend(const TunOpenOptions& options) : options_(options) {}
+
+  bool OpenDevice(const std::string& requested_name,
+                  std::string& out_interface_name,
+                  std::string& error) override {
+    struct stat statbuf;
+    if (stat(kTunDevicePath, &statbuf) != 0) {
+      error =
+          "TUN/TAP device not available: /dev/net/tun does not exist. "
+          "Please ensure the TUN/TAP kernel module is loaded (modprobe tun).";
+      return false;
+    }
+    if (options_.queues == 0 || options_.queues > kMaxTunQueues) {
+      error = "TUN queue count must be between 1 and " + std::to_string(kMaxTunQueues);
+      return false;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+    if (options_.offload) {
+      ifr.ifr_flags |= IFF_VNET_HDR;
+    }
+    if (options_.queues > 1) {
+      ifr.ifr_flags |= IFF_MULTI_QUEUE;
+    }
+
+    if (!requested_name.empty()) {
+      strncpy(ifr.ifr_name, requested_name.c_str(), IFNAMSIZ - 1);
+      ifr.ifr_name[IFNAMSIZ - 1] = '\0';
+    }
+
+    // With IFF_MULTI_QUEUE every TUNSETIFF on a fresh fd attaches another
+    // queue to the same interface; the first call picks the name.
+    std::vector<FileDescriptor> fds;
+    for (size_t queue = 0; queue < options_.queues; ++queue) {
+      FileDescriptor temp_fd(open(kTunDevicePath, O_RDWR));
+      if (!temp_fd.is_valid()) {
+        error =
+            std::string("Failed to open ") + kTunDevicePath + ": " + strerror(errno) +
+            ". This usually means you don't have sufficient permissions. "
+            "Try running with sudo or add your user to the 'tun' group.";
+        return false;
+      }
+
+      if (ioctl(temp_fd.get(), TUNSETIFF, &ifr) < 0) {
+        error = std::string("Failed to configure TUN device: ") + strerror(errno);
+        return false;
+      }
+
+      if (options_.offload && !EnableOffload(temp_fd.get(), error)) {
+        return false;
+      }
+
+      if (!SetNonBlocking(temp_fd.get(), error)) {
+        return false;
+      }
+      fds.push_back(std::move(temp_fd));
+    }
+
+    fd_ = std::move(fds[0]);
+    extra_fds_.clear();
+    for (size_t queue = 1; queue < fds.size(); ++queue) {
+      extra_fds_.push_back(std::move(fds[queue]));
+    }
+    queue_state_.clear();
+    queue_state_.resize(options_.queues);
+    vnet_hdr_ = options_.offload;
+    if (vnet_hdr_) {
+      for (QueueState& state : queue_state_) {
+        state.vnet_buffer.reset(new uint8_t[tcp_offload::kMaxSuperPacket]);
+      }
+    }
+    active_queues_ = options_.queues;
+    next_queue_ = 0;
+    interface_name_ = std::string(ifr.ifr_name);
+    out_interface_name = interface_name_;
+    return true;
+  }
+
+  void CloseDevice() override {
+    PosixTunBackend::CloseDevice();
+    extra_fds_.clear();
+    queue_state_.clear();
+    active_queues_ = 1;
+    next_queue_ = 0;
+    vnet_hdr_ = false;
+  }
+
+  bool OffloadEnabled() const override { return vnet_hdr_; }
+
+  bool HasBufferedPackets() const override {
+    for (size_t queue = 0; queue < active_queues_; ++queue) {
+      if (HasBufferedQueuePackets(queue)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool HasBufferedQueuePackets(size_t queue) const override {
+    return queue < queue_state_.size() && queue_state_[queue].segmenter.pending();
+  }
+
+  size_t QueueCount() const override { return fd_.is_valid() ? 1 + extra_fds_.size() : 1; }
+
+  size_t ActiveQueueCount() const override { return active_queues_; }
+
+  bool SetActiveQueues(size_t count, std::string& error) override {
+    if (!fd_.is_valid()) {
+      error = "Device not open";
+      return false;
+    }
+    const size_t total = QueueCount();
+    if (count == 0 || count > total) {
+      error = "Active queue count must be between 1 and " + std::to_string(total);
+      return false;
+    }
+    // Queue 0 carries every write, so it is never detached. The kernel
+    // rejects attaching an attached queue (and vice versa), so only toggle
+    // queues whose state changes.
+    for (size_t queue = 1; queue < total; ++queue) {
+      const bool attach = queue < count;
+      if (attach == (queue < active_queues_)) {
+        continue;
+      }
+      struct ifreq ifr;
+      memset(&ifr, 0, sizeof(ifr));
+      ifr.ifr_flags = attach ? IFF_ATTACH_QUEUE : IFF_DETACH_QUEUE;
+      if (ioctl(GetQueueFd(queue), TUNSETQUEUE, &ifr) < 0) {
+        error = std::string("Failed to ") + (attach ? "attach" : "detach") + " TUN queue " +
+                std::to_string(queue) + ": " + strerror(errno);
+        return false;
+      }
+      if (!attach) {
+        queue_state_[queue].segmenter.Reset();
+      }
+    }
+    active_queues_ = count;
+    next_queue_ = 0;
+    return true;
+  }
+
+  int GetQueueFd(size_t queue) const override {
+    if (queue == 0) {
+      return fd_.get();
+    }
+    return queue - 1 < extra_fds_.size() ? extra_fds_[queue - 1].get() : -1;
+  }
+
+  ssize_t WriteGsoPacket(const uint8_t* data,
+                         size_t length,
+                         const TunGsoInfo& gso,
+                         std::string& error) override {
+    if (!fd_.is_valid()) {
+      error = "Device not open";
+      return -1;
+    }
+    if (!vnet_hdr_) {
+      error = "TUN device was not opened with offload enabled";
+      return -1;
+    }
+    const VirtioNetHdr hdr = GsoHeader(gso);
+    int error_code = 0;
+    switch (WriteFrame(&hdr, data, length, error_code)) {
+      case TunIoStatus::kOk:
+        return static_cast<ssize_t>(length);
+      case TunIoStatus::kWouldBlock:
+        return 0;
+      default:
+        error = "Write error: " + TunIoErrorString(error_code);
+        return -1;
+    }
+  }
+
+protected:
+  // Round-robins over the attached queues, staying on a queue while it still
+  // has TSO segments buffered so a super-packet comes out contiguously.
+  TunIoStatus ReadInto(uint8_t* buffer,
+                       size_t capacity,
+                       size_t& length,
+                       int& error_code) override {
+    if (!fd_.is_valid()) {
+      error_code = EBADF;
+      return TunIoStatus::kError;
+    }
+    const size_t queues = active_queues_;
+    for (size_t i = 0; i < queues; ++i) {
+      const size_t queue = (next_queue_ + i) % queues;
+      const TunIoStatus status = ReadQueueInto(queue, buffer, capacity, length, error_code);
+      if (status == TunIoStatus::kWouldBlock) {
+        continue;
+      }
+      next_queue_ = HasBufferedQueuePackets(queue) ? queue : (queue + 1) % queues;
+      return status;
+    }
+    return TunIoStatus::kWouldBlock;
+  }
+
+  TunIoStatus ReadQueueInto(size_t queue,
+                            uint8_t* buffer,
+                            size_t capacity,
+                            size_t& length,
+                            int& error_code) override {
+    const int fd = GetQueueFd(queue);
+    if (fd < 0) {
+      error_code = EBADF;
+      return TunIoStatus::kError;
+    }
+    if (vnet_hdr_) {
+      return ReadVnetPacket(fd, queue_state_[queue], buffer, capacity, length, error_code);
+    }
+    const ssize_t bytes_read = read(fd, buffer, capacity);
+    if (bytes_read < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return TunIoStatus::kWouldBlock;
+      }
+      error_code = errno;
+      return TunIoStatus::kError;
+    }
+    if (bytes_read == 0) {
+      return TunIoStatus::kClosed;
+    }
+    length = static_cast<size_t>(bytes_read);
+    return TunIoStatus::kOk;
+  }
+
+  TunIoStatus WriteFrom(const uint8_t* data, size_t length, int& error_code) override {
+    if (vnet_hdr_) {
+      VirtioNetHdr hdr;
+      memset(&hdr, 0, sizeof(hdr));
+      return WriteFrame(&hdr, data, length, error_code);
+    }
+    return WriteFrame(nullptr, data, length, error_code);
+  }
+
+  // Offload-mode receive state, one per queue: scratch buffer and the
+  // super-packet being segmented out of it (ReadQueueInto returns one
+  // segment per call until it is drained).
+  struct QueueState {
+    std::unique_ptr<uint8_t[]> vnet_buffer;
+    tcp_offload::TcpSegmenter segmenter;
+    size_t segment_max_packet = 0;
+  };
+
+  // Every packet on an IFF_VNET_HDR device is prefixed by a virtio_net_hdr.
+  // TUN_F_CSUM lets both directions carry partial checksums, which is what
+  // allows GSO writes; partial checksums are finished on read. TUN_F_TSO6 lets
+  // the kernel hand us TCP/IPv6 super-packets, which ReadPacket segments.
+  static bool EnableOffload(int fd, std::string& error) {
+    int hdr_size = static_cast<int>(sizeof(VirtioNetHdr));
+    if (ioctl(fd, TUNSETVNETHDRSZ, &hdr_size) < 0) {
+      error = std::string("Failed to set TUN vnet header size: ") + strerror(errno);
+      return false;
+    }
+    if (ioctl(fd, TUNSETOFFLOAD, static_cast<unsigned long>(TUN_F_CSUM | TUN_F_TSO6)) < 0) {
+      error = std::string("Failed to enable TUN offload: ") + strerror(errno);
+      return false;
+    }
+    return true;
+  }
+
+  static VirtioNetHdr GsoHeader(const TunGsoInfo& gso) {
+    VirtioNetHdr hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.flags = kVirtioNetHdrFNeedsCsum;
+    hdr.gso_type = kVirtioNetHdrGsoTcpV6;
+    hdr.hdr_len = gso.header_length;
+    hdr.gso_size = gso.segment_size;
+    hdr.csum_start = gso.csum_start;
+    hdr.csum_offset = gso.csum_offset;
+    return hdr;
+  }
+
+  TunIoStatus ReadVnetPacket(int fd,
+                             QueueState& state,
+                             uint8_t* buffer,
+                             size_t capacity,
+                             size_t& length,
+                             int& error_code) {
+    if (state.segmenter.pending()) {
+      return NextSegment(state, buffer, capacity, length, error_code);
+    }
+
+    // TSO super-packets can reach 64 KiB, so read into the scratch buffer and
+    // copy (or segment) into the caller's buffer.
+    VirtioNetHdr hdr;
+    struct iovec iov[2];
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = state.vnet_buffer.get();
+    iov[1].iov_len = tcp_offload::kMaxSuperPacket;
+    const ssize_t bytes_read = readv(fd, iov, 2);
+    if (bytes_read < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return TunIoStatus::kWouldBlock;
+      }
+      error_code = errno;
+      return TunIoStatus::kError;
+    }
+    if (bytes_read == 0) {
+      return TunIoStatus::kClosed;
+    }
+    if (static_cast<size_t>(bytes_read) < sizeof(hdr)) {
+      // Missing virtio-net header.
+      error_code = EIO;
+      return TunIoStatus::kError;
+    }
+    return ParseVnetPacket(hdr, state.vnet_buffer.get(),
+                           static_cast<size_t>(bytes_read) - sizeof(hdr), state, buffer,
+                           capacity, length, error_code);
+  }
+
+  // Turns one packet read behind `hdr` into `buffer`: finishes a partial
+  // checksum in place, or loads a TSO super-packet into the segmenter, which
+  // borrows `packet` until it is drained. Malformed TSO packets and
+  // unexpected GSO types fail with EPROTO, bad checksum offsets with EBADMSG.
+  static TunIoStatus ParseVnetPacket(const VirtioNetHdr& hdr,
+                                     uint8_t* packet,
+                                     size_t len,
+                                     QueueState& state,
+                                     uint8_t* buffer,
+                                     size_t capacity,
+                                     size_t& length,
+                                     int& error_code) {
+    if (hdr.gso_type == kVirtioNetHdrGsoTcpV6) {
+      // hdr_len is only a hint (it may cover more than the headers), so the
+      // segmenter derives the header length from csum_start instead.
+      state.segment_max_packet = capacity;
+      if (!state.segmenter.Load(packet, len, hdr.csum_start, hdr.gso_size, capacity)) {
+        error_code = EPROTO;
+        return TunIoStatus::kError;
+      }
+      return NextSegment(state, buffer, capacity, length, error_code);
+    }
+    if (hdr.gso_type != kVirtioNetHdrGsoNone) {
+      // Only TSO6 is advertised through TUNSETOFFLOAD.
+      error_code = EPROTO;
+      return TunIoStatus::kError;
+    }
+    if ((hdr.flags & kVirtioNetHdrFNeedsCsum) != 0 &&
+        !tcp_offload::CompletePartialChecksum(packet, len, hdr.csum_start, hdr.csum_offset)) {
+      error_code = EBADMSG;
+      return TunIoStatus::kError;
+    }
+    // Same truncation as read() into a `capacity` buffer.
+    length = len < capacity ? len : capacity;
+    memcpy(buffer, packet, length);
+    return TunIoStatus::kOk;
+  }
+
+  // Segments are cut to the capacity the super-packet was loaded with, so a
+  // reader that shrinks its buffer mid-packet gets EMSGSIZE.
+  static TunIoStatus NextSegment(QueueState& state,
+                                 uint8_t* buffer,
+                                 size_t capacity,
+                                 size_t& length,
+                                 int& error_code) {
+    if (capacity < state.segment_max_packet) {
+      error_code = EMSGSIZE;
+      return TunIoStatus::kError;
+    }
+    length = state.segmenter.Next(buffer);
+    return TunIoStatus::kOk;
+  }
+
+  // Writes one packet, behind `hdr` when the device carries virtio-net
+  // headers. The io_uring backend overrides this to queue the write instead.
+  virtual TunIoStatus WriteFrame(const VirtioNetHdr* hdr,
+                                 const uint8_t* data,
+                                 size_t length,
+                                 int& error_code) {
+    if (!fd_.is_valid()) {
+      error_code = EBADF;
+      return TunIoStatus::kError;
+    }
+    struct iovec iov[2];
+    int iov_count = 0;
+    if (hdr != nullptr) {
+      iov[iov_count].iov_base = const_cast<VirtioNetHdr*>(hdr);
+      iov[iov_count].iov_len = sizeof(*hdr);
+      ++iov_count;
+    }
+    iov[iov_count].iov_base = const_cast<uint8_t*>(data);
+    iov[iov_count].iov_len = length;
+    ++iov_count;
+    const ssize_t bytes_written = writev(fd_.get(), iov, iov_count);
+    if (bytes_written < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return TunIoStatus::kWouldBlock;
+      }
+      error_code = errno;
+      return TunIoStatus::kError;
+    }
+    const size_t header_len = hdr != nullptr ? sizeof(*hdr) : 0;
+    if (static_cast<size_t>(bytes_written) < header_len + length) {
+      error_code = EIO;
+      return TunIoStatus::kError;
+    }
+    return TunIoStatus::kOk;
+  }
+
+  TunOpenOptions options_;
+  bool vnet_hdr_ = false;
+  // Queues 1..N-1 (queue 0 is `fd_`).
+  std::vector<FileDescriptor> extra_fds_;
+  std::vector<QueueState> queue_state_;
+  size_t active_queues_ = 1;
+  // Next queue for the round-robin ReadPacket.
+  size_t next_queue_ = 0;
+};
+
+#ifdef TUNTAP_HAVE_LIBURING
+// io_uring variant (tun_backend_linux_uring.cc); see `TunOpenOptions::io_uring`.
+std::unique_ptr<TunPlatformBackend> CreateUringTunBackend(const TunOpenOptions& options);
+#endif
+
+#endif
@@ -0,0 +1,546 @@
+#if defined(__linux__) && defined(TUNTAP_HAVE_LIBURING)
+
+#include "tun_backend_linux.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <liburing.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "debug_log.h"
+#include "file_descriptor.h"
+
+namespace {
+
+// Reads kept in flight on the device. Each owns one registered buffer.
+constexpr size_t kReadSlots = 8;
+// Registered write buffers; a write that finds none free reports kWouldBlock.
+constexpr size_t kWriteSlots = 16;
+// Queued writes are submitted once this many are pending, or on FlushWrites.
+constexpr size_t kWriteSubmitBatch = 8;
+// Largest packet a TUN device passes without virtio-net offload.
+constexpr size_t kMaxPlainPacket = 65535;
+// Index of the TUN fd in each ring's registered file table.
+constexpr int kFixedTunFile = 0;
+
+void* SlotTag(size_t slot) {
+  return reinterpret_cast<void*>(static_cast<uintptr_t>(slot));
+}
+
+size_t TagSlot(const struct io_uring_cqe* cqe) {
+  return static_cast<size_t>(reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe)));
+}
+
+std::string RingError(const char* what, int rc) {
+  return std::string(what) + ": " + strerror(rc < 0 ? -rc : rc);
+}
+
+// LinuxTunBackend with the data path moved onto io_uring:
+//
+// - Reads: `kReadSlots` READ_FIXED requests stay queued on the device. A
+//   completion is consumed straight from the completion ring, so a busy
+//   reader issues no syscall per packet; consumed slots are re-queued and
+//   handed back to the kernel in one submit when the reader runs dry.
+// - Writes: packets are copied into registered buffers and submitted as
+//   WRITE_FIXED batches (every `kWriteSubmitBatch` writes or on FlushWrites).
+//   Failures surface on the next write or flush. With every buffer in flight
+//   a write returns kWouldBlock; WaitWritable then waits on an eventfd the
+//   write ring signals per completion, so no caller (JS included) blocks on
+//   the ring while holding the write lock.
+// - Readiness: the read ring signals an eventfd for every completion, which
+//   stands in for the TUN fd in `GetQueueFd(0)` so libuv and WaitReadable keep
+//   working. It is only polled once the completion ring is empty.
+//
+// Reads and writes use separate rings so the reader and writer threads never
+// share a submission queue. Anything the kernel or build does not support
+// (ring setup, buffer registration, multi-queue devices) leaves the plain
+// LinuxTunBackend paths in charge.
+class UringTunBackend : public LinuxTunBackend {
+public:
+  explicit UringTunBackend(const TunOpenOptions& options) : LinuxTunBackend(options) {}
+
+  ~UringTunBackend() override { CloseDevice(); }
+
+  bool OpenDevice(const std::string& requested_name,
+                  std::string& out_interface_name,
+                  std::string& error) override {
+    if (!LinuxTunBackend::OpenDevice(requested_name, out_interface_name, error)) {
+      return false;
+    }
+    std::string ring_error;
+    if (QueueCount() > 1) {
+      ring_error = "multi-queue devices use read()/write()";
+    } else if (SetupRings(ring_error)) {
+      tuntap::FwdDebug("tun-io-uring", "readSlots=%zu writeSlots=%zu slotBytes=%zu", kReadSlots,
+                       kWriteSlots, slot_size_);
+      return true;
+    }
+    tuntap::FwdDebug("tun-io-uring-fallback", "%s", ring_error.c_str());
+    return true;
+  }
+
+  void CloseDevice() override {
+    // The libuv poll handles watch the eventfd torn down below.
+    StopReceiveLoop();
+    TeardownRings();
+    LinuxTunBackend::CloseDevice();
+  }
+
+  bool IoUringEnabled() const override { return rings_ready_; }
+
+  int GetQueueFd(size_t queue) const override {
+    if (rings_ready_ && queue == 0) {
+      return completion_event_.get();
+    }
+    return LinuxTunBackend::GetQueueFd(queue);
+  }
+
+  bool WaitWritable(const std::atomic<bool>& running,
+                    const WakeupEvent* wakeup,
+                    std::string& error) override {
+    if (!rings_ready_) {
+      return LinuxTunBackend::WaitWritable(running, wakeup, error);
+    }
+    // Clear the eventfd before looking for a free buffer, so a write that
+    // completes in between leaves it readable for the wait.
+    uint64_t count = 0;
+    while (::read(write_event_.get(), &count, sizeof(count)) < 0 && errno == EINTR) {
+    }
+    {
+      std::lock_guard<std::mutex> lock(write_mutex_);
+      ReapWrites();
+      if (!free_write_slots_.empty() || write_error_code_ != 0) {
+        return true;
+      }
+    }
+    const int fd = write_event_.get();
+    return WaitForEvents(&fd, 1, POLLIN, running, wakeup, error);
+  }
+
+  bool FlushWrites(std::string& error) override {
+    if (!rings_ready_) {
+      return true;
+    }
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (unsubmitted_writes_ > 0) {
+      const int rc = io_uring_submit(&write_ring_);
+      if (rc < 0) {
+        error = RingError("io_uring write submit failed", rc);
+        return false;
+      }
+      unsubmitted_writes_ = 0;
+    }
+    ReapWrites();
+    int error_code = 0;
+    if (!TakeWriteError(error_code)) {
+      error = "Write error: " + TunIoErrorString(error_code);
+      return false;
+    }
+    return true;
+  }
+
+protected:
+  TunIoStatus ReadQueueInto(size_t queue,
+                            uint8_t* buffer,
+                            size_t capacity,
+                            size_t& length,
+                            int& error_code) override {
+    if (!rings_ready_) {
+      return LinuxTunBackend::ReadQueueInto(queue, buffer, capacity, length, error_code);
+    }
+    if (queue != 0) {
+      error_code = EINVAL;
+      return TunIoStatus::kError;
+    }
+    return RingRead(buffer, capacity, length, error_code);
+  }
+
+  TunIoStatus WriteFrame(const VirtioNetHdr* hdr,
+                         const uint8_t* data,
+                         size_t length,
+                         int& error_code) override {
+    if (!rings_ready_) {
+      return LinuxTunBackend::WriteFrame(hdr, data, length, error_code);
+    }
+    return RingWrite(hdr, data, length, error_code);
+  }
+
+private:
+  struct ReadCompletion {
+    size_t slot = 0;
+    int result = 0;
+  };
+
+  bool SetupRings(std::string& error) {
+    slot_size_ = vnet_hdr_ ? sizeof(VirtioNetHdr) + tcp_offload::kMaxSuperPacket : kMaxPlainPacket;
+    read_arena_.reset(new uint8_t[kReadSlots * slot_size_]);
+    write_arena_.reset(new uint8_t[kWriteSlots * slot_size_]);
+
+    int rc = io_uring_queue_init(static_cast<unsigned>(kReadSlots), &read_ring_, 0);
+    if (rc < 0) {
+      error = RingError("io_uring_queue_init failed", rc);
+      TeardownRings();
+      return false;
+    }
+    read_ring_open_ = true;
+    rc = io_uring_queue_init(static_cast<unsigned>(kWriteSlots), &write_ring_, 0);
+    if (rc < 0) {
+      error = RingError("io_uring_queue_init failed", rc);
+      TeardownRings();
+      return false;
+    }
+    write_ring_open_ = true;
+
+    if (!RegisterRing(read_ring_, read_arena_.get(), kReadSlots, error) ||
+        !RegisterRing(write_ring_, write_arena_.get(), kWriteSlots, error)) {
+      TeardownRings();
+      return false;
+    }
+
+    completion_event_.reset(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+    if (!completion_event_.is_valid()) {
+      error = std::string("eventfd failed: ") + strerror(errno);
+      TeardownRings();
+      return false;
+    }
+    rc = io_uring_register_eventfd(&read_ring_, completion_event_.get());
+    if (rc < 0) {
+      error = RingError("io_uring_register_eventfd failed", rc);
+      TeardownRings();
+      return false;
+    }
+    write_event_.reset(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+    if (!write_event_.is_valid()) {
+      error = std::string("eventfd failed: ") + strerror(errno);
+      TeardownRings();
+      return false;
+    }
+    rc = io_uring_register_eventfd(&write_ring_, write_event_.get());
+    if (rc < 0) {
+      error = RingError("io_uring_register_eventfd failed", rc);
+      TeardownRings();
+      return false;
+    }
+
+    // Queued reads on a non-blocking fd would complete at once with -EAGAIN;
+    // in blocking mode the kernel parks them until a packet arrives. The
+    // flag is restored by TeardownRings.
+    const int flags = fcntl(fd_.get(), F_GETFL, 0);
+    if (flags < 0 || fcntl(fd_.get(), F_SETFL, flags & ~O_NONBLOCK) < 0) {
+      error = std::string("Failed to make TUN fd blocking: ") + strerror(errno);
+      TeardownRings();
+      return false;
+    }
+    fd_blocking_ = true;
+
+    for (size_t slot = 0; slot < kReadSlots; ++slot) {
+      QueueRead(slot);
+    }
+    rc = io_uring_submit(&read_ring_);
+    if (rc < 0) {
+      error = RingError("io_uring read submit failed", rc);
+      TeardownRings();
+      return false;
+    }
+    free_write_slots_.clear();
+    for (size_t slot = kWriteSlots; slot > 0; --slot) {
+      free_write_slots_.push_back(slot - 1);
+    }
+    write_lengths_.assign(kWriteSlots, 0);
+    rings_ready_ = true;
+    return true;
+  }
+
+  // Registers the TUN fd and `slots` consecutive buffers of `slot_size_`.
+  bool RegisterRing(struct io_uring& ring, uint8_t* arena, size_t slots, std::string& error) {
+    const int fd = fd_.get();
+    int rc = io_uring_register_files(&ring, &fd, 1);
+    if (rc < 0) {
+      error = RingError("io_uring_register_files failed", rc);
+      return false;
+    }
+    std::vector<struct iovec> iovecs(slots);
+    for (size_t slot = 0; slot < slots; ++slot) {
+      iovecs[slot].iov_base = arena + slot * slot_size_;
+      iovecs[slot].iov_len = slot_size_;
+    }
+    // Kernels before 5.12 charge registered buffers to RLIMIT_MEMLOCK.
+    rc = io_uring_register_buffers(&ring, iovecs.data(), static_cast<unsigned>(slots));
+    if (rc < 0) {
+      error = RingError("io_uring_register_buffers failed", rc);
+      return false;
+    }
+    return true;
+  }
+
+  void TeardownRings() {
+    // Exiting a ring cancels its in-flight requests before the buffers go.
+    if (read_ring_open_) {
+      io_uring_queue_exit(&read_ring_);
+      read_ring_open_ = false;
+    }
+    if (write_ring_open_) {
+      io_uring_queue_exit(&write_ring_);
+      write_ring_open_ = false;
+    }
+    if (fd_blocking_) {
+      // Hands the fd back as the plain backend keeps it, also to any
+      // duplicate taken through getFd().
+      const int flags = fcntl(fd_.get(), F_GETFL, 0);
+      if (flags >= 0) {
+        fcntl(fd_.get(), F_SETFL, flags | O_NONBLOCK);
+      }
+      fd_blocking_ = false;
+    }
+    rings_ready_ = false;
+    completion_event_.reset();
+    write_event_.reset();
+    read_arena_.reset();
+    write_arena_.reset();
+    ready_head_ = 0;
+    ready_count_ = 0;
+    held_slot_ = kNoSlot;
+    reads_unsubmitted_ = false;
+    free_write_slots_.clear();
+    write_lengths_.clear();
+    unsubmitted_writes_ = 0;
+    write_error_code_ = 0;
+  }
+
+  // Queues a read into `slot`; submitted with the next batch.
+  void QueueRead(size_t slot) {
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&read_ring_);
+    // The ring has one entry per slot and each slot is queued at most once,
+    // so an entry is always free.
+    io_uring_prep_read_fixed(sqe, kFixedTunFile, read_arena_.get() + slot * slot_size_,
+                             static_cast<unsigned>(slot_size_), 0, static_cast<int>(slot));
+    io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+    io_uring_sqe_set_data(sqe, SlotTag(slot));
+    reads_unsubmitted_ = true;
+  }
+
+  void ReapReads() {
+    struct io_uring_cqe* cqe = nullptr;
+    while (ready_count_ < kReadSlots && io_uring_peek_cqe(&read_ring_, &cqe) == 0) {
+      ready_[(ready_head_ + ready_count_) % kReadSlots] = ReadCompletion{TagSlot(cqe), cqe->res};
+      ++ready_count_;
+      io_uring_cqe_seen(&read_ring_, cqe);
+    }
+  }
+
+  TunIoStatus RingRead(uint8_t* out, size_t capacity, size_t& length, int& error_code) {
+    QueueState& state = queue_state_[0];
+    if (state.segmenter.pending()) {
+      const TunIoStatus status = NextSegment(state, out, capacity, length, error_code);
+      if (!state.segmenter.pending()) {
+        QueueRead(held_slot_);
+        held_slot_ = kNoSlot;
+      }
+      return status;
+    }
+
+    ReapReads();
+    if (ready_count_ == 0) {
+      // Out of completions: give the kernel the re-queued reads, then clear
+      // the eventfd and look once more, so a completion that lands in between
+      // leaves the eventfd readable for the next wait.
+      if (reads_unsubmitted_) {
+        const int rc = io_uring_submit(&read_ring_);
+        if (rc < 0) {
+          error_code = -rc;
+          return TunIoStatus::kError;
+        }
+        reads_unsubmitted_ = false;
+      }
+      uint64_t count = 0;
+      while (::read(completion_event_.get(), &count, sizeof(count)) < 0 && errno == EINTR) {
+      }
+      ReapReads();
+      if (ready_count_ == 0) {
+        return TunIoStatus::kWouldBlock;
+      }
+    }
+
+    const ReadCompletion completion = ready_[ready_head_];
+    ready_head_ = (ready_head_ + 1) % kReadSlots;
+    --ready_count_;
+    if (completion.result <= 0) {
+      QueueRead(completion.slot);
+      if (completion.result == 0) {
+        return TunIoStatus::kClosed;
+      }
+      error_code = -completion.result;
+      return TunIoStatus::kError;
+    }
+
+    uint8_t* buffer = read_arena_.get() + completion.slot * slot_size_;
+    const size_t bytes_read = static_cast<size_t>(completion.result);
+    if (!vnet_hdr_) {
+      length = bytes_read < capacity ? bytes_read : capacity;
+      memcpy(out, buffer, length);
+      QueueRead(completion.slot);
+      return TunIoStatus::kOk;
+    }
+
+    if (bytes_read < sizeof(VirtioNetHdr)) {
+      // Missing virtio-net header.
+      QueueRead(completion.slot);
+      error_code = EIO;
+      return TunIoStatus::kError;
+    }
+    VirtioNetHdr hdr;
+    memcpy(&hdr, buffer, sizeof(hdr));
+    const TunIoStatus status = ParseVnetPacket(hdr, buffer + sizeof(hdr), bytes_read - sizeof(hdr),
+                                               state, out, capacity, length, error_code);
+    // A loaded segmenter borrows the slot until its last segment is out.
+    if (state.segmenter.pending()) {
+      held_slot_ = completion.slot;
+    } else {
+      QueueRead(completion.slot);
+    }
+    return status;
+  }
+
+  TunIoStatus RingWrite(const VirtioNetHdr* hdr,
+                        const uint8_t* data,
+                        size_t length,
+                        int& error_code) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (!TakeWriteError(error_code)) {
+      return TunIoStatus::kError;
+    }
+    const size_t header_len = hdr != nullptr ? sizeof(*hdr) : 0;
+    if (header_len + length > slot_size_) {
+      error_code = EMSGSIZE;
+      return TunIoStatus::kError;
+    }
+    if (free_write_slots_.empty()) {
+      const TunIoStatus status = FreeWriteSlot(error_code);
+      if (status != TunIoStatus::kOk) {
+        return status;
+      }
+    }
+
+    const size_t slot = free_write_slots_.back();
+    free_write_slots_.pop_back();
+    uint8_t* buffer = write_arena_.get() + slot * slot_size_;
+    if (hdr != nullptr) {
+      memcpy(buffer, hdr, header_len);
+    }
+    memcpy(buffer + header_len, data, length);
+    write_lengths_[slot] = header_len + length;
+
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&write_ring_);
+    io_uring_prep_write_fixed(sqe, kFixedTunFile, buffer,
+                              static_cast<unsigned>(header_len + length), 0,
+                              static_cast<int>(slot));
+    io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+    io_uring_sqe_set_data(sqe, SlotTag(slot));
+    if (++unsubmitted_writes_ >= kWriteSubmitBatch) {
+      const int rc = io_uring_submit(&write_ring_);
+      if (rc < 0) {
+        error_code = -rc;
+        return TunIoStatus::kError;
+      }
+      unsubmitted_writes_ = 0;
+    }
+    return TunIoStatus::kOk;
+  }
+
+  // Submits pending writes and reaps whatever has completed, without
+  // waiting; kWouldBlock when every buffer is still in flight. Called with
+  // `write_mutex_` held.
+  TunIoStatus FreeWriteSlot(int& error_code) {
+    if (unsubmitted_writes_ > 0) {
+      const int rc = io_uring_submit(&write_ring_);
+      if (rc < 0) {
+        error_code = -rc;
+        return TunIoStatus::kError;
+      }
+      unsubmitted_writes_ = 0;
+    }
+    ReapWrites();
+    if (!TakeWriteError(error_code)) {
+      return TunIoStatus::kError;
+    }
+    return free_write_slots_.empty() ? TunIoStatus::kWouldBlock : TunIoStatus::kOk;
+  }
+
+  // Called with `write_mutex_` held.
+  void ReapWrites() {
+    struct io_uring_cqe* cqe = nullptr;
+    while (io_uring_peek_cqe(&write_ring_, &cqe) == 0) {
+      const size_t slot = TagSlot(cqe);
+      if (write_error_code_ == 0) {
+        if (cqe->res < 0) {
+          write_error_code_ = -cqe->res;
+        } else if (static_cast<size_t>(cqe->res) != write_lengths_[slot]) {
+          // Short write.
+          write_error_code_ = EIO;
+        }
+      }
+      free_write_slots_.push_back(slot);
+      io_uring_cqe_seen(&write_ring_, cqe);
+    }
+  }
+
+  // Moves a pending asynchronous write failure into `error_code`. Called
+  // with `write_mutex_` held.
+  bool TakeWriteError(int& error_code) {
+    if (write_error_code_ == 0) {
+      return true;
+    }
+    error_code = write_error_code_;
+    write_error_code_ = 0;
+    return false;
+  }
+
+  static constexpr size_t kNoSlot = ~static_cast<size_t>(0);
+
+  struct io_uring read_ring_ {};
+  struct io_uring write_ring_ {};
+  bool read_ring_open_ = false;
+  bool write_ring_open_ = false;
+  bool rings_ready_ = false;
+  // O_NONBLOCK was cleared on `fd_` for the queued reads.
+  bool fd_blocking_ = false;
+  size_t slot_size_ = 0;
+  FileDescriptor completion_event_;
+  // Signalled by the write ring per completion; WaitWritable polls it.
+  FileDescriptor write_event_;
+
+  // Read side; owned by the single reader thread.
+  std::unique_ptr<uint8_t[]> read_arena_;
+  ReadCompletion ready_[kReadSlots];
+  size_t ready_head_ = 0;
+  size_t ready_count_ = 0;
+  size_t held_slot_ = kNoSlot;
+  bool reads_unsubmitted_ = false;
+
+  // Write side; shared between the forwarder and JS writes.
+  std::mutex write_mutex_;
+  std::unique_ptr<uint8_t[]> write_arena_;
+  std::vector<size_t> free_write_slots_;
+  std::vector<size_t> write_lengths_;
+  size_t unsubmitted_writes_ = 0;
+  int write_error_code_ = 0;
+};
+
+} // namespace
+
+std::unique_ptr<TunPlatformBackend> CreateUringTunBackend(const TunOpenOptions& options) {
+  return std::make_unique<UringTunBackend>(options);
+}
+
+#endif
@@ -13,6 +13,9 @@
 #include <vector>
 
 #include "handle.h"
+#include "ipv6_frame.h"
+#include "receive_coalescer.h"
+#include "wakeup_event.h"
 #include "wintun_loader.h"
 
 namespace {
@@ -125,31 +128,24 @@ public:
       return ReadPacketStatus::Error;
     }
 
-    auto& api = WintunApi::Instance();
-    DWORD packet_size = 0;
-    BYTE* packet = api.ReceivePacket(session_, &packet_size);
-    if (!packet) {
-      DWORD err = ::GetLastError();
-      switch (err) {
-        case ERROR_NO_MORE_ITEMS:
-          out.clear();
-          return ReadPacketStatus::NoData;
-        case ERROR_HANDLE_EOF:
-          out.clear();
-          return ReadPacketStatus::Closed;
-        default:
-          out.clear();
-          error = "WintunReceivePacket failed: " + FormatLastError(err);
-          return ReadPacketStatus::Error;
-      }
+    out.resize(max_payload_size);
+    size_t length = 0;
+    DWORD err = ERROR_SUCCESS;
+    switch (ReceiveInto(out.data(), out.size(), length, err)) {
+      case TunIoStatus::kOk:
+        out.resize(length);
+        return ReadPacketStatus::Data;
+      case TunIoStatus::kWouldBlock:
+        out.clear();
+        return ReadPacketStatus::NoData;
+      case TunIoStatus::kClosed:
+        out.clear();
+        return ReadPacketStatus::Closed;
+      default:
+        out.clear();
+        error = "WintunReceivePacket failed: " + FormatLastError(err);
+        return ReadPacketStatus::Error;
     }
-
-    const size_t copy_len = static_cast<size_t>(packet_size) > max_payload_size
-                                ? max_payload_size
-                                : static_cast<size_t>(packet_size);
-    out.assign(packet, packet + copy_len);
-    api.ReleaseReceivePacket(session_, packet);
-    return ReadPacketStatus::Data;
   }
 
   ssize_t WritePacket(const uint8_t* data,
@@ -162,28 +158,78 @@ public:
     if (length == 0) {
       return 0;
     }
-    if (length > WINTUN_MAX_IP_PACKET_SIZE) {
-      error = "Packet exceeds WINTUN_MAX_IP_PACKET_SIZE";
-      return -1;
-    }
 
-    auto& api = WintunApi::Instance();
-    BYTE* slot = api.AllocateSendPacket(session_, static_cast<DWORD>(length));
-    if (!slot) {
-      DWORD err = ::GetLastError();
-      if (err == ERROR_HANDLE_EOF) {
-        error = "WinTun adapter is terminating";
-      } else if (err == ERROR_BUFFER_OVERFLOW) {
+    DWORD err = ERROR_SUCCESS;
+    switch (SendFrom(data, length, err)) {
+      case TunIoStatus::kOk:
+        return static_cast<ssize_t>(length);
+      case TunIoStatus::kWouldBlock:
         return 0;
-      } else {
-        error = "WintunAllocateSendPacket failed: " + FormatLastError(err);
+      case TunIoStatus::kClosed:
+        error = "WinTun adapter is terminating";
+        return -1;
+      default:
+        error = err == ERROR_INVALID_PARAMETER
+                    ? "Packet exceeds WINTUN_MAX_IP_PACKET_SIZE"
+                    : "WintunAllocateSendPacket failed: " + FormatLastError(err);
+        return -1;
+    }
+  }
+
+  TunIoStatus ReadPackets(PacketBatch& batch, size_t max_payload_size) override {
+    if (!session_) {
+      batch.set_error_code(ERROR_INVALID_HANDLE);
+      return TunIoStatus::kError;
+    }
+    const uint64_t now_ns = PacketBatch::NowNs();
+    TunIoStatus result = TunIoStatus::kWouldBlock;
+    while (uint8_t* slot = batch.Reserve(max_payload_size)) {
+      size_t length = 0;
+      DWORD err = ERROR_SUCCESS;
+      const TunIoStatus status = ReceiveInto(slot, max_payload_size, length, err);
+      if (status != TunIoStatus::kOk) {
+        if (result == TunIoStatus::kOk) {
+          break;
+        }
+        batch.set_error_code(static_cast<int>(err));
+        return status;
       }
-      return -1;
+      batch.Commit(length, now_ns, ipv6_frame::FlowHash(slot, length));
+      result = TunIoStatus::kOk;
     }
+    return result;
+  }
 
-    std::memcpy(slot, data, length);
-    api.SendPacket(session_, slot);
-    return static_cast<ssize_t>(length);
+  TunIoStatus ReadPacketInto(uint8_t* buffer,
+                             size_t capacity,
+                             size_t& length,
+                             int& error_code) override {
+    if (!session_) {
+      error_code = ERROR_INVALID_HANDLE;
+      return TunIoStatus::kError;
+    }
+    DWORD err = ERROR_SUCCESS;
+    const TunIoStatus status = ReceiveInto(buffer, capacity, length, err);
+    error_code = static_cast<int>(err);
+    return status;
+  }
+
+  TunIoStatus WritePackets(PacketBatch& batch) override {
+    if (!session_) {
+      batch.set_error_code(ERROR_INVALID_HANDLE);
+      return TunIoStatus::kError;
+    }
+    while (!batch.drained()) {
+      const size_t index = batch.cursor();
+      DWORD err = ERROR_SUCCESS;
+      const TunIoStatus status = SendFrom(batch.data(index), batch.length(index), err);
+      if (status != TunIoStatus::kOk) {
+        batch.set_error_code(static_cast<int>(err));
+        return status;
+      }
+      batch.Advance();
+    }
+    return TunIoStatus::kOk;
   }
 
   // The worker thread can begin invoking `on_packet`/`on_error` immediately
@@ -196,7 +242,7 @@ public:
   // first instruction. There is no deadlock risk because the calling JS
   // thread releases the lock as soon as `StartPolling` returns.
   bool StartReceiveLoop(uv_loop_t* /*loop*/,
-                        size_t buffer_size,
+                        const ReceiveLoopOptions& options,
                         PacketCallback on_packet,
                         ErrorCallback on_error,
                         std::string& error) override {
@@ -204,7 +250,7 @@ public:
       error = "Device not open";
       return false;
     }
-    if (buffer_size == 0) {
+    if (options.buffer_size == 0) {
       error = "Invalid receive-loop parameters";
       return false;
     }
@@ -222,8 +268,13 @@ public:
 
     worker_running_.store(true);
     try {
-      worker_ = std::thread(&WindowsTunBackend::WorkerMain, this, buffer_size,
-                            std::move(on_packet), std::move(on_error));
+      if (options.max_batch > 0) {
+        worker_ = std::thread(&WindowsTunBackend::BatchWorkerMain, this, options,
+                              std::move(on_packet), std::move(on_error));
+      } else {
+        worker_ = std::thread(&WindowsTunBackend::WorkerMain, this, options.buffer_size,
+                              std::move(on_packet), std::move(on_error));
+      }
     } catch (const std::system_error& sysErr) {
       worker_running_.store(false);
       quit_event_.reset();
@@ -259,32 +310,63 @@ public:
   // as "no pollable fd" and drives delivery through `StartReceiveLoop`.
   int GetNativeFd() const override { return -1; }
 
-  bool WaitReadable(const std::atomic<bool>& running, std::string& error) override {
+  bool WaitReadable(const std::atomic<bool>& running,
+                    const WakeupEvent* wakeup,
+                    std::string& error) override {
+    return WaitReadableFor(-1, running, wakeup, error);
+  }
+
+  bool WaitReadableFor(int timeout_ms,
+                       const std::atomic<bool>& running,
+                       const WakeupEvent* wakeup,
+                       std::string& error) override {
     if (!read_event_) {
       error = "Device not open";
       return false;
     }
 
+    const bool has_wakeup = wakeup != nullptr && wakeup->IsOpen();
+    HANDLE wait_handles[2] = {read_event_, has_wakeup ? wakeup->handle() : nullptr};
+    const DWORD poll_ms = has_wakeup ? INFINITE : 200;
+    const ULONGLONG deadline = ::GetTickCount64() + static_cast<ULONGLONG>(timeout_ms < 0 ? 0 : timeout_ms);
     while (running.load()) {
-      DWORD wait = ::WaitForSingleObject(read_event_, 200);
+      DWORD wait_ms = poll_ms;
+      if (timeout_ms >= 0) {
+        const ULONGLONG now = ::GetTickCount64();
+        const DWORD left_ms = now >= deadline ? 0 : static_cast<DWORD>(deadline - now);
+        wait_ms = poll_ms == INFINITE ? left_ms : (left_ms < poll_ms ? left_ms : poll_ms);
+      }
+      DWORD wait = ::WaitForMultipleObjects(has_wakeup ? 2 : 1, wait_handles, FALSE, wait_ms);
       if (wait == WAIT_OBJECT_0) {
         return true;
       }
+      if (wait == WAIT_OBJECT_0 + 1) {
+        return false;
+      }
       if (wait == WAIT_TIMEOUT) {
+        if (timeout_ms >= 0 && ::GetTickCount64() >= deadline) {
+          return false;
+        }
         continue;
       }
-      error = "WaitForSingleObject failed: " + FormatLastError(::GetLastError());
+      error = "WaitForMultipleObjects failed: " + FormatLastError(::GetLastError());
       return false;
     }
 
     return false;
   }
 
-  bool WaitWritable(const std::atomic<bool>& running, std::string& /*error*/) override {
-    // WinTun exposes only a read-wait event. A short sleep prevents a busy spin
-    // when the send ring is temporarily full.
+  bool WaitWritable(const std::atomic<bool>& running,
+                    const WakeupEvent* wakeup,
+                    std::string& /*error*/) override {
+    // WinTun exposes only a read-wait event. A short wait prevents a busy spin
+    // when the send ring is temporarily full; the wakeup still cuts it short.
     if (running.load()) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      if (wakeup != nullptr && wakeup->IsOpen()) {
+        ::WaitForSingleObject(wakeup->handle(), 1);
+      } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
       return running.load();
     }
     return false;
@@ -308,6 +390,61 @@ private:
     return out;
   }
 
+  // Copies the next received packet into `buffer` (truncated to
+  // `capacity`) and hands the ring slot straight back.
+  TunIoStatus ReceiveInto(uint8_t* buffer, size_t capacity, size_t& length, DWORD& err) {
+    auto& api = WintunApi::Instance();
+    DWORD packet_size = 0;
+    BYTE* packet = api.ReceivePacket(session_, &packet_size);
+    if (!packet) {
+      err = ::GetLastError();
+      switch (err) {
+        case ERROR_NO_MORE_ITEMS:
+          return TunIoStatus::kWouldBlock;
+        case ERROR_HANDLE_EOF:
+          return TunIoStatus::kClosed;
+        default:
+          return TunIoStatus::kError;
+      }
+    }
+
+    length = static_cast<size_t>(packet_size) > capacity ? capacity
+                                                         : static_cast<size_t>(packet_size);
+    std::memcpy(buffer, packet, length);
+    api.ReleaseReceivePacket(session_, packet);
+    return TunIoStatus::kOk;
+  }
+
+  // Copies one packet into the send ring. A full ring (ERROR_BUFFER_OVERFLOW)
+  // is back-pressure, not an error.
+  TunIoStatus SendFrom(const uint8_t* data, size_t length, DWORD& err) {
+    if (length == 0) {
+      return TunIoStatus::kOk;
+    }
+    if (length > WINTUN_MAX_IP_PACKET_SIZE) {
+      err = ERROR_INVALID_PARAMETER;
+      return TunIoStatus::kError;
+    }
+
+    auto& api = WintunApi::Instance();
+    BYTE* slot = api.AllocateSendPacket(session_, static_cast<DWORD>(length));
+    if (!slot) {
+      err = ::GetLastError();
+      switch (err) {
+        case ERROR_BUFFER_OVERFLOW:
+          return TunIoStatus::kWouldBlock;
+        case ERROR_HANDLE_EOF:
+          return TunIoStatus::kClosed;
+        default:
+          return TunIoStatus::kError;
+      }
+    }
+
+    std::memcpy(slot, data, length);
+    api.SendPacket(session_, slot);
+    return TunIoStatus::kOk;
+  }
+
   void EndSessionInternal() {
     if (session_) {
       WintunApi::Instance().EndSession(session_);
@@ -348,7 +485,7 @@ private:
           const size_t copy_len = static_cast<size_t>(packet_size) > buffer_size
                                       ? buffer_size
                                       : static_cast<size_t>(packet_size);
-          std::vector<uint8_t> data(packet, packet + copy_len);
+          PooledPacket data = PooledPacket::CopyOf(packet, copy_len);
           api.ReleaseReceivePacket(session_, packet);
           if (on_packet && !on_packet(std::move(data))) {
             break;
@@ -396,6 +533,75 @@ private:
     }
   }
 
+  // Batched delivery (ReceiveLoopOptions::max_batch): drains the receive
+  // ring into a coalescer and, while it holds a partial batch, waits on the
+  // read event only until the batch's deadline.
+  void BatchWorkerMain(ReceiveLoopOptions options,
+                       PacketCallback on_packet,
+                       ErrorCallback on_error) {
+    ReceiveCoalescer coalescer(options.max_batch, options.max_delay_us, options.buffer_size);
+    PacketBatch& batch = coalescer.batch();
+    HANDLE wait_handles[2] = {read_event_, quit_event_.get()};
+
+    while (worker_running_.load()) {
+      while (receive_paused_.load() && worker_running_.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      if (!worker_running_.load()) {
+        return;
+      }
+
+      const size_t held = batch.size();
+      const TunIoStatus status = ReadPackets(batch, options.buffer_size);
+      if (status == TunIoStatus::kClosed || status == TunIoStatus::kError) {
+        const std::string message =
+            status == TunIoStatus::kClosed
+                ? std::string("WinTun adapter terminating")
+                : "WintunReceivePacket failed: " +
+                      FormatLastError(static_cast<DWORD>(batch.error_code()));
+        if (!batch.empty() && on_packet) {
+          on_packet(coalescer.Take());
+        }
+        if (on_error) {
+          on_error(message);
+        }
+        worker_running_.store(false);
+        return;
+      }
+
+      // ReadPackets stops when the batch is full or the ring is empty.
+      const bool drained = !coalescer.full();
+      const uint64_t now_ns = PacketBatch::NowNs();
+      if (coalescer.ShouldDeliver(batch.size() - held, now_ns)) {
+        if (on_packet) {
+          on_packet(coalescer.Take());
+        } else {
+          batch.Clear();
+        }
+      }
+      if (!drained) {
+        continue;
+      }
+
+      // The read-wait event is auto-reset; the ring was drained above.
+      DWORD timeout = INFINITE;
+      if (!batch.empty()) {
+        const uint64_t deadline_ns = coalescer.DeadlineNs();
+        timeout = deadline_ns > now_ns ? static_cast<DWORD>((deadline_ns - now_ns) / 1000000) : 0;
+      }
+      DWORD wait = ::WaitForMultipleObjects(2, wait_handles, FALSE, timeout);
+      if (wait == WAIT_OBJECT_0 + 1) {
+        return;
+      }
+      if (wait != WAIT_OBJECT_0 && wait != WAIT_TIMEOUT) {
+        if (on_error) {
+          on_error("WaitForMultipleObjects failed: " + FormatLastError(::GetLastError()));
+        }
+        return;
+      }
+    }
+  }
+
   WINTUN_ADAPTER_HANDLE adapter_ = nullptr;
   WINTUN_SESSION_HANDLE session_ = nullptr;
   HANDLE read_event_ = nullptr; // Owned by `session_`; do not CloseHandle.
@@ -408,7 +614,9 @@ private:
 
 } // namespace
 
-std::unique_ptr<TunPlatformBackend> CreatePlatformBackend() {
+std::unique_ptr<TunPlatformBackend> CreatePlatformBackend(const TunOpenOptions& options) {
+  // Segmentation offload is Linux-only; utun/Wintun always move plain packets.
+  (void)options;
   return std::make_unique<WindowsTunBackend>();
 }
 
@@ -1,5 +1,6 @@
 #include "tunnel_forwarder.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <cstdio>
 #include <cstring>
@@ -10,7 +11,12 @@
 #include <unistd.h>
 
 #include <arpa/inet.h>
-#else
+#include <sys/socket.h>
+#endif
+#ifdef __linux__
+#include <linux/tls.h>
+#endif
+#ifdef _WIN32
 #include <winsock2.h>
 #include <uv.h>
 #include <v8.h>
@@ -20,13 +26,24 @@
 #include <openssl/err.h>
 
 #include "debug_log.h"
+#include "forwarding_hub.h"
+#include "ingress_buffer.h"
 #include "ipv6_frame.h"
+#include "tcp_offload.h"
+#include "thread_tuning.h"
+#include "tunnel_pump.h"
+#include "wakeup_event.h"
 
 namespace {
 
 constexpr char kCdTunnelMagic[] = "CDTunnel";
 constexpr size_t kCdTunnelHeaderSize = 10;
-constexpr size_t kMaxIngressBuffer = 256 * 1024;
+
+// TLS ContentType of records carrying tunnel data.
+constexpr unsigned char kTlsRecordApplicationData = 23;
+
+// Frames the device-to-tun loop hands to WritePackets at a time.
+constexpr size_t kTunWriteBatch = 64;
 
 #ifdef _WIN32
 constexpr short kPollIn = POLLRDNORM;
@@ -281,73 +298,6 @@ bool NormalizeTcpChecksum(std::vector<uint8_t>& packet, uint16_t& old_checksum,
 }
 #endif
 
-std::string FormatIpv6Address(const uint8_t* addr) {
-  char buf[40];
-  std::snprintf(buf,
-                sizeof(buf),
-                "%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x",
-                addr[0],
-                addr[1],
-                addr[2],
-                addr[3],
-                addr[4],
-                addr[5],
-                addr[6],
-                addr[7],
-                addr[8],
-                addr[9],
-                addr[10],
-                addr[11],
-                addr[12],
-                addr[13],
-                addr[14],
-                addr[15]);
-  return buf;
-}
-
-void DebugIpv6Packet(const char* tag, const uint8_t* data, size_t len, uint64_t count) {
-  if (!tuntap::DebugEnabled()) {
-    return;
-  }
-  if (data == nullptr || len < 40 || (data[0] >> 4) != 6) {
-    tuntap::FwdDebug(tag, "len=%zu packets=%llu non-ipv6", len,
-                     static_cast<unsigned long long>(count));
-    return;
-  }
-  const uint16_t payload_len = static_cast<uint16_t>((data[4] << 8) | data[5]);
-  const std::string src = FormatIpv6Address(data + 8);
-  const std::string dst = FormatIpv6Address(data + 24);
-
-  if (data[6] == 6 && len >= 60) {
-    const size_t tcp_offset = 40;
-    const uint16_t src_port = static_cast<uint16_t>((data[tcp_offset] << 8) | data[tcp_offset + 1]);
-    const uint16_t dst_port =
-        static_cast<uint16_t>((data[tcp_offset + 2] << 8) | data[tcp_offset + 3]);
-    const uint8_t flags = data[tcp_offset + 13];
-    tuntap::FwdDebug(tag,
-                     "len=%zu packets=%llu next=%u payload=%u %s:%u -> %s:%u flags=0x%02x",
-                     len,
-                     static_cast<unsigned long long>(count),
-                     data[6],
-                     payload_len,
-                     src.c_str(),
-                     src_port,
-                     dst.c_str(),
-                     dst_port,
-                     flags);
-    return;
-  }
-
-  tuntap::FwdDebug(tag,
-                   "len=%zu packets=%llu next=%u payload=%u %s -> %s",
-                   len,
-                   static_cast<unsigned long long>(count),
-                   data[6],
-                   payload_len,
-                   src.c_str(),
-                   dst.c_str());
-}
-
 void DebugSslError(const char* tag, int ssl_error) {
   unsigned long openssl_error = ERR_get_error();
 #ifdef _WIN32
@@ -364,43 +314,74 @@ void DebugSslError(const char* tag, int ssl_error) {
                    socket_error);
 }
 
-bool PollFd(int fd, short events, const std::atomic<bool>* running, TimePoint deadline) {
+// Waits for `events` on `fd`. On POSIX a signalled `wakeup` ends the wait at
+// once, so with one the wait has no timer at all; Windows sockets cannot be
+// waited on together with an event, so WSAPoll keeps re-checking `running`
+// every 200 ms there.
+bool PollFd(int fd,
+            short events,
+            const std::atomic<bool>* running,
+            TimePoint deadline,
+            const WakeupEvent* wakeup = nullptr) {
   if (fd < 0) {
     return false;
   }
 #ifdef _WIN32
-  WSAPOLLFD pfd {};
-  pfd.fd = static_cast<SOCKET>(fd);
+  (void)wakeup;
+  WSAPOLLFD pfds[1] {};
+  pfds[0].fd = static_cast<SOCKET>(fd);
+  constexpr ULONG nfds = 1;
+  constexpr int kSliceMs = 200;
 #else
-  struct pollfd pfd {};
-  pfd.fd = fd;
+  struct pollfd pfds[2] {};
+  pfds[0].fd = fd;
+  const bool has_wakeup = wakeup != nullptr && wakeup->IsOpen();
+  pfds[1].fd = has_wakeup ? wakeup->fd() : -1;
+  pfds[1].events = POLLIN;
+  const nfds_t nfds = has_wakeup ? 2 : 1;
+  const int kSliceMs = has_wakeup ? -1 : 200;
 #endif
-  pfd.events = events;
+  pfds[0].events = events;
   for (;;) {
     if (running != nullptr && !running->load()) {
       return false;
     }
-    const TimePoint now = Clock::now();
-    if (now >= deadline) {
-      return false;
+    int timeout_ms = kSliceMs;
+    if (deadline != TimePoint::max()) {
+      const TimePoint now = Clock::now();
+      if (now >= deadline) {
+        return false;
+      }
+      const auto remaining_ms =
+          std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+      if (timeout_ms < 0 || remaining_ms < timeout_ms) {
+        timeout_ms = remaining_ms > std::numeric_limits<int>::max()
+                         ? std::numeric_limits<int>::max()
+                         : static_cast<int>(remaining_ms);
+      }
     }
-    const auto remaining_ms =
-        std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
-    const int timeout_ms = remaining_ms > 200 ? 200 : static_cast<int>(remaining_ms);
 #ifdef _WIN32
-    const int rc = WSAPoll(&pfd, 1, timeout_ms);
+    const int rc = WSAPoll(pfds, nfds, timeout_ms);
 #else
-    const int rc = poll(&pfd, 1, timeout_ms);
+    const int rc = poll(pfds, nfds, timeout_ms);
 #endif
     if (rc > 0) {
-      if ((pfd.revents & (POLLERR | POLLHUP
+      if ((pfds[0].revents & (POLLERR | POLLHUP
 #ifndef _WIN32
-                          | POLLNVAL
+                              | POLLNVAL
 #endif
-                          )) != 0) {
+                              )) != 0) {
         return false;
       }
-      return (pfd.revents & events) != 0;
+      if ((pfds[0].revents & events) != 0) {
+        return true;
+      }
+#ifndef _WIN32
+      if (has_wakeup && pfds[1].revents != 0) {
+        return false;
+      }
+#endif
+      continue;
     }
     if (rc == 0) {
       continue;
@@ -416,14 +397,39 @@ bool PollFd(int fd, short events, const std::atomic<bool>* running, TimePoint de
   }
 }
 
+const char* EngineName(ForwarderEngine engine) {
+  switch (engine) {
+    case ForwarderEngine::kPump:
+      return "pump";
+    case ForwarderEngine::kPipeline:
+      return "pipeline";
+    case ForwarderEngine::kHub:
+      return "hub";
+    case ForwarderEngine::kThreaded:
+      break;
+  }
+  return "threaded";
+}
+
 }  // namespace
 
 TunnelForwarder::~TunnelForwarder() {
   Stop();
 }
 
-void TunnelForwarder::Fail(const std::string& reason) {
+void TunnelForwarder::SignalStop() {
   running_.store(false);
+  wakeup_.Signal();
+  if (egress_queue_) {
+    egress_queue_->Wake();
+  }
+  if (ingress_queue_) {
+    ingress_queue_->Wake();
+  }
+}
+
+void TunnelForwarder::Fail(const std::string& reason) {
+  SignalStop();
   if (error_reported_.exchange(true)) {
     return;
   }
@@ -442,18 +448,21 @@ void TunnelForwarder::Fail(const std::string& reason) {
 bool TunnelForwarder::Connect(int tcp_fd,
                               const std::string& cert_pem,
                               const std::string& key_pem,
+                              const TunnelSslOptions& ssl_options,
                               std::string& error) {
   Stop();
-  return ssl_.Connect(tcp_fd, cert_pem, key_pem, kTunnelHandshakeTimeoutMs, error);
+  return ssl_.Connect(tcp_fd, cert_pem, key_pem, kTunnelHandshakeTimeoutMs, ssl_options, error);
 }
 
 bool TunnelForwarder::ConnectPsk(int tcp_fd,
                                  const uint8_t* psk,
                                  size_t psk_len,
                                  const std::string& identity,
+                                 const TunnelSslOptions& ssl_options,
                                  std::string& error) {
   Stop();
-  return ssl_.ConnectPsk(tcp_fd, psk, psk_len, identity, kTunnelHandshakeTimeoutMs, error);
+  return ssl_.ConnectPsk(tcp_fd, psk, psk_len, identity, kTunnelHandshakeTimeoutMs, ssl_options,
+                         error);
 }
 
 bool TunnelForwarder::Handshake(uint32_t requested_mtu, TunnelHandshakeInfo& info, std::string& error) {
@@ -464,18 +473,21 @@ bool TunnelForwarder::Handshake(uint32_t requested_mtu, TunnelHandshakeInfo& inf
   }
 
   handshake_deadline_ = Clock::now() + std::chrono::milliseconds(kTunnelHandshakeTimeoutMs);
+  // Handshake traffic is not part of the forwarding statistics.
+  ForwarderStatsSlot handshake_stats;
 
   const std::string request =
       "{\"type\":\"clientHandshakeRequest\",\"mtu\":" + std::to_string(requested_mtu) + "}";
   const std::string packet = EncodeCdTunnelMessage(request);
-  if (SslWriteAll(reinterpret_cast<const uint8_t*>(packet.data()), packet.size(), false) < 0) {
+  if (SslWriteAll(reinterpret_cast<const uint8_t*>(packet.data()), packet.size(), handshake_stats,
+                  false) < 0) {
     error = Clock::now() >= handshake_deadline_ ? "Tunnel handshake timeout"
                                                 : "Failed to send CDTunnel handshake request";
     return false;
   }
 
   uint8_t header[kCdTunnelHeaderSize];
-  if (SslReadExact(header, kCdTunnelHeaderSize) < 0) {
+  if (SslReadExact(header, kCdTunnelHeaderSize, handshake_stats) < 0) {
     error = Clock::now() >= handshake_deadline_ ? "Tunnel handshake timeout"
                                                 : "Failed to read CDTunnel handshake header";
     return false;
@@ -486,7 +498,7 @@ bool TunnelForwarder::Handshake(uint32_t requested_mtu, TunnelHandshakeInfo& inf
   }
   const uint16_t payload_len = ntohs(*reinterpret_cast<uint16_t*>(header + 8));
   std::vector<uint8_t> body(payload_len);
-  if (payload_len > 0 && SslReadExact(body.data(), body.size()) < 0) {
+  if (payload_len > 0 && SslReadExact(body.data(), body.size(), handshake_stats) < 0) {
     error = Clock::now() >= handshake_deadline_ ? "Tunnel handshake timeout"
                                                 : "Failed to read CDTunnel handshake body";
     return false;
@@ -506,6 +518,7 @@ bool TunnelForwarder::Handshake(uint32_t requested_mtu, TunnelHandshakeInfo& inf
 }
 
 bool TunnelForwarder::StartForwarding(TunPlatformBackend* tun_backend,
+                                      const ForwarderOptions& options,
                                       ForwarderErrorCallback on_error,
                                       std::string& error) {
   if (running_.load()) {
@@ -524,9 +537,54 @@ bool TunnelForwarder::StartForwarding(TunPlatformBackend* tun_backend,
   if (tun_thread_.joinable()) {
     tun_thread_.join();
   }
+  for (std::thread& thread : tun_queue_threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+  tun_queue_threads_.clear();
   if (sock_thread_.joinable()) {
     sock_thread_.join();
   }
+  if (pump_thread_.joinable()) {
+    pump_thread_.join();
+  }
+  if (encrypt_thread_.joinable()) {
+    encrypt_thread_.join();
+  }
+  if (tun_writer_thread_.joinable()) {
+    tun_writer_thread_.join();
+  }
+  if (options.engine == ForwarderEngine::kPump || options.engine == ForwarderEngine::kHub) {
+#ifdef _WIN32
+    error = std::string("The ") + EngineName(options.engine) +
+            " forwarder engine is not supported on Windows";
+    return false;
+#else
+    if (tun_backend->GetNativeFd() < 0) {
+      error = std::string("The ") + EngineName(options.engine) +
+              " forwarder engine requires a pollable TUN file descriptor";
+      return false;
+    }
+    // These engines wait on the queue-0 fd only.
+    if (tun_backend->ActiveQueueCount() > 1) {
+      error = std::string("The ") + EngineName(options.engine) +
+              " forwarder engine does not support multi-queue TUN devices";
+      return false;
+    }
+    // ...and poll the device fd itself, on which io_uring reads are parked.
+    if (tun_backend->IoUringEnabled()) {
+      error = std::string("The ") + EngineName(options.engine) +
+              " forwarder engine does not support io_uring TUN devices";
+      return false;
+    }
+#endif
+  }
+
+  if (!wakeup_.Open(error)) {
+    return false;
+  }
+  wakeup_.Reset();
 
   error_reported_.store(false);
   {
@@ -534,19 +592,112 @@ bool TunnelForwarder::StartForwarding(TunPlatformBackend* tun_backend,
     on_error_ = std::move(on_error);
   }
 
+  {
+    // Let OpenSSL pull every queued record off the socket per recv() so the
+    // ingress loop can decode several records per wakeup.
+    std::lock_guard<std::mutex> lock(ssl_mutex_);
+    SSL_set_read_ahead(ssl_.ssl(), 1);
+    // The pump and hub engines keep calling OpenSSL (which goes straight to the kernel
+    // when offloaded). The other engines talk to the socket themselves, but
+    // only once OpenSSL holds no decrypted bytes that would be skipped.
+    const bool direct =
+        options.engine != ForwarderEngine::kPump && options.engine != ForwarderEngine::kHub;
+    ktls_tx_direct_ = direct && ssl_.ktls_send();
+    ktls_rx_direct_ = direct && ssl_.ktls_recv() && SSL_pending(ssl_.ssl()) == 0;
+  }
+
   tun_backend_ = tun_backend;
+  options_ = options;
   running_.store(true);
-  tun_writes_.store(0);
-  tun_drops_.store(0);
-  ssl_reads_.store(0);
-  tuntap::FwdDebug("forwarder-start", "mtu=%zu tunFd=%d", mtu_, tun_backend->GetNativeFd());
-  tun_thread_ = std::thread(&TunnelForwarder::TunToDeviceLoop, this);
-  sock_thread_ = std::thread(&TunnelForwarder::DeviceToTunLoop, this);
+  stats_.Reset();
+  latency_.Reset();
+  tun_gro_packets_ = 0;
+  tuntap::FwdDebug("forwarder-start",
+                   "mtu=%zu tunFd=%d engine=%s batchPackets=%zu batchBytes=%zu ktlsTx=%s ktlsRx=%s "
+                   "tunOffload=%s tunIoUring=%s",
+                   mtu_,
+                   tun_backend->GetNativeFd(),
+                   EngineName(options_.engine),
+                   options_.egress_batch_packets,
+                   options_.egress_batch_bytes,
+                   ktls_tx_direct_ ? "direct" : (ssl_.ktls_send() ? "openssl" : "off"),
+                   ktls_rx_direct_ ? "direct" : (ssl_.ktls_recv() ? "openssl" : "off"),
+                   tun_backend->OffloadEnabled() ? "true" : "false",
+                   tun_backend->IoUringEnabled() ? "true" : "false");
+  if (options_.engine == ForwarderEngine::kPump) {
+    pump_thread_ = StartWorker("tuntap-pump", options_.tun_thread, [this] { PumpLoop(); });
+    return true;
+  }
+#ifndef _WIN32
+  if (options_.engine == ForwarderEngine::kHub) {
+    if (!ForwardingHub::Instance().Attach(
+            ssl_.ssl(), tun_backend, mtu_, options_, options_.hub_workers,
+            stats_.slot(forwarder_stats::kTun), latency_,
+            [this](std::string reason) { Fail(reason); },
+            hub_id_, error)) {
+      running_.store(false);
+      tun_backend_ = nullptr;
+      return false;
+    }
+    return true;
+  }
+#endif
+  if (options_.engine == ForwarderEngine::kPipeline) {
+    egress_queue_ = std::make_unique<SpscPacketQueue>(options_.pipeline_queue_depth, mtu_);
+    ingress_queue_ = std::make_unique<SpscPacketQueue>(options_.pipeline_queue_depth, mtu_);
+    tun_thread_ = StartWorker("tuntap-tun-rd", options_.tun_thread,
+                              [this] { PipelineTunReaderLoop(); });
+    encrypt_thread_ = StartWorker("tuntap-encrypt", options_.socket_thread,
+                                  [this] { PipelineEncryptLoop(); });
+    sock_thread_ = StartWorker("tuntap-decrypt", options_.socket_thread,
+                               [this] { PipelineDecryptLoop(); });
+    tun_writer_thread_ = StartWorker("tuntap-tun-wr", options_.tun_thread,
+                                     [this] { PipelineTunWriterLoop(); });
+    return true;
+  }
+  // One reader per attached queue, so flows the kernel hashed to different
+  // queues are read and filtered in parallel.
+  const size_t queues = tun_backend->ActiveQueueCount();
+  serialize_egress_ = queues > 1;
+  if (queues > 1) {
+    tun_thread_ = StartWorker("tuntap-tun-0", options_.tun_thread, [this] { TunToDeviceLoop(0); });
+    for (size_t queue = 1; queue < queues; ++queue) {
+      tun_queue_threads_.push_back(StartWorker("tuntap-tun-" + std::to_string(queue),
+                                               options_.tun_thread,
+                                               [this, queue] { TunToDeviceLoop(queue); }));
+    }
+  } else {
+    tun_thread_ =
+        StartWorker("tuntap-tun", options_.tun_thread, [this] { TunToDeviceLoop(kAnyQueue); });
+  }
+  sock_thread_ =
+      StartWorker("tuntap-sock", options_.socket_thread, [this] { DeviceToTunLoop(); });
   return true;
 }
 
+std::thread TunnelForwarder::StartWorker(std::string name,
+                                         const ThreadTuning& tuning,
+                                         std::function<void()> loop) {
+  return std::thread([name = std::move(name), &tuning, loop = std::move(loop)]() {
+    ApplyThreadTuning(name.c_str(), tuning);
+    loop();
+  });
+}
+
 void TunnelForwarder::Stop() {
-  running_.store(false);
+  SignalStop();
+
+  // The pump thread (or hub worker) owns the SSL session without locking, so
+  // it must be gone before anything else touches it; `ssl_.Close()` sends close_notify then.
+  if (pump_thread_.joinable()) {
+    pump_thread_.join();
+  }
+#ifndef _WIN32
+  if (hub_id_ != 0) {
+    ForwardingHub::Instance().Detach(hub_id_);
+    hub_id_ = 0;
+  }
+#endif
 
   {
     std::lock_guard<std::mutex> lock(ssl_mutex_);
@@ -558,9 +709,21 @@ void TunnelForwarder::Stop() {
   if (tun_thread_.joinable()) {
     tun_thread_.join();
   }
+  for (std::thread& thread : tun_queue_threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+  tun_queue_threads_.clear();
   if (sock_thread_.joinable()) {
     sock_thread_.join();
   }
+  if (encrypt_thread_.joinable()) {
+    encrypt_thread_.join();
+  }
+  if (tun_writer_thread_.joinable()) {
+    tun_writer_thread_.join();
+  }
 
   {
     std::lock_guard<std::mutex> lock(error_mutex_);
@@ -569,15 +732,32 @@ void TunnelForwarder::Stop() {
 
   ssl_.Close();
   tun_backend_ = nullptr;
+  ktls_tx_direct_ = false;
+  ktls_rx_direct_ = false;
 }
 
-ssize_t TunnelForwarder::SslReadChunk(uint8_t* buf, size_t max_len, bool only_while_running) {
+void TunnelForwarder::GetOffloadStatus(bool& ktls_tx, bool& ktls_rx) const {
+  ktls_tx = ssl_.ktls_send();
+  ktls_rx = ssl_.ktls_recv();
+}
+
+ssize_t TunnelForwarder::SslReadChunk(uint8_t* buf,
+                                      size_t max_len,
+                                      ForwarderStatsSlot& stats,
+                                      bool only_while_running) {
   if (max_len == 0) {
     return -1;
   }
 
+  if (only_while_running && ktls_rx_direct_) {
+    return KtlsReadChunk(buf, max_len, stats);
+  }
+
   const TimePoint deadline =
       only_while_running ? TimePoint::max() : handshake_deadline_;
+  const bool spin = only_while_running && options_.spin_us > 0;
+  TimePoint spin_until{};
+  bool spinning = false;
 
   for (;;) {
     if (only_while_running && !running_.load()) {
@@ -598,9 +778,21 @@ ssize_t TunnelForwarder::SslReadChunk(uint8_t* buf, size_t max_len, bool only_wh
       if (ssl == nullptr) {
         return -1;
       }
-      n = SSL_read(ssl, buf, static_cast<int>(max_len));
-      if (n > 0) {
-        return n;
+      size_t got = 0;
+      n = SSL_read_ex(ssl, buf, max_len, &got);
+      if (n == 1) {
+        // Read ahead: keep decoding records OpenSSL already holds before going
+        // back to poll, so one wakeup can drain several records.
+        while (only_while_running && got < max_len && SSL_has_pending(ssl) == 1) {
+          size_t more = 0;
+          if (SSL_read_ex(ssl, buf + got, max_len - got, &more) != 1) {
+            // Leave any WANT_READ/error for the next call to surface.
+            ERR_clear_error();
+            break;
+          }
+          got += more;
+        }
+        return static_cast<ssize_t>(got);
       }
       err = SSL_get_error(ssl, n);
       if (err == SSL_ERROR_ZERO_RETURN) {
@@ -615,17 +807,36 @@ ssize_t TunnelForwarder::SslReadChunk(uint8_t* buf, size_t max_len, bool only_wh
       poll_events = (err == SSL_ERROR_WANT_READ) ? kPollIn : kPollOut;
     }
 
+    // Spin-then-block: retry the read (outside the lock, so the writer can
+    // interleave) for `spin_us` before parking in poll().
+    if (spin && err == SSL_ERROR_WANT_READ) {
+      if (!spinning) {
+        spinning = true;
+        spin_until = Clock::now() + std::chrono::microseconds(options_.spin_us);
+      }
+      if (Clock::now() < spin_until) {
+        CpuRelax();
+        continue;
+      }
+    }
+    spinning = false;
+
+    stats.Add(err == SSL_ERROR_WANT_READ ? forwarder_stats::kSslWantRead
+                                         : forwarder_stats::kSslWantWrite);
     const std::atomic<bool>* running = only_while_running ? &running_ : nullptr;
-    if (!PollFd(fd, poll_events, running, deadline)) {
+    const uint64_t wait_start = forwarder_latency::Now();
+    if (!PollFd(fd, poll_events, running, deadline, only_while_running ? &wakeup_ : nullptr)) {
       return -1;
     }
+    latency_.Record(forwarder_latency::kIngressSocketWait, wait_start, forwarder_latency::Now());
+    stats.Add(forwarder_stats::kPollWakeups);
   }
 }
 
-ssize_t TunnelForwarder::SslReadExact(uint8_t* buf, size_t len) {
+ssize_t TunnelForwarder::SslReadExact(uint8_t* buf, size_t len, ForwarderStatsSlot& stats) {
   size_t got = 0;
   while (got < len) {
-    const ssize_t n = SslReadChunk(buf + got, len - got, false);
+    const ssize_t n = SslReadChunk(buf + got, len - got, stats, false);
     if (n < 0) {
       return -1;
     }
@@ -634,7 +845,14 @@ ssize_t TunnelForwarder::SslReadExact(uint8_t* buf, size_t len) {
   return static_cast<ssize_t>(got);
 }
 
-ssize_t TunnelForwarder::SslWriteAll(const uint8_t* data, size_t len, bool only_while_running) {
+ssize_t TunnelForwarder::SslWriteAll(const uint8_t* data,
+                                     size_t len,
+                                     ForwarderStatsSlot& stats,
+                                     bool only_while_running) {
+  if (only_while_running && ktls_tx_direct_) {
+    return KtlsWriteAll(data, len, stats);
+  }
+
   size_t sent = 0;
   const TimePoint deadline =
       only_while_running ? TimePoint::max() : handshake_deadline_;
@@ -676,33 +894,160 @@ ssize_t TunnelForwarder::SslWriteAll(const uint8_t* data, size_t len, bool only_
       poll_events = (err == SSL_ERROR_WANT_READ) ? kPollIn : kPollOut;
     }
 
+    stats.Add(err == SSL_ERROR_WANT_READ ? forwarder_stats::kSslWantRead
+                                         : forwarder_stats::kSslWantWrite);
     const std::atomic<bool>* running = only_while_running ? &running_ : nullptr;
-    if (!PollFd(fd, poll_events, running, deadline)) {
+    const uint64_t wait_start = forwarder_latency::Now();
+    if (!PollFd(fd, poll_events, running, deadline, only_while_running ? &wakeup_ : nullptr)) {
       return -1;
     }
+    latency_.Record(forwarder_latency::kEgressSocketWait, wait_start, forwarder_latency::Now());
+    stats.Add(forwarder_stats::kPollWakeups);
   }
   return static_cast<ssize_t>(sent);
 }
 
-TunReadResult TunnelForwarder::ReadTunPacket(std::vector<uint8_t>& out) {
+// kTLS data paths: the kernel frames and encrypts application-data records, so
+// plain socket I/O replaces SSL_write/SSL_read and needs no `ssl_mutex_`.
+ssize_t TunnelForwarder::KtlsWriteAll(const uint8_t* data, size_t len, ForwarderStatsSlot& stats) {
+#ifdef __linux__
+  const int fd = ssl_.fd();
+  size_t sent = 0;
+  while (sent < len) {
+    if (!running_.load()) {
+      return -1;
+    }
+    const ssize_t n = ::send(fd, data + sent, len - sent, MSG_NOSIGNAL);
+    if (n > 0) {
+      sent += static_cast<size_t>(n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      stats.Add(forwarder_stats::kSslWantWrite);
+      const uint64_t wait_start = forwarder_latency::Now();
+      if (!PollFd(fd, kPollOut, &running_, TimePoint::max(), &wakeup_)) {
+        return -1;
+      }
+      latency_.Record(forwarder_latency::kEgressSocketWait, wait_start, forwarder_latency::Now());
+      stats.Add(forwarder_stats::kPollWakeups);
+      continue;
+    }
+    tuntap::FwdDebug("forwarder-ktls-send-error", "errno=%d %s", errno, strerror(errno));
+    return -1;
+  }
+  return static_cast<ssize_t>(sent);
+#else
+  return -1;
+#endif
+}
+
+ssize_t TunnelForwarder::KtlsReadChunk(uint8_t* buf, size_t max_len, ForwarderStatsSlot& stats) {
+#ifdef __linux__
+  const int fd = ssl_.fd();
+  for (;;) {
+    if (!running_.load()) {
+      return -1;
+    }
+    struct iovec iov {buf, max_len};
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(unsigned char))];
+    struct msghdr msg {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    const ssize_t n = ::recvmsg(fd, &msg, 0);
+    if (n > 0) {
+      // The kernel never mixes record types in one read and tags each read
+      // with the type; anything but application data (alerts, close_notify,
+      // renegotiation) ends the session.
+      const struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+      if (cmsg != nullptr && cmsg->cmsg_level == SOL_TLS &&
+          cmsg->cmsg_type == TLS_GET_RECORD_TYPE &&
+          *CMSG_DATA(cmsg) != kTlsRecordApplicationData) {
+        tuntap::FwdTrace("forwarder-ktls-recv-record", "type=%u len=%zd",
+                         static_cast<unsigned>(*CMSG_DATA(cmsg)), n);
+        return -1;
+      }
+      return n;
+    }
+    if (n == 0) {
+      tuntap::FwdDebug("forwarder-ktls-recv-close", "fd=%d", fd);
+      return -1;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      stats.Add(forwarder_stats::kSslWantRead);
+      const uint64_t wait_start = forwarder_latency::Now();
+      if (!PollFd(fd, kPollIn, &running_, TimePoint::max(), &wakeup_)) {
+        return -1;
+      }
+      latency_.Record(forwarder_latency::kIngressSocketWait, wait_start, forwarder_latency::Now());
+      stats.Add(forwarder_stats::kPollWakeups);
+      continue;
+    }
+    tuntap::FwdDebug("forwarder-ktls-recv-error", "errno=%d %s", errno, strerror(errno));
+    return -1;
+  }
+#else
+  return -1;
+#endif
+}
+
+TunReadResult TunnelForwarder::ReadTunPacket(std::vector<uint8_t>& out,
+                                             ForwarderStatsSlot& stats,
+                                             bool wait,
+                                             size_t queue) {
   if (tun_backend_ == nullptr) {
     return TunReadResult::kFatal;
   }
 
+  auto read = [&](std::string& err) {
+    return queue == kAnyQueue ? tun_backend_->ReadPacket(mtu_, out, err)
+                              : tun_backend_->ReadQueuePacket(queue, mtu_, out, err);
+  };
   std::string error;
-  const ReadPacketStatus status = tun_backend_->ReadPacket(mtu_, out, error);
+  const ReadPacketStatus status = read(error);
   switch (status) {
     case ReadPacketStatus::Data:
       return TunReadResult::kOk;
-    case ReadPacketStatus::NoData:
-      tuntap::FwdDebug("forwarder-tun-wait", "fd=%d", tun_backend_->GetNativeFd());
-      if (!tun_backend_->WaitReadable(running_, error)) {
+    case ReadPacketStatus::NoData: {
+      stats.Add(forwarder_stats::kTunReadWouldBlock);
+      if (!wait) {
+        return TunReadResult::kWouldBlock;
+      }
+      if (options_.spin_us > 0) {
+        const TimePoint spin_until = Clock::now() + std::chrono::microseconds(options_.spin_us);
+        ReadPacketStatus spun = ReadPacketStatus::NoData;
+        while (spun == ReadPacketStatus::NoData && running_.load() && Clock::now() < spin_until) {
+          CpuRelax();
+          spun = read(error);
+        }
+        if (spun == ReadPacketStatus::Data) {
+          return TunReadResult::kOk;
+        }
+        if (spun != ReadPacketStatus::NoData) {
+          return running_.load() ? TunReadResult::kFatal : TunReadResult::kWouldBlock;
+        }
+      }
+      tuntap::FwdTrace("forwarder-tun-wait", "fd=%d", tun_backend_->GetNativeFd());
+      const bool readable = queue == kAnyQueue
+                                ? tun_backend_->WaitReadable(running_, &wakeup_, error)
+                                : tun_backend_->WaitQueueReadable(queue, running_, &wakeup_, error);
+      if (!readable) {
         if (!error.empty()) {
           tuntap::FwdDebug("forwarder-tun-wait-error", "%s", error.c_str());
         }
         return running_.load() ? TunReadResult::kFatal : TunReadResult::kWouldBlock;
       }
+      stats.Add(forwarder_stats::kPollWakeups);
       return TunReadResult::kWouldBlock;
+    }
     case ReadPacketStatus::Closed:
       return running_.load() ? TunReadResult::kFatal : TunReadResult::kWouldBlock;
     case ReadPacketStatus::Error:
@@ -715,14 +1060,18 @@ TunReadResult TunnelForwarder::ReadTunPacket(std::vector<uint8_t>& out) {
   return TunReadResult::kFatal;
 }
 
-ssize_t TunnelForwarder::WriteTunPacket(const uint8_t* data, size_t len) {
+ssize_t TunnelForwarder::WriteTunPacket(const uint8_t* data,
+                                        size_t len,
+                                        ForwarderStatsSlot& stats,
+                                        const TunGsoInfo* gso) {
   if (tun_backend_ == nullptr) {
     return -1;
   }
 
   for (;;) {
     std::string error;
-    const ssize_t n = tun_backend_->WritePacket(data, len, error);
+    const ssize_t n = gso != nullptr ? tun_backend_->WriteGsoPacket(data, len, *gso, error)
+                                     : tun_backend_->WritePacket(data, len, error);
     if (n == static_cast<ssize_t>(len)) {
       return n;
     }
@@ -737,21 +1086,185 @@ ssize_t TunnelForwarder::WriteTunPacket(const uint8_t* data, size_t len) {
       return -1;
     }
 
-    tuntap::FwdDebug("forwarder-tun-write-blocked", "fd=%d", tun_backend_->GetNativeFd());
-    if (!tun_backend_->WaitWritable(running_, error)) {
+    stats.Add(forwarder_stats::kTunWriteBlocked);
+    tuntap::FwdTrace("forwarder-tun-write-blocked", "fd=%d", tun_backend_->GetNativeFd());
+    const uint64_t wait_start = forwarder_latency::Now();
+    if (!tun_backend_->WaitWritable(running_, &wakeup_, error)) {
       if (!error.empty()) {
         tuntap::FwdDebug("forwarder-tun-write-wait-error", "%s", error.c_str());
       }
       return -1;
     }
+    latency_.Record(forwarder_latency::kIngressTunWait, wait_start, forwarder_latency::Now());
+    stats.Add(forwarder_stats::kPollWakeups);
+  }
+}
+
+bool TunnelForwarder::WriteTunBatch(PacketBatch& batch, ForwarderStatsSlot& stats) {
+  for (;;) {
+    const TunIoStatus status = tun_backend_->WritePackets(batch);
+    if (status == TunIoStatus::kOk) {
+      return true;
+    }
+    if (status != TunIoStatus::kWouldBlock) {
+      tuntap::FwdDebug("forwarder-tun-write-error", "%s",
+                       TunIoErrorString(batch.error_code()).c_str());
+      return false;
+    }
+
+    stats.Add(forwarder_stats::kTunWriteBlocked);
+    tuntap::FwdTrace("forwarder-tun-write-blocked", "fd=%d pending=%zu",
+                     tun_backend_->GetNativeFd(), batch.size() - batch.cursor());
+    std::string error;
+    const uint64_t wait_start = forwarder_latency::Now();
+    if (!tun_backend_->WaitWritable(running_, &wakeup_, error)) {
+      if (!error.empty()) {
+        tuntap::FwdDebug("forwarder-tun-write-wait-error", "%s", error.c_str());
+      }
+      return false;
+    }
+    latency_.Record(forwarder_latency::kIngressTunWait, wait_start, forwarder_latency::Now());
+    stats.Add(forwarder_stats::kPollWakeups);
+  }
+}
+
+bool TunnelForwarder::FlushGro(tcp_offload::TcpGroCoalescer& gro, ForwarderStatsSlot& stats) {
+  if (gro.empty()) {
+    return true;
+  }
+  ssize_t n;
+  if (gro.segments() == 1) {
+    n = WriteTunPacket(gro.data(), gro.size(), stats);
+  } else {
+    TunGsoInfo gso;
+    gro.Finish(gso);
+    n = WriteTunPacket(gro.data(), gro.size(), stats, &gso);
+    const uint64_t count = ++tun_gro_packets_;
+    if (count <= 20 || count % 200 == 0) {
+      tuntap::FwdTrace("forwarder-tun-gro", "segments=%zu bytes=%zu mss=%u packets=%llu",
+                       gro.segments(), gro.size(), gso.segment_size,
+                       static_cast<unsigned long long>(count));
+    }
   }
+  gro.Reset();
+  return n >= 0;
 }
 
-void TunnelForwarder::TunToDeviceLoop() {
+bool TunnelForwarder::FlushTunWrites() {
+  std::string error;
+  if (!tun_backend_->FlushWrites(error)) {
+    tuntap::FwdDebug("forwarder-tun-write-error", "%s", error.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool TunnelForwarder::SendEgress(const uint8_t* data,
+                                 size_t len,
+                                 ForwarderStatsSlot& stats,
+                                 const uint64_t* read_ticks,
+                                 size_t packets) {
+  std::unique_lock<std::mutex> lock(egress_mutex_, std::defer_lock);
+  if (serialize_egress_) {
+    lock.lock();
+  }
+  if (SslWriteAll(data, len, stats) < 0) {
+    if (running_.load()) {
+      Fail("SSL write failed in tun-to-device loop");
+    }
+    return false;
+  }
+  // Recorded under the egress lock: the histograms take one writer at a time.
+  const uint64_t sent = forwarder_latency::Now();
+  for (size_t i = 0; i < packets; ++i) {
+    latency_.Record(forwarder_latency::kEgressTunToTunnel, read_ticks[i], sent);
+  }
+  return true;
+}
+
+// Applies the per-packet egress filters and accounting shared by the threaded
+// and pipeline engines. Returns false when the packet must not be sent.
+bool TunnelForwarder::AdmitEgressPacket(std::vector<uint8_t>& packet, ForwarderStatsSlot& stats) {
+#ifdef _WIN32
+  if (!IsIpv6Packet(packet.data(), packet.size())) {
+    const uint64_t count = stats.Add(forwarder_stats::kDropNonIpv6);
+    if (count <= 20 || count % 200 == 0) {
+      tuntap::FwdTracePacket("forwarder-tun-drop-nonipv6", packet.data(), packet.size(), count);
+    }
+    return false;
+  }
+  if (IsIpv6Multicast(packet.data(), packet.size())) {
+    const uint64_t count = stats.Add(forwarder_stats::kDropMulticast);
+    if (count <= 20 || count % 200 == 0) {
+      tuntap::FwdTracePacket("forwarder-tun-drop-mcast", packet.data(), packet.size(), count);
+    }
+    return false;
+  }
+  if (IsIcmpv6NeighborDiscovery(packet.data(), packet.size())) {
+    const uint64_t count = stats.Add(forwarder_stats::kDropNeighborDiscovery);
+    if (count <= 20 || count % 200 == 0) {
+      tuntap::FwdTracePacket("forwarder-tun-drop-ndp", packet.data(), packet.size(), count);
+    }
+    return false;
+  }
+  uint16_t old_checksum = 0;
+  uint16_t new_checksum = 0;
+  const bool checksum_changed = NormalizeTcpChecksum(packet, old_checksum, new_checksum);
+#endif
+  stats.Add(forwarder_stats::kEgressBytes, packet.size());
+  const uint64_t count = stats.Add(forwarder_stats::kEgressPackets);
+  if (count <= 100 || count % 200 == 0) {
+    tuntap::FwdTracePacket("forwarder-tun-write", packet.data(), packet.size(), count);
+#ifdef _WIN32
+    tuntap::FwdTrace("forwarder-tcp-checksum",
+                     "packets=%llu changed=%s old=0x%04x new=0x%04x",
+                     static_cast<unsigned long long>(count),
+                     checksum_changed ? "true" : "false",
+                     old_checksum,
+                     new_checksum);
+#endif
+  }
+  return true;
+}
+
+void TunnelForwarder::TunToDeviceLoop(size_t queue) {
+  ForwarderStatsSlot& stats = stats_.tun_queue_slot(queue);
   std::vector<uint8_t> packet;
+  std::vector<uint8_t> batch;
+  size_t batch_packets = 0;
+  // TUN read completion time of each packet in `batch`.
+  std::vector<uint64_t> batch_read_ticks;
+  // In offload mode the backend segments TSO super-packets; all segments of
+  // one super-packet go out in a single batch regardless of the budgets.
+  const bool offload = tun_backend_->OffloadEnabled();
+  const bool batching = options_.egress_batch_packets > 1 || offload;
+  if (batching) {
+    batch.reserve(std::max(options_.egress_batch_bytes, offload ? tcp_offload::kMaxSuperPacket : 0) +
+                  mtu_);
+  }
+
+  auto flush_batch = [&]() -> bool {
+    if (batch_packets == 0) {
+      return true;
+    }
+    const size_t packets = batch_packets;
+    const size_t bytes = batch.size();
+    batch_packets = 0;
+    if (!SendEgress(batch.data(), bytes, stats, batch_read_ticks.data(), packets)) {
+      return false;
+    }
+    batch.clear();
+    batch_read_ticks.clear();
+    if (packets > 1) {
+      tuntap::FwdTrace("forwarder-tun-batch", "packets=%zu bytes=%zu", packets, bytes);
+    }
+    return true;
+  };
 
   while (running_.load()) {
-    const TunReadResult read_result = ReadTunPacket(packet);
+    // Only the first packet of a batch waits for readiness; the rest of the
+    // run drains whatever the kernel has already queued.
+    const TunReadResult read_result = ReadTunPacket(packet, stats, batch_packets == 0, queue);
     if (read_result == TunReadResult::kFatal) {
       if (running_.load()) {
         Fail("TUN read failed in tun-to-device loop");
@@ -759,95 +1272,428 @@ void TunnelForwarder::TunToDeviceLoop() {
       return;
     }
     if (read_result != TunReadResult::kOk || packet.empty()) {
+      if (!flush_batch()) {
+        return;
+      }
       continue;
     }
-#ifdef _WIN32
-    if (!IsIpv6Packet(packet.data(), packet.size())) {
-      const uint64_t count = ++tun_drops_;
-      if (count <= 20 || count % 200 == 0) {
-        DebugIpv6Packet("forwarder-tun-drop-nonipv6", packet.data(), packet.size(), count);
-      }
+    const uint64_t read_done = forwarder_latency::Now();
+    if (!AdmitEgressPacket(packet, stats)) {
       continue;
     }
-    if (IsIpv6Multicast(packet.data(), packet.size())) {
-      const uint64_t count = ++tun_drops_;
-      if (count <= 20 || count % 200 == 0) {
-        DebugIpv6Packet("forwarder-tun-drop-mcast", packet.data(), packet.size(), count);
+    if (batching) {
+      batch.insert(batch.end(), packet.begin(), packet.end());
+      batch_read_ticks.push_back(read_done);
+      ++batch_packets;
+    } else if (!SendEgress(packet.data(), packet.size(), stats, &read_done, 1)) {
+      return;
+    }
+    const bool mid_super_packet =
+        offload && (queue == kAnyQueue ? tun_backend_->HasBufferedPackets()
+                                       : tun_backend_->HasBufferedQueuePackets(queue));
+    if (batching && !mid_super_packet &&
+        (batch_packets >= options_.egress_batch_packets ||
+         batch.size() + mtu_ > options_.egress_batch_bytes)) {
+      if (!flush_batch()) {
+        return;
       }
+    }
+  }
+}
+
+void TunnelForwarder::DeviceToTunLoop() {
+  ForwarderStatsSlot& stats = stats_.slot(forwarder_stats::kSocket);
+  uint64_t ssl_reads = 0;
+  IngressBuffer ingress(kIngressBufferCapacity);
+  // In offload mode consecutive segments of a TCP flow decoded from one read
+  // are injected as a single GSO super-packet.
+  const bool gro_enabled = tun_backend_->OffloadEnabled();
+  tcp_offload::TcpGroCoalescer gro;
+  // Other frames are described in place in the ingress buffer and written
+  // with one WritePackets call per run. The batch is always written before
+  // the GRO group so frames reach the device in stream order.
+  PacketBatch batch(kTunWriteBatch, 0);
+
+  while (running_.load()) {
+    if (!ingress.Reserve(kIngressReadReserve)) {
+      Fail("SSL ingress buffer overflow");
+      return;
+    }
+
+    const ssize_t n = SslReadChunk(ingress.write_ptr(), ingress.writable(), stats);
+    if (n < 0) {
+      if (running_.load()) {
+        Fail("SSL read failed in device-to-tun loop");
+      }
+      return;
+    }
+    if (n == 0) {
       continue;
     }
-    if (IsIcmpv6NeighborDiscovery(packet.data(), packet.size())) {
-      const uint64_t count = ++tun_drops_;
-      if (count <= 20 || count % 200 == 0) {
-        DebugIpv6Packet("forwarder-tun-drop-ndp", packet.data(), packet.size(), count);
+    const uint64_t read_done = forwarder_latency::Now();
+
+    const uint64_t count = ++ssl_reads;
+    if (count == 1 || count % 200 == 0) {
+      tuntap::FwdTrace("forwarder-ssl-read", "len=%zd chunks=%llu buffered=%zu", n,
+                       static_cast<unsigned long long>(count), ingress.readable());
+    }
+
+    ingress.Commit(static_cast<size_t>(n));
+    stats.Max(forwarder_stats::kIngressHighWater, ingress.readable());
+
+    const uint8_t* base = ingress.read_ptr();
+    const size_t readable = ingress.readable();
+    batch.Wrap(base, readable);
+    // FrameToTun starts at the read, or at the previous TUN write for frames
+    // extracted after it.
+    uint64_t extracted = read_done;
+    const auto written = [&](size_t frames) {
+      const uint64_t now = forwarder_latency::Now();
+      latency_.Record(forwarder_latency::kIngressFrameToTun, extracted, now, frames);
+      extracted = now;
+    };
+    const auto flush_batch = [&]() {
+      if (batch.empty()) {
+        return true;
+      }
+      const size_t frames = batch.size();
+      if (!WriteTunBatch(batch, stats)) {
+        return false;
+      }
+      written(frames);
+      batch.Wrap(base, readable);
+      return true;
+    };
+    const auto flush_gro = [&]() {
+      const size_t frames = gro.segments();
+      if (!FlushGro(gro, stats)) {
+        return false;
+      }
+      if (frames > 0) {
+        written(frames);
       }
+      return true;
+    };
+
+    bool write_failed = false;
+    const size_t consumed =
+        ipv6_frame::ForEachFrame(base, readable, [&](const uint8_t* frame, size_t len) {
+          stats.Add(forwarder_stats::kIngressPackets);
+          stats.Add(forwarder_stats::kIngressBytes, len);
+          latency_.Record(forwarder_latency::kIngressReadToFrame, read_done,
+                          forwarder_latency::Now());
+          if (gro_enabled) {
+            if (gro.Add(frame, len)) {
+              return true;
+            }
+            if (!flush_batch() || !flush_gro()) {
+              write_failed = true;
+              return false;
+            }
+            if (gro.Add(frame, len)) {
+              return true;
+            }
+          }
+          const size_t offset = static_cast<size_t>(frame - base);
+          if (!batch.AddRange(offset, len)) {
+            if (!flush_batch() || !batch.AddRange(offset, len)) {
+              write_failed = true;
+              return false;
+            }
+          }
+          return true;
+        });
+    if (!write_failed && (!flush_batch() || !flush_gro() || !FlushTunWrites())) {
+      write_failed = true;
+    }
+    if (write_failed) {
+      if (running_.load()) {
+        Fail("TUN write failed in device-to-tun loop");
+      }
+      return;
+    }
+    ingress.Consume(consumed);
+  }
+}
+
+void TunnelForwarder::PumpLoop() {
+#ifndef _WIN32
+  ForwarderStatsSlot& stats = stats_.slot(forwarder_stats::kTun);
+  TunnelPump pump(ssl_.ssl(), tun_backend_, mtu_, options_, stats, latency_);
+  struct pollfd fds[3] {};
+  fds[0].fd = tun_backend_->GetNativeFd();
+  fds[1].fd = SSL_get_fd(ssl_.ssl());
+  fds[2].fd = wakeup_.fd();
+  fds[2].events = POLLIN;
+
+  while (running_.load()) {
+    PumpInterest interest;
+    std::string error;
+    if (!pump.Pump(interest, error)) {
+      if (running_.load()) {
+        Fail(error.empty() ? "Pump engine failed" : error);
+      }
+      return;
+    }
+    if (interest.again) {
       continue;
     }
-    uint16_t old_checksum = 0;
-    uint16_t new_checksum = 0;
-    const bool checksum_changed = NormalizeTcpChecksum(packet, old_checksum, new_checksum);
-#endif
-    if (SslWriteAll(packet.data(), packet.size()) < 0) {
+
+    fds[0].events = static_cast<short>((interest.tun_readable ? POLLIN : 0) |
+                                       (interest.tun_writable ? POLLOUT : 0));
+    fds[1].events = static_cast<short>((interest.sock_readable ? POLLIN : 0) |
+                                       (interest.sock_writable ? POLLOUT : 0));
+    fds[0].revents = 0;
+    fds[1].revents = 0;
+    // Stop() signals the wakeup fd, so the wait needs no timeout.
+    const uint64_t wait_start = forwarder_latency::Now();
+    const int rc = poll(fds, 3, -1);
+    // The wait counts toward every stage that was waiting on it.
+    const uint64_t wait_end = forwarder_latency::Now();
+    if (interest.tun_writable) {
+      latency_.Record(forwarder_latency::kIngressTunWait, wait_start, wait_end);
+    }
+    if (interest.sock_writable) {
+      latency_.Record(forwarder_latency::kEgressSocketWait, wait_start, wait_end);
+    }
+    if (interest.sock_readable) {
+      latency_.Record(forwarder_latency::kIngressSocketWait, wait_start, wait_end);
+    }
+    if (rc < 0 && errno != EINTR) {
       if (running_.load()) {
-        Fail("SSL write failed in tun-to-device loop");
+        Fail(std::string("Pump engine poll failed: ") + strerror(errno));
       }
       return;
     }
-    const uint64_t count = ++tun_writes_;
-    if (count <= 100 || count % 200 == 0) {
-      DebugIpv6Packet("forwarder-tun-write", packet.data(), packet.size(), count);
-#ifdef _WIN32
-      tuntap::FwdDebug("forwarder-tcp-checksum",
-                       "packets=%llu changed=%s old=0x%04x new=0x%04x",
-                       static_cast<unsigned long long>(count),
-                       checksum_changed ? "true" : "false",
-                       old_checksum,
-                       new_checksum);
-#endif
+    stats.Add(forwarder_stats::kPollWakeups);
+    if ((fds[0].revents & (POLLERR | POLLNVAL)) != 0) {
+      if (running_.load()) {
+        Fail("TUN device poll failed in pump engine");
+      }
+      return;
     }
+    // Socket POLLHUP/POLLERR fall through: the next SSL call reports the
+    // concrete failure.
   }
+
+  tuntap::FwdDebug("forwarder-pump-exit",
+                   "egressPackets=%llu ingressFrames=%llu",
+                   static_cast<unsigned long long>(stats.Get(forwarder_stats::kEgressPackets)),
+                   static_cast<unsigned long long>(stats.Get(forwarder_stats::kIngressPackets)));
+#endif
 }
 
-void TunnelForwarder::DeviceToTunLoop() {
-  std::vector<uint8_t> ingress;
-  uint8_t chunk[16384];
+// --- pipeline engine ---
+//
+// TUN reader -> egress_queue_ -> encryptor    (SSL_write under ssl_mutex_)
+// decryptor  -> ingress_queue_ -> TUN writer  (SSL_read under ssl_mutex_)
+//
+// Each queue has exactly one producer and one consumer thread. Stages park on
+// the queue when it is full/empty and exit once `running_` drops; SignalStop()
+// wakes them.
+
+void TunnelForwarder::PipelineTunReaderLoop() {
+  ForwarderStatsSlot& stats = stats_.slot(forwarder_stats::kTun);
+  std::vector<uint8_t> packet;
+  SpscPacketQueue& queue = *egress_queue_;
 
   while (running_.load()) {
-    const ssize_t n = SslReadChunk(chunk, sizeof(chunk));
-    if (n < 0) {
+    const TunReadResult read_result = ReadTunPacket(packet, stats);
+    if (read_result == TunReadResult::kFatal) {
       if (running_.load()) {
-        Fail("SSL read failed in device-to-tun loop");
+        Fail("TUN read failed in pipeline reader");
       }
       return;
     }
-    if (n == 0) {
+    if (read_result != TunReadResult::kOk || packet.empty()) {
+      continue;
+    }
+    const uint64_t read_done = forwarder_latency::Now();
+    if (!AdmitEgressPacket(packet, stats)) {
+      continue;
+    }
+    if (packet.size() > queue.slot_size()) {
+      const uint64_t count = stats.Add(forwarder_stats::kDropOversize);
+      tuntap::FwdDebug("forwarder-pipeline-oversize", "dir=egress len=%zu drops=%llu",
+                       packet.size(), static_cast<unsigned long long>(count));
       continue;
     }
 
-    const uint64_t count = ++ssl_reads_;
-    if (count == 1 || count % 200 == 0) {
-      tuntap::FwdDebug("forwarder-ssl-read", "len=%zd chunks=%llu", n,
-                       static_cast<unsigned long long>(count));
+    uint8_t* slot = queue.BeginPush();
+    while (slot == nullptr) {
+      if (!queue.WaitNotFull(running_)) {
+        return;
+      }
+      slot = queue.BeginPush();
+    }
+    std::memcpy(slot, packet.data(), packet.size());
+    queue.CommitPush(packet.size(), read_done);
+  }
+}
+
+void TunnelForwarder::PipelineEncryptLoop() {
+  ForwarderStatsSlot& stats = stats_.slot(forwarder_stats::kEncrypt);
+  SpscPacketQueue& queue = *egress_queue_;
+  std::vector<uint8_t> batch;
+  std::vector<uint64_t> batch_read_ticks;
+  const bool batching = options_.egress_batch_packets > 1;
+  if (batching) {
+    batch.reserve(options_.egress_batch_bytes + mtu_);
+    batch_read_ticks.reserve(options_.egress_batch_packets);
+  }
+
+  while (running_.load()) {
+    if (!queue.WaitNotEmpty(running_)) {
+      return;
+    }
+
+    const uint8_t* data = nullptr;
+    size_t len = 0;
+    if (!batching) {
+      // Send straight from the slot; popping afterwards keeps the reader
+      // throttled to what the socket actually accepts.
+      if (!queue.Front(data, len)) {
+        return;
+      }
+      const uint64_t read_done = queue.FrontStamp();
+      if (!SendEgress(data, len, stats, &read_done, 1)) {
+        return;
+      }
+      queue.Pop();
+      continue;
+    }
+
+    size_t packets = 0;
+    batch.clear();
+    batch_read_ticks.clear();
+    while (packets < options_.egress_batch_packets && queue.Front(data, len) &&
+           (packets == 0 || batch.size() + len <= options_.egress_batch_bytes)) {
+      batch.insert(batch.end(), data, data + len);
+      batch_read_ticks.push_back(queue.FrontStamp());
+      queue.Pop();
+      ++packets;
+    }
+    if (!SendEgress(batch.data(), batch.size(), stats, batch_read_ticks.data(), packets)) {
+      return;
     }
+    if (packets > 1) {
+      tuntap::FwdTrace("forwarder-tun-batch", "packets=%zu bytes=%zu", packets, batch.size());
+    }
+  }
+}
+
+void TunnelForwarder::PipelineDecryptLoop() {
+  ForwarderStatsSlot& stats = stats_.slot(forwarder_stats::kSocket);
+  SpscPacketQueue& queue = *ingress_queue_;
+  IngressBuffer ingress(kIngressBufferCapacity);
 
-    if (ingress.size() + static_cast<size_t>(n) > kMaxIngressBuffer) {
+  while (running_.load()) {
+    if (!ingress.Reserve(kIngressReadReserve)) {
       Fail("SSL ingress buffer overflow");
       return;
     }
-    ingress.insert(ingress.end(), chunk, chunk + n);
 
-    std::vector<std::vector<uint8_t>> frames;
-    ipv6_frame::DrainFrames(ingress, frames);
+    const ssize_t n = SslReadChunk(ingress.write_ptr(), ingress.writable(), stats);
+    if (n < 0) {
+      if (running_.load()) {
+        Fail("SSL read failed in pipeline decryptor");
+      }
+      return;
+    }
+    if (n == 0) {
+      continue;
+    }
+    const uint64_t read_done = forwarder_latency::Now();
+    ingress.Commit(static_cast<size_t>(n));
+    stats.Max(forwarder_stats::kIngressHighWater, ingress.readable());
+
+    bool stopped = false;
+    const size_t consumed = ipv6_frame::ForEachFrame(
+        ingress.read_ptr(), ingress.readable(), [&](const uint8_t* frame, size_t len) {
+          if (len > queue.slot_size()) {
+            const uint64_t count = stats.Add(forwarder_stats::kDropOversize);
+            tuntap::FwdDebug("forwarder-pipeline-oversize", "dir=ingress len=%zu drops=%llu",
+                             len, static_cast<unsigned long long>(count));
+            return true;
+          }
+          uint8_t* slot = queue.BeginPush();
+          while (slot == nullptr) {
+            if (!queue.WaitNotFull(running_)) {
+              stopped = true;
+              return false;
+            }
+            slot = queue.BeginPush();
+          }
+          // Taken once the frame has a slot, so a full queue counts here.
+          const uint64_t extracted = forwarder_latency::Now();
+          latency_.Record(forwarder_latency::kIngressReadToFrame, read_done, extracted);
+          std::memcpy(slot, frame, len);
+          queue.CommitPush(len, extracted);
+          return true;
+        });
+    if (stopped) {
+      return;
+    }
+    ingress.Consume(consumed);
+  }
+}
+
+void TunnelForwarder::PipelineTunWriterLoop() {
+  ForwarderStatsSlot& stats = stats_.slot(forwarder_stats::kTunWriter);
+  SpscPacketQueue& queue = *ingress_queue_;
+  // Extraction time of each frame written since the last flush.
+  std::vector<uint64_t> extracted;
+  extracted.reserve(queue.capacity());
 
-    for (const auto& frame : frames) {
-      if (WriteTunPacket(frame.data(), frame.size()) < 0) {
+  while (running_.load()) {
+    if (!queue.WaitNotEmpty(running_)) {
+      return;
+    }
+    const uint8_t* data = nullptr;
+    size_t len = 0;
+    while (queue.Front(data, len)) {
+      if (WriteTunPacket(data, len, stats) < 0) {
         if (running_.load()) {
-          Fail("TUN write failed in device-to-tun loop");
+          Fail("TUN write failed in pipeline writer");
         }
         return;
       }
+      stats.Add(forwarder_stats::kIngressPackets);
+      stats.Add(forwarder_stats::kIngressBytes, len);
+      extracted.push_back(queue.FrontStamp());
+      queue.Pop();
     }
+    if (!FlushTunWrites()) {
+      if (running_.load()) {
+        Fail("TUN write failed in pipeline writer");
+      }
+      return;
+    }
+    const uint64_t flushed = forwarder_latency::Now();
+    for (const uint64_t tick : extracted) {
+      latency_.Record(forwarder_latency::kIngressFrameToTun, tick, flushed);
+    }
+    extracted.clear();
+  }
+}
+
+bool TunnelForwarder::GetQueueStats(ForwarderQueueStats& egress,
+                                    ForwarderQueueStats& ingress) const {
+  if (!egress_queue_ || !ingress_queue_) {
+    return false;
+  }
+  egress = {egress_queue_->depth(), egress_queue_->high_water(), egress_queue_->capacity()};
+  ingress = {ingress_queue_->depth(), ingress_queue_->high_water(), ingress_queue_->capacity()};
+  return true;
+}
+
+bool TunnelForwarder::AttachStats(uint8_t* memory, size_t length, std::string& error) {
+  if (running_.load() || hub_id_ != 0 || tun_thread_.joinable() || sock_thread_.joinable() ||
+      pump_thread_.joinable()) {
+    error = "Cannot change stats memory while forwarding";
+    return false;
   }
+  return stats_.Attach(memory, length, error);
 }
 
 // --- N-API wrapper ---
@@ -864,7 +1710,13 @@ public:
                      InstanceMethod("connectPskSocket", &TunnelForwarderWrap::ConnectPskSocket),
                      InstanceMethod("handshake", &TunnelForwarderWrap::Handshake),
                      InstanceMethod("startForwarding", &TunnelForwarderWrap::StartForwarding),
-                     InstanceMethod("stop", &TunnelForwarderWrap::Stop)});
+                     InstanceMethod("getQueueStats", &TunnelForwarderWrap::GetQueueStats),
+                     InstanceMethod("getOffloadStatus", &TunnelForwarderWrap::GetOffloadStatus),
+                     InstanceMethod("getLatencyStats", &TunnelForwarderWrap::GetLatencyStats),
+                     InstanceMethod("resetLatencyStats", &TunnelForwarderWrap::ResetLatencyStats),
+                     InstanceMethod("setStatsMemory", &TunnelForwarderWrap::SetStatsMemory),
+                     InstanceMethod("stop", &TunnelForwarderWrap::Stop),
+                     StaticMethod("getHubStats", &TunnelForwarderWrap::GetHubStats)});
     exports.Set("TunnelForwarder", func);
     return exports;
   }
@@ -903,18 +1755,45 @@ private:
     }
   }
 
+  // Reads the optional `{ktls}` TLS options argument at `index`.
+  static bool ParseSslOptions(const Napi::CallbackInfo& info, size_t index, TunnelSslOptions& out) {
+    if (info.Length() <= index || info[index].IsUndefined() || info[index].IsNull()) {
+      return true;
+    }
+    Napi::Env env = info.Env();
+    if (!info[index].IsObject()) {
+      Napi::TypeError::New(env, "TLS options must be an object").ThrowAsJavaScriptException();
+      return false;
+    }
+    const Napi::Value ktls = info[index].As<Napi::Object>().Get("ktls");
+    if (!ktls.IsUndefined()) {
+      if (!ktls.IsBoolean()) {
+        Napi::TypeError::New(env, "ktls must be a boolean").ThrowAsJavaScriptException();
+        return false;
+      }
+      out.enable_ktls = ktls.As<Napi::Boolean>().Value();
+    }
+    return true;
+  }
+
   Napi::Value Connect(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsString() || !info[2].IsString()) {
-      Napi::TypeError::New(env, "Expected (tcpFd, certPem, keyPem)")
+      Napi::TypeError::New(env, "Expected (tcpFd, certPem, keyPem[, tlsOptions])")
           .ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
+    TunnelSslOptions ssl_options;
+    if (!ParseSslOptions(info, 3, ssl_options)) {
+      return env.Undefined();
+    }
+
     std::string error;
     if (!forwarder_.Connect(info[0].As<Napi::Number>().Int32Value(),
                             info[1].As<Napi::String>().Utf8Value(),
                             info[2].As<Napi::String>().Utf8Value(),
+                            ssl_options,
                             error)) {
       Napi::Error::New(env, error).ThrowAsJavaScriptException();
     }
@@ -924,11 +1803,16 @@ private:
   Napi::Value ConnectSocket(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     if (info.Length() < 3 || !info[1].IsString() || !info[2].IsString()) {
-      Napi::TypeError::New(env, "Expected (tcpHandle, certPem, keyPem)")
+      Napi::TypeError::New(env, "Expected (tcpHandle, certPem, keyPem[, tlsOptions])")
           .ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
+    TunnelSslOptions ssl_options;
+    if (!ParseSslOptions(info, 3, ssl_options)) {
+      return env.Undefined();
+    }
+
 #ifdef _WIN32
     int tcp_fd = -1;
     std::string error;
@@ -936,6 +1820,7 @@ private:
         !forwarder_.Connect(tcp_fd,
                             info[1].As<Napi::String>().Utf8Value(),
                             info[2].As<Napi::String>().Utf8Value(),
+                            ssl_options,
                             error)) {
       Napi::Error::New(env, error).ThrowAsJavaScriptException();
     }
@@ -948,7 +1833,7 @@ private:
   Napi::Value ConnectPsk(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsBuffer()) {
-      Napi::TypeError::New(env, "Expected (tcpFd, pskBuffer[, identity])")
+      Napi::TypeError::New(env, "Expected (tcpFd, pskBuffer[, identity[, tlsOptions]])")
           .ThrowAsJavaScriptException();
       return env.Undefined();
     }
@@ -957,6 +1842,10 @@ private:
     if (info.Length() >= 3 && info[2].IsString()) {
       identity = info[2].As<Napi::String>().Utf8Value();
     }
+    TunnelSslOptions ssl_options;
+    if (!ParseSslOptions(info, 3, ssl_options)) {
+      return env.Undefined();
+    }
 
     Napi::Buffer<uint8_t> psk = info[1].As<Napi::Buffer<uint8_t>>();
     std::string error;
@@ -964,6 +1853,7 @@ private:
                                psk.Data(),
                                psk.Length(),
                                identity,
+                               ssl_options,
                                error)) {
       Napi::Error::New(env, error).ThrowAsJavaScriptException();
     }
@@ -973,7 +1863,7 @@ private:
   Napi::Value ConnectPskSocket(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     if (info.Length() < 2 || !info[1].IsBuffer()) {
-      Napi::TypeError::New(env, "Expected (tcpHandle, pskBuffer[, identity])")
+      Napi::TypeError::New(env, "Expected (tcpHandle, pskBuffer[, identity[, tlsOptions]])")
           .ThrowAsJavaScriptException();
       return env.Undefined();
     }
@@ -982,13 +1872,17 @@ private:
     if (info.Length() >= 3 && info[2].IsString()) {
       identity = info[2].As<Napi::String>().Utf8Value();
     }
+    TunnelSslOptions ssl_options;
+    if (!ParseSslOptions(info, 3, ssl_options)) {
+      return env.Undefined();
+    }
 
 #ifdef _WIN32
     int tcp_fd = -1;
     std::string error;
     Napi::Buffer<uint8_t> psk = info[1].As<Napi::Buffer<uint8_t>>();
     if (!ExtractTcpFdFromNodeHandle(info[0], tcp_fd, error) ||
-        !forwarder_.ConnectPsk(tcp_fd, psk.Data(), psk.Length(), identity, error)) {
+        !forwarder_.ConnectPsk(tcp_fd, psk.Data(), psk.Length(), identity, ssl_options, error)) {
       Napi::Error::New(env, error).ThrowAsJavaScriptException();
     }
 #else
@@ -1022,10 +1916,175 @@ private:
     return result;
   }
 
+  // Reads an optional integer property into `out`, throwing on bad input.
+  static bool ReadSizeOption(Napi::Env env,
+                             const Napi::Object& options,
+                             const char* key,
+                             size_t min,
+                             size_t max,
+                             size_t& out) {
+    Napi::Value value = options.Get(key);
+    if (value.IsUndefined()) {
+      return true;
+    }
+    if (!value.IsNumber()) {
+      Napi::TypeError::New(env, std::string(key) + " must be a number").ThrowAsJavaScriptException();
+      return false;
+    }
+    const double number = value.As<Napi::Number>().DoubleValue();
+    if (!(number >= static_cast<double>(min) && number <= static_cast<double>(max)) ||
+        number != static_cast<double>(static_cast<size_t>(number))) {
+      Napi::RangeError::New(env,
+                            std::string(key) + " must be an integer between " +
+                                std::to_string(min) + " and " + std::to_string(max))
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+    out = static_cast<size_t>(number);
+    return true;
+  }
+
+  static bool ParseThreadTuning(Napi::Env env,
+                                const Napi::Object& threads,
+                                const char* key,
+                                ThreadTuning& out) {
+    const Napi::Value value = threads.Get(key);
+    if (value.IsUndefined()) {
+      return true;
+    }
+    if (!value.IsObject()) {
+      Napi::TypeError::New(env, std::string("threads.") + key + " must be an object")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+    const Napi::Object tuning = value.As<Napi::Object>();
+
+    const Napi::Value cpus = tuning.Get("cpus");
+    if (!cpus.IsUndefined()) {
+      if (!cpus.IsArray()) {
+        Napi::TypeError::New(env, "cpus must be an array of CPU indices")
+            .ThrowAsJavaScriptException();
+        return false;
+      }
+      const Napi::Array list = cpus.As<Napi::Array>();
+      for (uint32_t i = 0; i < list.Length(); ++i) {
+        const Napi::Value cpu = list.Get(i);
+        if (!cpu.IsNumber()) {
+          Napi::TypeError::New(env, "cpus must contain non-negative integers")
+              .ThrowAsJavaScriptException();
+          return false;
+        }
+        const double index = cpu.As<Napi::Number>().DoubleValue();
+        if (!(index >= 0 && index < kMaxThreadCpus) ||
+            index != static_cast<double>(static_cast<int>(index))) {
+          Napi::RangeError::New(env, "cpus must contain integers between 0 and " +
+                                         std::to_string(kMaxThreadCpus - 1))
+              .ThrowAsJavaScriptException();
+          return false;
+        }
+        out.cpus.push_back(static_cast<int>(index));
+      }
+    }
+
+    const Napi::Value policy = tuning.Get("policy");
+    if (!policy.IsUndefined()) {
+      const std::string name = policy.IsString() ? policy.As<Napi::String>().Utf8Value() : "";
+      if (name == "other") {
+        out.policy = ThreadSchedPolicy::kOther;
+      } else if (name == "batch") {
+        out.policy = ThreadSchedPolicy::kBatch;
+      } else if (name == "idle") {
+        out.policy = ThreadSchedPolicy::kIdle;
+      } else if (name == "fifo") {
+        out.policy = ThreadSchedPolicy::kFifo;
+      } else if (name == "rr") {
+        out.policy = ThreadSchedPolicy::kRoundRobin;
+      } else {
+        Napi::TypeError::New(env, "policy must be 'other', 'batch', 'idle', 'fifo' or 'rr'")
+            .ThrowAsJavaScriptException();
+        return false;
+      }
+    }
+
+    size_t priority = 0;
+    if (!ReadSizeOption(env, tuning, "priority", 1, 99, priority)) {
+      return false;
+    }
+    out.priority = static_cast<int>(priority);
+    if ((out.policy == ThreadSchedPolicy::kFifo || out.policy == ThreadSchedPolicy::kRoundRobin) &&
+        out.priority == 0) {
+      out.priority = 1;
+    }
+
+    const Napi::Value nice = tuning.Get("nice");
+    if (!nice.IsUndefined()) {
+      const double level = nice.IsNumber() ? nice.As<Napi::Number>().DoubleValue() : 100;
+      if (!(level >= -20 && level <= 19) || level != static_cast<double>(static_cast<int>(level))) {
+        Napi::RangeError::New(env, "nice must be an integer between -20 and 19")
+            .ThrowAsJavaScriptException();
+        return false;
+      }
+      out.has_nice = true;
+      out.nice = static_cast<int>(level);
+    }
+    return true;
+  }
+
+  static bool ParseForwarderOptions(Napi::Env env, const Napi::Value& value, ForwarderOptions& out) {
+    if (value.IsUndefined() || value.IsNull()) {
+      return true;
+    }
+    if (!value.IsObject()) {
+      Napi::TypeError::New(env, "Forwarding options must be an object").ThrowAsJavaScriptException();
+      return false;
+    }
+    const Napi::Object options = value.As<Napi::Object>();
+    const Napi::Value engine = options.Get("engine");
+    if (!engine.IsUndefined()) {
+      const std::string name = engine.IsString() ? engine.As<Napi::String>().Utf8Value() : "";
+      if (name == "threaded") {
+        out.engine = ForwarderEngine::kThreaded;
+      } else if (name == "pump") {
+        out.engine = ForwarderEngine::kPump;
+      } else if (name == "pipeline") {
+        out.engine = ForwarderEngine::kPipeline;
+      } else if (name == "hub") {
+        out.engine = ForwarderEngine::kHub;
+      } else {
+        Napi::TypeError::New(env, "engine must be 'threaded', 'pump', 'pipeline' or 'hub'")
+            .ThrowAsJavaScriptException();
+        return false;
+      }
+    }
+    const Napi::Value threads = options.Get("threads");
+    if (!threads.IsUndefined()) {
+      if (!threads.IsObject()) {
+        Napi::TypeError::New(env, "threads must be an object").ThrowAsJavaScriptException();
+        return false;
+      }
+      const Napi::Object roles = threads.As<Napi::Object>();
+      if (!ParseThreadTuning(env, roles, "tun", out.tun_thread) ||
+          !ParseThreadTuning(env, roles, "socket", out.socket_thread)) {
+        return false;
+      }
+    }
+    return ReadSizeOption(env, options, "spinUs", 0, 10000, out.spin_us) &&
+           ReadSizeOption(env, options, "egressBatchPackets", 1, 1024, out.egress_batch_packets) &&
+           ReadSizeOption(env, options, "egressBatchBytes", 1, 1024 * 1024, out.egress_batch_bytes) &&
+           ReadSizeOption(env, options, "pipelineQueueDepth", 2, 65536, out.pipeline_queue_depth) &&
+           ReadSizeOption(env, options, "hubWorkers", 0, 64, out.hub_workers);
+  }
+
   Napi::Value StartForwarding(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     if (info.Length() < 1 || !info[0].IsExternal()) {
-      Napi::TypeError::New(env, "Expected (tunForwardingHandle[, onError])").ThrowAsJavaScriptException();
+      Napi::TypeError::New(env, "Expected (tunForwardingHandle[, onError[, options]])")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    ForwarderOptions options;
+    if (info.Length() >= 3 && !ParseForwarderOptions(env, info[2], options)) {
       return env.Undefined();
     }
 
@@ -1048,13 +2107,120 @@ private:
     TunPlatformBackend* tun_backend = info[0].As<Napi::External<TunPlatformBackend>>().Data();
     std::string error;
     ForwarderErrorCallback callback = [this](std::string msg) { ReportError(std::move(msg)); };
-    if (!forwarder_.StartForwarding(tun_backend, std::move(callback), error)) {
+    if (!forwarder_.StartForwarding(tun_backend, options, std::move(callback), error)) {
       ReleaseErrorTsfn();
       Napi::Error::New(env, error).ThrowAsJavaScriptException();
     }
     return env.Undefined();
   }
 
+  static Napi::Object QueueStatsToObject(Napi::Env env, const ForwarderQueueStats& stats) {
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("depth", Napi::Number::New(env, static_cast<double>(stats.depth)));
+    out.Set("highWater", Napi::Number::New(env, static_cast<double>(stats.high_water)));
+    out.Set("capacity", Napi::Number::New(env, static_cast<double>(stats.capacity)));
+    return out;
+  }
+
+  Napi::Value GetQueueStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    ForwarderQueueStats egress;
+    ForwarderQueueStats ingress;
+    if (!forwarder_.GetQueueStats(egress, ingress)) {
+      return env.Null();
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("egress", QueueStatsToObject(env, egress));
+    result.Set("ingress", QueueStatsToObject(env, ingress));
+    return result;
+  }
+
+  Napi::Value GetOffloadStatus(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    bool ktls_tx = false;
+    bool ktls_rx = false;
+    forwarder_.GetOffloadStatus(ktls_tx, ktls_rx);
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("ktlsTx", Napi::Boolean::New(env, ktls_tx));
+    result.Set("ktlsRx", Napi::Boolean::New(env, ktls_rx));
+    return result;
+  }
+
+  static Napi::Object LatencyToObject(Napi::Env env,
+                                      const LatencyHistogram& histogram,
+                                      double nanos_per_tick) {
+    const LatencyHistogram::Summary summary = histogram.Snapshot(nanos_per_tick);
+    const auto micros = [](double nanos) { return nanos / 1000.0; };
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("count", Napi::Number::New(env, static_cast<double>(summary.count)));
+    out.Set("meanUs", Napi::Number::New(env, micros(summary.mean_ns)));
+    out.Set("maxUs", Napi::Number::New(env, micros(static_cast<double>(summary.max_ns))));
+    out.Set("p50Us", Napi::Number::New(env, micros(static_cast<double>(summary.p50_ns))));
+    out.Set("p90Us", Napi::Number::New(env, micros(static_cast<double>(summary.p90_ns))));
+    out.Set("p99Us", Napi::Number::New(env, micros(static_cast<double>(summary.p99_ns))));
+    out.Set("p999Us", Napi::Number::New(env, micros(static_cast<double>(summary.p999_ns))));
+    return out;
+  }
+
+  Napi::Value GetLatencyStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const ForwarderLatency& latency = forwarder_.latency();
+    const double nanos_per_tick = forwarder_latency::NanosPerTick();
+    const auto stage = [&](forwarder_latency::Stage s) {
+      return LatencyToObject(env, latency.stage(s), nanos_per_tick);
+    };
+    Napi::Object egress = Napi::Object::New(env);
+    egress.Set("tunToTunnel", stage(forwarder_latency::kEgressTunToTunnel));
+    egress.Set("socketWait", stage(forwarder_latency::kEgressSocketWait));
+    Napi::Object ingress = Napi::Object::New(env);
+    ingress.Set("readToFrame", stage(forwarder_latency::kIngressReadToFrame));
+    ingress.Set("frameToTun", stage(forwarder_latency::kIngressFrameToTun));
+    ingress.Set("tunWait", stage(forwarder_latency::kIngressTunWait));
+    ingress.Set("socketWait", stage(forwarder_latency::kIngressSocketWait));
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("egress", egress);
+    result.Set("ingress", ingress);
+    return result;
+  }
+
+  Napi::Value ResetLatencyStats(const Napi::CallbackInfo& info) {
+    forwarder_.ResetLatency();
+    return info.Env().Undefined();
+  }
+
+  Napi::Value SetStatsMemory(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsTypedArray() ||
+        info[0].As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+      Napi::TypeError::New(env, "Expected a Uint8Array over the stats SharedArrayBuffer")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Uint8Array memory = info[0].As<Napi::Uint8Array>();
+    std::string error;
+    if (!forwarder_.AttachStats(memory.Data(), memory.ByteLength(), error)) {
+      Napi::Error::New(env, error).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    stats_memory_ = Napi::Persistent(info[0].As<Napi::Object>());
+    return env.Undefined();
+  }
+
+  static Napi::Value GetHubStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Array workers = Napi::Array::New(env);
+#ifndef _WIN32
+    const std::vector<ForwardingHubWorkerStats> stats = ForwardingHub::Instance().GetStats();
+    for (size_t i = 0; i < stats.size(); ++i) {
+      Napi::Object worker = Napi::Object::New(env);
+      worker.Set("tunnels", Napi::Number::New(env, static_cast<double>(stats[i].tunnels)));
+      worker.Set("wakeups", Napi::Number::New(env, static_cast<double>(stats[i].wakeups)));
+      workers.Set(static_cast<uint32_t>(i), worker);
+    }
+#endif
+    return workers;
+  }
+
   Napi::Value Stop(const Napi::CallbackInfo& info) {
     forwarder_.Stop();
     ReleaseErrorTsfn();
@@ -1064,8 +2230,13 @@ private:
   TunnelForwarder forwarder_;
   std::mutex error_tsfn_mutex_;
   Napi::ThreadSafeFunction error_tsfn_;
+  // Keeps the buffer the forwarding threads count into alive.
+  Napi::ObjectReference stats_memory_;
 };
 
 Napi::Object InitTunnelForwarder(Napi::Env env, Napi::Object exports) {
+  // Pins the tick calibration origin long before getLatencyStats() converts,
+  // so that call never has to wait for the calibration window.
+  forwarder_latency::StartCalibration();
   return TunnelForwarderWrap::Init(env, exports);
 }
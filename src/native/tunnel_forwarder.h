@@ -4,6 +4,7 @@
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -11,8 +12,17 @@
 
 #include <napi.h>
 
+#include "forwarder_options.h"
+#include "forwarder_stats.h"
+#include "latency_histogram.h"
+#include "spsc_packet_queue.h"
 #include "tun_backend.h"
 #include "tunnel_ssl.h"
+#include "wakeup_event.h"
+
+namespace tcp_offload {
+class TcpGroCoalescer;
+}
 
 struct TunnelHandshakeInfo {
   std::string client_address;
@@ -23,6 +33,13 @@ struct TunnelHandshakeInfo {
 
 using ForwarderErrorCallback = std::function<void(std::string)>;
 
+/** Occupancy of one pipeline queue. */
+struct ForwarderQueueStats {
+  size_t depth = 0;
+  size_t high_water = 0;
+  size_t capacity = 0;
+};
+
 enum class TunReadResult {
   kOk,
   kWouldBlock,
@@ -32,6 +49,11 @@ enum class TunReadResult {
 /**
  * pmd3/go-ios style bidirectional forwarder: blocking tun read/write loops on
  * independent threads over an OpenSSL TLS session (lockdown cert or TLS-PSK).
+ * `ForwarderEngine::kPump` instead runs both directions on one thread that
+ * owns the session (see {@link TunnelPump}), and `ForwarderEngine::kPipeline`
+ * splits each direction into an I/O stage and a crypto stage joined by
+ * {@link SpscPacketQueue}s. `ForwarderEngine::kHub` runs no threads of its
+ * own and hands the session to a shared {@link ForwardingHub} worker.
  */
 class TunnelForwarder {
 public:
@@ -44,31 +66,94 @@ public:
   bool Connect(int tcp_fd,
                const std::string& cert_pem,
                const std::string& key_pem,
+               const TunnelSslOptions& ssl_options,
                std::string& error);
 
   bool ConnectPsk(int tcp_fd,
                   const uint8_t* psk,
                   size_t psk_len,
                   const std::string& identity,
+                  const TunnelSslOptions& ssl_options,
                   std::string& error);
 
   bool Handshake(uint32_t requested_mtu, TunnelHandshakeInfo& info, std::string& error);
 
   bool StartForwarding(TunPlatformBackend* tun_backend,
+                       const ForwarderOptions& options,
                        ForwarderErrorCallback on_error,
                        std::string& error);
 
   void Stop();
 
+  /** Directions whose record crypto the kernel performs (kTLS). */
+  void GetOffloadStatus(bool& ktls_tx, bool& ktls_rx) const;
+
+  /** Egress/ingress queue occupancy; false unless the pipeline engine ran. */
+  bool GetQueueStats(ForwarderQueueStats& egress, ForwarderQueueStats& ingress) const;
+
+  /**
+   * Moves the statistics counters into `memory` (see forwarder_stats.h).
+   * Fails while forwarding; the caller keeps `memory` alive until `Stop()`.
+   */
+  bool AttachStats(uint8_t* memory, size_t length, std::string& error);
+
+  /** Per-stage latency histograms; cleared when forwarding starts. */
+  const ForwarderLatency& latency() const { return latency_; }
+  void ResetLatency() { latency_.Reset(); }
+
 private:
-  ssize_t SslReadExact(uint8_t* buf, size_t len);
-  ssize_t SslWriteAll(const uint8_t* data, size_t len, bool only_while_running = true);
-  void TunToDeviceLoop();
+  static constexpr size_t kAnyQueue = ~static_cast<size_t>(0);
+
+  ssize_t SslReadExact(uint8_t* buf, size_t len, ForwarderStatsSlot& stats);
+  ssize_t SslWriteAll(const uint8_t* data,
+                      size_t len,
+                      ForwarderStatsSlot& stats,
+                      bool only_while_running = true);
+  // Reads one TUN queue (multi-queue devices) or all of them (`kAnyQueue`).
+  void TunToDeviceLoop(size_t queue);
   void DeviceToTunLoop();
-  TunReadResult ReadTunPacket(std::vector<uint8_t>& out);
-  ssize_t WriteTunPacket(const uint8_t* data, size_t len);
-  ssize_t SslReadChunk(uint8_t* buf, size_t max_len, bool only_while_running = true);
+  void PumpLoop();
+  void PipelineTunReaderLoop();
+  void PipelineEncryptLoop();
+  void PipelineDecryptLoop();
+  void PipelineTunWriterLoop();
+  // The per-thread helpers below count into `stats`, the slot of the calling thread.
+  bool AdmitEgressPacket(std::vector<uint8_t>& packet, ForwarderStatsSlot& stats);
+  TunReadResult ReadTunPacket(std::vector<uint8_t>& out,
+                              ForwarderStatsSlot& stats,
+                              bool wait = true,
+                              size_t queue = kAnyQueue);
+  // `read_ticks` holds the TUN read completion time of each of the
+  // `packets` packets in `data`, for the egress latency histogram.
+  bool SendEgress(const uint8_t* data,
+                  size_t len,
+                  ForwarderStatsSlot& stats,
+                  const uint64_t* read_ticks,
+                  size_t packets);
+  // With `gso` the packet goes out through WriteGsoPacket (offload mode).
+  ssize_t WriteTunPacket(const uint8_t* data,
+                         size_t len,
+                         ForwarderStatsSlot& stats,
+                         const TunGsoInfo* gso = nullptr);
+  // Writes `batch` from its cursor, waiting out device back-pressure.
+  bool WriteTunBatch(PacketBatch& batch, ForwarderStatsSlot& stats);
+  // Writes the coalesced group (if any) and empties `gro`; false on failure.
+  bool FlushGro(tcp_offload::TcpGroCoalescer& gro, ForwarderStatsSlot& stats);
+  // Ends a burst of TUN writes (see TunPlatformBackend::FlushWrites).
+  bool FlushTunWrites();
+  ssize_t SslReadChunk(uint8_t* buf,
+                       size_t max_len,
+                       ForwarderStatsSlot& stats,
+                       bool only_while_running = true);
+  ssize_t KtlsWriteAll(const uint8_t* data, size_t len, ForwarderStatsSlot& stats);
+  ssize_t KtlsReadChunk(uint8_t* buf, size_t max_len, ForwarderStatsSlot& stats);
   void Fail(const std::string& reason);
+  // Clears `running_` and wakes every blocked worker (poll sets, queues).
+  void SignalStop();
+  // Starts `loop` on a new thread named `name` with `tuning` applied.
+  std::thread StartWorker(std::string name,
+                          const ThreadTuning& tuning,
+                          std::function<void()> loop);
 
   TunnelSslClient ssl_;
   std::mutex ssl_mutex_;
@@ -77,13 +162,35 @@ private:
   std::atomic<bool> error_reported_{false};
   TunPlatformBackend* tun_backend_ = nullptr;
   size_t mtu_ = 1280;
+  ForwarderOptions options_;
   std::atomic<bool> running_{false};
-  std::atomic<uint64_t> tun_writes_{0};
-  std::atomic<uint64_t> tun_drops_{0};
-  std::atomic<uint64_t> ssl_reads_{0};
+  // Part of every forwarding wait set; signalled by SignalStop().
+  WakeupEvent wakeup_;
+  // With kTLS active the forwarding loops bypass OpenSSL (and `ssl_mutex_`)
+  // and move plaintext with send()/recvmsg() on the socket directly.
+  bool ktls_tx_direct_ = false;
+  bool ktls_rx_direct_ = false;
+  // Written by the forwarding threads, one slot each; read by JS.
+  ForwarderStats stats_;
+  ForwarderLatency latency_;
+  // Socket-thread only: samples GRO debug logging.
+  uint64_t tun_gro_packets_ = 0;
   std::chrono::steady_clock::time_point handshake_deadline_{};
   std::thread tun_thread_;
+  // Threaded engine on a multi-queue TUN device: readers for queues 1..N-1.
+  // Their egress batches are serialized by `egress_mutex_` so records from
+  // different readers never interleave on the TLS stream.
+  std::vector<std::thread> tun_queue_threads_;
+  std::mutex egress_mutex_;
+  bool serialize_egress_ = false;
   std::thread sock_thread_;
+  std::thread pump_thread_;
+  // Non-zero while attached to the ForwardingHub (hub engine).
+  uint64_t hub_id_ = 0;
+  std::thread encrypt_thread_;
+  std::thread tun_writer_thread_;
+  std::unique_ptr<SpscPacketQueue> egress_queue_;
+  std::unique_ptr<SpscPacketQueue> ingress_queue_;
 };
 
 Napi::Object InitTunnelForwarder(Napi::Env env, Napi::Object exports);
@@ -0,0 +1,212 @@
+#include "tunnel_pump.h"
+
+#include <algorithm>
+
+#include <openssl/err.h>
+
+#include "debug_log.h"
+#include "forwarder_options.h"
+#include "ipv6_frame.h"
+
+namespace {
+
+// Upper bound on SSL/TUN operations per direction per `Pump()` call so a
+// saturated direction cannot starve the other one.
+constexpr int kPumpBudget = 64;
+
+}  // namespace
+
+TunnelPump::TunnelPump(SSL* ssl,
+                       TunPlatformBackend* tun_backend,
+                       size_t mtu,
+                       const ForwarderOptions& options,
+                       ForwarderStatsSlot& stats,
+                       ForwarderLatency& latency)
+    : ssl_(ssl),
+      tun_backend_(tun_backend),
+      mtu_(mtu),
+      batch_packets_(std::max<size_t>(options.egress_batch_packets, 1)),
+      batch_bytes_(options.egress_batch_bytes),
+      ingress_(kIngressBufferCapacity),
+      stats_(stats),
+      latency_(latency) {
+  egress_.reserve(batch_bytes_ + mtu_);
+  egress_read_ticks_.reserve(batch_packets_);
+  // Partial writes let a full socket buffer hand back control instead of
+  // holding the whole batch; retries always resume from `egress_sent_`.
+  SSL_set_mode(ssl_, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+}
+
+bool TunnelPump::Pump(PumpInterest& interest, std::string& error) {
+  interest = PumpInterest{};
+  return PumpEgress(interest, error) && PumpIngress(interest, error);
+}
+
+bool TunnelPump::HandleSslError(int ret,
+                                const char* op,
+                                PumpInterest& interest,
+                                std::string& error) {
+  const int err = SSL_get_error(ssl_, ret);
+  switch (err) {
+    case SSL_ERROR_WANT_READ:
+      stats_.Add(forwarder_stats::kSslWantRead);
+      interest.sock_readable = true;
+      return true;
+    case SSL_ERROR_WANT_WRITE:
+      stats_.Add(forwarder_stats::kSslWantWrite);
+      interest.sock_writable = true;
+      return true;
+    case SSL_ERROR_ZERO_RETURN:
+      error = std::string("TLS session closed by peer during ") + op;
+      return false;
+    default: {
+      const unsigned long openssl_error = ERR_get_error();
+      const char* reason = openssl_error == 0 ? nullptr : ERR_reason_error_string(openssl_error);
+      tuntap::FwdDebug("pump-ssl-error", "op=%s ssl_error=%d reason=%s", op, err,
+                       reason == nullptr ? "(none)" : reason);
+      error = std::string(op) + " failed in pump engine";
+      return false;
+    }
+  }
+}
+
+bool TunnelPump::FillEgress(std::string& error) {
+  egress_.clear();
+  egress_read_ticks_.clear();
+  egress_sent_ = 0;
+  tun_drained_ = false;
+
+  size_t packets = 0;
+  while (packets < batch_packets_ && egress_.size() + mtu_ <= std::max(batch_bytes_, mtu_)) {
+    const ReadPacketStatus status = tun_backend_->ReadPacket(mtu_, packet_, error);
+    if (status == ReadPacketStatus::NoData) {
+      stats_.Add(forwarder_stats::kTunReadWouldBlock);
+      tun_drained_ = true;
+      break;
+    }
+    if (status == ReadPacketStatus::Closed) {
+      error = "TUN device closed";
+      return false;
+    }
+    if (status == ReadPacketStatus::Error) {
+      return false;
+    }
+    if (packet_.empty()) {
+      continue;
+    }
+    egress_read_ticks_.push_back(forwarder_latency::Now());
+    egress_.insert(egress_.end(), packet_.begin(), packet_.end());
+    ++packets;
+  }
+  stats_.Add(forwarder_stats::kEgressPackets, packets);
+  stats_.Add(forwarder_stats::kEgressBytes, egress_.size());
+  return true;
+}
+
+bool TunnelPump::PumpEgress(PumpInterest& interest, std::string& error) {
+  for (int i = 0; i < kPumpBudget; ++i) {
+    if (egress_sent_ >= egress_.size()) {
+      if (!FillEgress(error)) {
+        return false;
+      }
+      if (egress_.empty()) {
+        interest.tun_readable = true;
+        return true;
+      }
+    }
+
+    size_t written = 0;
+    const int ret = SSL_write_ex(ssl_, egress_.data() + egress_sent_,
+                                 egress_.size() - egress_sent_, &written);
+    if (ret != 1) {
+      return HandleSslError(ret, "SSL_write", interest, error);
+    }
+    egress_sent_ += written;
+    if (egress_sent_ >= egress_.size()) {
+      const uint64_t sent = forwarder_latency::Now();
+      for (const uint64_t read_done : egress_read_ticks_) {
+        latency_.Record(forwarder_latency::kEgressTunToTunnel, read_done, sent);
+      }
+      egress_read_ticks_.clear();
+    }
+    if (egress_sent_ >= egress_.size() && tun_drained_) {
+      interest.tun_readable = true;
+      return true;
+    }
+  }
+  interest.again = true;
+  return true;
+}
+
+bool TunnelPump::FlushIngressFrames(PumpInterest& interest, std::string& error) {
+  if (ingress_.readable() == 0) {
+    return true;
+  }
+  bool blocked = false;
+  bool failed = false;
+  // One extraction and one completion time per pass; frames held back by
+  // TUN back-pressure count from the pass that finally writes them.
+  const uint64_t extracted = forwarder_latency::Now();
+  uint64_t frames_written = 0;
+  const size_t consumed = ipv6_frame::ForEachFrame(
+      ingress_.read_ptr(), ingress_.readable(), [&](const uint8_t* frame, size_t len) {
+        const ssize_t n = tun_backend_->WritePacket(frame, len, error);
+        if (n == static_cast<ssize_t>(len)) {
+          latency_.Record(forwarder_latency::kIngressReadToFrame, ingress_read_done_, extracted);
+          stats_.Add(forwarder_stats::kIngressPackets);
+          stats_.Add(forwarder_stats::kIngressBytes, len);
+          ++frames_written;
+          return true;
+        }
+        if (n == 0) {
+          stats_.Add(forwarder_stats::kTunWriteBlocked);
+          blocked = true;
+        } else {
+          if (n > 0) {
+            error = "Short TUN write in pump engine";
+          }
+          failed = true;
+        }
+        return false;
+      });
+  ingress_.Consume(consumed);
+  if (frames_written > 0) {
+    latency_.Record(forwarder_latency::kIngressFrameToTun, extracted, forwarder_latency::Now(),
+                    frames_written);
+  }
+  if (failed) {
+    return false;
+  }
+  if (blocked) {
+    // Stop decrypting until the TUN accepts the pending frame again; the
+    // ingress buffer holds it in place meanwhile.
+    interest.tun_writable = true;
+  }
+  return true;
+}
+
+bool TunnelPump::PumpIngress(PumpInterest& interest, std::string& error) {
+  for (int i = 0; i < kPumpBudget; ++i) {
+    if (!FlushIngressFrames(interest, error)) {
+      return false;
+    }
+    if (interest.tun_writable) {
+      return true;
+    }
+    if (!ingress_.Reserve(kIngressReadReserve)) {
+      error = "SSL ingress buffer overflow";
+      return false;
+    }
+
+    size_t got = 0;
+    const int ret = SSL_read_ex(ssl_, ingress_.write_ptr(), ingress_.writable(), &got);
+    if (ret != 1) {
+      return HandleSslError(ret, "SSL_read", interest, error);
+    }
+    ingress_read_done_ = forwarder_latency::Now();
+    ingress_.Commit(got);
+    stats_.Max(forwarder_stats::kIngressHighWater, ingress_.readable());
+  }
+  interest.again = true;
+  return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <openssl/ssl.h>
+
+#include "forwarder_stats.h"
+#include "ingress_buffer.h"
+#include "latency_histogram.h"
+#include "tun_backend.h"
+
+struct ForwarderOptions;
+
+/** Readiness a {@link TunnelPump} needs before it can make progress again. */
+struct PumpInterest {
+  bool tun_readable = false;
+  bool tun_writable = false;
+  bool sock_readable = false;
+  bool sock_writable = false;
+  // A direction stopped on its per-call budget rather than on readiness;
+  // call `Pump()` again without waiting.
+  bool again = false;
+};
+
+/**
+ * Non-blocking, lock-free driver for both directions of one tunnel.
+ *
+ * The owner must be the only thread touching `ssl` while the pump is alive.
+ * Every `Pump()` call retries whichever SSL_write / SSL_read is outstanding,
+ * so a WANT_READ raised by the writer (or WANT_WRITE raised by the reader) is
+ * satisfied by any socket readiness the caller reports afterwards.
+ */
+class TunnelPump {
+public:
+  // Traffic is counted into `stats` and timed into `latency`, which must
+  // outlive the pump.
+  TunnelPump(SSL* ssl,
+             TunPlatformBackend* tun_backend,
+             size_t mtu,
+             const ForwarderOptions& options,
+             ForwarderStatsSlot& stats,
+             ForwarderLatency& latency);
+
+  TunnelPump(const TunnelPump&) = delete;
+  TunnelPump& operator=(const TunnelPump&) = delete;
+
+  /** Move as much data as possible without blocking. False on a fatal error. */
+  bool Pump(PumpInterest& interest, std::string& error);
+
+  ForwarderStatsSlot& stats() { return stats_; }
+
+private:
+  bool PumpEgress(PumpInterest& interest, std::string& error);
+  bool PumpIngress(PumpInterest& interest, std::string& error);
+  bool FillEgress(std::string& error);
+  bool FlushIngressFrames(PumpInterest& interest, std::string& error);
+  bool HandleSslError(int ret, const char* op, PumpInterest& interest, std::string& error);
+
+  SSL* ssl_;
+  TunPlatformBackend* tun_backend_;
+  size_t mtu_;
+  size_t batch_packets_;
+  size_t batch_bytes_;
+
+  std::vector<uint8_t> packet_;
+  // Plaintext accepted from the TUN but not yet taken by SSL_write. The
+  // buffer is not touched while a write is outstanding so retries pass the
+  // same bytes back to OpenSSL.
+  std::vector<uint8_t> egress_;
+  // TUN read completion time of each packet in `egress_`.
+  std::vector<uint64_t> egress_read_ticks_;
+  size_t egress_sent_ = 0;
+  bool tun_drained_ = false;
+
+  IngressBuffer ingress_;
+  // Completion time of the latest SSL read.
+  uint64_t ingress_read_done_ = 0;
+
+  ForwarderStatsSlot& stats_;
+  ForwarderLatency& latency_;
+};
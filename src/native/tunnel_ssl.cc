@@ -26,6 +26,12 @@ namespace {
 constexpr char kAppleTvPskCiphers[] =
     "PSK-AES256-CBC-SHA:PSK-AES128-CBC-SHA:PSK-3DES-EDE-CBC-SHA:PSK-RC4-SHA:PSK";
 
+#ifdef SSL_OP_ENABLE_KTLS
+constexpr uint64_t kKtlsOption = SSL_OP_ENABLE_KTLS;
+#else
+constexpr uint64_t kKtlsOption = 0;
+#endif
+
 #ifdef _WIN32
 constexpr short kPollIn = POLLRDNORM;
 constexpr short kPollOut = POLLWRNORM;
@@ -189,6 +195,19 @@ unsigned int TunnelSslClient::PskClientCallback(SSL* ssl,
   return static_cast<unsigned int>(self->psk_key_.size());
 }
 
+void TunnelSslClient::ApplyOptions(const TunnelSslOptions& options) {
+#if defined(__linux__) && defined(SSL_OP_ENABLE_KTLS)
+  if (options.enable_ktls) {
+    // OpenSSL installs the keys into the socket after the handshake if the
+    // kernel `tls` module accepts the suite, and silently stays in user space
+    // otherwise; ConnectTls() records what was actually offloaded.
+    SSL_set_options(ssl_, SSL_OP_ENABLE_KTLS);
+  }
+#else
+  (void)options;
+#endif
+}
+
 bool TunnelSslClient::ConnectTls(int timeout_ms, std::string& error) {
   if (owned_fd_ < 0 || ssl_ == nullptr) {
     error = "TLS session is not initialized";
@@ -201,6 +220,15 @@ bool TunnelSslClient::ConnectTls(int timeout_ms, std::string& error) {
   for (;;) {
     const int rc = SSL_connect(ssl_);
     if (rc == 1) {
+      ktls_send_ = BIO_get_ktls_send(SSL_get_wbio(ssl_)) > 0;
+      ktls_recv_ = BIO_get_ktls_recv(SSL_get_rbio(ssl_)) > 0;
+      if ((SSL_get_options(ssl_) & kKtlsOption) != 0) {
+        tuntap::FwdDebug("forwarder-ssl-ktls",
+                         "cipher=%s tx=%s rx=%s",
+                         SSL_get_cipher_name(ssl_),
+                         ktls_send_ ? "kernel" : "user",
+                         ktls_recv_ ? "kernel" : "user");
+      }
       return true;
     }
     const int err = SSL_get_error(ssl_, rc);
@@ -227,6 +255,7 @@ bool TunnelSslClient::Connect(int tcp_fd,
                               const std::string& cert_pem,
                               const std::string& key_pem,
                               int timeout_ms,
+                              const TunnelSslOptions& options,
                               std::string& error) {
   Close();
   if (tcp_fd < 0) {
@@ -285,6 +314,7 @@ bool TunnelSslClient::Connect(int tcp_fd,
   }
 
   SSL_set_fd(ssl_, owned_fd_);
+  ApplyOptions(options);
   if (!ConnectTls(timeout_ms, error)) {
     Close();
     return false;
@@ -299,6 +329,7 @@ bool TunnelSslClient::ConnectPsk(int tcp_fd,
                                  size_t psk_len,
                                  const std::string& identity,
                                  int timeout_ms,
+                                 const TunnelSslOptions& options,
                                  std::string& error) {
   Close();
   if (tcp_fd < 0) {
@@ -357,6 +388,7 @@ bool TunnelSslClient::ConnectPsk(int tcp_fd,
 
   SSL_set_app_data(ssl_, this);
   SSL_set_fd(ssl_, owned_fd_);
+  ApplyOptions(options);
   if (!ConnectTls(timeout_ms, error)) {
     Close();
     return false;
@@ -388,6 +420,8 @@ void TunnelSslClient::Close() {
     owned_fd_ = -1;
   }
   close_owned_fd_ = true;
+  ktls_send_ = false;
+  ktls_recv_ = false;
   psk_key_.clear();
   psk_identity_.clear();
 }
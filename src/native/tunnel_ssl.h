@@ -10,6 +10,14 @@
 /** SSL_connect and CDTunnel handshake I/O deadline (milliseconds). */
 inline constexpr int kTunnelHandshakeTimeoutMs = 15000;
 
+/** Per-connection TLS settings applied before the handshake. */
+struct TunnelSslOptions {
+  // Ask OpenSSL to hand record crypto to the kernel (Linux kTLS). It only takes
+  // effect when the kernel supports the negotiated suite (AES-GCM in practice),
+  // so the CBC-only TLS-PSK suites always stay in user space.
+  bool enable_ktls = false;
+};
+
 /** TLS client for lockdown (PEM cert) or Apple TV Remote Pairing (TLS-PSK). */
 class TunnelSslClient {
 public:
@@ -23,6 +31,7 @@ public:
                const std::string& cert_pem,
                const std::string& key_pem,
                int timeout_ms,
+               const TunnelSslOptions& options,
                std::string& error);
 
   bool ConnectPsk(int tcp_fd,
@@ -30,11 +39,17 @@ public:
                   size_t psk_len,
                   const std::string& identity,
                   int timeout_ms,
+                  const TunnelSslOptions& options,
                   std::string& error);
 
   void Close();
 
   SSL* ssl() const { return ssl_; }
+  int fd() const { return owned_fd_; }
+
+  /** Whether the kernel encrypts outgoing / decrypts incoming records (kTLS). */
+  bool ktls_send() const { return ktls_send_; }
+  bool ktls_recv() const { return ktls_recv_; }
 
 private:
   static unsigned int PskClientCallback(SSL* ssl,
@@ -44,12 +59,15 @@ private:
                                         unsigned char* psk,
                                         unsigned int max_psk_len);
 
+  void ApplyOptions(const TunnelSslOptions& options);
   bool ConnectTls(int timeout_ms, std::string& error);
 
   SSL_CTX* ctx_ = nullptr;
   SSL* ssl_ = nullptr;
   int owned_fd_ = -1;
   bool close_owned_fd_ = true;
+  bool ktls_send_ = false;
+  bool ktls_recv_ = false;
   std::vector<uint8_t> psk_key_;
   std::string psk_identity_;
 };
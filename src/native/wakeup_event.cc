@@ -0,0 +1,123 @@
+#include "wakeup_event.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool WakeupEvent::IsOpen() const {
+#ifdef _WIN32
+  return event_.is_valid();
+#else
+  return read_fd_.is_valid();
+#endif
+}
+
+#ifdef _WIN32
+
+bool WakeupEvent::Open(std::string& error) {
+  if (event_.is_valid()) {
+    return true;
+  }
+  event_.reset(::CreateEventW(nullptr, /*manualReset=*/TRUE, /*initialState=*/FALSE, nullptr));
+  if (!event_.is_valid()) {
+    error = "Failed to create wakeup event: " + std::to_string(::GetLastError());
+    return false;
+  }
+  return true;
+}
+
+void WakeupEvent::Signal() {
+  if (event_.is_valid()) {
+    ::SetEvent(event_.get());
+  }
+}
+
+void WakeupEvent::Reset() {
+  if (event_.is_valid()) {
+    ::ResetEvent(event_.get());
+  }
+}
+
+#else
+
+bool WakeupEvent::Open(std::string& error) {
+  if (read_fd_.is_valid()) {
+    return true;
+  }
+#ifdef __linux__
+  const int fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (fd < 0) {
+    error = std::string("Failed to create wakeup eventfd: ") + strerror(errno);
+    return false;
+  }
+  read_fd_.reset(fd);
+  // Plain dup() would clear FD_CLOEXEC and leak the eventfd into children.
+  write_fd_.reset(::fcntl(fd, F_DUPFD_CLOEXEC, 0));
+  if (!write_fd_.is_valid()) {
+    error = std::string("Failed to duplicate wakeup eventfd: ") + strerror(errno);
+    read_fd_.reset();
+    return false;
+  }
+#else
+  int fds[2] = {-1, -1};
+  if (::pipe(fds) != 0) {
+    error = std::string("Failed to create wakeup pipe: ") + strerror(errno);
+    return false;
+  }
+  read_fd_.reset(fds[0]);
+  write_fd_.reset(fds[1]);
+  for (int fd : fds) {
+    const int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0 ||
+        fcntl(fd, F_SETFD, FD_CLOEXEC) < 0) {
+      error = std::string("Failed to configure wakeup pipe: ") + strerror(errno);
+      read_fd_.reset();
+      write_fd_.reset();
+      return false;
+    }
+  }
+#endif
+  return true;
+}
+
+void WakeupEvent::Signal() {
+  if (!write_fd_.is_valid()) {
+    return;
+  }
+  // A full pipe / saturated counter already reads as signalled, so EAGAIN is
+  // not an error here.
+#ifdef __linux__
+  const uint64_t one = 1;
+  while (::write(write_fd_.get(), &one, sizeof(one)) < 0 && errno == EINTR) {
+  }
+#else
+  const uint8_t byte = 1;
+  while (::write(write_fd_.get(), &byte, sizeof(byte)) < 0 && errno == EINTR) {
+  }
+#endif
+}
+
+void WakeupEvent::Reset() {
+  if (!read_fd_.is_valid()) {
+    return;
+  }
+  uint8_t drain[64];
+  for (;;) {
+    const ssize_t n = ::read(read_fd_.get(), drain, sizeof(drain));
+    if (n > 0 || (n < 0 && errno == EINTR)) {
+      continue;
+    }
+    return;
+  }
+}
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include "handle.h"
+#else
+#include "file_descriptor.h"
+#endif
+
+// Manual-reset wakeup that blocking waits add to their wait set so another
+// thread can interrupt them immediately instead of the waiter polling a flag
+// on a timer. Once signalled it stays signalled (every waiter wakes) until
+// `Reset()`.
+//
+// - Linux: an `eventfd`, readable while signalled.
+// - macOS: a non-blocking self-pipe, readable while signalled.
+// - Windows: a manual-reset Win32 event.
+class WakeupEvent {
+public:
+  WakeupEvent() = default;
+
+  WakeupEvent(const WakeupEvent&) = delete;
+  WakeupEvent& operator=(const WakeupEvent&) = delete;
+
+  // Creates the underlying kernel object. Safe to call again once open.
+  bool Open(std::string& error);
+  bool IsOpen() const;
+
+  void Signal();
+  void Reset();
+
+#ifdef _WIN32
+  HANDLE handle() const { return event_.get(); }
+#else
+  // Poll for POLLIN; -1 while closed.
+  int fd() const { return read_fd_.get(); }
+#endif
+
+private:
+#ifdef _WIN32
+  Handle event_;
+#else
+  FileDescriptor read_fd_;
+  // Same descriptor as `read_fd_` for eventfd; the pipe's write end on macOS.
+  FileDescriptor write_fd_;
+#endif
+};
@@ -6,10 +6,18 @@ import type {TunTapInterfaceStats, TunTapPlatform} from './types.js';
 /** macOS implementation using `ifconfig`, `route`, and `netstat`. */
 export class DarwinTunTapPlatform implements TunTapPlatform {
   /** @inheritdoc */
-  async configure(interfaceName: string, address: string, mtu: number): Promise<void> {
+  async configure(
+    interfaceName: string,
+    address: string,
+    mtu: number,
+    routes: string[] = [],
+  ): Promise<void> {
     assertEffectiveRoot();
     await execFileAsync('ifconfig', [interfaceName, 'inet6', address, 'prefixlen', '64', 'up']);
     await execFileAsync('ifconfig', [interfaceName, 'mtu', String(mtu)]);
+    for (const route of routes) {
+      await this.addRoute(interfaceName, route);
+    }
   }
 
   /** @inheritdoc */
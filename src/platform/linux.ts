@@ -1,91 +1,104 @@
-import type {ExecException} from 'node:child_process';
+import {createRequire} from 'node:module';
+import path from 'node:path';
+import {fileURLToPath} from 'node:url';
 
-import {fs} from '@appium/support';
 import {log} from '../logger.js';
 import {TunTapError} from '../errors.js';
-import {execFileAsync} from './exec.js';
+import {readLinkStats} from '../LinkStats.js';
 import {assertEffectiveRoot} from './require-root.js';
 import type {TunTapInterfaceStats, TunTapPlatform} from './types.js';
 
-/** Linux implementation using `ip` from iproute2. */
+const require = createRequire(import.meta.url);
+const pkgRoot = path.join(fileURLToPath(new URL('.', import.meta.url)), '..', '..');
+
+/** Outcome of one native `configure` transaction. */
+interface NativeConfigureResult {
+  addressExists: boolean;
+  existingRoutes: string[];
+}
+
+/** Native rtnetlink bindings (`src/native/rtnetlink.cc`). */
+interface NativeRtNetlink {
+  configure(
+    interfaceName: string,
+    address: string,
+    prefixLength: number,
+    mtu: number,
+    routes: string[],
+  ): NativeConfigureResult;
+  /** @returns false when the route already existed */
+  addRoute(interfaceName: string, destination: string): boolean;
+  /** @returns false when there was no such route */
+  removeRoute(interfaceName: string, destination: string): boolean;
+}
+
+/** Error thrown by the native rtnetlink bindings. */
+interface NativeRtNetlinkError extends Error {
+  /** errno name, e.g. `EPERM`. */
+  code?: string;
+  errno?: number;
+  /** Request that failed, e.g. `RTM_NEWADDR`. */
+  operation?: string;
+}
+
+/**
+ * Linux implementation. Addresses, MTU, link state and routes are set over
+ * rtnetlink from the addon, and statistics come from `IFLA_STATS64` (see
+ * {@link readLinkStats}), so nothing spawns a subprocess.
+ */
 export class LinuxTunTapPlatform implements TunTapPlatform {
   /** @inheritdoc */
-  async configure(interfaceName: string, address: string, mtu: number): Promise<void> {
+  async configure(
+    interfaceName: string,
+    address: string,
+    mtu: number,
+    routes: string[] = [],
+  ): Promise<void> {
     assertEffectiveRoot();
-    try {
-      await fs.which('ip');
-    } catch {
-      throw new TunTapError(
-        'The "ip" command is not available. Please install iproute2 (e.g., sudo apt install iproute2)',
-      );
-    }
-
-    try {
-      await execFileAsync('ip', ['-6', 'addr', 'add', `${address}/64`, 'dev', interfaceName]);
-    } catch (err: unknown) {
-      // `util.promisify(execFile)` rejects with `ExecException` (extends `Error`; adds `stderr`, `code`, …).
-      const {message} = err as ExecException;
-      if (!message.includes('File exists')) {
-        throw err;
-      }
+    const result = callRtNetlink((netlink) =>
+      netlink.configure(interfaceName, address, 64, mtu, routes),
+    );
+    if (result.addressExists) {
       log.warn(`Address ${address} may already be configured on ${interfaceName}`);
     }
-
-    await execFileAsync('ip', ['link', 'set', 'dev', interfaceName, 'up', 'mtu', String(mtu)]);
+    for (const route of result.existingRoutes) {
+      log.info(`Route to ${route} already exists`);
+    }
   }
 
   /** @inheritdoc */
   async addRoute(interfaceName: string, destination: string): Promise<void> {
     assertEffectiveRoot();
-    try {
-      await execFileAsync('ip', ['-6', 'route', 'add', destination, 'dev', interfaceName]);
-    } catch (err: unknown) {
-      const {message} = err as ExecException;
-      if (message.includes('File exists')) {
-        log.info(`Route to ${destination} already exists`);
-        return;
-      }
-      throw err;
+    if (!callRtNetlink((netlink) => netlink.addRoute(interfaceName, destination))) {
+      log.info(`Route to ${destination} already exists`);
     }
   }
 
   /** @inheritdoc */
   async removeRoute(interfaceName: string, destination: string): Promise<void> {
     assertEffectiveRoot();
-    await execFileAsync('ip', ['-6', 'route', 'del', destination, 'dev', interfaceName]);
+    if (!callRtNetlink((netlink) => netlink.removeRoute(interfaceName, destination))) {
+      log.info(`Route to ${destination} was not in the table`);
+    }
   }
 
   /** @inheritdoc */
   async getStats(interfaceName: string): Promise<TunTapInterfaceStats> {
-    const {stdout} = await execFileAsync('ip', ['-s', 'link', 'show', interfaceName]);
-    const lines = stdout.trim().split('\n');
-
-    const rxIndex = lines.findIndex((line) => line.includes('RX:'));
-    const txIndex = lines.findIndex((line) => line.includes('TX:'));
-
-    if (rxIndex === -1 || txIndex === -1) {
-      throw new TunTapError('Could not parse interface statistics');
-    }
-
-    const rxLine = lines[rxIndex + 1]?.trim();
-    const txLine = lines[txIndex + 1]?.trim();
-    if (!rxLine || !txLine) {
-      throw new TunTapError('Could not parse interface statistics: missing data lines');
-    }
-
-    const rxStats = rxLine.split(/\s+/);
-    const txStats = txLine.split(/\s+/);
-    if (rxStats.length < 3 || txStats.length < 3) {
-      throw new TunTapError('Could not parse interface statistics: unexpected format');
+    const [stats] = readLinkStats([interfaceName]);
+    if (!stats) {
+      throw new TunTapError(`Interface ${interfaceName} does not exist`, 'ENODEV');
     }
+    return stats;
+  }
+}
 
-    return {
-      rxBytes: parseInt(rxStats[0], 10) || 0,
-      rxPackets: parseInt(rxStats[1], 10) || 0,
-      rxErrors: parseInt(rxStats[2], 10) || 0,
-      txBytes: parseInt(txStats[0], 10) || 0,
-      txPackets: parseInt(txStats[1], 10) || 0,
-      txErrors: parseInt(txStats[2], 10) || 0,
-    };
+/** Runs `fn` against the native rtnetlink bindings, mapping kernel errors to {@link TunTapError}. */
+function callRtNetlink<T>(fn: (netlink: NativeRtNetlink) => T): T {
+  const native = require('node-gyp-build')(pkgRoot) as {rtnetlink: NativeRtNetlink};
+  try {
+    return fn(native.rtnetlink);
+  } catch (err: unknown) {
+    const {message, code} = err as NativeRtNetlinkError;
+    throw new TunTapError(message, code);
   }
 }
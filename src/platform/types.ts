@@ -8,6 +8,9 @@ export interface TunTapInterfaceStats {
   txPackets: number;
   rxErrors: number;
   txErrors: number;
+  /** Packets dropped by the kernel (Linux only). */
+  rxDropped?: number;
+  txDropped?: number;
 }
 
 /**
@@ -23,8 +26,16 @@ export interface TunTapPlatform {
    * @param interfaceName — kernel interface name (e.g. `utun7`)
    * @param address — IPv6 address
    * @param mtu — link MTU in bytes
+   * @param routes — IPv6 routes to add via the interface once it is up, as for
+   *   {@link TunTapPlatform.addRoute}; the Linux backend sends them in the same
+   *   rtnetlink batch as the address and MTU
    */
-  configure(interfaceName: string, address: string, mtu: number): Promise<void>;
+  configure(
+    interfaceName: string,
+    address: string,
+    mtu: number,
+    routes?: string[],
+  ): Promise<void>;
 
   /**
    * Add an IPv6 route via this interface.
@@ -26,7 +26,12 @@ const ADDRESS_READY_TIMEOUT_MS = 5000;
  *  PowerShell `Get-NetAdapterStatistics` for byte counters. */
 export class WindowsTunTapPlatform implements TunTapPlatform {
   /** @inheritdoc */
-  async configure(interfaceName: string, address: string, mtu: number): Promise<void> {
+  async configure(
+    interfaceName: string,
+    address: string,
+    mtu: number,
+    routes: string[] = [],
+  ): Promise<void> {
     await assertAdminOnWindows();
     assertSafeAdapterName(interfaceName);
     tunDebug(`[win] configure: interface=${interfaceName} address=${address} mtu=${mtu}`);
@@ -34,6 +39,9 @@ export class WindowsTunTapPlatform implements TunTapPlatform {
     await addIpv6Address(interfaceName, address);
     await waitForIpv6AddressReady(interfaceName, address);
     await setIpv6Mtu(interfaceName, mtu);
+    for (const route of routes) {
+      await this.addRoute(interfaceName, route);
+    }
   }
 
   /** @inheritdoc */
@@ -1,5 +1,13 @@
+import {createRequire} from 'node:module';
+import path from 'node:path';
+import {fileURLToPath} from 'node:url';
+
+import {TunTapError} from '../errors.js';
 import {log} from '../logger.js';
 
+const require = createRequire(import.meta.url);
+const pkgRoot = path.join(fileURLToPath(new URL('.', import.meta.url)), '..', '..');
+
 /** Tunnel debug logging — set APPIUM_TUNTAP_DEBUG=1 on the tunnel process. */
 export const APPIUM_TUNTAP_DEBUG =
   process.env.APPIUM_TUNTAP_DEBUG === '1' || process.env.APPIUM_TUNTAP_DEBUG === 'true';
@@ -29,6 +37,51 @@ export function fwdDebug(event: string, detail?: Record<string, string | number
   log.info(`[fwd] ${parts.join(' ')}`);
 }
 
+/**
+ * Verbosity of the native forwarder log: `debug` covers connection lifecycle
+ * and errors, `trace` adds per-packet and per-batch events.
+ */
+export type ForwarderDebugLevel = 'off' | 'debug' | 'trace';
+
+interface NativeDebugLog {
+  getLevel(): ForwarderDebugLevel;
+  setLevel(level: ForwarderDebugLevel): void;
+  flush(): void;
+  compiledOut: boolean;
+}
+
+function nativeDebugLog(): NativeDebugLog {
+  return (require('node-gyp-build')(pkgRoot) as {debugLog: NativeDebugLog}).debugLog;
+}
+
+/**
+ * Current native forwarder log level. It starts from {@link APPIUM_TUNTAP_DEBUG}
+ * (`1`, `true` or `trace` for trace, `debug` for debug).
+ */
+export function getForwarderDebugLevel(): ForwarderDebugLevel {
+  return nativeDebugLog().getLevel();
+}
+
+/**
+ * Changes the native forwarder log level at runtime. Forwarder threads only
+ * copy binary records into per-thread rings; a background thread formats
+ * them to stderr, so logging can stay on under load.
+ *
+ * @throws {TunTapError} if the addon was built with `TUNTAP_DISABLE_DEBUG_LOG`
+ */
+export function setForwarderDebugLevel(level: ForwarderDebugLevel): void {
+  const native = nativeDebugLog();
+  if (native.compiledOut && level !== 'off') {
+    throw new TunTapError('Native debug logging was compiled out of this build', 'ENOTSUP');
+  }
+  native.setLevel(level);
+}
+
+/** Writes every native record logged so far to stderr. */
+export function flushForwarderDebugLog(): void {
+  nativeDebugLog().flush();
+}
+
 /** Summarize reassembly buffer state for debug logs. */
 export function fwdBufferState(buffer: Buffer): {
   buf: number;
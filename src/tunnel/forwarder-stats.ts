@@ -0,0 +1,155 @@
+/**
+ * Reader side of the statistics block the native tunnel forwarder counts into.
+ *
+ * This module has no native dependency, so a worker thread can import it and
+ * read the counters from the `SharedArrayBuffer` it received via `postMessage`.
+ * The memory layout is defined in `src/native/forwarder_stats.h`.
+ */
+
+const STATS_HEADER_BYTES = 64;
+const STATS_SLOT_BYTES = 256;
+const STATS_MAGIC = 0x54465354;
+/** One slot per forwarder thread role plus one per extra TUN queue (16 queues max). */
+const STATS_SLOT_COUNT = 4 + 15;
+
+// Header word indices (32-bit).
+const MAGIC = 0;
+const SLOT_COUNT = 1;
+const SLOT_BYTES = 2;
+const COUNTER_COUNT = 3;
+
+// Counter indices within a slot, in native order.
+const EGRESS_PACKETS = 0;
+const EGRESS_BYTES = 1;
+const INGRESS_PACKETS = 2;
+const INGRESS_BYTES = 3;
+const DROP_NON_IPV6 = 4;
+const DROP_MULTICAST = 5;
+const DROP_NEIGHBOR_DISCOVERY = 6;
+const DROP_OVERSIZE = 7;
+const TUN_READ_WOULD_BLOCK = 8;
+const TUN_WRITE_BLOCKED = 9;
+const SSL_WANT_READ = 10;
+const SSL_WANT_WRITE = 11;
+const POLL_WAKEUPS = 12;
+const INGRESS_HIGH_WATER = 13;
+const COUNTERS = 14;
+
+/** Egress packets dropped before reaching the tunnel, by reason. */
+export interface TunnelForwarderDropStats {
+  /** Non-IPv6 packets (Windows). */
+  nonIpv6: number;
+  /** IPv6 multicast (Windows). */
+  multicast: number;
+  /** ICMPv6 neighbor discovery (Windows). */
+  neighborDiscovery: number;
+  /** Packets larger than a `pipeline` queue slot. */
+  oversize: number;
+}
+
+/** Totals over every forwarder thread since forwarding started. */
+export interface TunnelForwarderStatsSnapshot {
+  /** Packets read from the TUN device and sent into the tunnel. */
+  egressPackets: number;
+  egressBytes: number;
+  /** Packets received from the tunnel and written to the TUN device. */
+  ingressPackets: number;
+  ingressBytes: number;
+  drops: TunnelForwarderDropStats;
+  /** TUN reads that found the device empty. */
+  tunReadWouldBlock: number;
+  /** TUN writes the device refused until it drained. */
+  tunWriteBlocked: number;
+  /** Waits for the socket to become readable (`SSL_ERROR_WANT_READ` or its kTLS equivalent). */
+  sslWantRead: number;
+  /** Waits for the socket to become writable (`SSL_ERROR_WANT_WRITE` or its kTLS equivalent). */
+  sslWantWrite: number;
+  /** Returns from a blocking readiness wait (service turns for `hub` tunnels). */
+  pollWakeups: number;
+  /** Most decrypted bytes buffered ahead of the TUN device at once. */
+  ingressHighWater: number;
+}
+
+/**
+ * Live view of a forwarder's counters. Every forwarder thread writes its own
+ * cache-line-padded slot; {@link TunnelForwarderStats.snapshot} sums them
+ * with `Atomics.load`, without calling into native code.
+ */
+export class TunnelForwarderStats {
+  /** The shared memory; pass it to a worker and wrap it there with `new TunnelForwarderStats(buffer)`. */
+  readonly buffer: SharedArrayBuffer;
+  private readonly counters: BigUint64Array;
+
+  /** Bytes of shared memory the block needs. */
+  static readonly byteLength = STATS_HEADER_BYTES + STATS_SLOT_COUNT * STATS_SLOT_BYTES;
+
+  /** Allocates a zeroed block with its header written. */
+  static create(): TunnelForwarderStats {
+    const buffer = new SharedArrayBuffer(TunnelForwarderStats.byteLength);
+    const header = new Uint32Array(buffer, 0, STATS_HEADER_BYTES / 4);
+    header[SLOT_COUNT] = STATS_SLOT_COUNT;
+    header[SLOT_BYTES] = STATS_SLOT_BYTES;
+    header[COUNTER_COUNT] = COUNTERS;
+    header[MAGIC] = STATS_MAGIC;
+    return new TunnelForwarderStats(buffer);
+  }
+
+  /**
+   * @param buffer — block memory, as returned by {@link TunnelForwarderStats.buffer}
+   * @throws {TypeError} if `buffer` does not hold a stats block
+   */
+  constructor(buffer: SharedArrayBuffer) {
+    if (
+      !(buffer instanceof SharedArrayBuffer) ||
+      buffer.byteLength < TunnelForwarderStats.byteLength
+    ) {
+      throw new TypeError('Forwarder stats memory must be a SharedArrayBuffer');
+    }
+    const header = new Uint32Array(buffer, 0, STATS_HEADER_BYTES / 4);
+    if (
+      header[MAGIC] !== STATS_MAGIC ||
+      header[SLOT_COUNT] !== STATS_SLOT_COUNT ||
+      header[SLOT_BYTES] !== STATS_SLOT_BYTES ||
+      header[COUNTER_COUNT] !== COUNTERS
+    ) {
+      throw new TypeError('SharedArrayBuffer does not hold forwarder stats');
+    }
+    this.buffer = buffer;
+    this.counters = new BigUint64Array(
+      buffer,
+      STATS_HEADER_BYTES,
+      (STATS_SLOT_COUNT * STATS_SLOT_BYTES) / 8,
+    );
+  }
+
+  /** Current totals. Counters restart from zero when forwarding starts. */
+  snapshot(): TunnelForwarderStatsSnapshot {
+    const totals = new Array<number>(COUNTERS).fill(0);
+    const stride = STATS_SLOT_BYTES / 8;
+    for (let slot = 0; slot < STATS_SLOT_COUNT; slot++) {
+      const base = slot * stride;
+      for (let i = 0; i < COUNTERS; i++) {
+        const value = Number(Atomics.load(this.counters, base + i));
+        totals[i] = i === INGRESS_HIGH_WATER ? Math.max(totals[i], value) : totals[i] + value;
+      }
+    }
+    return {
+      egressPackets: totals[EGRESS_PACKETS],
+      egressBytes: totals[EGRESS_BYTES],
+      ingressPackets: totals[INGRESS_PACKETS],
+      ingressBytes: totals[INGRESS_BYTES],
+      drops: {
+        nonIpv6: totals[DROP_NON_IPV6],
+        multicast: totals[DROP_MULTICAST],
+        neighborDiscovery: totals[DROP_NEIGHBOR_DISCOVERY],
+        oversize: totals[DROP_OVERSIZE],
+      },
+      tunReadWouldBlock: totals[TUN_READ_WOULD_BLOCK],
+      tunWriteBlocked: totals[TUN_WRITE_BLOCKED],
+      sslWantRead: totals[SSL_WANT_READ],
+      sslWantWrite: totals[SSL_WANT_WRITE],
+      pollWakeups: totals[POLL_WAKEUPS],
+      ingressHighWater: totals[INGRESS_HIGH_WATER],
+    };
+  }
+}
@@ -4,6 +4,7 @@ import {fileURLToPath} from 'node:url';
 import type {Socket} from 'node:net';
 
 import type {TunTap} from '../TunTap.js';
+import {TunnelForwarderStats} from './forwarder-stats.js';
 import type {TunnelInfo} from './types.js';
 
 const require = createRequire(import.meta.url);
@@ -22,59 +23,250 @@ export interface TunnelPskTlsCredentials {
   identity?: string;
 }
 
+/** TLS session settings applied before the handshake. */
+export interface TunnelTlsOptions {
+  /**
+   * Ask OpenSSL to offload record encryption to the Linux kernel (kTLS, needs the `tls` module).
+   * Only AES-GCM suites can be offloaded, so TLS-PSK sessions (CBC-only) silently stay in user
+   * space; check {@link TunnelForwarder.getOffloadStatus} for the outcome. Ignored off Linux.
+   */
+  ktls?: boolean;
+}
+
+/** Directions whose TLS record crypto runs in the kernel. */
+export interface TunnelOffloadStatus {
+  ktlsTx: boolean;
+  ktlsRx: boolean;
+}
+
+/**
+ * Native forwarder scheduling model.
+ *
+ * - `threaded` (default): one blocking thread per direction sharing the TLS session under a lock.
+ * - `pump`: one thread owns the TLS session and drives both directions from a single readiness
+ *   loop, so encryption never waits on decryption (macOS/Linux only).
+ * - `pipeline`: separate TUN reader, encryptor, decryptor and TUN writer threads joined by bounded
+ *   lock-free queues, so TUN syscalls overlap with crypto and a slow socket does not stall TUN reads.
+ * - `hub`: no per-tunnel threads; the tunnel joins a process-wide pool of event-loop workers that
+ *   multiplex many tunnels, assigned to the least-loaded worker (macOS/Linux only).
+ */
+export type TunnelForwarderEngine = 'threaded' | 'pump' | 'pipeline' | 'hub';
+
+/** Scheduling classes accepted by {@link TunnelForwarderThreadTuning.policy}. */
+export type TunnelForwarderSchedPolicy = 'other' | 'batch' | 'idle' | 'fifo' | 'rr';
+
+/**
+ * Placement and scheduling for one group of forwarder threads. Best effort: settings the OS
+ * refuses (missing privileges, unsupported platform) leave the thread untuned and are reported as
+ * `thread-tuning-failed` in the native debug log (see `setForwarderDebugLevel()`).
+ */
+export interface TunnelForwarderThreadTuning {
+  /** CPUs the threads may run on (Linux, Windows): integer indices from 0 to 1023. */
+  cpus?: number[];
+  /** Scheduling policy; `fifo`/`rr` usually need CAP_SYS_NICE. `batch`/`idle` are Linux-only. */
+  policy?: TunnelForwarderSchedPolicy;
+  /** Static priority for `fifo`/`rr` (1-99, default 1). */
+  priority?: number;
+  /** Per-thread nice level, -20 to 19 (Linux only). */
+  nice?: number;
+}
+
+/** Native forwarding knobs accepted by {@link TunnelForwarder.startForwarding}. */
+export interface TunnelForwardingOptions {
+  /** Forwarding engine (default `threaded`). */
+  engine?: TunnelForwarderEngine;
+  /**
+   * Max TUN packets coalesced into one TLS write (1-1024). `1` (default) sends each packet on
+   * its own; larger values drain the TUN queue and send the run as one write.
+   */
+  egressBatchPackets?: number;
+  /** Byte budget for one coalesced TLS write (default 65536, max 1 MiB). */
+  egressBatchBytes?: number;
+  /** Slots per direction in the `pipeline` engine queues (default 256, rounded up to a power of two). */
+  pipelineQueueDepth?: number;
+  /**
+   * Minimum size of the shared `hub` worker pool (0-64). The pool is created on first use with
+   * this many workers (default 2) and only ever grows.
+   */
+  hubWorkers?: number;
+  /**
+   * Per-tunnel thread placement. `tun` covers the TUN-side threads (and the `pump` thread),
+   * `socket` the TLS-side threads. Threads are named `tuntap-*` for `top -H`/`perf` either way;
+   * shared `hub` workers are not tuned per tunnel.
+   */
+  threads?: {
+    tun?: TunnelForwarderThreadTuning;
+    socket?: TunnelForwarderThreadTuning;
+  };
+  /**
+   * Spin-then-block: busy-retry TUN and TLS reads for this many microseconds (0-10000) before
+   * sleeping in `poll()`. Lowers wakeup latency at the cost of CPU; `0` (default) disables it.
+   */
+  spinUs?: number;
+}
+
+/** Occupancy of one shared `hub` engine worker. */
+export interface TunnelForwarderHubWorkerStats {
+  /** Tunnels currently assigned to the worker. */
+  tunnels: number;
+  /** Event-loop iterations since the worker started. */
+  wakeups: number;
+}
+
+/** Occupancy of one `pipeline` engine queue. */
+export interface TunnelForwarderQueueStats {
+  /** Packets currently queued. */
+  depth: number;
+  /** Deepest the queue has been since forwarding started. */
+  highWater: number;
+  /** Queue capacity in packets. */
+  capacity: number;
+}
+
+/** Queue occupancy of the `pipeline` engine, one queue per direction. */
+export interface TunnelForwarderPipelineStats {
+  /** TUN reader to encryptor. */
+  egress: TunnelForwarderQueueStats;
+  /** Decryptor to TUN writer. */
+  ingress: TunnelForwarderQueueStats;
+}
+
+/**
+ * Latency distribution of one forwarding stage. Percentiles come from a
+ * log-linear histogram and overstate the true value by at most 6.25 %.
+ */
+export interface TunnelForwarderLatencyPercentiles {
+  /** Samples recorded (packets for packet stages, waits for wait stages). */
+  count: number;
+  meanUs: number;
+  maxUs: number;
+  p50Us: number;
+  p90Us: number;
+  p99Us: number;
+  p999Us: number;
+}
+
+/** Per-stage latency of the native forwarder, in microseconds. */
+export interface TunnelForwarderLatencyStats {
+  egress: {
+    /** TUN read completion to TLS write completion, per packet. */
+    tunToTunnel: TunnelForwarderLatencyPercentiles;
+    /** Time blocked waiting for the socket to become writable. */
+    socketWait: TunnelForwarderLatencyPercentiles;
+  };
+  ingress: {
+    /** TLS read completion to frame extraction, per packet. */
+    readToFrame: TunnelForwarderLatencyPercentiles;
+    /** Frame extraction to TUN write completion, per packet. */
+    frameToTun: TunnelForwarderLatencyPercentiles;
+    /** Time blocked waiting for the TUN device to accept writes. */
+    tunWait: TunnelForwarderLatencyPercentiles;
+    /** Time blocked waiting for the socket to become readable. */
+    socketWait: TunnelForwarderLatencyPercentiles;
+  };
+}
+
 interface NativeTunnelForwarder {
-  connect(tcpFd: number, certPem: string, keyPem: string): void;
-  connectSocket(tcpHandle: unknown, certPem: string, keyPem: string): void;
-  connectPsk(tcpFd: number, psk: Buffer, identity?: string): void;
-  connectPskSocket(tcpHandle: unknown, psk: Buffer, identity?: string): void;
+  connect(tcpFd: number, certPem: string, keyPem: string, tlsOptions?: TunnelTlsOptions): void;
+  connectSocket(
+    tcpHandle: unknown,
+    certPem: string,
+    keyPem: string,
+    tlsOptions?: TunnelTlsOptions,
+  ): void;
+  connectPsk(tcpFd: number, psk: Buffer, identity?: string, tlsOptions?: TunnelTlsOptions): void;
+  connectPskSocket(
+    tcpHandle: unknown,
+    psk: Buffer,
+    identity?: string,
+    tlsOptions?: TunnelTlsOptions,
+  ): void;
   handshake(requestedMtu: number): TunnelInfo;
-  startForwarding(tunForwardingHandle: unknown, onError?: (message: string) => void): void;
+  startForwarding(
+    tunForwardingHandle: unknown,
+    onError?: (message: string) => void,
+    options?: TunnelForwardingOptions,
+  ): void;
+  getQueueStats(): TunnelForwarderPipelineStats | null;
+  getOffloadStatus(): TunnelOffloadStatus;
+  getLatencyStats(): TunnelForwarderLatencyStats;
+  resetLatencyStats(): void;
+  setStatsMemory(memory: Uint8Array): void;
   stop(): void;
 }
 
 interface NativeTuntapModule {
-  TunnelForwarder: new () => NativeTunnelForwarder;
+  TunnelForwarder: {
+    new (): NativeTunnelForwarder;
+    getHubStats(): TunnelForwarderHubWorkerStats[];
+  };
 }
 
 /**
- * OpenSSL tunnel forwarder (pmd3/go-ios style): TLS + two blocking pthread loops in C++.
+ * OpenSSL tunnel forwarder (pmd3/go-ios style): the TLS session and the TUN device are driven
+ * entirely in C++, shaped by {@link TunnelForwardingOptions.engine}:
+ * - `threaded` (default): one blocking loop thread per direction.
+ * - `pump`: both directions on one thread that owns the session.
+ * - `pipeline`: each direction split into an I/O stage and a crypto stage joined by queues.
+ * - `hub`: no threads of its own; the session runs on a shared worker pool (see
+ *   {@link TunnelForwarder.getHubStats}).
  */
 export class TunnelForwarder {
   private forwarder: NativeTunnelForwarder | null = null;
   private retainedSocket: Socket | null = null;
+  private readonly stats = TunnelForwarderStats.create();
+
+  /** Per-worker load of the shared `hub` engine pool (empty until a hub tunnel starts). */
+  static getHubStats(): TunnelForwarderHubWorkerStats[] {
+    const native = require('node-gyp-build')(pkgRoot) as NativeTuntapModule;
+    return native.TunnelForwarder.getHubStats();
+  }
 
-  connect(tcpSocket: Socket, credentials: TunnelLockdownTlsCredentials): void {
+  connect(
+    tcpSocket: Socket,
+    credentials: TunnelLockdownTlsCredentials,
+    tlsOptions: TunnelTlsOptions = {},
+  ): void {
     tcpSocket.pause();
     tcpSocket.removeAllListeners();
 
-    const native = require('node-gyp-build')(pkgRoot) as NativeTuntapModule;
-    this.forwarder = new native.TunnelForwarder();
+    this.forwarder = this.createNative();
     if (process.platform === 'win32') {
-      this.forwarder.connectSocket(getSocketHandle(tcpSocket), credentials.cert, credentials.key);
+      this.forwarder.connectSocket(
+        getSocketHandle(tcpSocket),
+        credentials.cert,
+        credentials.key,
+        tlsOptions,
+      );
     } else {
-      this.forwarder.connect(getSocketFd(tcpSocket), credentials.cert, credentials.key);
+      this.forwarder.connect(getSocketFd(tcpSocket), credentials.cert, credentials.key, tlsOptions);
     }
 
     this.takeSocketOwnership(tcpSocket);
   }
 
-  connectPsk(tcpSocket: Socket, credentials: TunnelPskTlsCredentials): void {
+  connectPsk(
+    tcpSocket: Socket,
+    credentials: TunnelPskTlsCredentials,
+    tlsOptions: TunnelTlsOptions = {},
+  ): void {
     tcpSocket.pause();
     tcpSocket.removeAllListeners();
 
-    const native = require('node-gyp-build')(pkgRoot) as NativeTuntapModule;
-    this.forwarder = new native.TunnelForwarder();
+    this.forwarder = this.createNative();
     if (process.platform === 'win32') {
       this.forwarder.connectPskSocket(
         getSocketHandle(tcpSocket),
         credentials.psk,
         credentials.identity ?? '',
+        tlsOptions,
       );
     } else {
       this.forwarder.connectPsk(
         getSocketFd(tcpSocket),
         credentials.psk,
         credentials.identity ?? '',
+        tlsOptions,
       );
     }
 
@@ -88,18 +280,56 @@ export class TunnelForwarder {
     return this.forwarder.handshake(requestedMtu);
   }
 
-  startForwarding(tun: TunTap, onError?: (message: string) => void): void {
+  startForwarding(
+    tun: TunTap,
+    onError?: (message: string) => void,
+    options?: TunnelForwardingOptions,
+  ): void {
     if (!this.forwarder) {
       throw new Error('Tunnel forwarder is not connected');
     }
     const forwardingHandle = tun.forwardingHandle;
-    if (onError) {
+    if (options) {
+      this.forwarder.startForwarding(forwardingHandle, onError, options);
+    } else if (onError) {
       this.forwarder.startForwarding(forwardingHandle, onError);
     } else {
       this.forwarder.startForwarding(forwardingHandle);
     }
   }
 
+  /** Pipeline queue occupancy, or `null` unless the `pipeline` engine has been started. */
+  getQueueStats(): TunnelForwarderPipelineStats | null {
+    return this.forwarder?.getQueueStats() ?? null;
+  }
+
+  /**
+   * Live traffic counters, read from shared memory without calling into native
+   * code. The same view stays valid across reconnects; counters restart from
+   * zero each time forwarding starts.
+   */
+  getStats(): TunnelForwarderStats {
+    return this.stats;
+  }
+
+  /**
+   * Per-stage latency percentiles since forwarding started or the last
+   * {@link resetLatencyStats}, or `null` when not connected.
+   */
+  getLatencyStats(): TunnelForwarderLatencyStats | null {
+    return this.forwarder?.getLatencyStats() ?? null;
+  }
+
+  /** Clears the latency histograms, e.g. to measure one load phase on its own. */
+  resetLatencyStats(): void {
+    this.forwarder?.resetLatencyStats();
+  }
+
+  /** Which directions the kernel encrypts/decrypts (kTLS); both false when not connected. */
+  getOffloadStatus(): TunnelOffloadStatus {
+    return this.forwarder?.getOffloadStatus() ?? {ktlsTx: false, ktlsRx: false};
+  }
+
   stop(): void {
     this.forwarder?.stop();
     this.forwarder = null;
@@ -109,6 +339,13 @@ export class TunnelForwarder {
     }
   }
 
+  private createNative(): NativeTunnelForwarder {
+    const native = require('node-gyp-build')(pkgRoot) as NativeTuntapModule;
+    const forwarder = new native.TunnelForwarder();
+    forwarder.setStatsMemory(new Uint8Array(this.stats.buffer));
+    return forwarder;
+  }
+
   private takeSocketOwnership(socket: Socket): void {
     destroySocket(socket);
   }
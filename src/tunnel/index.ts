@@ -1,7 +1,34 @@
 export type {TunnelConnection} from './types.js';
+export {
+  flushForwarderDebugLog,
+  getForwarderDebugLevel,
+  setForwarderDebugLevel,
+  type ForwarderDebugLevel,
+} from './debug-log.js';
 export {
   TunnelForwarder,
+  type TunnelForwarderEngine,
+  type TunnelForwarderHubWorkerStats,
+  type TunnelForwarderLatencyPercentiles,
+  type TunnelForwarderLatencyStats,
+  type TunnelForwarderPipelineStats,
+  type TunnelForwarderSchedPolicy,
+  type TunnelForwarderThreadTuning,
+  type TunnelForwarderQueueStats,
+  type TunnelForwardingOptions,
   type TunnelLockdownTlsCredentials,
+  type TunnelOffloadStatus,
   type TunnelPskTlsCredentials,
+  type TunnelTlsOptions,
 } from './forwarder.js';
-export {TunnelManager, connectToTunnelLockdown, connectToTunnelPsk} from './manager.js';
+export {
+  TunnelForwarderStats,
+  type TunnelForwarderDropStats,
+  type TunnelForwarderStatsSnapshot,
+} from './forwarder-stats.js';
+export {
+  TunnelManager,
+  connectToTunnelLockdown,
+  connectToTunnelPsk,
+  type ConnectTunnelOptions,
+} from './manager.js';
@@ -1,16 +1,33 @@
 import {log} from '../logger.js';
-import {TunTap} from '../TunTap.js';
+import {TunTap, type TunTapOptions} from '../TunTap.js';
 import type {Socket} from 'node:net';
 
 import {CD_TUNNEL_MTU} from './constants.js';
 import {tunDebug} from './debug-log.js';
 import {
   TunnelForwarder,
+  type TunnelForwarderLatencyStats,
+  type TunnelForwarderPipelineStats,
   type TunnelLockdownTlsCredentials,
+  type TunnelForwardingOptions,
   type TunnelPskTlsCredentials,
+  type TunnelTlsOptions,
 } from './forwarder.js';
+import type {TunnelForwarderStats} from './forwarder-stats.js';
 import type {TunnelConnection, TunnelInfo} from './types.js';
 
+/** Options shared by {@link connectToTunnelLockdown} and {@link connectToTunnelPsk}. */
+export interface ConnectTunnelOptions {
+  /** Called when the native forwarder dies unexpectedly. */
+  onDead?: (reason: string) => void;
+  /** Native forwarder tuning passed to {@link TunnelForwarder.startForwarding}. */
+  forwarding?: TunnelForwardingOptions;
+  /** TLS session settings (e.g. kTLS offload) passed to the native connect. */
+  tls?: TunnelTlsOptions;
+  /** TUN device settings (e.g. segmentation offload) for the tunnel interface. */
+  device?: TunTapOptions;
+}
+
 /**
  * Manages a {@link TunTap} interface and native OpenSSL tunnel forwarding.
  */
@@ -24,15 +41,17 @@ export class TunnelManager {
    * Open a {@link TunTap}, assign the client IPv6 address/MTU, and add a /128 route to the server.
    *
    * @param tunnelInfo — handshake result (client address, MTU, server address)
+   * @param deviceOptions — native TUN device settings
    * @returns interface name, MTU, and the live {@link TunTap} instance
    */
   async setupInterface(
     tunnelInfo: TunnelInfo,
+    deviceOptions?: TunTapOptions,
   ): Promise<{name: string; mtu: number; interface: TunTap}> {
     tunDebug(`Setting up tunnel with parameters:`, tunnelInfo);
 
     try {
-      this.tun = new TunTap();
+      this.tun = new TunTap('', process.platform, deviceOptions);
 
       if (!this.tun.open()) {
         throw new Error('Failed to open TUN device');
@@ -43,10 +62,9 @@ export class TunnelManager {
       await this.tun.configure(
         tunnelInfo.clientParameters.address,
         tunnelInfo.clientParameters.mtu,
+        [`${tunnelInfo.serverAddress}/128`],
       );
 
-      await this.tun.addRoute(`${tunnelInfo.serverAddress}/128`);
-
       tunDebug(
         `Configured TUN interface ${this.tun.name} with address ${tunnelInfo.clientParameters.address} and MTU ${tunnelInfo.clientParameters.mtu}`,
       );
@@ -75,8 +93,13 @@ export class TunnelManager {
    *
    * @param forwarder — connected forwarder after {@link TunnelForwarder.handshake}
    * @param onDead — optional callback when native forwarder threads exit unexpectedly
+   * @param options — optional native forwarder tuning
    */
-  startForwarding(forwarder: TunnelForwarder, onDead?: (reason: string) => void): void {
+  startForwarding(
+    forwarder: TunnelForwarder,
+    onDead?: (reason: string) => void,
+    options?: TunnelForwardingOptions,
+  ): void {
     if (!this.tun) {
       log.error('TUN device is not set up');
       return;
@@ -84,19 +107,50 @@ export class TunnelManager {
 
     tunDebug(`Starting OpenSSL tunnel forwarding for ${this.tun.name}`);
     this.forwarder = forwarder;
-    forwarder.startForwarding(this.tun, (message) => {
-      if (this.cancelled) {
-        tunDebug(`Ignoring forwarder error during shutdown: ${message}`);
-        return;
-      }
-      log.error('Tunnel forwarder error:', message);
-      setImmediate(() => {
-        void (async () => {
-          await this.stop();
-          onDead?.(message);
-        })();
-      });
-    });
+    forwarder.startForwarding(
+      this.tun,
+      (message) => {
+        if (this.cancelled) {
+          tunDebug(`Ignoring forwarder error during shutdown: ${message}`);
+          return;
+        }
+        log.error('Tunnel forwarder error:', message);
+        setImmediate(() => {
+          void (async () => {
+            await this.stop();
+            onDead?.(message);
+          })();
+        });
+      },
+      options,
+    );
+  }
+
+  /**
+   * Queue occupancy of the native `pipeline` forwarding engine.
+   *
+   * @returns per-direction depth/high-water/capacity, or `null` for other engines
+   */
+  getQueueStats(): TunnelForwarderPipelineStats | null {
+    return this.forwarder?.getQueueStats() ?? null;
+  }
+
+  /**
+   * Live traffic counters of the native forwarder (see {@link TunnelForwarder.getStats}).
+   *
+   * @returns the shared stats view, or `null` before forwarding starts
+   */
+  getStats(): TunnelForwarderStats | null {
+    return this.forwarder?.getStats() ?? null;
+  }
+
+  /**
+   * Per-stage latency of the native forwarder (see {@link TunnelForwarder.getLatencyStats}).
+   *
+   * @returns percentiles per stage, or `null` before forwarding starts
+   */
+  getLatencyStats(): TunnelForwarderLatencyStats | null {
+    return this.forwarder?.getLatencyStats() ?? null;
   }
 
   /**
@@ -148,14 +202,14 @@ export class TunnelManager {
 export async function connectToTunnelLockdown(
   tcpSocket: Socket,
   credentials: TunnelLockdownTlsCredentials,
-  options?: {onDead?: (reason: string) => void},
+  options?: ConnectTunnelOptions,
 ): Promise<TunnelConnection> {
   return connectTunnel(
     tcpSocket,
     (forwarder) => {
-      forwarder.connect(tcpSocket, credentials);
+      forwarder.connect(tcpSocket, credentials, options?.tls);
     },
-    options?.onDead,
+    options,
   );
 }
 
@@ -167,21 +221,21 @@ export async function connectToTunnelLockdown(
 export async function connectToTunnelPsk(
   tcpSocket: Socket,
   credentials: TunnelPskTlsCredentials,
-  options?: {onDead?: (reason: string) => void},
+  options?: ConnectTunnelOptions,
 ): Promise<TunnelConnection> {
   return connectTunnel(
     tcpSocket,
     (forwarder) => {
-      forwarder.connectPsk(tcpSocket, credentials);
+      forwarder.connectPsk(tcpSocket, credentials, options?.tls);
     },
-    options?.onDead,
+    options,
   );
 }
 
 async function connectTunnel(
   tcpSocket: Socket,
   setupTls: (forwarder: TunnelForwarder) => void,
-  onDead?: (reason: string) => void,
+  options?: ConnectTunnelOptions,
 ): Promise<TunnelConnection> {
   const tunnelManager = new TunnelManager();
   const forwarder = new TunnelForwarder();
@@ -194,10 +248,10 @@ async function connectTunnel(
     const tunnelInfo = forwarder.handshake(CD_TUNNEL_MTU);
     tunDebug('Tunnel parameters exchanged:', tunnelInfo);
 
-    const tunInterfaceInfo = await tunnelManager.setupInterface(tunnelInfo);
+    const tunInterfaceInfo = await tunnelManager.setupInterface(tunnelInfo, options?.device);
     tunDebug('Tunnel interface set up:', tunInterfaceInfo.name);
 
-    tunnelManager.startForwarding(forwarder, onDead);
+    tunnelManager.startForwarding(forwarder, options?.onDead, options?.forwarding);
 
     const closeFunc = async () => {
       tunDebug('Closing tunnel connection');
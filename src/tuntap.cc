@@ -2,84 +2,251 @@
 
 #include <atomic>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <utility>
-#include <deque>
-
+#include <vector>
+
+#include "native/async_reader.h"
+#include "native/async_writer.h"
+#include "native/debug_log.h"
+#include "native/packet_pool.h"
+#include "native/packet_ring.h"
+#include "native/receive_coalescer.h"
+#include "native/tcp_offload.h"
 #include "native/tun_backend.h"
 #include "native/tunnel_forwarder.h"
 
+#ifdef __linux__
+#include "native/link_stats.h"
+#include "native/rtnetlink.h"
+#endif
+
+struct TunPollDispatch;
+
+// Runs on the JS thread for each packet the receive loop posted.
+void CallJsPacket(Napi::Env env,
+                  Napi::Function js_callback,
+                  TunPollDispatch* dispatch,
+                  PacketBuffer* packet);
+
+using PacketTsfn = Napi::TypedThreadSafeFunction<TunPollDispatch, PacketBuffer, CallJsPacket>;
+
 struct TunPollDispatch {
-  Napi::ThreadSafeFunction tsfn;
+  PacketTsfn tsfn;
   std::mutex mutex;
-  std::deque<std::vector<uint8_t>> pending;
+  // Packets accepted but not yet queued on the TSFN: a fixed ring of
+  // `max_pending_` slots, so posting a packet never allocates.
+  std::vector<PacketBuffer*> pending;
+  size_t pending_head = 0;
+  size_t pending_count = 0;
   size_t max_pending_ = 1;
+  // Deliveries the receive loop may still post before JS runs a callback;
+  // starts at the queue depth, is spent by PostPacket and returned by
+  // OnJsConsumed. The receive loop pauses only while it is zero, which also
+  // bounds `pending` and the TSFN queue to the queue depth.
+  size_t credits = 0;
+  // Each posted buffer is a packed batch (see receive_coalescer.h).
+  bool batched = false;
   class TunDevice* device_ = nullptr;
 
-  struct PacketJob {
-    TunPollDispatch* dispatch;
-    std::vector<uint8_t>* packet;
-  };
+  ~TunPollDispatch() {
+    while (pending_count > 0) {
+      PacketPool::Instance().Release(pending[pending_head]);
+      pending_head = (pending_head + 1) % pending.size();
+      --pending_count;
+    }
+  }
 
-  void OnJsConsumed();
+  void SetCapacity(size_t max_pending) {
+    max_pending_ = max_pending;
+    pending.assign(max_pending, nullptr);
+    credits = max_pending;
+  }
 
-  static void CallJs(Napi::Env env,
-                     Napi::Function jsCallback,
-                     TunPollDispatch* self,
-                     std::vector<uint8_t>* packet) {
-    if (env == nullptr || jsCallback.IsEmpty() || packet == nullptr) {
-      delete packet;
-      return;
-    }
-    auto* backing = packet;
-    Napi::Buffer<uint8_t> buf = Napi::Buffer<uint8_t>::New(
-        env,
-        backing->data(),
-        backing->size(),
-        [](Napi::Env, uint8_t*, std::vector<uint8_t>* vec) { delete vec; },
-        backing);
-    jsCallback.Call({buf});
-    if (self != nullptr) {
-      self->OnJsConsumed();
-    }
+  bool HasCredit() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return credits > 0;
   }
 
+  void OnJsConsumed();
+
   void FlushPending() {
     std::lock_guard<std::mutex> lock(mutex);
-    while (!pending.empty()) {
-      auto* packet = new std::vector<uint8_t>(std::move(pending.front()));
-      auto* job = new PacketJob{this, packet};
-      napi_status status = tsfn.NonBlockingCall(
-          job,
-          [](Napi::Env env, Napi::Function jsCallback, PacketJob* job) {
-            CallJs(env, jsCallback, job->dispatch, job->packet);
-            delete job;
-          });
-      if (status != napi_ok) {
-        delete packet;
-        delete job;
+    while (pending_count > 0) {
+      // The TSFN hands the buffer to CallJsPacket without wrapping it, so a
+      // queued call costs no allocation either.
+      if (tsfn.NonBlockingCall(pending[pending_head]) != napi_ok) {
         break;
       }
-      pending.pop_front();
+      pending_head = (pending_head + 1) % pending.size();
+      --pending_count;
     }
   }
 
-  bool PostPacket(std::vector<uint8_t> packet) {
+  // Spends a credit on `packet`; false once none are left (the packet is
+  // dropped if it arrived without one).
+  bool PostPacket(PooledPacket packet) {
+    bool has_credit = false;
     {
       std::lock_guard<std::mutex> lock(mutex);
-      if (pending.size() >= max_pending_) {
+      if (credits == 0 || pending_count >= max_pending_) {
         return false;
       }
-      pending.push_back(std::move(packet));
+      pending[(pending_head + pending_count) % pending.size()] = packet.release();
+      ++pending_count;
+      --credits;
+      has_credit = credits > 0;
     }
     FlushPending();
-    std::lock_guard<std::mutex> lock(mutex);
-    return pending.size() < max_pending_;
+    return has_credit;
+  }
+};
+
+// A JS Buffer aliasing pooled memory; GC returns it to the pool. The raw
+// N-API call takes a plain C finalizer, where Napi::Buffer::New would
+// allocate a finalizer record per buffer. Null (buffer released) on failure.
+napi_value NewPooledBuffer(napi_env env, PacketBuffer* packet) {
+  napi_value value = nullptr;
+  const napi_status status = napi_create_external_buffer(
+      env, packet->size, packet->data(),
+      [](napi_env, void*, void* hint) {
+        PacketPool::Instance().Release(static_cast<PacketBuffer*>(hint));
+      },
+      packet, &value);
+  if (status != napi_ok) {
+    PacketPool::Instance().Release(packet);
+    return nullptr;
+  }
+  return value;
+}
+
+// Copies the boundaries of a packed batch (see receive_coalescer.h) out of
+// `packet` before the buffer is handed to GC.
+Napi::Uint32Array NewPackedBatchOffsets(Napi::Env env, const PacketBuffer* packet) {
+  const PackedBatchView view = ViewPackedBatch(packet);
+  Napi::Uint32Array offsets = Napi::Uint32Array::New(env, view.count + 1);
+  memcpy(offsets.Data(), view.offsets, (view.count + 1) * sizeof(uint32_t));
+  return offsets;
+}
+
+void CallJsPacket(Napi::Env env,
+                  Napi::Function js_callback,
+                  TunPollDispatch* dispatch,
+                  PacketBuffer* packet) {
+  if (env == nullptr || js_callback.IsEmpty() || packet == nullptr) {
+    PacketPool::Instance().Release(packet);
+    return;
+  }
+  Napi::Uint32Array offsets;
+  if (dispatch != nullptr && dispatch->batched) {
+    offsets = NewPackedBatchOffsets(env, packet);
+  }
+  napi_value value = NewPooledBuffer(env, packet);
+  if (value == nullptr) {
+    return;
   }
+  if (!offsets.IsEmpty()) {
+    js_callback.Call({value, offsets});
+  } else {
+    js_callback.Call({value});
+  }
+  if (dispatch != nullptr) {
+    dispatch->OnJsConsumed();
+  }
+}
+
+// Runs on the JS thread when the packet ring producer needs its consumer
+// woken (`message` null) or stopped on an error.
+void CallJsRing(Napi::Env env, Napi::Function js_callback, void*, std::string* message) {
+  std::unique_ptr<std::string> owned(message);
+  if (env == nullptr || js_callback.IsEmpty()) {
+    return;
+  }
+  if (owned) {
+    js_callback.Call({Napi::String::New(env, *owned)});
+  } else {
+    js_callback.Call({});
+  }
+}
+
+using RingTsfn = Napi::TypedThreadSafeFunction<void, std::string, CallJsRing>;
+
+// Answer to one readMany()/writeMany() call, posted by the async reader or
+// writer thread.
+struct AsyncIoCompletion {
+  napi_deferred deferred = nullptr;
+  // Reads: packed batch, null when the wait timed out or failed.
+  PacketBuffer* batch = nullptr;
+  // Writes: packets written; resolves the promise unless `error` is set.
+  bool is_write = false;
+  size_t written = 0;
+  std::string error;
 };
 
+struct AsyncIoDispatch;
+
+void CallJsAsyncIo(Napi::Env env,
+                   Napi::Function js_callback,
+                   AsyncIoDispatch* dispatch,
+                   AsyncIoCompletion* completion);
+
+using AsyncIoTsfn = Napi::TypedThreadSafeFunction<AsyncIoDispatch, AsyncIoCompletion, CallJsAsyncIo>;
+
+// Context of the TSFN that answers readMany()/writeMany() promises; freed by
+// its finalizer.
+struct AsyncIoDispatch {
+  AsyncIoTsfn tsfn;
+  // Calls not yet answered (JS thread only). The TSFN holds the event loop
+  // open only while this is non-zero.
+  size_t in_flight = 0;
+};
+
+void CallJsAsyncIo(Napi::Env env,
+                   Napi::Function,
+                   AsyncIoDispatch* dispatch,
+                   AsyncIoCompletion* completion) {
+  std::unique_ptr<AsyncIoCompletion> owned(completion);
+  if (env == nullptr || completion == nullptr) {
+    if (completion != nullptr) {
+      PacketPool::Instance().Release(completion->batch);
+    }
+    return;
+  }
+  if (dispatch != nullptr && dispatch->in_flight > 0 && --dispatch->in_flight == 0) {
+    dispatch->tsfn.Unref(env);
+  }
+
+  Napi::HandleScope scope(env);
+  if (completion->is_write && completion->error.empty()) {
+    napi_resolve_deferred(env, completion->deferred,
+                          Napi::Number::New(env, static_cast<double>(completion->written)));
+    return;
+  }
+  if (!completion->error.empty()) {
+    PacketPool::Instance().Release(completion->batch);
+    napi_reject_deferred(env, completion->deferred, Napi::Error::New(env, completion->error).Value());
+    return;
+  }
+  if (completion->batch == nullptr) {
+    napi_resolve_deferred(env, completion->deferred, env.Null());
+    return;
+  }
+  Napi::Uint32Array offsets = NewPackedBatchOffsets(env, completion->batch);
+  napi_value data = NewPooledBuffer(env, completion->batch);
+  if (data == nullptr) {
+    napi_reject_deferred(env, completion->deferred,
+                         Napi::Error::New(env, "Failed to create packet buffer").Value());
+    return;
+  }
+  Napi::Array result = Napi::Array::New(env, 2);
+  result.Set(uint32_t(0), Napi::Value(env, data));
+  result.Set(uint32_t(1), offsets);
+  napi_resolve_deferred(env, completion->deferred, result);
+}
+
 class TunDevice : public Napi::ObjectWrap<TunDevice> {
 public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
@@ -97,12 +264,22 @@ private:
   Napi::Value Close(const Napi::CallbackInfo& info);
   Napi::Value Read(const Napi::CallbackInfo& info);
   Napi::Value Write(const Napi::CallbackInfo& info);
+  Napi::Value ReadMany(const Napi::CallbackInfo& info);
+  Napi::Value ReadInto(const Napi::CallbackInfo& info);
+  Napi::Value WriteFrom(const Napi::CallbackInfo& info);
+  Napi::Value WriteMany(const Napi::CallbackInfo& info);
   Napi::Value GetName(const Napi::CallbackInfo& info);
   Napi::Value GetFd(const Napi::CallbackInfo& info);
+  Napi::Value GetOffloadEnabled(const Napi::CallbackInfo& info);
+  Napi::Value GetQueueCount(const Napi::CallbackInfo& info);
+  Napi::Value GetIoUringEnabled(const Napi::CallbackInfo& info);
+  static Napi::Value GetPacketPoolStats(const Napi::CallbackInfo& info);
   Napi::Value GetForwardingHandle(const Napi::CallbackInfo& info);
   Napi::Value StartPolling(const Napi::CallbackInfo& info);
   Napi::Value PausePolling(const Napi::CallbackInfo& info);
   Napi::Value ResumePolling(const Napi::CallbackInfo& info);
+  Napi::Value StartRing(const Napi::CallbackInfo& info);
+  Napi::Value StopRing(const Napi::CallbackInfo& info);
 
   std::unique_ptr<TunPlatformBackend> backend_;
   std::string requested_name_;
@@ -110,12 +287,47 @@ private:
   std::atomic<bool> is_open_;
   std::mutex device_mutex_;
 
-  Napi::ThreadSafeFunction tsfn_;
+  PacketTsfn tsfn_;
   TunPollDispatch* poll_dispatch_ = nullptr;
   std::atomic<bool> polling_;
+  // Set by pausePolling(); returning credits must not undo it.
+  std::atomic<bool> polling_paused_{false};
   static constexpr size_t MAX_POLL_BUFFER = 65535;
-
-  void StopPollingLocked();
+  static constexpr size_t MAX_POLL_BATCH = 256;
+  static constexpr uint32_t MAX_POLL_DELAY_US = 1000000;
+
+  // Shared packet ring (startRing): the producer thread writes into
+  // `ring_memory_`, which the reference keeps alive until it is joined.
+  std::unique_ptr<PacketRingProducer> ring_;
+  RingTsfn ring_tsfn_;
+  // Carries the producer's single terminal error. It has its own queue slot
+  // so a pending wakeup can never crowd it out.
+  RingTsfn ring_error_tsfn_;
+  Napi::ObjectReference ring_memory_;
+  static constexpr size_t MAX_RING_SLOTS = 65536;
+  static constexpr size_t MAX_RING_SLOT_SIZE = MAX_POLL_BUFFER + 1 + packet_ring::kSlotHeaderBytes;
+
+  // Asynchronous I/O (readMany/writeMany): the reader and writer threads
+  // and the TSFN answering their promises, all created on first use.
+  std::unique_ptr<TunAsyncReader> async_reader_;
+  std::unique_ptr<TunAsyncWriter> async_writer_;
+  AsyncIoTsfn async_tsfn_;
+  AsyncIoDispatch* async_dispatch_ = nullptr;
+  static constexpr size_t MAX_READ_MANY_PACKETS = 1024;
+  static constexpr size_t MAX_READ_MANY_BYTES = 4 * 1024 * 1024;
+
+  // Creates the async TSFN if needed and a promise it will settle.
+  bool BeginAsyncCall(Napi::Env env, napi_deferred& deferred, napi_value& promise);
+
+  // Stops the receive loop and re-attaches the queues startPolling
+  // detached. Polling stops either way; false (with `error`) when a queue
+  // could not be re-attached.
+  bool StopPollingLocked(std::string& error);
+  void StopRingLocked();
+  void StopAsyncIoLocked();
+  // Throws and returns true while readMany() calls are pending: the async
+  // reader thread then owns the backend's single-consumer read side.
+  bool RejectWhileAsyncReadsLocked(Napi::Env env, const char* operation);
   void ReleaseTsfnLocked();
   void PauseReceiveFromDispatch();
 };
@@ -130,12 +342,22 @@ Napi::Object TunDevice::Init(Napi::Env env, Napi::Object exports) {
     InstanceMethod("close", &TunDevice::Close),
     InstanceMethod("read", &TunDevice::Read),
     InstanceMethod("write", &TunDevice::Write),
+    InstanceMethod("readMany", &TunDevice::ReadMany),
+    InstanceMethod("readInto", &TunDevice::ReadInto),
+    InstanceMethod("writeFrom", &TunDevice::WriteFrom),
+    InstanceMethod("writeMany", &TunDevice::WriteMany),
     InstanceMethod("getName", &TunDevice::GetName),
     InstanceMethod("getFd", &TunDevice::GetFd),
+    InstanceMethod("getOffloadEnabled", &TunDevice::GetOffloadEnabled),
+    InstanceMethod("getQueueCount", &TunDevice::GetQueueCount),
+    InstanceMethod("getIoUringEnabled", &TunDevice::GetIoUringEnabled),
     InstanceMethod("getForwardingHandle", &TunDevice::GetForwardingHandle),
     InstanceMethod("startPolling", &TunDevice::StartPolling),
     InstanceMethod("pausePolling", &TunDevice::PausePolling),
     InstanceMethod("resumePolling", &TunDevice::ResumePolling),
+    InstanceMethod("startRing", &TunDevice::StartRing),
+    InstanceMethod("stopRing", &TunDevice::StopRing),
+    StaticMethod("getPacketPoolStats", &TunDevice::GetPacketPoolStats),
   });
 
   constructor = Napi::Persistent(func);
@@ -147,7 +369,6 @@ Napi::Object TunDevice::Init(Napi::Env env, Napi::Object exports) {
 
 TunDevice::TunDevice(const Napi::CallbackInfo& info)
     : Napi::ObjectWrap<TunDevice>(info),
-      backend_(CreatePlatformBackend()),
       is_open_(false),
       polling_(false) {
   Napi::Env env = info.Env();
@@ -156,6 +377,47 @@ TunDevice::TunDevice(const Napi::CallbackInfo& info)
   if (info.Length() > 0 && info[0].IsString()) {
     requested_name_ = info[0].As<Napi::String>().Utf8Value();
   }
+
+  TunOpenOptions options;
+  if (info.Length() > 1 && !info[1].IsUndefined() && !info[1].IsNull()) {
+    if (!info[1].IsObject()) {
+      Napi::TypeError::New(env, "Expected options object as second argument")
+        .ThrowAsJavaScriptException();
+      return;
+    }
+    Napi::Object opts = info[1].As<Napi::Object>();
+    Napi::Value offload = opts.Get("offload");
+    if (!offload.IsUndefined()) {
+      if (!offload.IsBoolean()) {
+        Napi::TypeError::New(env, "offload must be a boolean").ThrowAsJavaScriptException();
+        return;
+      }
+      options.offload = offload.As<Napi::Boolean>().Value();
+    }
+    Napi::Value queues = opts.Get("queues");
+    if (!queues.IsUndefined()) {
+      if (!queues.IsNumber()) {
+        Napi::TypeError::New(env, "queues must be a number").ThrowAsJavaScriptException();
+        return;
+      }
+      const uint32_t count = queues.As<Napi::Number>().Uint32Value();
+      if (count == 0 || count > kMaxTunQueues) {
+        Napi::RangeError::New(env, "queues must be between 1 and " + std::to_string(kMaxTunQueues))
+          .ThrowAsJavaScriptException();
+        return;
+      }
+      options.queues = count;
+    }
+    Napi::Value io_uring = opts.Get("ioUring");
+    if (!io_uring.IsUndefined()) {
+      if (!io_uring.IsBoolean()) {
+        Napi::TypeError::New(env, "ioUring must be a boolean").ThrowAsJavaScriptException();
+        return;
+      }
+      options.io_uring = io_uring.As<Napi::Boolean>().Value();
+    }
+  }
+  backend_ = CreatePlatformBackend(options);
 }
 
 TunDevice::~TunDevice() {
@@ -203,6 +465,9 @@ Napi::Value TunDevice::Read(const Napi::CallbackInfo& info) {
     Napi::Error::New(env, "Device not open").ThrowAsJavaScriptException();
     return env.Null();
   }
+  if (RejectWhileAsyncReadsLocked(env, "read()")) {
+    return env.Null();
+  }
 
   size_t buffer_size = 4096;
   if (info.Length() > 0 && info[0].IsNumber()) {
@@ -246,6 +511,108 @@ Napi::Value TunDevice::Write(const Napi::CallbackInfo& info) {
 
   std::string error;
   ssize_t bytes_written = backend_->WritePacket(data, length, error);
+  if (bytes_written >= 0 && !backend_->FlushWrites(error)) {
+    bytes_written = -1;
+  }
+  if (bytes_written < 0) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  return Napi::Number::New(env, static_cast<double>(bytes_written));
+}
+
+// Validates `(Uint8Array, offset[, length])` for readInto/writeFrom and
+// returns the addressed range, or false with a pending JS exception.
+bool GetByteRange(const Napi::CallbackInfo& info,
+                  bool has_length,
+                  uint8_t*& data,
+                  size_t& length) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsTypedArray() ||
+      info[0].As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+    Napi::TypeError::New(env, "Expected Buffer or Uint8Array as first argument")
+      .ThrowAsJavaScriptException();
+    return false;
+  }
+  Napi::Uint8Array array = info[0].As<Napi::Uint8Array>();
+  const double size = static_cast<double>(array.ByteLength());
+  const double offset =
+      info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().DoubleValue() : 0;
+  if (offset < 0 || offset > size) {
+    Napi::RangeError::New(env, "Offset out of range").ThrowAsJavaScriptException();
+    return false;
+  }
+  double span = size - offset;
+  if (has_length && info.Length() > 2 && info[2].IsNumber()) {
+    span = info[2].As<Napi::Number>().DoubleValue();
+    if (span < 0 || offset + span > size) {
+      Napi::RangeError::New(env, "Length out of range").ThrowAsJavaScriptException();
+      return false;
+    }
+  }
+  data = array.Data() + static_cast<size_t>(offset);
+  length = static_cast<size_t>(span);
+  return true;
+}
+
+Napi::Value TunDevice::ReadInto(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::lock_guard<std::mutex> lock(device_mutex_);
+
+  if (!is_open_ || !backend_ || !backend_->IsOpen()) {
+    Napi::Error::New(env, "Device not open").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (RejectWhileAsyncReadsLocked(env, "readInto()")) {
+    return env.Null();
+  }
+  uint8_t* data = nullptr;
+  size_t capacity = 0;
+  if (!GetByteRange(info, false, data, capacity)) {
+    return env.Null();
+  }
+  if (capacity == 0) {
+    Napi::RangeError::New(env, "No room to read into").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Straight into the caller's memory: no vector, no Buffer allocation.
+  size_t length = 0;
+  int error_code = 0;
+  switch (backend_->ReadPacketInto(data, capacity, length, error_code)) {
+    case TunIoStatus::kOk:
+      return Napi::Number::New(env, static_cast<double>(length));
+    case TunIoStatus::kWouldBlock:
+    case TunIoStatus::kClosed:
+      return Napi::Number::New(env, 0);
+    default:
+      Napi::Error::New(env, "Read error: " + TunIoErrorString(error_code)).ThrowAsJavaScriptException();
+      return env.Null();
+  }
+}
+
+Napi::Value TunDevice::WriteFrom(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::lock_guard<std::mutex> lock(device_mutex_);
+
+  if (!is_open_ || !backend_ || !backend_->IsOpen()) {
+    Napi::Error::New(env, "Device not open").ThrowAsJavaScriptException();
+    return Napi::Number::New(env, -1);
+  }
+  uint8_t* data = nullptr;
+  size_t length = 0;
+  if (!GetByteRange(info, true, data, length)) {
+    return Napi::Number::New(env, -1);
+  }
+  if (length == 0) {
+    return Napi::Number::New(env, 0);
+  }
+
+  std::string error;
+  ssize_t bytes_written = backend_->WritePacket(data, length, error);
+  if (bytes_written >= 0 && !backend_->FlushWrites(error)) {
+    bytes_written = -1;
+  }
   if (bytes_written < 0) {
     Napi::Error::New(env, error).ThrowAsJavaScriptException();
     return Napi::Number::New(env, -1);
@@ -253,6 +620,181 @@ Napi::Value TunDevice::Write(const Napi::CallbackInfo& info) {
   return Napi::Number::New(env, static_cast<double>(bytes_written));
 }
 
+Napi::Value TunDevice::ReadMany(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::lock_guard<std::mutex> lock(device_mutex_);
+
+  if (!is_open_ || !backend_ || !backend_->IsOpen()) {
+    Napi::Error::New(env, "Device not open").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (polling_ || ring_) {
+    // Polling and the packet ring read the device on threads of their own.
+    Napi::Error::New(env, "readMany() is not available while polling or a packet ring is active")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info.Length() < 3 || !info[0].IsNumber() || !info[1].IsNumber() || !info[2].IsNumber()) {
+    Napi::TypeError::New(env, "Expected (maxPackets, maxSize, maxBytes[, timeoutMs])")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  AsyncReadRequest request;
+  request.max_packets = info[0].As<Napi::Number>().Uint32Value();
+  request.max_size = info[1].As<Napi::Number>().Uint32Value();
+  request.max_bytes = info[2].As<Napi::Number>().Uint32Value();
+  if (request.max_packets == 0 || request.max_packets > MAX_READ_MANY_PACKETS) {
+    Napi::RangeError::New(env, "Max packets must be between 1 and " +
+                                   std::to_string(MAX_READ_MANY_PACKETS))
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (request.max_size == 0 || request.max_size > MAX_POLL_BUFFER) {
+    Napi::RangeError::New(env, "Read buffer size must be between 1 and " + std::to_string(MAX_POLL_BUFFER))
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (request.max_bytes < request.max_size || request.max_bytes > MAX_READ_MANY_BYTES) {
+    Napi::RangeError::New(env, "Max bytes must be between the read size and " +
+                                   std::to_string(MAX_READ_MANY_BYTES))
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info.Length() > 3 && info[3].IsNumber()) {
+    const double timeout = info[3].As<Napi::Number>().DoubleValue();
+    if (timeout < 0 || timeout > INT32_MAX) {
+      Napi::RangeError::New(env, "Timeout must be between 0 and " + std::to_string(INT32_MAX) + " ms")
+        .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    request.timeout_ms = static_cast<int>(timeout);
+  }
+
+  if (!async_reader_) {
+    async_reader_ = std::make_unique<TunAsyncReader>();
+  }
+  std::string error;
+  if (!async_reader_->Start(backend_.get(), error)) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  napi_deferred deferred = nullptr;
+  napi_value promise = nullptr;
+  if (!BeginAsyncCall(env, deferred, promise)) {
+    return env.Null();
+  }
+  AsyncIoTsfn tsfn = async_tsfn_;
+  async_reader_->Submit(request, [tsfn, deferred](PooledPacket batch, const std::string& error) mutable {
+    auto* completion = new AsyncIoCompletion();
+    completion->deferred = deferred;
+    completion->batch = batch.release();
+    completion->error = error;
+    if (tsfn.NonBlockingCall(completion) != napi_ok) {
+      PacketPool::Instance().Release(completion->batch);
+      delete completion;
+    }
+  });
+  return Napi::Value(env, promise);
+}
+
+Napi::Value TunDevice::WriteMany(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::lock_guard<std::mutex> lock(device_mutex_);
+
+  if (!is_open_ || !backend_ || !backend_->IsOpen()) {
+    Napi::Error::New(env, "Device not open").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "Expected an array of buffers").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Array buffers = info[0].As<Napi::Array>();
+  const uint32_t count = buffers.Length();
+  if (count == 0 || count > TunAsyncWriter::kMaxJobPackets) {
+    Napi::RangeError::New(env, "Packet count must be between 1 and " +
+                                   std::to_string(TunAsyncWriter::kMaxJobPackets))
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Copy the packets off the JS heap into one pooled buffer, so the writer
+  // thread never touches JS memory and the caller may reuse its buffers.
+  std::vector<Napi::Uint8Array> arrays;
+  arrays.reserve(count);
+  size_t bytes = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    Napi::Value value = buffers.Get(i);
+    if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+      Napi::TypeError::New(env, "Every packet must be a Buffer or Uint8Array").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    arrays.push_back(value.As<Napi::Uint8Array>());
+    const size_t length = arrays.back().ByteLength();
+    if (length == 0 || length > MAX_POLL_BUFFER) {
+      Napi::RangeError::New(env, "Packet length must be between 1 and " + std::to_string(MAX_POLL_BUFFER))
+        .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    bytes += length;
+  }
+  PooledPacket packed(PacketPool::Instance().Acquire(PackedBatchBytes(bytes, count)));
+  PacketBuffer* buffer = packed.get();
+  uint32_t* offsets = WritePackedBatchTail(buffer, bytes, count);
+  size_t offset = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    offsets[i] = static_cast<uint32_t>(offset);
+    memcpy(packed.data() + offset, arrays[i].Data(), arrays[i].ByteLength());
+    offset += arrays[i].ByteLength();
+  }
+  offsets[count] = static_cast<uint32_t>(offset);
+
+  if (!async_writer_) {
+    async_writer_ = std::make_unique<TunAsyncWriter>();
+  }
+  std::string error;
+  if (!async_writer_->Start(backend_.get(), error)) {
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  napi_deferred deferred = nullptr;
+  napi_value promise = nullptr;
+  if (!BeginAsyncCall(env, deferred, promise)) {
+    return env.Null();
+  }
+  AsyncIoTsfn tsfn = async_tsfn_;
+  async_writer_->Submit(std::move(packed), [tsfn, deferred](size_t written, const std::string& error) mutable {
+    auto* completion = new AsyncIoCompletion();
+    completion->deferred = deferred;
+    completion->is_write = true;
+    completion->written = written;
+    completion->error = error;
+    if (tsfn.NonBlockingCall(completion) != napi_ok) {
+      delete completion;
+    }
+  });
+  return Napi::Value(env, promise);
+}
+
+bool TunDevice::BeginAsyncCall(Napi::Env env, napi_deferred& deferred, napi_value& promise) {
+  if (!async_tsfn_) {
+    async_dispatch_ = new AsyncIoDispatch();
+    async_tsfn_ = AsyncIoTsfn::New(env, "TunDeviceAsyncIo", 0, 1, async_dispatch_,
+                                   [](Napi::Env, void*, AsyncIoDispatch* dispatch) { delete dispatch; });
+    async_dispatch_->tsfn = async_tsfn_;
+    async_tsfn_.Unref(env);
+  }
+  if (napi_create_promise(env, &deferred, &promise) != napi_ok) {
+    Napi::Error::New(env, "Failed to create promise").ThrowAsJavaScriptException();
+    return false;
+  }
+  if (async_dispatch_->in_flight++ == 0) {
+    async_tsfn_.Ref(env);
+  }
+  return true;
+}
+
 Napi::Value TunDevice::GetName(const Napi::CallbackInfo& info) {
   std::lock_guard<std::mutex> lock(device_mutex_);
   return Napi::String::New(info.Env(), interface_name_);
@@ -263,6 +805,34 @@ Napi::Value TunDevice::GetFd(const Napi::CallbackInfo& info) {
   return Napi::Number::New(info.Env(), backend_ ? backend_->GetNativeFd() : -1);
 }
 
+Napi::Value TunDevice::GetOffloadEnabled(const Napi::CallbackInfo& info) {
+  std::lock_guard<std::mutex> lock(device_mutex_);
+  return Napi::Boolean::New(info.Env(), backend_ && backend_->OffloadEnabled());
+}
+
+Napi::Value TunDevice::GetQueueCount(const Napi::CallbackInfo& info) {
+  std::lock_guard<std::mutex> lock(device_mutex_);
+  return Napi::Number::New(info.Env(), backend_ ? static_cast<double>(backend_->QueueCount()) : 1);
+}
+
+Napi::Value TunDevice::GetIoUringEnabled(const Napi::CallbackInfo& info) {
+  std::lock_guard<std::mutex> lock(device_mutex_);
+  return Napi::Boolean::New(info.Env(), backend_ && backend_->IoUringEnabled());
+}
+
+Napi::Value TunDevice::GetPacketPoolStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  const PacketPoolStats stats = PacketPool::Instance().GetStats();
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("heapAllocations", Napi::Number::New(env, static_cast<double>(stats.heap_allocations)));
+  result.Set("oversizeAllocations",
+             Napi::Number::New(env, static_cast<double>(stats.oversize_allocations)));
+  result.Set("acquired", Napi::Number::New(env, static_cast<double>(stats.acquired)));
+  result.Set("released", Napi::Number::New(env, static_cast<double>(stats.released)));
+  result.Set("pooled", Napi::Number::New(env, static_cast<double>(stats.pooled)));
+  return result;
+}
+
 Napi::Value TunDevice::GetForwardingHandle(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   std::lock_guard<std::mutex> lock(device_mutex_);
@@ -283,13 +853,21 @@ Napi::Value TunDevice::StartPolling(const Napi::CallbackInfo& info) {
     Napi::Error::New(env, "Device not open").ThrowAsJavaScriptException();
     return env.Null();
   }
+  if (RejectWhileAsyncReadsLocked(env, "startPolling()")) {
+    return env.Null();
+  }
 
   if (info.Length() < 1 || !info[0].IsFunction()) {
     Napi::TypeError::New(env, "Expected function as first argument").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  StopPollingLocked();
+  std::string stop_error;
+  if (!StopPollingLocked(stop_error)) {
+    Napi::Error::New(env, stop_error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  StopRingLocked();
 
   size_t buffer_size = MAX_POLL_BUFFER;
   if (info.Length() > 1 && info[1].IsNumber()) {
@@ -310,14 +888,62 @@ Napi::Value TunDevice::StartPolling(const Napi::CallbackInfo& info) {
     }
   }
 
+  // Receive queues to poll on a multi-queue device; the rest are detached
+  // while polling so the kernel does not steer flows to them.
+  size_t poll_queues = backend_->QueueCount();
+  if (info.Length() > 3 && info[3].IsNumber()) {
+    poll_queues = info[3].As<Napi::Number>().Uint32Value();
+    if (poll_queues == 0 || poll_queues > backend_->QueueCount()) {
+      Napi::RangeError::New(env, "Poll queue count must be between 1 and " +
+                                     std::to_string(backend_->QueueCount()))
+        .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+  // Batched delivery: up to `max_batch` packets per callback, held at most
+  // `max_delay_us` while the device is busy.
+  ReceiveLoopOptions loop_options;
+  loop_options.buffer_size = buffer_size;
+  if (info.Length() > 4 && info[4].IsNumber()) {
+    loop_options.max_batch = info[4].As<Napi::Number>().Uint32Value();
+    if (loop_options.max_batch == 0 || loop_options.max_batch > MAX_POLL_BATCH) {
+      Napi::RangeError::New(env, "Max batch must be between 1 and " + std::to_string(MAX_POLL_BATCH))
+        .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+  if (info.Length() > 5 && info[5].IsNumber()) {
+    loop_options.max_delay_us = info[5].As<Napi::Number>().Uint32Value();
+    if (loop_options.max_delay_us > MAX_POLL_DELAY_US) {
+      Napi::RangeError::New(env, "Max delay must be at most " + std::to_string(MAX_POLL_DELAY_US) + " us")
+        .ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+
+  std::string queue_error;
+  if (!backend_->SetActiveQueues(poll_queues, queue_error)) {
+    Napi::Error::New(env, queue_error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  polling_paused_ = false;
+  auto* dispatch = new TunPollDispatch();
+  dispatch->SetCapacity(queue_depth);
+  dispatch->batched = loop_options.max_batch > 0;
+  dispatch->device_ = this;
+  poll_dispatch_ = dispatch;
+
   // Queue depth > 1 lets the poll thread post the next packet while JS is still
   // handling the previous callback (still serialized on the main thread).
-  tsfn_ = Napi::ThreadSafeFunction::New(
+  tsfn_ = PacketTsfn::New(
       env,
       info[0].As<Napi::Function>(),
       "TunDeviceDataCallback",
       0,
-      queue_depth);
+      queue_depth,
+      dispatch);
+  dispatch->tsfn = tsfn_;
 
   uv_loop_t* loop = nullptr;
   napi_status napi_st = napi_get_uv_event_loop(env, &loop);
@@ -327,19 +953,21 @@ Napi::Value TunDevice::StartPolling(const Napi::CallbackInfo& info) {
     return env.Null();
   }
 
-  Napi::ThreadSafeFunction tsfn = tsfn_;
-  auto* dispatch = new TunPollDispatch();
-  dispatch->tsfn = tsfn;
-  dispatch->max_pending_ = queue_depth;
-  dispatch->device_ = this;
-  poll_dispatch_ = dispatch;
-  auto packet_cb = [this, dispatch](std::vector<uint8_t> packet) mutable -> bool {
-    const bool accepted = dispatch->PostPacket(std::move(packet));
+  // The receive loop keeps draining while this returns true. Out of credits
+  // it pauses until JS hands one back (OnJsConsumed resumes it); the
+  // re-check covers a credit returned between the post and the pause, which
+  // can happen when the loop runs on its own thread (Windows).
+  auto packet_cb = [this, dispatch](PooledPacket packet) mutable -> bool {
+    if (dispatch->PostPacket(std::move(packet))) {
+      return true;
+    }
     if (polling_ && backend_) {
-      // Pause until the JS callback runs (pmd3 reads one utun packet per iteration).
       backend_->PauseReceiveLoop();
+      if (dispatch->HasCredit() && !polling_paused_) {
+        backend_->ResumeReceiveLoop();
+      }
     }
-    return accepted;
+    return false;
   };
   // Terminal errors from the receive loop (poll error, device closed, read
   // error) call back here so the JS-side polling_ flag and TSFN are released
@@ -348,12 +976,15 @@ Napi::Value TunDevice::StartPolling(const Napi::CallbackInfo& info) {
   auto error_cb = [this](const std::string& message) {
     fprintf(stderr, "tuntap receive loop error: %s\n", message.c_str());
     std::lock_guard<std::mutex> lock(device_mutex_);
-    polling_ = false;
-    ReleaseTsfnLocked();
+    // Other queues' poll handles share the dispatch released here.
+    std::string stop_error;
+    if (!StopPollingLocked(stop_error)) {
+      tuntap::FwdDebug("poll-queue-reattach-failed", "%s", stop_error.c_str());
+    }
   };
 
   std::string start_error;
-  if (!backend_->StartReceiveLoop(loop, buffer_size, std::move(packet_cb), std::move(error_cb), start_error)) {
+  if (!backend_->StartReceiveLoop(loop, loop_options, std::move(packet_cb), std::move(error_cb), start_error)) {
     ReleaseTsfnLocked();
     Napi::Error::New(env, start_error).ThrowAsJavaScriptException();
     return env.Null();
@@ -371,6 +1002,7 @@ Napi::Value TunDevice::PausePolling(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
+  polling_paused_ = true;
   backend_->PauseReceiveLoop();
   return env.Undefined();
 }
@@ -383,13 +1015,125 @@ Napi::Value TunDevice::ResumePolling(const Napi::CallbackInfo& info) {
     return env.Undefined();
   }
 
-  backend_->ResumeReceiveLoop();
+  polling_paused_ = false;
+  // Without credits the loop stays paused until JS consumes a delivery.
+  if (poll_dispatch_ == nullptr || poll_dispatch_->HasCredit()) {
+    backend_->ResumeReceiveLoop();
+  }
   return env.Undefined();
 }
 
+Napi::Value TunDevice::StartRing(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::lock_guard<std::mutex> lock(device_mutex_);
+
+  if (!is_open_ || !backend_ || !backend_->IsOpen()) {
+    Napi::Error::New(env, "Device not open").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (RejectWhileAsyncReadsLocked(env, "startRing()")) {
+    return env.Null();
+  }
+  if (info.Length() < 4 || !info[0].IsTypedArray() || !info[1].IsNumber() ||
+      !info[2].IsNumber() || !info[3].IsFunction()) {
+    Napi::TypeError::New(env, "Expected (Uint8Array, slots, slotSize, wakeup callback)")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::TypedArray typed = info[0].As<Napi::TypedArray>();
+  if (typed.TypedArrayType() != napi_uint8_array) {
+    Napi::TypeError::New(env, "Packet ring memory must be a Uint8Array").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  // The producer thread writes while JS runs, which is only defined for
+  // shared memory; a plain ArrayBuffer could also be detached or moved.
+  napi_value backing = nullptr;
+  bool is_plain_buffer = false;
+  if (napi_get_typedarray_info(env, typed, nullptr, nullptr, nullptr, &backing, nullptr) != napi_ok ||
+      napi_is_arraybuffer(env, backing, &is_plain_buffer) != napi_ok || is_plain_buffer) {
+    Napi::TypeError::New(env, "Packet ring memory must be backed by a SharedArrayBuffer")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  Napi::Uint8Array memory = info[0].As<Napi::Uint8Array>();
+  const size_t slots = info[1].As<Napi::Number>().Uint32Value();
+  const size_t slot_size = info[2].As<Napi::Number>().Uint32Value();
+  if (slots < 2 || slots > MAX_RING_SLOTS || (slots & (slots - 1)) != 0) {
+    Napi::RangeError::New(env, "Ring slots must be a power of two between 2 and " +
+                                   std::to_string(MAX_RING_SLOTS))
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (slot_size <= packet_ring::kSlotHeaderBytes || slot_size > MAX_RING_SLOT_SIZE ||
+      slot_size % 8 != 0) {
+    Napi::RangeError::New(env, "Ring slot size must be a multiple of 8 up to " +
+                                   std::to_string(MAX_RING_SLOT_SIZE))
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  // The producer thread writes here while JS runs, so the memory must be
+  // 4-byte aligned for the header atomics and big enough for every slot.
+  if (memory.ByteLength() < PacketRingProducer::RequiredBytes(slots, slot_size) ||
+      reinterpret_cast<uintptr_t>(memory.Data()) % alignof(uint32_t) != 0) {
+    Napi::RangeError::New(env, "Packet ring memory is too small or misaligned")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // The ring reads every active queue, so it needs them all attached again.
+  std::string stop_error;
+  if (!StopPollingLocked(stop_error)) {
+    Napi::Error::New(env, stop_error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  StopRingLocked();
+
+  ring_tsfn_ = RingTsfn::New(env, info[3].As<Napi::Function>(), "TunDeviceRingWakeup", 0, 1);
+  ring_error_tsfn_ =
+    RingTsfn::New(env, info[3].As<Napi::Function>(), "TunDeviceRingError", 1, 1);
+  ring_memory_ = Napi::Persistent(info[0].As<Napi::Object>());
+  ring_ = std::make_unique<PacketRingProducer>();
+
+  RingTsfn tsfn = ring_tsfn_;
+  RingTsfn error_tsfn = ring_error_tsfn_;
+  // A full wakeup queue already holds a wakeup, so dropping this one is fine.
+  auto wake = [tsfn]() mutable { tsfn.NonBlockingCall(); };
+  // The error call also wakes the consumer; if it cannot be queued, fall
+  // back to a plain wakeup so the consumer still sees the failed state.
+  auto on_error = [tsfn, error_tsfn](const std::string& message) mutable {
+    tuntap::FwdDebug("ring-error", "%s", message.c_str());
+    auto* owned = new std::string(message);
+    if (error_tsfn.NonBlockingCall(owned) != napi_ok) {
+      delete owned;
+      tsfn.NonBlockingCall();
+    }
+  };
+
+  std::string error;
+  if (!ring_->Start(backend_.get(), memory.Data(), slots, slot_size, std::move(wake),
+                    std::move(on_error), error)) {
+    StopRingLocked();
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return env.Undefined();
+}
+
+Napi::Value TunDevice::StopRing(const Napi::CallbackInfo& info) {
+  std::lock_guard<std::mutex> lock(device_mutex_);
+  StopRingLocked();
+  return info.Env().Undefined();
+}
+
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
   TunDevice::Init(env, exports);
   InitTunnelForwarder(env, exports);
+  InitDebugLog(env, exports);
+  InitTcpOffload(env, exports);
+#ifdef __linux__
+  InitRtNetlink(env, exports);
+  InitLinkStats(env, exports);
+#endif
   return exports;
 }
 
@@ -397,7 +1141,12 @@ NODE_API_MODULE(tuntap, Init)
 
 void TunDevice::CloseInternal() {
   if (is_open_.exchange(false)) {
-    StopPollingLocked();
+    std::string stop_error;
+    if (!StopPollingLocked(stop_error)) {
+      tuntap::FwdDebug("poll-queue-reattach-failed", "%s", stop_error.c_str());
+    }
+    StopRingLocked();
+    StopAsyncIoLocked();
     if (backend_) {
       backend_->CloseDevice();
     }
@@ -405,11 +1154,60 @@ void TunDevice::CloseInternal() {
   }
 }
 
-void TunDevice::StopPollingLocked() {
+bool TunDevice::StopPollingLocked(std::string& error) {
+  bool ok = true;
   if (polling_.exchange(false) && backend_) {
     backend_->StopReceiveLoop();
+    // Re-attach queues startPolling detached.
+    ok = !backend_->IsOpen() || backend_->SetActiveQueues(backend_->QueueCount(), error);
   }
   ReleaseTsfnLocked();
+  return ok;
+}
+
+void TunDevice::StopRingLocked() {
+  // Join the producer before dropping the memory it writes to; its final
+  // wakeup is still delivered by the TSFN release.
+  if (ring_) {
+    ring_->Stop();
+    ring_.reset();
+  }
+  if (ring_tsfn_) {
+    ring_tsfn_.Release();
+    ring_tsfn_ = nullptr;
+  }
+  if (ring_error_tsfn_) {
+    ring_error_tsfn_.Release();
+    ring_error_tsfn_ = nullptr;
+  }
+  ring_memory_.Reset();
+}
+
+bool TunDevice::RejectWhileAsyncReadsLocked(Napi::Env env, const char* operation) {
+  if (!async_reader_ || !async_reader_->busy()) {
+    return false;
+  }
+  Napi::Error::New(env, std::string(operation) + " is not available while readMany() calls are pending")
+    .ThrowAsJavaScriptException();
+  return true;
+}
+
+void TunDevice::StopAsyncIoLocked() {
+  // Pending calls are rejected through the TSFN, which still delivers them
+  // after the release below.
+  if (async_reader_) {
+    async_reader_->Stop();
+    async_reader_.reset();
+  }
+  if (async_writer_) {
+    async_writer_->Stop();
+    async_writer_.reset();
+  }
+  if (async_tsfn_) {
+    async_tsfn_.Release();
+    async_tsfn_ = nullptr;
+    async_dispatch_ = nullptr;
+  }
 }
 
 void TunDevice::ReleaseTsfnLocked() {
@@ -430,7 +1228,8 @@ void TunPollDispatch::OnJsConsumed() {
   TunDevice* device = nullptr;
   {
     std::lock_guard<std::mutex> lock(mutex);
-    if (pending.empty() && device_ != nullptr) {
+    // Only the credit that ends a pause needs to wake the loop.
+    if (credits++ == 0 && device_ != nullptr) {
       device = device_;
     }
   }
@@ -448,7 +1247,7 @@ void TunDevice::PauseReceiveFromDispatch() {
 
 void TunDevice::ResumeReceiveFromDispatch() {
   std::lock_guard<std::mutex> lock(device_mutex_);
-  if (polling_ && backend_) {
+  if (polling_ && backend_ && !polling_paused_) {
     backend_->ResumeReceiveLoop();
   }
 }
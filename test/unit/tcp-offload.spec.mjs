@@ -0,0 +1,179 @@
+import assert from 'node:assert';
+import {createRequire} from 'node:module';
+import path from 'node:path';
+import {describe, it} from 'node:test';
+import {fileURLToPath} from 'node:url';
+
+// The coalescer and segmenter are native-only; `tcpOffload` is a test hook on
+// the addon rather than part of the package API.
+const require = createRequire(import.meta.url);
+const pkgRoot = path.resolve(path.dirname(fileURLToPath(import.meta.url)), '../..');
+const {tcpOffload} = require('node-gyp-build')(pkgRoot);
+
+const IPV6_HEADER = 40;
+const TCP_HEADER = 20;
+const TCP_CHECKSUM = 16;
+const FIN = 0x01;
+const PSH = 0x08;
+const ACK = 0x10;
+const CWR = 0x80;
+
+function sum16(buffer, start, end, sum = 0) {
+  for (let i = start; i < end; i += 2) {
+    sum += (buffer[i] << 8) | (i + 1 < end ? buffer[i + 1] : 0);
+  }
+  return sum;
+}
+
+function fold(sum) {
+  while (sum > 0xffff) {
+    sum = (sum & 0xffff) + Math.floor(sum / 0x10000);
+  }
+  return sum;
+}
+
+function pseudoHeaderSum(packet) {
+  const upperLength = packet.length - IPV6_HEADER;
+  return sum16(packet, 8, 40) + Math.floor(upperLength / 0x10000) + (upperLength & 0xffff) + 6;
+}
+
+/** True when the TCP checksum of an IPv6 packet verifies. */
+function tcpChecksumValid(packet) {
+  return fold(sum16(packet, IPV6_HEADER, packet.length, pseudoHeaderSum(packet))) === 0xffff;
+}
+
+function payloadOf(packet) {
+  return packet.subarray(IPV6_HEADER + TCP_HEADER);
+}
+
+/** IPv6/TCP segment 2001:db8::1:49152 -> 2001:db8::2:443 with a valid checksum. */
+function tcpPacket({seq, payload, flags = ACK, window = 512}) {
+  const packet = Buffer.alloc(IPV6_HEADER + TCP_HEADER + payload.length);
+  packet[0] = 0x60;
+  packet.writeUInt16BE(TCP_HEADER + payload.length, 4);
+  packet[6] = 6;
+  packet[7] = 64;
+  packet.writeUInt16BE(0x2001, 8);
+  packet.writeUInt16BE(0x0db8, 10);
+  packet[23] = 1;
+  packet.writeUInt16BE(0x2001, 24);
+  packet.writeUInt16BE(0x0db8, 26);
+  packet[39] = 2;
+  const tcp = IPV6_HEADER;
+  packet.writeUInt16BE(49152, tcp);
+  packet.writeUInt16BE(443, tcp + 2);
+  packet.writeUInt32BE(seq, tcp + 4);
+  packet.writeUInt32BE(1000, tcp + 8);
+  packet[tcp + 12] = (TCP_HEADER / 4) << 4;
+  packet[tcp + 13] = flags;
+  packet.writeUInt16BE(window, tcp + 14);
+  payload.copy(packet, tcp + TCP_HEADER);
+  const checksum = ~fold(sum16(packet, tcp, packet.length, pseudoHeaderSum(packet))) & 0xffff;
+  packet.writeUInt16BE(checksum, tcp + TCP_CHECKSUM);
+  return packet;
+}
+
+function payloadBytes(length, seed) {
+  return Buffer.from(Array.from({length}, (_, i) => (seed + i) & 0xff));
+}
+
+/** Consecutive segments of one flow starting at `seq`, one per payload size. */
+function tcpRun(sizes, {seq = 5000, lastFlags = ACK} = {}) {
+  const frames = [];
+  for (const [i, size] of sizes.entries()) {
+    const flags = i === sizes.length - 1 ? lastFlags : ACK;
+    frames.push(tcpPacket({seq, payload: payloadBytes(size, i * 31), flags}));
+    seq += size;
+  }
+  return frames;
+}
+
+describe('TCP offload', () => {
+  describe('TcpGroCoalescer', () => {
+    it('coalesces an in-order run into one GSO super-packet', () => {
+      const frames = tcpRun([100, 100, 100, 100], {lastFlags: ACK | PSH});
+      const groups = tcpOffload.coalesce(frames);
+
+      assert.strictEqual(groups.length, 1);
+      const [{packet, segments, gso}] = groups;
+      assert.strictEqual(segments, 4);
+      assert.deepStrictEqual(gso, {
+        headerLength: 60,
+        segmentSize: 100,
+        csumStart: 40,
+        csumOffset: 16,
+      });
+      assert.strictEqual(packet.length, IPV6_HEADER + TCP_HEADER + 400);
+      assert.strictEqual(packet.readUInt16BE(4), TCP_HEADER + 400);
+      assert.strictEqual(packet.readUInt32BE(IPV6_HEADER + 4), 5000);
+      assert.strictEqual(packet[IPV6_HEADER + 13], ACK | PSH);
+      assert.ok(payloadOf(packet).equals(Buffer.concat(frames.map(payloadOf))));
+      // CHECKSUM_PARTIAL: the field holds the folded pseudo-header sum.
+      assert.strictEqual(
+        packet.readUInt16BE(IPV6_HEADER + TCP_CHECKSUM),
+        fold(pseudoHeaderSum(packet)),
+      );
+    });
+
+    it('closes a group on a short segment or PSH', () => {
+      const shortRun = tcpRun([100, 100, 60, 100]);
+      assert.deepStrictEqual(tcpOffload.coalesce(shortRun).map((group) => group.segments), [3, 1]);
+
+      const pushRun = tcpRun([100, 100, 100]);
+      pushRun[1] = tcpPacket({seq: 5100, payload: payloadBytes(100, 31), flags: ACK | PSH});
+      assert.deepStrictEqual(tcpOffload.coalesce(pushRun).map((group) => group.segments), [2, 1]);
+    });
+
+    it('passes through segments with a bad checksum or a sequence gap', () => {
+      const frames = tcpRun([100, 100, 100]);
+      frames[1] = Buffer.from(frames[1]);
+      frames[1][IPV6_HEADER + TCP_HEADER] ^= 0xff;
+      const corrupt = tcpOffload.coalesce(frames);
+      assert.deepStrictEqual(corrupt.map((group) => group.segments), [1, 1, 1]);
+      assert.ok(corrupt[1].packet.equals(frames[1]));
+      assert.strictEqual(corrupt[0].gso, undefined);
+
+      const gap = tcpRun([100, 100]).concat(tcpRun([100, 100], {seq: 9000}));
+      assert.deepStrictEqual(tcpOffload.coalesce(gap).map((group) => group.segments), [2, 2]);
+    });
+  });
+
+  describe('TcpSegmenter', () => {
+    it('splits a super-packet into MSS segments with valid checksums', () => {
+      const payload = payloadBytes(250, 7);
+      const superPacket = tcpPacket({seq: 70000, payload, flags: ACK | PSH | FIN | CWR});
+      const segments = tcpOffload.segment(superPacket, IPV6_HEADER, 100, 1500);
+
+      assert.deepStrictEqual(segments.map((segment) => segment.length), [160, 160, 110]);
+      for (const [i, segment] of segments.entries()) {
+        assert.strictEqual(segment.readUInt16BE(4), segment.length - IPV6_HEADER);
+        assert.strictEqual(segment.readUInt32BE(IPV6_HEADER + 4), 70000 + i * 100);
+        assert.ok(tcpChecksumValid(segment), `segment ${i} checksum`);
+      }
+      // FIN/PSH only on the last segment, CWR only on the first.
+      assert.deepStrictEqual(
+        segments.map((segment) => segment[IPV6_HEADER + 13]),
+        [ACK | CWR, ACK, ACK | PSH | FIN],
+      );
+      assert.ok(Buffer.concat(segments.map(payloadOf)).equals(payload));
+    });
+
+    it('caps segments at the reader buffer size', () => {
+      const superPacket = tcpPacket({seq: 1, payload: payloadBytes(200, 0)});
+      const maxPacket = IPV6_HEADER + TCP_HEADER + 80;
+      const segments = tcpOffload.segment(superPacket, IPV6_HEADER, 1000, maxPacket);
+      assert.deepStrictEqual(segments.map((segment) => payloadOf(segment).length), [80, 80, 40]);
+    });
+
+    it('rejects packets that are not TCP/IPv6 super-packets', () => {
+      assert.throws(() => tcpOffload.segment(Buffer.alloc(30), IPV6_HEADER, 100, 1500));
+    });
+
+    it('restores the original segments of a coalesced run', () => {
+      const frames = tcpRun([100, 100, 100, 100], {lastFlags: ACK | PSH});
+      const [{packet, gso}] = tcpOffload.coalesce(frames);
+      const segments = tcpOffload.segment(packet, gso.csumStart, gso.segmentSize, 1500);
+      assert.deepStrictEqual(segments, frames);
+    });
+  });
+});
@@ -1,7 +1,16 @@
 import assert from 'node:assert';
 import {afterEach, describe, it} from 'node:test';
 
-import {TunTap, TunnelForwarder} from '../../lib/index.js';
+import {
+  flushForwarderDebugLog,
+  getForwarderDebugLevel,
+  LinkRateMeter,
+  readLinkStats,
+  setForwarderDebugLevel,
+  TunTap,
+  TunnelForwarder,
+  TunnelForwarderStats,
+} from '../../lib/index.js';
 import {hasPrivileges} from '../utils.mjs';
 
 /**
@@ -30,9 +39,58 @@ describe('TunTap Unit Tests', {timeout: 10000}, () => {
     assert.strictEqual(typeof forwarder.connectPsk, 'function');
     assert.strictEqual(typeof forwarder.handshake, 'function');
     assert.strictEqual(typeof forwarder.startForwarding, 'function');
+    assert.strictEqual(forwarder.getQueueStats(), null);
+    assert.strictEqual(forwarder.getLatencyStats(), null);
+    forwarder.resetLatencyStats();
+    assert.ok(Array.isArray(TunnelForwarder.getHubStats()));
     forwarder.stop();
   });
 
+  it('should expose zeroed forwarder stats in shared memory', () => {
+    const forwarder = new TunnelForwarder();
+    const stats = forwarder.getStats();
+    assert.ok(stats.buffer instanceof SharedArrayBuffer);
+    const snapshot = stats.snapshot();
+    assert.strictEqual(snapshot.egressPackets, 0);
+    assert.strictEqual(snapshot.ingressBytes, 0);
+    assert.strictEqual(snapshot.drops.oversize, 0);
+    // A worker wraps the same memory.
+    assert.deepStrictEqual(new TunnelForwarderStats(stats.buffer).snapshot(), snapshot);
+    assert.throws(() => new TunnelForwarderStats(new SharedArrayBuffer(16)), TypeError);
+    forwarder.stop();
+  });
+
+  it('should change the native debug log level at runtime', () => {
+    const initial = getForwarderDebugLevel();
+    try {
+      setForwarderDebugLevel('off');
+      assert.strictEqual(getForwarderDebugLevel(), 'off');
+      assert.throws(() => setForwarderDebugLevel('verbose'), TypeError);
+      flushForwarderDebugLog();
+    } finally {
+      setForwarderDebugLevel(initial);
+    }
+  });
+
+  it(
+    'should read link stats natively',
+    {skip: process.platform !== 'linux' && 'Linux only'},
+    () => {
+      const [loopback, missing] = readLinkStats(['lo', 'tuntap-missing0']);
+      assert.ok(loopback.rxPackets >= 0);
+      assert.strictEqual(typeof loopback.rxDropped, 'number');
+      assert.strictEqual(missing, null);
+
+      const meter = new LinkRateMeter();
+      const [first] = meter.sample(['lo']);
+      assert.strictEqual(first.rates, null);
+      const [second] = meter.sample(['lo']);
+      assert.ok(second.intervalMs > 0);
+      assert.ok(second.rates.rxPps >= 0);
+      assert.ok(second.stats.rxBytes >= first.stats.rxBytes);
+    },
+  );
+
   it('should open and close the TUN device', {skip: skipWithoutPrivileges}, () => {
     tun = new TunTap();
     assert.strictEqual(tun.open(), true, 'TUN device should open');
@@ -66,6 +124,19 @@ describe('TunTap Unit Tests', {timeout: 10000}, () => {
     tun.close();
   });
 
+  it('should configure routes together with the address', {skip: skipWithoutPrivileges}, async () => {
+    tun = new TunTap();
+    tun.open();
+    await tun.configure('fd00::4', 1500, ['fd02::1/128', 'fd03::/64']);
+    // Applying the same configuration again tolerates what already exists.
+    await tun.configure('fd00::4', 1500, ['fd02::1/128', 'fd03::/64']);
+    await tun.removeRoute('fd03::/64');
+    // A missing route is not an error.
+    await tun.removeRoute('fd03::/64');
+    await assert.rejects(() => tun.configure('fd00::4', 1500, ['fd04::/abc']), TypeError);
+    tun.close();
+  });
+
   it('should not leave open handles after close', {skip: skipWithoutPrivileges}, async () => {
     tun = new TunTap();
     tun.open();
@@ -90,6 +161,69 @@ describe('TunTap Unit Tests', {timeout: 10000}, () => {
     await assert.rejects(() => tun.configure('fd00::3', 100), /MTU must be between/);
     tun.close();
   });
+
+  it('should validate batch polling options', {skip: skipWithoutPrivileges}, () => {
+    tun = new TunTap();
+    tun.open();
+    const onBatch = () => {};
+    assert.throws(() => tun.startPolling(onBatch, {batch: true, maxBatch: 0}), RangeError);
+    assert.throws(() => tun.startPolling(onBatch, {batch: true, maxDelayUs: -1}), RangeError);
+    tun.startPolling(onBatch, {batch: true, maxBatch: 16, maxDelayUs: 100});
+    tun.close();
+  });
+
+  it('should validate caller-provided buffers', {skip: skipWithoutPrivileges}, () => {
+    tun = new TunTap();
+    tun.open();
+    const arena = Buffer.alloc(8192);
+    assert.throws(() => tun.readInto(arena, arena.length), RangeError);
+    assert.throws(() => tun.writeFrom(arena, 4096, 8192), RangeError);
+    assert.throws(() => tun.readInto('nope'), TypeError);
+    assert.strictEqual(tun.writeFrom(arena, 100, 0), 0);
+    tun.close();
+  });
+
+  it('should queue asynchronous writes', {skip: skipWithoutPrivileges}, async () => {
+    tun = new TunTap();
+    tun.open();
+    await assert.rejects(() => tun.writeMany([]), RangeError);
+    await assert.rejects(() => tun.writeMany([Buffer.alloc(0)]), RangeError);
+    assert.throws(() => tun.setWriteQueueOptions({highWaterMark: 0}), RangeError);
+    assert.strictEqual(tun.writeQueueDepth, 0);
+    assert.strictEqual(tun.writeQueueFull, false);
+    tun.close();
+  });
+
+  it('should time out asynchronous reads', {skip: skipWithoutPrivileges}, async () => {
+    tun = new TunTap();
+    tun.open();
+    await assert.rejects(() => tun.readMany(0), RangeError);
+    await assert.rejects(() => tun.readMany(4, 1024, {maxSize: 4096}), RangeError);
+    assert.strictEqual(await tun.readAsync(4096, {timeoutMs: 50}), null);
+    assert.deepStrictEqual(await tun.readMany(16, 65536, {timeoutMs: 50}), []);
+    // The reader thread owns the device while a call is pending.
+    const pending = tun.readMany(16, 65536, {timeoutMs: 100});
+    assert.throws(() => tun.read(), /readMany\(\) calls are pending/);
+    assert.throws(() => tun.startRing(), /readMany\(\) calls are pending/);
+    assert.deepStrictEqual(await pending, []);
+    tun.startRing({slots: 64, slotSize: 2048});
+    await assert.rejects(() => tun.readMany(16, 65536, {timeoutMs: 50}), /packet ring is active/);
+    tun.stopRing();
+    tun.close();
+  });
+
+  it('should start a shared packet ring', {skip: skipWithoutPrivileges}, () => {
+    tun = new TunTap();
+    tun.open();
+    assert.throws(() => tun.startRing({slots: 1000}), RangeError);
+    assert.throws(() => tun.startRing({slotSize: 1500}), RangeError);
+    const ring = tun.startRing({slots: 64, slotSize: 2048});
+    assert.strictEqual(ring.slotCount, 64);
+    assert.strictEqual(ring.slotSize, 2048);
+    tun.stopRing();
+    assert.strictEqual(ring.stopped, true);
+    tun.close();
+  });
 });
 
 function getPrivilegeSkipReason(hasRequiredPrivileges) {